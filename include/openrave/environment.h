@@ -834,6 +834,14 @@ public:
         return _formatedNameId;
     }
 
+    /// \brief returns the counters of the hot paths of the interfaces in this environment. <b>[multi-thread safe]</b>
+    ///
+    /// Plugins get their counters once with \ref StatisticsRegistry::GetCounter and update them with \ref StatisticsTimer.
+    /// The counters can also be read and reset through the GetStatistics and ResetStatistics json commands of any interface.
+    inline StatisticsRegistry& GetStatisticsRegistry() const {
+        return *__pStatisticsRegistry;
+    }
+
     /// \brief sets a named parameter to be tracked by the environment
     ///
     /// internally locks the environment mutex
@@ -942,6 +950,7 @@ protected:
 private:
     UserDataPtr __pUserData;         ///< \see GetUserData
     int __nUniqueId;         ///< \see RaveGetEnvironmentId
+    StatisticsRegistryPtr __pStatisticsRegistry; ///< \see GetStatisticsRegistry
 };
 
 } // end namespace OpenRAVE
@@ -243,7 +243,8 @@ public:
 
         The command must be registered by \ref RegisterJSONCommand. A special command '\b help' is
         always supported and provides a way for the user to query the current commands and the help
-        string.
+        string. The commands '\b GetStatistics' and '\b ResetStatistics' are also always supported and
+        access the \ref StatisticsRegistry of the environment, optionally restricted to input["interfaceName"].
 
         \param cmdname command name
         \param input the input rapidjson value
@@ -347,6 +348,8 @@ private:
 
     /// Write the help commands to an output stream
     virtual void _GetJSONCommandHelp(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator) const;
+    virtual void _GetJSONStatistics(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator) const;
+    virtual void _ResetJSONStatistics(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator);
 
     inline InterfaceBase& operator=(const InterfaceBase&r) {
         throw openrave_exception("InterfaceBase copying not allowed");
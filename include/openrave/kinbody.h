@@ -55,7 +55,7 @@ enum GeometryType : uint8_t
     GT_CalibrationBoard=7, ///< a box shaped geometry with grid of cylindrical dots of two sizes. The dots are always on the +z side of the box and are oriented towards z-axis.
     GT_Axial = 8, ///< a geometry defined by many slices along an axis, oriented towards z-axis
     GT_ConicalFrustum = 9, ///< a geometry defined by a conical frustum, oriented towards z-axis
-    GT_Prism = 10, ///< Non-trimesh right prisms with arbitrary non-convex cross-section and infinite height, which represent “walls” or “safe zones”. _meshcollision.vertices[2 * i].xy describes the cross-section.
+    GT_Prism = 10, ///< Non-trimesh right prisms with arbitrary non-convex cross-section and infinite height, which represent “walls” or “safe zones”. _meshcollision.GetVertex(2 * i).xy describes the cross-section.
     GT_Capsule = 11, ///< Non-trimesh capsules (oriented towards z-axis), representing "robot link model" or "gripper model", which are able of degenerating to perfect spheres with the height tends to zero.
 };
 
@@ -537,8 +537,9 @@ public:
         ///
         /// Should be transformed by \ref _t before rendering.
         /// For spheres and cylinders, an appropriate discretization value is chosen.
-        /// If empty, will be automatically computed from the geometry's type and render data
-        TriMesh _meshcollision;
+        /// If empty, will be automatically computed from the geometry's type and render data.
+        /// Stored compactly, copies of the info share the buffers.
+        CompactTriMesh _meshcollision;
 
         GeometryType _type = GT_None; ///< the type of geometry primitive
         std::string _id;   ///< unique id of the geometry
@@ -553,7 +554,7 @@ public:
         /// \brief filename for collision data (optional)
         ///
         /// This is for record keeping only and geometry does not get automatically loaded to _meshcollision.
-        /// The user should call _meshcollision = *env->ReadTrimeshURI(_filenamecollision) by themselves.
+        /// The user should call _meshcollision.SetTriMesh(*env->ReadTrimeshURI(_filenamecollision)) by themselves.
         std::string _filenamecollision;
 
         Vector _vRenderScale = Vector(1,1,1); ///< render scale of the object (x,y,z) from _filenamerender
@@ -807,7 +808,7 @@ public:
         }
 
         /// \brief returns the local collision mesh
-        inline const TriMesh& GetCollisionMesh() const {
+        inline const CompactTriMesh& GetCollisionMesh() const {
             return _info._meshcollision;
         }
 
@@ -853,6 +854,7 @@ public:
 
         /// \brief sets a new collision mesh and notifies every registered callback about it
         void SetCollisionMesh(const TriMesh& mesh);
+        void SetCollisionMesh(const CompactTriMesh& mesh);
         /// \brief sets visible flag. if changed, notifies every registered callback about it.
         ///
         /// \return true if changed
@@ -957,6 +959,11 @@ public:
         }
 
 protected:
+        /// \brief same as \ref UpdateFromInfo, but leaves updating the parent link to the caller so that a link updates only once for all of its geometries
+        ///
+        /// \param[out] bLinkUpdateRequired set to true if the shape or transform changed, then the caller has to call _Update of the parent link
+        UpdateFromInfoResult _UpdateFromInfo(const KinBody::GeometryInfo& info, bool& bLinkUpdateRequired);
+
         boost::weak_ptr<Link> _parent;
         KinBody::GeometryInfo _info; ///< geometry info
 #ifdef RAVE_PRIVATE
@@ -1162,8 +1169,22 @@ public:
         inline int GetIndex() const {
             return _index;
         }
-        inline const TriMesh& GetCollisionData() const {
-            return _collision;
+        /// \brief returns the triangulation of all the link geometries in the link coordinate system as a TriMesh
+        ///
+        /// The TriMesh is converted from \ref GetCompactCollisionData on first use and kept until the geometries change. Prefer GetCompactCollisionData, which avoids holding the extra copy.
+        /// The returned reference stays valid for the lifetime of the link, its content is recomputed when the geometries change.
+        const TriMesh& GetCollisionData() const;
+
+        /// \brief returns the triangulation of all the link geometries in the link coordinate system
+        ///
+        /// Computed from the geometries on first use after they change. The returned reference stays valid for the lifetime of the link, its content is recomputed when the geometries change.
+        const CompactTriMesh& GetCompactCollisionData() const;
+
+        /// \brief returns a number that changes every time the geometries of this link change.
+        ///
+        /// Collision checkers can compare it against a stored value to only rebuild the links whose geometries changed when \ref KinBody::Prop_LinkGeometry is posted.
+        inline int GetGeometryUpdateStamp() const {
+            return _nGeometryUpdateStamp;
         }
 
         /// \brief Compute the aabb of all the geometries of the link in the link coordinate system
@@ -1444,6 +1465,9 @@ protected:
         /// \param parameterschanged if true, will
         void _Update(bool parameterschanged=true, uint32_t extraParametersChanged=0);
 
+        /// \brief clears the collision data computed from the geometries, it is computed again on next use
+        void _ResetCollisionData();
+
         std::vector<GeometryPtr> _vGeometries;         ///< \see GetGeometries
 
         LinkInfo _info; ///< parameter information of the link
@@ -1456,8 +1480,28 @@ private:
         KinBodyWeakPtr _parent;         ///< \see GetParent
         std::vector<int> _vParentLinks;         ///< \see GetParentLinks, IsParentLink
         std::vector<int> _vRigidlyAttachedLinks;         ///< \see IsRigidlyAttached, GetRigidlyAttachedLinks
-        TriMesh _collision; ///< triangles for collision checking, triangles are always the triangulation
-                            ///< of the body when it is at the identity transformation
+        /// \brief collision data computed from the geometries on first use. Copies share the compact buffers and get their own mutex.
+        struct CollisionData
+        {
+            CollisionData() {
+            }
+            CollisionData(const CollisionData& r) : collision(r.collision), valid(r.valid.load() & 1) {
+            }
+            CollisionData& operator=(const CollisionData& r) {
+                collision = r.collision;
+                collisiontrimesh = TriMesh();
+                valid.store(r.valid.load() & 1);
+                return *this;
+            }
+
+            CompactTriMesh collision; ///< triangles for collision checking, triangles are always the triangulation
+                                      ///< of the body when it is at the identity transformation. computed on first use, cleared when the geometries change
+            TriMesh collisiontrimesh; ///< collision converted for GetCollisionData
+            boost::mutex mutex; ///< protects the computation of collision and collisiontrimesh
+            std::atomic<uint8_t> valid{0}; ///< bit 0 set if collision is computed, bit 1 set if collisiontrimesh is computed
+        };
+        mutable CollisionData _collisiondata; ///< \see GetCompactCollisionData, GetCollisionData
+        int _nGeometryUpdateStamp = 0; ///< \see GetGeometryUpdateStamp
         //@}
 #ifdef RAVE_PRIVATE
 #ifdef _MSC_VER
@@ -3143,6 +3187,24 @@ private:
      */
     virtual void ComputeInverseDynamics(boost::array< std::vector<dReal>, 3>& doftorquecomponents, const std::vector<dReal>& dofaccelerations, const ForceTorqueMap& externalforcetorque=ForceTorqueMap()) const;
 
+    /** \brief Computes the joint-space inertia matrix at the current robot position with the composite rigid body algorithm.
+
+        The matrix is consistent with ComputeInverseDynamics, so torques = massmatrix * dofaccel + torques at zero acceleration.
+        This means rows of prismatic dofs share the force scaling of ComputeInverseDynamics and the rotor inertias of electric motors are added to the diagonal.
+        Only bodies whose joints are all single dof revolute or prismatic joints without mimic equations are supported.
+        \param[out] massmatrix GetDOF()*GetDOF() matrix in row-major order
+     */
+    virtual void ComputeMassMatrix(std::vector<dReal>& massmatrix) const;
+
+    /** \brief Computes the dof accelerations resulting from dof torques at the current robot position and velocity.
+
+        Inverts ComputeInverseDynamics by solving massmatrix * dofaccel = doftorques - torques at zero acceleration, so it has the same restrictions as ComputeMassMatrix.
+        \param[out] dofaccelerations The dof accelerations.
+        \param[in] doftorques The torques applied at every dof.
+        \param[in] externalforcetorque [optional] Specifies all the external forces/torques acting on the links at their center of mass.
+     */
+    virtual void ComputeForwardDynamics(std::vector<dReal>& dofaccelerations, const std::vector<dReal>& doftorques, const ForceTorqueMap& externalforcetorque=ForceTorqueMap()) const;
+
     /** \brief Computes dynamic limits for acceleration and jerks, which are dynamically changing based on the given positions and velocities of the robot.
 
         Since not all robots supports dynamic limits, so this function should be overriden in the subclass.
@@ -3625,6 +3687,12 @@ protected:
     /// \param[in] externalaccelerations [optional] The external accelerations to add to each link. When doing inverse dynamics, should set the base link's acceleration to -gravity.
     virtual void _ComputeLinkAccelerations(const std::vector<dReal>& dofvelocities, const std::vector<dReal>& dofaccelerations, const std::vector< std::pair<Vector, Vector> >& linkvelocities, std::vector<std::pair<Vector,Vector> >& linkaccelerations, AccelerationMapConstPtr externalaccelerations=AccelerationMapConstPtr()) const;
 
+    class DynamicsWorkspace;
+    typedef boost::shared_ptr<DynamicsWorkspace> DynamicsWorkspacePtr;
+
+    /// \brief returns the dynamics workspace of the body, creating it if the joints or link dynamics changed since the last call
+    DynamicsWorkspace& _GetDynamicsWorkspace() const;
+
     /// \brief Called to notify the body that certain groups of parameters have been changed.
     ///
     /// This function in calls every registers calledback that is tracking the changes. It also
@@ -3667,6 +3735,7 @@ protected:
     ///
     /// Assumes plink has _info initialized correctly, so will be initializing the other data depending on it.
     /// Can only be called before internal robot hierarchy is initialized.
+    /// Geometries without a collision mesh are not tessellated here so that the caller can tessellate all new links at once.
     void _InitAndAddLink(LinkPtr plink);
 
     /// \brief initializes and adds a link to internal hierarchy.
@@ -3743,6 +3812,8 @@ protected:
 
 private:
     mutable std::vector<dReal> _vTempJoints;
+    mutable DynamicsWorkspacePtr _pDynamicsWorkspace; ///< topology and buffers for the dynamics computations, reset whenever joints or link dynamics change
+    StatisticsCounter* _pSetDOFValuesStatistics; ///< counts the SetDOFValues calls, grouped under the interface type name
     virtual const char* GetHash() const {
         return OPENRAVE_KINBODY_HASH;
     }
@@ -54,6 +54,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <atomic>
 
 #if  __cplusplus >= 201703L
 #include <string_view>
@@ -695,6 +696,9 @@ OPENRAVE_API IkParameterizationType RaveGetIkTypeFromUniqueId(int uniqueid);
 class OPENRAVE_API ConfigurationSpecification
 {
 public:
+    class Converter;
+    typedef boost::shared_ptr<Converter> ConverterPtr;
+    typedef boost::shared_ptr<Converter const> ConverterConstPtr;
 
     /// \brief A group referencing the values of one body in the environment
     class OPENRAVE_API Group
@@ -1108,6 +1112,108 @@ protected:
     std::vector<Group> _vgroups;
 };
 
+/** \brief Converts data between two fixed configuration specifications, see \ref ConfigurationSpecification::ConvertData
+
+    The group names, compatible groups, dof index mappings and affine conversions are resolved once on initialization into a flat list of copy ranges, so converting points only costs copying the data. Default values for uninitialized data are still read from the environment on every call to \ref Convert, so the results are the same as \ref ConfigurationSpecification::ConvertData.
+ */
+class OPENRAVE_API ConfigurationSpecification::Converter
+{
+public:
+    Converter();
+
+    /// \brief calls \ref Init
+    Converter(const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups=true);
+
+    /** \brief prepares converting data of sourcespec to data of targetspec
+
+        \param bFillMissingGroups If true, target groups that do not have a compatible source group are set to default values when filluninitialized is set. Otherwise they are left untouched.
+        \throw openrave_exception throw if groups are incompatible
+     */
+    void Init(const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups=true);
+
+    /// \brief prepares converting data between two compatible groups, see \ref ConfigurationSpecification::ConvertGroupData
+    ///
+    /// The offsets of the groups are ignored. Since there are no specifications, \ref Convert has to be called with explicit strides.
+    void InitGroup(const Group& gtarget, const Group& gsource);
+
+    /// \brief the target specification, empty if initialized with \ref InitGroup
+    inline const ConfigurationSpecification& GetTargetSpecification() const {
+        return _targetspec;
+    }
+
+    /// \brief the source specification, empty if initialized with \ref InitGroup
+    inline const ConfigurationSpecification& GetSourceSpecification() const {
+        return _sourcespec;
+    }
+
+    inline bool IsFillingMissingGroups() const {
+        return _bFillMissingGroups;
+    }
+
+    /** \brief converts points, the strides are the dofs of the specifications
+
+        \param ittargetdata iterator pointing to start of target data that should be overwritten
+        \param itsourcedata iterator pointing to start of source data that should be read
+        \param numpoints the number of points to convert
+        \param penv [optional] The environment which might be needed to fill in unknown data. Assumes environment is locked.
+        \param filluninitialized If there exists target groups that cannot be initialized, then will set default values using the current environment.
+     */
+    void Convert(std::vector<dReal>::iterator ittargetdata, std::vector<dReal>::const_iterator itsourcedata, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized=true) const;
+
+    /// \brief converts points with explicit strides, see \ref Convert
+    void Convert(std::vector<dReal>::iterator ittargetdata, size_t targetstride, const dReal* psourcedata, size_t sourcestride, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized=true) const;
+
+private:
+    /// \brief consecutive values that are copied from the source to the target
+    struct CopyRange
+    {
+        int targetoffset, sourceoffset, length;
+    };
+
+    /// \brief an affine rotation that has to be converted to a different representation
+    struct RotationConversion
+    {
+        int targetoffset, sourceoffset;
+        boost::function<void(std::vector<dReal>::iterator, const dReal*)> convertfn;
+    };
+
+    /// \brief target values that are not in the source and are set from the environment or constants
+    struct DefaultValues
+    {
+        enum Type
+        {
+            DV_Constant=0,
+            DV_JointValues=1,
+            DV_JointVelocities=2,
+            DV_AffineTransform=3, ///< values of the body transform
+        };
+        Type type;
+        dReal fconstant;
+        std::vector<std::string> vbodynames; ///< bodies to get the values from, the first one existing in the environment is used
+        bool bWarnMissingBody;
+        std::string groupname;
+        int affinedofs;
+        std::vector<int> vtargetoffsets; ///< offsets of the values in the target point
+        std::vector<int> vindices; ///< for every target offset, the body dof index or the index into the affine values. -1 for zero.
+    };
+
+    void _Reset();
+    void _Compile(const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups);
+    void _AddGroup(int targetoffset, const Group& gtarget, int sourceoffset, const Group& gsource);
+    void _AddMissingGroup(int targetoffset, const Group& gtarget);
+    void _AddTransfer(int targetoffset, int sourceoffset);
+    void _ComputeDefaultValues(const DefaultValues& defaultvalues, EnvironmentBaseConstPtr penv, std::vector<dReal>::iterator itvalues) const;
+
+    ConfigurationSpecification _targetspec, _sourcespec;
+    std::vector<CopyRange> _vcopyranges;
+    std::vector<RotationConversion> _vrotationconversions;
+    std::vector<DefaultValues> _vdefaultvalues;
+    size_t _numdefaultvalues; ///< total number of target offsets in _vdefaultvalues
+    bool _bFillMissingGroups;
+
+    friend class ConfigurationSpecification;
+};
+
 OPENRAVE_API std::ostream& operator<<(std::ostream& O, const ConfigurationSpecification &spec);
 OPENRAVE_API std::istream& operator>>(std::istream& I, ConfigurationSpecification& spec);
 
@@ -2497,6 +2603,8 @@ inline IkParameterization operator* (const Transform &t, const IkParameterizatio
 OPENRAVE_API std::ostream& operator<<(std::ostream& O, const IkParameterization &ikparam);
 OPENRAVE_API std::istream& operator>>(std::istream& I, IkParameterization& ikparam);
 
+class OPENRAVE_API CompactTriMesh;
+
 /// \brief User data for trimesh geometries. Vertices are defined in counter-clockwise order for outward pointing faces.
 class OPENRAVE_API TriMesh
 {
@@ -2510,6 +2618,7 @@ public:
     /// append another TRIMESH to this tri mesh
     void Append(const TriMesh& mesh);
     void Append(const TriMesh& mesh, const Transform& trans);
+    void Append(const CompactTriMesh& mesh, const Transform& trans);
 
     /// clear vertices and indices vector
     void Clear();
@@ -2533,6 +2642,98 @@ public:
 OPENRAVE_API std::ostream& operator<<(std::ostream& O, const TriMesh& trimesh);
 OPENRAVE_API std::istream& operator>>(std::istream& I, TriMesh& trimesh);
 
+/** \brief Triangle mesh with packed xyz vertices in single or double precision, held in shared immutable buffers.
+
+    Copying a CompactTriMesh only copies pointers, the copies share the vertex and index buffers. A shared buffer is duplicated when one of the copies is modified (copy-on-write). Compared to TriMesh, vertices take 12 (float) or 24 (double) bytes instead of 32.
+ */
+class OPENRAVE_API CompactTriMesh
+{
+public:
+    /// \param bSinglePrecision if true, vertices are stored as float
+    CompactTriMesh(bool bSinglePrecision=false);
+    CompactTriMesh(const TriMesh& mesh, bool bSinglePrecision=false);
+
+    /// \brief sets the vertices and indices from a TriMesh, keeping the precision
+    void SetTriMesh(const TriMesh& mesh);
+
+    /// \brief converts to a TriMesh
+    void GetTriMesh(TriMesh& mesh) const;
+
+    /// \brief appends mesh transformed by trans
+    void Append(const TriMesh& mesh, const Transform& trans);
+    void Append(const CompactTriMesh& mesh, const Transform& trans);
+
+    void ApplyTransform(const Transform& t);
+    void ApplyTransform(const TransformMatrix& t);
+
+    /// \brief multiplies all vertices by fScale
+    void Scale(dReal fScale);
+
+    void Reserve(size_t numvertices, size_t numindices);
+    void Clear();
+
+    /// \brief writes the same data as TriMesh::serialize, so hashes do not depend on the storage
+    void serialize(std::ostream& o, int options=0) const;
+
+    /// \brief compares the vertex positions and indices, the precision of the storage is ignored
+    bool operator==(const CompactTriMesh& other) const;
+    bool operator!=(const CompactTriMesh& other) const {
+        return !operator==(other);
+    }
+
+    inline bool IsSinglePrecision() const {
+        return _bSinglePrecision;
+    }
+
+    inline size_t GetNumVertices() const {
+        return _bSinglePrecision ? _pverticesf->size()/3 : _pvertices->size()/3;
+    }
+
+    inline size_t GetNumTriangles() const {
+        return _pindices->size()/3;
+    }
+
+    inline Vector GetVertex(size_t ivertex) const {
+        if( _bSinglePrecision ) {
+            const float* p = &_pverticesf->at(3*ivertex);
+            return Vector(p[0], p[1], p[2]);
+        }
+        const dReal* p = &_pvertices->at(3*ivertex);
+        return Vector(p[0], p[1], p[2]);
+    }
+
+    /// \brief packed xyz of all vertices, nullptr if the vertices are stored in single precision
+    inline const dReal* GetVertexData() const {
+        return _bSinglePrecision || _pvertices->empty() ? nullptr : _pvertices->data();
+    }
+
+    /// \brief packed xyz of all vertices, nullptr if the vertices are stored in double precision
+    inline const float* GetVertexDataFloat() const {
+        return !_bSinglePrecision || _pverticesf->empty() ? nullptr : _pverticesf->data();
+    }
+
+    inline const std::vector<int32_t>& GetIndices() const {
+        return *_pindices;
+    }
+
+    AABB ComputeAABB() const;
+
+    /// \brief returns the number of bytes held by the vertex and index buffers, shared buffers are counted fully
+    size_t GetMemoryUsage() const;
+
+    /// \brief returns true if the buffers are shared with another copy
+    bool IsShared() const;
+
+private:
+    /// \brief duplicates the buffers that are shared with other copies
+    void _MakeUnique();
+
+    boost::shared_ptr< std::vector<dReal> > _pvertices; ///< packed xyz, used when !_bSinglePrecision
+    boost::shared_ptr< std::vector<float> > _pverticesf; ///< packed xyz, used when _bSinglePrecision
+    boost::shared_ptr< std::vector<int32_t> > _pindices;
+    bool _bSinglePrecision;
+};
+
 /// \brief Selects which DOFs of the affine transformation to include in the active configuration.
 enum DOFAffine
 {
@@ -2620,6 +2821,7 @@ OPENRAVE_API ConfigurationSpecification RaveGetAffineConfigurationSpecification(
 }
 
 #include <openrave/plugininfo.h>
+#include <openrave/statistics.h>
 #include <openrave/interface.h>
 #include <openrave/spacesampler.h>
 #include <openrave/kinbody.h>
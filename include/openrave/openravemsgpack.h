@@ -33,6 +33,9 @@ namespace MsgPack {
 OPENRAVE_API void DumpMsgPack(const rapidjson::Value& value, std::ostream& os);
 OPENRAVE_API void DumpMsgPack(const rapidjson::Value& value, std::vector<char>& output);
 
+/// \brief parses msgpack data into the rapidjson document d.
+///
+/// The msgpack events are forwarded to d without an intermediate msgpack::object, but the whole document is still built in memory and the infos have to be deserialized from it.
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const std::string& str);
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, std::istream& is);
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const void* data, size_t size);
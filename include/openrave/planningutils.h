@@ -58,6 +58,18 @@ OPENRAVE_API int JitterCurrentConfiguration(PlannerBase::PlannerParametersConstP
  */
 OPENRAVE_API void VerifyTrajectory(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, dReal samplingstep=0.002);
 
+/** \brief validates a trajectory like \ref VerifyTrajectory, but checks the sampled segments with several threads.
+
+    The waypoints are checked in the calling thread with parameters. The sampled segments are split into contiguous chunks and every chunk is checked by its own thread on a clone of the environment (Clone_Bodies), so the calling environment is not modified while the workers run.
+    The functions of parameters are bound to the calling environment, so every worker binds the default state and constraint functions of PlannerParameters::SetConfigurationSpecification to its clone and then reads the serialized data of parameters (limits, resolutions, _sExtraParameters). Custom constraint functions that are not described by that data are only used for the waypoints.
+    If several segments are invalid, the error of the earliest one is thrown. Falls back to \ref VerifyTrajectory when there are not enough segments to split.
+    Assume that trajectory->GetEnv() is locked.
+    \param parameters the planner parameters passed to the planner that returned the trajectory. If not initialized, the default constraints created from trajectory->GetConfigurationSpecification() are used.
+    \param numthreads number of threads to use. If <= 0, uses the number of hardware threads.
+    \throw openrave_exception If the trajectory is invalid, will throw ORE_InconsistentConstraints.
+ */
+OPENRAVE_API void VerifyTrajectoryParallel(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, dReal samplingstep=0.002, int numthreads=0);
+
 /** \brief Extends the last ramp of the trajectory in order to reach a goal. THe configuration space matches the positional data of the trajectory.
 
     Useful when appending jittered points to the trajectory.
@@ -416,6 +428,13 @@ public:
  */
 OPENRAVE_API void GetDHParameters(std::vector<DHParameter>&vparameters, KinBodyConstPtr pbody);
 
+/// \brief the order DynamicsCollisionConstraint checks the interpolated configurations of a segment
+enum DynamicsCollisionCheckOrder
+{
+    DCCO_Sequential = 0, ///< check the configurations from the start to the end of the segment
+    DCCO_Bisection = 1, ///< check the configurations in van der Corput order (0, 1/2, 1/4, 3/4, ...). A collision in the later parts of the segment is found earlier on average.
+};
+
 /** \brief dynamics and collision checking with linear interpolation
 
     For any joints with maxtorque > 0, uses KinBody::ComputeInverseDynamics to check if the necessary torque exceeds the max torque. Max torque is always called via GetMaxTorque
@@ -449,6 +468,12 @@ public:
     /// \param torquelimitmode 1 if should use instantaneous max torque, 0 if should use nominal torque
     virtual void SetTorqueLimitMode(DynamicsConstraintsType torquelimitmode);
 
+    /// \brief sets the order the interpolated configurations of a segment are checked in.
+    ///
+    /// Only segments that are linearly interpolated are reordered, and only when the neighbor function does not deviate from the interpolation. Otherwise the configurations are checked sequentially.
+    /// If CFO_FillCheckedConfiguration is set, the checked configurations are still returned in time order. On failure, only the configurations before the invalid one that were checked are returned.
+    virtual void SetCheckOrder(DynamicsCollisionCheckOrder checkorder);
+
     /// \brief set user check fucntions
     ///
     /// Two functions can be set, one to be called before check collision and one after.
@@ -479,6 +504,13 @@ protected:
     virtual int _SetAndCheckState(PlannerBase::PlannerParametersConstPtr params, const std::vector<dReal>& vdofvalues, const std::vector<dReal>& vdofvelocities, const std::vector<dReal>& vdofaccels, int options, ConstraintFilterReturnPtr filterreturn);
     virtual void _PrintOnFailure(const std::string& prefix);
 
+    /// \brief checks the linearly interpolated configurations of Check in the order of _checkorder.
+    ///
+    /// The configurations are first generated by stepping with the neighbor function starting from _vtempconfig, and then checked. On success, _vtempconfig and _vtempvelconfig hold the state after the last step like when checking sequentially.
+    /// \param start, numSteps the steps start, ..., numSteps-1 are checked. The configuration of step f is at time f*fisteps.
+    /// \return -1 if the neighbor function deviated from the interpolation and the configurations have to be checked sequentially. Otherwise the return code of the check.
+    virtual int _CheckLinearSamplesOutOfOrder(PlannerBase::PlannerParametersConstPtr params, const std::vector<dReal>& q0, const std::vector<dReal>& dq0, int start, int numSteps, dReal fisteps, bool validVelocities, int neighstateoptions, int maskoptions, int options, ConstraintFilterReturnPtr filterreturn);
+
     PlannerBase::PlannerParametersWeakConstPtr _parameters;
     std::vector<dReal> _vtempconfig, _vtempvelconfig, dQ, _vtempveldelta, _vtempacceldelta, _vtempaccelconfig, _vtempjerkconfig, _vperturbedvalues, _vcoeff2, _vcoeff1, _vprevtempconfig, _vprevtempvelconfig, _vprevtempaccelconfig, _vtempconfig2, _vdiffconfig, _vdiffvelconfig, _vdiffaccelconfig, _vstepconfig; ///< in configuration space
     std::vector<dReal> _vrawroots, _vrawcoeffs;
@@ -488,7 +520,11 @@ protected:
     int _filtermask;
     DynamicsConstraintsType _torquelimitmode; ///< 1 if should use instantaneous max torque, 0 if should use nominal torque
     dReal _perturbation;
+    DynamicsCollisionCheckOrder _checkorder;
     boost::array< boost::function<bool() >, 2> _usercheckfns;
+    std::vector<dReal> _vsampleconfigs, _vsamplevelconfigs; ///< for _CheckLinearSamplesOutOfOrder, the generated configurations in time order
+    std::vector<int> _vsampleorder; ///< for _CheckLinearSamplesOutOfOrder, sample indices in the order to check them
+    std::vector<uint8_t> _vsamplechecked; ///< for _CheckLinearSamplesOutOfOrder, 1 if the sample at the index was checked and is valid
 
     // for dynamics
     ConfigurationSpecification _specvel;
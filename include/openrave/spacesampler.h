@@ -102,6 +102,25 @@ public:
      */
     virtual int SampleSequence(std::vector<dReal>& samples, size_t num=1,IntervalType interval=IT_Closed) OPENRAVE_DUMMY_IMPLEMENTATION;
 
+    /** \brief sequentially sampling the next 'num' samples into a caller provided buffer
+
+        Use when sampling many values at once, samplers that override it do not allocate or copy.
+        \param samples contiguous buffer of num*GetNumberOfValues() values that receives the samples
+        \param num number of samples to return
+        \param interval the sampling intervel for each of the dimensions.
+        \return the number of samples completed or an error code. Error codes are <= 0.
+     */
+    virtual int SampleSequence(dReal* samples, size_t num, IntervalType interval=IT_Closed)
+    {
+        // by default, use the std::vector SampleSequence
+        std::vector<dReal> vsamples;
+        int ret = SampleSequence(vsamples,num,interval);
+        if( ret > 0 ) {
+            std::copy(vsamples.begin(), vsamples.begin()+std::min(vsamples.size(), (size_t)ret*GetNumberOfValues()), samples);
+        }
+        return ret;
+    }
+
     /// \brief samples the real next value on the sequence, only valid for 1 DOF sequences.
     ///
     /// \throw openrave_exception throw if could not be sampled
@@ -123,6 +142,23 @@ public:
      */
     virtual int SampleSequence(std::vector<uint32_t>& sample, size_t num=1) OPENRAVE_DUMMY_IMPLEMENTATION;
 
+    /** \brief sequentially sampling the next 'num' samples into a caller provided buffer
+
+        \param samples contiguous buffer of num*GetNumberOfValues() values that receives the samples
+        \param num number of samples to return
+        \return the number of samples completed or an error code. Error codes are <= 0.
+     */
+    virtual int SampleSequence(uint32_t* samples, size_t num)
+    {
+        // by default, use the std::vector SampleSequence
+        std::vector<uint32_t> vsamples;
+        int ret = SampleSequence(vsamples,num);
+        if( ret > 0 ) {
+            std::copy(vsamples.begin(), vsamples.begin()+std::min(vsamples.size(), (size_t)ret*GetNumberOfValues()), samples);
+        }
+        return ret;
+    }
+
     /// \brief samples the unsigned integer next value on the sequence, only valid for 1 DOF sequences.
     ///
     /// \throw openrave_exception throw if could not be sampled
@@ -0,0 +1,151 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2006-2024 Rosen Diankov (rosen.diankov@gmail.com)
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/** \file statistics.h
+    \brief Counters and duration histograms of hot paths, kept per environment.
+
+    Automatically included with \ref openrave.h
+ */
+#ifndef OPENRAVE_STATISTICS_H
+#define OPENRAVE_STATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace OpenRAVE {
+
+/** \brief number of calls and distribution of the call durations of one hot path. <b>[multi-thread safe]</b>
+
+    Durations are accumulated in a histogram with power of two buckets, so counting a call costs a few relaxed atomic operations and does not allocate.
+ */
+class OPENRAVE_API StatisticsCounter
+{
+public:
+    static const int NUM_BUCKETS = 40; ///< bucket i counts durations in [2^i, 2^(i+1)) nanoseconds, the last bucket also counts all longer durations
+
+    StatisticsCounter();
+
+    /// \brief counts calls without timing them
+    inline void Increment(uint64_t numCalls=1) {
+        _numCalls.fetch_add(numCalls, std::memory_order_relaxed);
+    }
+
+    /// \brief counts one call that took durationNs nanoseconds
+    inline void AddDuration(uint64_t durationNs) {
+        _numCalls.fetch_add(1, std::memory_order_relaxed);
+        _totalDurationNs.fetch_add(durationNs, std::memory_order_relaxed);
+        uint64_t maxDurationNs = _maxDurationNs.load(std::memory_order_relaxed);
+        while( durationNs > maxDurationNs && !_maxDurationNs.compare_exchange_weak(maxDurationNs, durationNs, std::memory_order_relaxed) ) {
+        }
+        _vHistogram[_GetBucketIndex(durationNs)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline uint64_t GetNumCalls() const {
+        return _numCalls.load(std::memory_order_relaxed);
+    }
+
+    /// \brief sum of the durations of the timed calls in nanoseconds
+    inline uint64_t GetTotalDuration() const {
+        return _totalDurationNs.load(std::memory_order_relaxed);
+    }
+
+    /// \brief longest duration of the timed calls in nanoseconds
+    inline uint64_t GetMaxDuration() const {
+        return _maxDurationNs.load(std::memory_order_relaxed);
+    }
+
+    /// \brief estimates the duration in nanoseconds that the given fraction of the timed calls do not exceed
+    ///
+    /// The estimate is the upper boundary of the histogram bucket containing the fraction, so it is at most twice the actual duration.
+    /// \param fraction in [0,1], for example 0.99 for the 99th percentile
+    uint64_t ComputeDurationPercentile(dReal fraction) const;
+
+    /// \brief sets all counts and durations to 0
+    void Reset();
+
+    /// \brief writes numCalls, totalDurationNs, maxDurationNs, the 50th, 90th and 99th percentiles and the histogram up to the last non-empty bucket
+    void SerializeJSON(rapidjson::Value& rCounter, rapidjson::Document::AllocatorType& allocator) const;
+
+private:
+    static inline int _GetBucketIndex(uint64_t durationNs) {
+        int index = 0;
+        while( durationNs > 1 && index < NUM_BUCKETS-1 ) {
+            durationNs >>= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    std::atomic<uint64_t> _numCalls, _totalDurationNs, _maxDurationNs;
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> _vHistogram;
+};
+
+/// \brief times the scope it is declared in and adds the duration to a counter. Does nothing if the counter is NULL.
+class StatisticsTimer
+{
+public:
+    inline StatisticsTimer(StatisticsCounter* pcounter) : _pcounter(pcounter) {
+        if( !!_pcounter ) {
+            _starttime = std::chrono::steady_clock::now();
+        }
+    }
+    inline ~StatisticsTimer() {
+        if( !!_pcounter ) {
+            _pcounter->AddDuration(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _starttime).count());
+        }
+    }
+
+private:
+    StatisticsCounter* _pcounter;
+    std::chrono::steady_clock::time_point _starttime;
+};
+
+/** \brief counters of the hot paths of the interfaces of one environment, see \ref EnvironmentBase::GetStatisticsRegistry. <b>[multi-thread safe]</b>
+
+    Counters are grouped by interface name, which by convention is the xml id of the interface (for example the collision checker name) or the interface type name for kinbodies and robots.
+ */
+class OPENRAVE_API StatisticsRegistry
+{
+public:
+    StatisticsRegistry();
+
+    /// \brief returns the counter of the hot path name of the interface interfaceName, creating it if needed.
+    ///
+    /// Counters are never removed, so hot paths look them up once and keep the pointer for the life time of the environment.
+    /// \param interfaceName anything after the first space is ignored, so the xml id of an interface created with parameters can be passed directly
+    StatisticsCounter* GetCounter(const std::string& interfaceName, const std::string& name);
+
+    /// \brief sets the counters of interfaceName to 0, or all counters if interfaceName is empty
+    void Reset(const std::string& interfaceName=std::string());
+
+    /// \brief writes an object of interface names to objects of counter names to counters, see \ref StatisticsCounter::SerializeJSON
+    ///
+    /// \param interfaceName if not empty, only writes the counters of this interface
+    void SerializeJSON(rapidjson::Value& rStatistics, rapidjson::Document::AllocatorType& allocator, const std::string& interfaceName=std::string()) const;
+
+private:
+    mutable std::mutex _mutex;
+    std::map<std::string, std::map<std::string, boost::shared_ptr<StatisticsCounter> > > _mapCounters; ///< interface name -> counter name -> counter
+};
+
+typedef boost::shared_ptr<StatisticsRegistry> StatisticsRegistryPtr;
+
+} // end namespace OpenRAVE
+
+#endif
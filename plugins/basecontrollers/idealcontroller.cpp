@@ -15,15 +15,18 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "plugindefs.h"
 
+#include <openrave/planningutils.h>
 #include <boost/bind/bind.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <atomic>
+
 using namespace boost::placeholders;
 
 class IdealController : public ControllerBase
 {
 public:
-    IdealController(EnvironmentBasePtr penv, std::istream& sinput) : ControllerBase(penv), cmdid(0), _bPause(false), _bIsDone(true), _bCheckCollision(false), _bThrowExceptions(false), _bEnableLogging(false)
+    IdealController(EnvironmentBasePtr penv, std::istream& sinput) : ControllerBase(penv), cmdid(0), _bPause(false), _bIsDone(true), _bCheckCollision(false), _bThrowExceptions(false), _bEnableLogging(false), _bRealtimePlayback(false), _bTrajPreconverted(false)
     {
         __description = ":Interface Author: Rosen Diankov\n\nIdeal controller used for planning and non-physics simulations. Forces exact robot positions.\n\n\
 If \ref ControllerBase::SetPath is called and the trajectory finishes, then the controller will continue to set the trajectory's final joint values and transformation until one of three things happens:\n\n\
@@ -39,9 +42,16 @@ If SetDesired is called, only joint values will be set at every timestep leaving
                         "If set, will throw exceptions instead of print warnings. Format is:\n\n  [0/1]");
         RegisterCommand("SetEnableLogging",boost::bind(&IdealController::_SetEnableLogging,this,_1,_2),
                         "If set, will write trajectories to disk");
+        RegisterCommand("SetRealtimePlayback",boost::bind(&IdealController::_SetRealtimePlayback,this,_1,_2),
+                        "If set, trajectories passed to SetPath are converted to the controlled dofs beforehand so that SimulationStep does not allocate memory or block on the controller mutex. Takes effect on the next SetPath. Format is:\n\n  [0/1]");
+        RegisterCommand("GetTickStatistics",boost::bind(&IdealController::_GetTickStatistics,this,_1,_2),
+                        "Returns the statistics of the SimulationStep calls since the last reset. Format is:\n\n  numticks numskipped meanduration maxduration meanjitter maxjitter\n\nwhere durations are the compute times of SimulationStep and jitter is the difference between the wall time between two calls and the elapsed simulation time, all in seconds. numskipped is the number of ticks skipped in real-time playback because SetPath was running.");
+        RegisterCommand("ResetTickStatistics",boost::bind(&IdealController::_ResetTickStatistics,this,_1,_2),
+                        "Resets the statistics returned by GetTickStatistics");
         _fCommandTime = 0;
         _fSpeed = 1;
         _nControlTransformation = 0;
+        _ClearTickStatistics();
     }
     virtual ~IdealController() {
     }
@@ -82,6 +92,7 @@ If SetDesired is called, only joint values will be set at every timestep leaving
                 }
                 _gjointvalues->name = ss.str();
             }
+            _vdofvalues.resize(_dofindices.size());
             if( nControlTransformation ) {
                 _gtransform.reset(new ConfigurationSpecification::Group());
                 _gtransform->offset = robot->GetDOF();
@@ -155,6 +166,7 @@ If SetDesired is called, only joint values will be set at every timestep leaving
         _bIsDone = true;
         _vecdesired.resize(0);
         _ptraj.reset();
+        _bTrajPreconverted = false;
 
         if( !!ptraj ) {
             RobotBasePtr probot = _probot.lock();
@@ -248,6 +260,20 @@ If SetDesired is called, only joint values will be set at every timestep leaving
 
             _ptraj = RaveCreateTrajectory(GetEnv(),ptraj->GetXMLId());
             _ptraj->Clone(ptraj,0);
+            if( _bRealtimePlayback ) {
+                ConfigurationSpecification playbackspec;
+                _ComputePlaybackSpec(ptraj->GetConfigurationSpecification(), playbackspec);
+                try {
+                    planningutils::ConvertTrajectorySpecification(_ptraj, playbackspec);
+                    _bTrajPreconverted = true;
+                    // Sample only resizes the buffer, so reserving here keeps SimulationStep from allocating
+                    _vsampledata.reserve(playbackspec.GetDOF());
+                }
+                catch(const openrave_exception& ex) {
+                    RAVELOG_WARN_FORMAT("robot %s failed to convert trajectory for real-time playback, falling back to sampling with conversion: %s", probot->GetName()%ex.what());
+                    _ptraj->Clone(ptraj,0);
+                }
+            }
             _bIsDone = false;
         }
 
@@ -259,12 +285,123 @@ If SetDesired is called, only joint values will be set at every timestep leaving
         if( _bPause ) {
             return;
         }
-        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t starttime = utils::GetNanoPerformanceTime();
+        std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+        if( _bRealtimePlayback ) {
+            // never block the simulation thread, SetPath will be picked up on the next tick
+            if( !lock.try_lock() ) {
+                // _tickstats is protected by _mutex, so only record the skip in atomics here
+                ++_nSkippedTicks;
+                _nLastSkippedTickTime = starttime;
+                return;
+            }
+        }
+        else {
+            lock.lock();
+        }
+        _SimulationStep(fTimeElapsed);
+        _UpdateTickStatistics(starttime, utils::GetNanoPerformanceTime(), fTimeElapsed);
+    }
+
+    virtual bool IsDone() {
+        return _bIsDone;
+    }
+    virtual dReal GetTime() const {
+        return _fCommandTime;
+    }
+    virtual RobotBasePtr GetRobot() const {
+        return _probot.lock();
+    }
+
+private:
+    /// \brief statistics of the SimulationStep calls, times are in nanoseconds
+    struct TickStatistics
+    {
+        uint64_t numticks;
+        uint64_t sumduration, maxduration;
+        uint64_t sumjitter, maxjitter;
+        uint64_t lastticktime; ///< start time of the previous tick, 0 if none
+    };
+
+    /// \brief computes the specification trajectories are converted to for real-time playback.
+    ///
+    /// The leading groups are the same as _samplespec so sampled data can be used with its offsets. They are followed by the derivative groups the trajectory has for them, which are needed for interpolation, and deltatime.
+    void _ComputePlaybackSpec(const ConfigurationSpecification& trajspec, ConfigurationSpecification& playbackspec) const
+    {
+        static const boost::array<std::string,3> s_GroupsJointDerivatives = {{"joint_velocities", "joint_accelerations", "joint_jerks"}};
+        static const boost::array<std::string,3> s_GroupsAffineDerivatives = {{"affine_velocities", "affine_accelerations", "affine_jerks"}};
+        playbackspec = _samplespec;
+        FOREACH(itgroup, playbackspec._vgroups) {
+            std::vector<ConfigurationSpecification::Group>::const_iterator itcompatible = trajspec.FindCompatibleGroup(*itgroup, false);
+            if( itcompatible != trajspec._vgroups.end() ) {
+                itgroup->interpolation = itcompatible->interpolation;
+            }
+        }
+        int dof = playbackspec.GetDOF();
+        size_t numgroups = playbackspec._vgroups.size();
+        for(size_t igroup = 0; igroup < numgroups; ++igroup) {
+            const ConfigurationSpecification::Group g = playbackspec._vgroups[igroup];
+            const boost::array<std::string,3>* pderivativenames = NULL;
+            size_t prefixlength = 0;
+            if( g.name.size() >= 12 && g.name.substr(0,12) == "joint_values" ) {
+                pderivativenames = &s_GroupsJointDerivatives;
+                prefixlength = 12;
+            }
+            else if( g.name.size() >= 16 && g.name.substr(0,16) == "affine_transform" ) {
+                pderivativenames = &s_GroupsAffineDerivatives;
+                prefixlength = 16;
+            }
+            else {
+                continue;
+            }
+            FOREACHC(itname, *pderivativenames) {
+                ConfigurationSpecification::Group gderiv;
+                gderiv.name = *itname + g.name.substr(prefixlength);
+                std::vector<ConfigurationSpecification::Group>::const_iterator itcompatible = trajspec.FindCompatibleGroup(gderiv.name, false);
+                if( itcompatible == trajspec._vgroups.end() ) {
+                    break;
+                }
+                gderiv.offset = dof;
+                gderiv.dof = g.dof;
+                gderiv.interpolation = itcompatible->interpolation;
+                playbackspec._vgroups.push_back(gderiv);
+                dof += gderiv.dof;
+            }
+        }
+        playbackspec.AddDeltaTimeGroup();
+    }
+
+    void _UpdateTickStatistics(uint64_t starttime, uint64_t endtime, dReal fTimeElapsed)
+    {
+        uint64_t duration = endtime - starttime;
+        ++_tickstats.numticks;
+        _tickstats.sumduration += duration;
+        _tickstats.maxduration = std::max(_tickstats.maxduration, duration);
+        // a tick skipped by real-time playback still counts as the previous tick
+        _tickstats.lastticktime = std::max(_tickstats.lastticktime, _nLastSkippedTickTime.load());
+        if( _tickstats.lastticktime > 0 ) {
+            int64_t expected = (int64_t)(fTimeElapsed*1e9);
+            int64_t actual = (int64_t)(starttime - _tickstats.lastticktime);
+            uint64_t jitter = (uint64_t)(actual > expected ? actual - expected : expected - actual);
+            _tickstats.sumjitter += jitter;
+            _tickstats.maxjitter = std::max(_tickstats.maxjitter, jitter);
+        }
+        _tickstats.lastticktime = starttime;
+    }
+
+    void _SimulationStep(dReal fTimeElapsed)
+    {
         TrajectoryBaseConstPtr ptraj = _ptraj; // because of multi-threading setting issues
         if( !!ptraj ) {
             RobotBasePtr probot = _probot.lock();
-            vector<dReal> sampledata;
-            ptraj->Sample(sampledata,_fCommandTime,_samplespec);
+            std::vector<dReal>& sampledata = _vsampledata;
+            if( _bTrajPreconverted ) {
+                // already in the playback spec whose leading groups match _samplespec
+                ptraj->Sample(sampledata,_fCommandTime);
+            }
+            else {
+                ptraj->Sample(sampledata,_fCommandTime,_samplespec);
+            }
 
             // already sampled, so change the command times before before setting values
             // incase the below functions fail
@@ -278,9 +415,12 @@ If SetDesired is called, only joint values will be set at every timestep leaving
             }
 
             // first process all grab info
-            list<KinBodyPtr> listrelease;
-            list<pair<KinBodyPtr, KinBody::LinkPtr> > listgrab;
-            list<int> listgrabindices;
+            std::vector<KinBodyPtr>& listrelease = _vreleasebodies;
+            std::vector<pair<KinBodyPtr, KinBody::LinkPtr> >& listgrab = _vgrabbodies;
+            std::vector<int>& listgrabindices = _vgrabindices;
+            listrelease.resize(0);
+            listgrab.resize(0);
+            listgrabindices.resize(0);
             FOREACH(itgrabinfo,_vgrablinks) {
                 int bodyid = int(std::floor(sampledata.at(itgrabinfo->first)+0.5));
                 if( bodyid != 0 ) {
@@ -324,23 +464,35 @@ If SetDesired is called, only joint values will be set at every timestep leaving
                 }
             }
 
-            vector<dReal> vdofvalues;
+            bool bHasDOFValues = false;
             if( _bTrajHasJoints && _dofindices.size() > 0 ) {
-                vdofvalues.resize(_dofindices.size());
-                _samplespec.ExtractJointValues(vdofvalues.begin(),sampledata.begin(), probot, _dofindices, 0);
+                if( _bTrajPreconverted ) {
+                    // the joint values group is first and ordered like _dofindices
+                    std::copy(sampledata.begin(), sampledata.begin()+_dofindices.size(), _vdofvalues.begin());
+                }
+                else {
+                    _samplespec.ExtractJointValues(_vdofvalues.begin(),sampledata.begin(), probot, _dofindices, 0);
+                }
+                bHasDOFValues = true;
             }
+            const std::vector<dReal>& vdofvalues = _vdofvalues;
 
             Transform t;
             if( _bTrajHasTransform && _nControlTransformation ) {
-                _samplespec.ExtractTransform(t,sampledata.begin(),probot);
-                if( vdofvalues.size() > 0 ) {
+                if( _bTrajPreconverted ) {
+                    RaveGetTransformFromAffineDOFValues(t, sampledata.begin()+(_bTrajHasJoints ? _dofindices.size() : 0), DOF_Transform);
+                }
+                else {
+                    _samplespec.ExtractTransform(t,sampledata.begin(),probot);
+                }
+                if( bHasDOFValues ) {
                     _SetDOFValues(vdofvalues,t, _fCommandTime > 0 ? fTimeElapsed : 0);
                 }
                 else {
                     probot->SetTransform(t);
                 }
             }
-            else if( vdofvalues.size() > 0 ) {
+            else if( bHasDOFValues ) {
                 _SetDOFValues(vdofvalues, _fCommandTime > 0 ? fTimeElapsed : 0);
             }
 
@@ -380,17 +532,6 @@ If SetDesired is called, only joint values will be set at every timestep leaving
         }
     }
 
-    virtual bool IsDone() {
-        return _bIsDone;
-    }
-    virtual dReal GetTime() const {
-        return _fCommandTime;
-    }
-    virtual RobotBasePtr GetRobot() const {
-        return _probot.lock();
-    }
-
-private:
     virtual bool _Pause(std::ostream& os, std::istream& is)
     {
         is >> _bPause;
@@ -414,6 +555,34 @@ private:
         is >> _bEnableLogging;
         return !!is;
     }
+    virtual bool _SetRealtimePlayback(std::ostream& os, std::istream& is)
+    {
+        is >> _bRealtimePlayback;
+        return !!is;
+    }
+    virtual bool _GetTickStatistics(std::ostream& os, std::istream& is)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        dReal fmeanduration = _tickstats.numticks > 0 ? 1e-9*_tickstats.sumduration/_tickstats.numticks : 0;
+        dReal fmeanjitter = _tickstats.numticks > 1 ? 1e-9*_tickstats.sumjitter/(_tickstats.numticks-1) : 0;
+        os << _tickstats.numticks << " " << _nSkippedTicks.load() << " " << fmeanduration << " " << 1e-9*_tickstats.maxduration << " " << fmeanjitter << " " << 1e-9*_tickstats.maxjitter;
+        return true;
+    }
+    virtual bool _ResetTickStatistics(std::ostream& os, std::istream& is)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _ClearTickStatistics();
+        return true;
+    }
+    void _ClearTickStatistics()
+    {
+        _tickstats.numticks = 0;
+        _nSkippedTicks = 0;
+        _nLastSkippedTickTime = 0;
+        _tickstats.sumduration = _tickstats.maxduration = 0;
+        _tickstats.sumjitter = _tickstats.maxjitter = 0;
+        _tickstats.lastticktime = 0;
+    }
 
     inline boost::shared_ptr<IdealController> shared_controller() {
         return boost::static_pointer_cast<IdealController>(shared_from_this());
@@ -438,8 +607,7 @@ private:
     virtual void _SetDOFValues(const std::vector<dReal>&values, dReal timeelapsed)
     {
         RobotBasePtr probot = _probot.lock();
-        
-        vector<dReal> prevvalues, curvalues, curvel;
+        std::vector<dReal>& prevvalues = _vprevvalues, &curvalues = _vcurvalues, &curvel = _vcurvel;
         probot->GetDOFValues(prevvalues);
         curvalues = prevvalues;
         probot->GetDOFVelocities(curvel);
@@ -459,7 +627,7 @@ private:
     {
         RobotBasePtr probot = _probot.lock();
         BOOST_ASSERT(_nControlTransformation);
-        vector<dReal> prevvalues, curvalues, curvel;
+        std::vector<dReal>& prevvalues = _vprevvalues, &curvalues = _vcurvalues, &curvel = _vcurvel;
         probot->GetDOFValues(prevvalues);
         curvalues = prevvalues;
         probot->GetDOFVelocities(curvel);
@@ -490,7 +658,8 @@ private:
             }
         }
         if( timeelapsed > 0 ) {
-            vector<dReal> vdiff = curvalues;
+            std::vector<dReal>& vdiff = _vdiffvalues;
+            vdiff = curvalues;
             probot->SubtractDOFValues(vdiff,prevvalues);
             for(size_t i = 0; i < _vupper[1].size(); ++i) {
                 if( std::isnan(vdiff.at(i)) ) {
@@ -564,11 +733,22 @@ private:
     ofstream flog;
     int cmdid;
     bool _bPause, _bIsDone, _bCheckCollision, _bThrowExceptions, _bEnableLogging;
+    bool _bRealtimePlayback; ///< if true, SetPath converts trajectories for real-time playback
+    bool _bTrajPreconverted; ///< if true, _ptraj has been converted with _ComputePlaybackSpec
     CollisionReportPtr _report;
     UserDataPtr _cblimits;
     ConfigurationSpecification _samplespec;
     boost::shared_ptr<ConfigurationSpecification::Group> _gjointvalues, _gtransform;
     std::mutex _mutex;
+
+    // buffers reused by SimulationStep in order to avoid allocating memory every tick
+    std::vector<dReal> _vsampledata, _vdofvalues, _vprevvalues, _vcurvalues, _vcurvel, _vdiffvalues;
+    std::vector<KinBodyPtr> _vreleasebodies;
+    std::vector<pair<KinBodyPtr, KinBody::LinkPtr> > _vgrabbodies;
+    std::vector<int> _vgrabindices;
+    TickStatistics _tickstats; ///< protected by _mutex
+    std::atomic<uint64_t> _nSkippedTicks; ///< number of ticks skipped in real-time playback, updated without _mutex
+    std::atomic<uint64_t> _nLastSkippedTickTime; ///< start time of the last skipped tick
 };
 
 ControllerBasePtr CreateIdealController(EnvironmentBasePtr penv, std::istream& sinput)
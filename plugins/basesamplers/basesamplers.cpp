@@ -18,6 +18,7 @@
 
 #include "mt19937ar.h"
 #include "halton.h"
+#include "sobol.h"
 #include "robotconfiguration.h"
 #include "bodyconfiguration.h"
 
@@ -25,6 +26,8 @@ BaseSamplersPlugin::BaseSamplersPlugin()
 {
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("MT19937");
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("Halton");
+    _interfaces[OpenRAVE::PT_SpaceSampler].push_back("LeapedHalton");
+    _interfaces[OpenRAVE::PT_SpaceSampler].push_back("ScrambledSobol");
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("RobotConfiguration");
     _interfaces[OpenRAVE::PT_SpaceSampler].push_back("BodyConfiguration");
 }
@@ -41,6 +44,12 @@ OpenRAVE::InterfaceBasePtr BaseSamplersPlugin::CreateInterface(OpenRAVE::Interfa
         else if( interfacename == "halton" ) {
             return InterfaceBasePtr(new HaltonSampler(penv,sinput));
         }
+        else if( interfacename == "leapedhalton" ) {
+            return InterfaceBasePtr(new HaltonSampler(penv,sinput,true));
+        }
+        else if( interfacename == "scrambledsobol" ) {
+            return InterfaceBasePtr(new ScrambledSobolSampler(penv,sinput));
+        }
         else if( interfacename == "robotconfiguration" ) {
             return InterfaceBasePtr(new RobotConfigurationSampler(penv,sinput));
         }
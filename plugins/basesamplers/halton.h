@@ -15,13 +15,16 @@
 #define SAMPLER_HALTON
 
 #include <openrave/openrave.h>
+#include <boost/bind/bind.hpp>
 using namespace OpenRAVE;
 using namespace std;
+using namespace boost::placeholders;
 
 class HaltonSampler : public SpaceSamplerBase
 {
 public:
-    HaltonSampler(EnvironmentBasePtr penv, std::istream& sinput) : SpaceSamplerBase(penv)
+    /// \param bLeaped if true, samples the stream read from sinput as "[stream index] [leap]", see SetStream
+    HaltonSampler(EnvironmentBasePtr penv, std::istream& sinput, bool bLeaped=false) : SpaceSamplerBase(penv), _streamindex(0), _leap(1)
     {
         __description = ":Interface Author: John Burkardt\n\n\
 References:\n\n\
@@ -29,24 +32,36 @@ References:\n\n\
 2. John Halton, GB Smith, Algorithm 247: Radical-Inverse Quasi-Random Point Sequence, Communications of the ACM, Volume 7, 1964, pages 701-702.\n\n\
 3. Ladislav Kocis, William Whiten, Computational Investigations of Low-Discrepancy Sequences, ACM Transactions on Mathematical Software, Volume 23, Number 2, 1997, pages 266-294.\n\n\
 ";
+        RegisterCommand("SetStream",boost::bind(&HaltonSampler::_SetStreamCommand,this,_1,_2),
+                        "Samples the leaped Halton subsequence 'stream index', 'stream index'+leap, 'stream index'+2*leap, ... so that samplers with different stream indices and the same leap return disjoint points, for example one sampler per thread of a parallel planner. The leap has to be a prime that is not a base of the sampled dimensions, 409 is used for up to 79 dimensions. Format::\n\n  SetStream [stream index] [leap]\n\n");
         halton_BASE = NULL;
         halton_LEAP = NULL;
         halton_DIM_NUM = -1;
         halton_SEED = NULL;
         halton_STEP = -1;
+        if( bLeaped ) {
+            _leap = 409;
+            sinput >> _streamindex;
+            sinput >> _leap;
+            if( !sinput || _leap < 1 ) {
+                _leap = 409;
+            }
+            _streamindex = std::max(0, _streamindex);
+        }
         SetSpaceDOF(1);
         SetSeed(0);
         halton_step_set (1);
     }
 
     void SetSeed(uint32_t seed) {
-        vector<int> vseed(halton_dim_num_get(),0);
+        vector<int> vseed(halton_dim_num_get(),_streamindex);
         halton_seed_set ( &vseed[0] );
     }
 
     void SetSpaceDOF(int dof) {
         BOOST_ASSERT(dof > 0);
         halton_dim_num_set ( dof );
+        _UpdateStream();
     }
     int GetDOF() const {
         return halton_dim_num_get();
@@ -75,6 +90,12 @@ References:\n\n\
         return (int)num;
     }
 
+    int SampleSequence(dReal* samples, size_t num, IntervalType interval=IT_Closed)
+    {
+        halton_sequence(num,samples);
+        return (int)num;
+    }
+
     dReal SampleSequenceOneReal(IntervalType interval=IT_Closed)
     {
         OPENRAVE_ASSERT_OP_FORMAT0(GetDOF(),==,1,"sample can only be 1 dof", ORE_InvalidState);
@@ -84,6 +105,40 @@ References:\n\n\
     }
 
 protected:
+    bool _SetStreamCommand(ostream& sout, istream& sinput)
+    {
+        int streamindex = 0, leap = 409;
+        sinput >> streamindex;
+        if( !sinput || streamindex < 0 ) {
+            return false;
+        }
+        sinput >> leap;
+        if( !sinput ) {
+            leap = 409;
+        }
+        if( leap < 1 ) {
+            return false;
+        }
+        _streamindex = streamindex;
+        _leap = leap;
+        _UpdateStream();
+        halton_step_set (1);
+        return true;
+    }
+
+    /// \brief sets the seed and leap of all the dimensions to the stream
+    void _UpdateStream()
+    {
+        for(int i = 0; i < halton_dim_num_get(); ++i) {
+            if( _leap > 1 && halton_BASE[i] == _leap ) {
+                RAVELOG_WARN_FORMAT("halton leap %d is the base of dimension %d, the dimension will be constant", _leap%i);
+            }
+        }
+        vector<int> vseed(halton_dim_num_get(),_streamindex), vleap(halton_dim_num_get(),_leap);
+        halton_seed_set ( &vseed[0] );
+        halton_leap_set ( &vleap[0] );
+    }
+
     dReal arc_cosine ( dReal c );
     dReal atan4 ( dReal y, dReal x );
     char digit_to_ch ( int i );
@@ -120,6 +175,8 @@ protected:
     int halton_DIM_NUM;
     int *halton_SEED;
     int halton_STEP;
+
+    int _streamindex, _leap; ///< \see SetStream
 };
 
 #endif
@@ -101,30 +101,41 @@ Mersenne twister sampling algorithm that is based on matrix linear recurrence ov
     int SampleSequence(std::vector<dReal>& samples, size_t num=1,IntervalType interval=IT_Closed)
     {
         samples.resize(_dof*num);
+        return SampleSequence(samples.data(), num, interval);
+    }
+
+    int SampleSequence(dReal* samples, size_t num, IntervalType interval=IT_Closed)
+    {
+        dReal fscale, foffset;
         switch(interval) {
         case IT_Open:
-            for(size_t i = 0; i < samples.size(); ++i) {
-                samples[i] = (((dReal)genrand_int32()) + 0.5f)*(1.0f/4294967296.0f);
-            }
+            fscale = 1.0f/4294967296.0f; foffset = 0.5f*fscale;
             break;
         case IT_OpenStart:
-            for(size_t i = 0; i < samples.size(); ++i) {
-                samples[i] = (((dReal)genrand_int32()) + 1.0f)*(1.0f/4294967296.0f);
-            }
+            fscale = 1.0f/4294967296.0f; foffset = fscale;
             break;
         case IT_OpenEnd:
-            for(size_t i = 0; i < samples.size(); ++i) {
-                samples[i] = (dReal)genrand_int32()*(1.0f/4294967296.0f);
-            }
+            fscale = 1.0f/4294967296.0f; foffset = 0;
             break;
         case IT_Closed:
-            for(size_t i = 0; i < samples.size(); ++i) {
-                samples[i] = (dReal)genrand_int32()*(1.0f/4294967295.0f);
-            }
+            fscale = 1.0f/4294967295.0f; foffset = 0;
             break;
         default:
             throw OPENRAVE_EXCEPTION_FORMAT0("invalid interval", ORE_InvalidArguments);
         }
+        // generate the integers in blocks so the conversion loop has no dependencies and can be vectorized
+        const size_t numvalues = _dof*num;
+        uint32_t block[256];
+        for(size_t offset = 0; offset < numvalues; offset += 256) {
+            const size_t blocksize = std::min(numvalues-offset, (size_t)256);
+            for(size_t i = 0; i < blocksize; ++i) {
+                block[i] = genrand_int32();
+            }
+            dReal* pblocksamples = samples + offset;
+            for(size_t i = 0; i < blocksize; ++i) {
+                pblocksamples[i] = (dReal)block[i]*fscale + foffset;
+            }
+        }
         return (int)num;
     }
 
@@ -149,7 +160,12 @@ Mersenne twister sampling algorithm that is based on matrix linear recurrence ov
     int SampleSequence(std::vector<uint32_t>& samples, size_t num)
     {
         samples.resize(_dof*num);
-        for(size_t i = 0; i < samples.size(); ++i) {
+        return SampleSequence(samples.data(), num);
+    }
+
+    int SampleSequence(uint32_t* samples, size_t num)
+    {
+        for(size_t i = 0; i < _dof*num; ++i) {
             samples[i] = genrand_int32();
         }
         return (int)num;
@@ -80,31 +80,40 @@ void RobotConfigurationSampler::GetLimits(std::vector<dReal>& vLowerLimit, std::
 
 int RobotConfigurationSampler::SampleSequence(std::vector<dReal>& samples, size_t num,IntervalType interval)
 {
-    _psampler->SampleSequence(samples,num,interval);
-    for (size_t inum = 0; inum < num*_lower.size(); inum += _lower.size()) {
-        for (size_t i = 0; i < _lower.size(); i++) {
-            if( _viscircular[i] || (int)i == _affinerotaxis ) {
-                samples[inum+i] = -PI + 2*PI*samples[inum+i];
-            }
-            else if( _affinerot3d >= 0 && (int)i >= _affinerot3d && (int)i < _affinerot3d+3 ) {
-                if( (int)i == _affinerot3d ) {
-                    Vector axisangle = axisAngleFromQuat(_SampleQuaternion());
-                    samples[inum+i+0] = axisangle[0];
-                    samples[inum+i+1] = axisangle[1];
-                    samples[inum+i+2] = axisangle[2];
-                }
-            }
-            else if( _affinequat >= 0 && (int)i >= _affinequat && (int)i < _affinequat+3 ) {
-                if( (int)i == _affinequat ) {
-                    Vector quat = _SampleQuaternion();
-                    samples[inum+i+0] = quat[0];
-                    samples[inum+i+1] = quat[1];
-                    samples[inum+i+2] = quat[2];
-                    samples[inum+i+3] = quat[3];
-                }
+    samples.resize(num*_lower.size());
+    return SampleSequence(samples.data(), num, interval);
+}
+
+int RobotConfigurationSampler::SampleSequence(dReal* samples, size_t num,IntervalType interval)
+{
+    const size_t dof = _lower.size();
+    int ret = _psampler->SampleSequence(samples,num,interval);
+    if( ret <= 0 ) {
+        return ret;
+    }
+    // scale all the dofs with the same operations so that the loop can be vectorized, the rotations are overwritten afterwards
+    const dReal* plower = _samplelower.data();
+    const dReal* prange = _samplerange.data();
+    for (size_t inum = 0; inum < num*dof; inum += dof) {
+        dReal* psample = samples + inum;
+        for (size_t i = 0; i < dof; i++) {
+            psample[i] = plower[i] + psample[i]*prange[i];
+        }
+    }
+    if( _affinerot3d >= 0 || _affinequat >= 0 ) {
+        for (size_t inum = 0; inum < num*dof; inum += dof) {
+            if( _affinerot3d >= 0 ) {
+                Vector axisangle = axisAngleFromQuat(_SampleQuaternion());
+                samples[inum+_affinerot3d+0] = axisangle[0];
+                samples[inum+_affinerot3d+1] = axisangle[1];
+                samples[inum+_affinerot3d+2] = axisangle[2];
             }
-            else {
-                samples[inum+i] = _lower[i] + samples[inum+i]*_range[i];
+            if( _affinequat >= 0 ) {
+                Vector quat = _SampleQuaternion();
+                samples[inum+_affinequat+0] = quat[0];
+                samples[inum+_affinequat+1] = quat[1];
+                samples[inum+_affinequat+2] = quat[2];
+                samples[inum+_affinequat+3] = quat[3];
             }
         }
     }
@@ -175,6 +184,15 @@ void RobotConfigurationSampler::_UpdateDOFs()
         _affinequat = _probot->GetActiveDOFIndices().size()+RaveGetIndexFromAffineDOF(_probot->GetAffineDOF(),DOF_RotationQuat);
     }
 
+    _samplelower = _lower;
+    _samplerange = _range;
+    for(size_t i = 0; i < _lower.size(); ++i) {
+        if( _viscircular[i] || (int)i == _affinerotaxis ) {
+            _samplelower[i] = -PI;
+            _samplerange[i] = 2*PI;
+        }
+    }
+
     if( _lower.size() > 0 ) {
         _psampler->SetSpaceDOF(_lower.size());
     }
@@ -33,6 +33,7 @@ public:
     void GetLimits(std::vector<dReal>& vLowerLimit, std::vector<dReal>& vUpperLimit) const override;
 
     int SampleSequence(std::vector<dReal>& samples, size_t num=1,IntervalType interval=IT_Closed) override;
+    int SampleSequence(dReal* samples, size_t num, IntervalType interval=IT_Closed) override;
 
 protected:
 
@@ -45,7 +46,8 @@ protected:
     SpaceSamplerBasePtr _psampler;
     RobotBasePtr _probot;
     UserDataPtr _updatedofscallback;
-    std::vector<dReal> _lower, _upper, _range, _rangescaled;
+    std::vector<dReal> _lower, _upper, _range;
+    std::vector<dReal> _samplelower, _samplerange; ///< maps the [0,1] samples of every dof, circular joints use [-PI,PI]
     std::vector<dReal> _tempsamples;
     std::vector<uint8_t> _viscircular;
     int _affinerotaxis, _affinerot3d, _affinequat;
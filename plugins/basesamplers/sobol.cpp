@@ -0,0 +1,310 @@
+// -*- coding: utf-8 --*
+// Copyright (C) 2006-2022 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "sobol.h"
+
+#include <boost/bind/bind.hpp>
+#include <random>
+
+using namespace boost::placeholders;
+
+namespace {
+
+/// \brief primitive polynomial and initial direction numbers of one dimension
+struct SobolDirectionInit
+{
+    int s; ///< degree of the polynomial
+    uint32_t a; ///< coefficients of the polynomial
+    uint32_t m[8]; ///< initial direction numbers
+};
+
+/// direction numbers of dimensions 2..40 from S. Joe and F. Y. Kuo, Constructing Sobol sequences with better two-dimensional projections, SIAM J. Sci. Comput. 30, 2635-2654 (2008). The first dimension is the van der Corput sequence.
+static const SobolDirectionInit s_sobolinit[] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    {7, 7, {1, 1, 3, 13, 7, 35, 63}},
+    {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+    {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+    {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+    {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+    {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+    {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+    {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+    {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+    {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+    {7, 42, {1, 3, 7, 3, 13, 59, 17}},
+    {7, 50, {1, 3, 1, 3, 5, 53, 69}},
+    {7, 55, {1, 1, 5, 5, 23, 33, 13}},
+    {7, 56, {1, 1, 7, 7, 1, 61, 123}},
+    {7, 59, {1, 1, 7, 9, 13, 61, 49}},
+    {7, 62, {1, 3, 3, 5, 3, 55, 33}},
+    {8, 14, {1, 3, 1, 15, 31, 13, 49, 245}},
+    {8, 21, {1, 3, 5, 15, 31, 59, 63, 97}},
+    {8, 22, {1, 3, 1, 11, 11, 11, 77, 249}},
+};
+
+inline uint32_t CountTrailingZeros(uint32_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    uint32_t n = 0;
+    while( !(x & 1) ) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline uint32_t Parity(uint32_t x)
+{
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return x & 1;
+}
+
+} // end namespace
+
+ScrambledSobolSampler::ScrambledSobolSampler(EnvironmentBasePtr penv, std::istream& sinput) : SpaceSamplerBase(penv), _dof(1), _seed(0), _streamindex(0), _streamlog2(20), _index(0)
+{
+    __description = ":Interface Author: Rosen Diankov\n\n\
+Sobol low-discrepancy sequence of up to 40 dimensions with the direction numbers of Joe and Kuo. Every dimension is randomized with a linear matrix scramble and a digital shift chosen by the seed, which keeps the low discrepancy while removing the correlations of the unscrambled sequence. \
+The seed sets the scramble instead of the start of the sequence.\n\n\
+References:\n\n\
+1. S. Joe and F. Y. Kuo, Constructing Sobol sequences with better two-dimensional projections, SIAM J. Sci. Comput. 30, 2635-2654 (2008).\n\n\
+2. J. Matousek, On the L2-discrepancy for anchored boxes, Journal of Complexity 14, 527-556 (1998).\n\n\
+";
+    RegisterCommand("SetStream",boost::bind(&ScrambledSobolSampler::_SetStreamCommand,this,_1,_2),
+                    "Starts the sequence at point 'stream index'*2^'block size log2' so that samplers with the same seed and different stream indices return disjoint blocks of the same scrambled sequence, for example one sampler per thread of a parallel planner. Format::\n\n  SetStream [stream index] [block size log2=20]\n\n");
+    _InitDirections();
+}
+
+void ScrambledSobolSampler::SetSeed(uint32_t seed)
+{
+    _seed = seed;
+    _InitDirections();
+}
+
+void ScrambledSobolSampler::SetSpaceDOF(int dof)
+{
+    BOOST_ASSERT(dof > 0);
+    if( dof > GetMaxDOF() ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("sobol sampler supports up to %d dimensions, %d requested", GetMaxDOF()%dof, ORE_InvalidArguments);
+    }
+    _dof = dof;
+    _InitDirections();
+}
+
+int ScrambledSobolSampler::GetDOF() const
+{
+    return _dof;
+}
+
+int ScrambledSobolSampler::GetNumberOfValues() const
+{
+    return _dof;
+}
+
+bool ScrambledSobolSampler::Supports(SampleDataType type) const
+{
+    return true;
+}
+
+void ScrambledSobolSampler::GetLimits(std::vector<dReal>& vLowerLimit, std::vector<dReal>& vUpperLimit) const
+{
+    vLowerLimit.resize(0); vLowerLimit.resize(_dof, 0);
+    vUpperLimit.resize(0); vUpperLimit.resize(_dof, 1);
+}
+
+void ScrambledSobolSampler::GetLimits(std::vector<uint32_t>& vLowerLimit, std::vector<uint32_t>& vUpperLimit) const
+{
+    vLowerLimit.resize(0); vLowerLimit.resize(_dof, 0);
+    vUpperLimit.resize(0); vUpperLimit.resize(_dof, 0xffffffff);
+}
+
+int ScrambledSobolSampler::GetMaxDOF()
+{
+    return 1 + (int)(sizeof(s_sobolinit)/sizeof(s_sobolinit[0]));
+}
+
+int ScrambledSobolSampler::SampleSequence(std::vector<dReal>& samples, size_t num, IntervalType interval)
+{
+    samples.resize(_dof*num);
+    return SampleSequence(samples.data(), num, interval);
+}
+
+int ScrambledSobolSampler::SampleSequence(dReal* samples, size_t num, IntervalType interval)
+{
+    dReal fscale, foffset;
+    switch(interval) {
+    case IT_Open:
+        fscale = 1.0/4294967296.0; foffset = 0.5*fscale;
+        break;
+    case IT_OpenStart:
+        fscale = 1.0/4294967296.0; foffset = fscale;
+        break;
+    case IT_OpenEnd:
+        fscale = 1.0/4294967296.0; foffset = 0;
+        break;
+    case IT_Closed:
+        fscale = 1.0/4294967295.0; foffset = 0;
+        break;
+    default:
+        throw OPENRAVE_EXCEPTION_FORMAT0("invalid interval", ORE_InvalidArguments);
+    }
+    const uint32_t* ppoint = _vpoint.data();
+    for(size_t inum = 0; inum < num; ++inum) {
+        dReal* psample = samples + inum*_dof;
+        for(int i = 0; i < _dof; ++i) {
+            psample[i] = (dReal)ppoint[i]*fscale + foffset;
+        }
+        _Advance();
+    }
+    return (int)num;
+}
+
+int ScrambledSobolSampler::SampleSequence(std::vector<uint32_t>& samples, size_t num)
+{
+    samples.resize(_dof*num);
+    return SampleSequence(samples.data(), num);
+}
+
+int ScrambledSobolSampler::SampleSequence(uint32_t* samples, size_t num)
+{
+    for(size_t inum = 0; inum < num; ++inum) {
+        std::copy(_vpoint.begin(), _vpoint.end(), samples + inum*_dof);
+        _Advance();
+    }
+    return (int)num;
+}
+
+bool ScrambledSobolSampler::_SetStreamCommand(std::ostream& sout, std::istream& sinput)
+{
+    uint32_t streamindex = 0, streamlog2 = 20;
+    sinput >> streamindex;
+    if( !sinput ) {
+        return false;
+    }
+    sinput >> streamlog2;
+    if( !sinput ) {
+        streamlog2 = 20;
+    }
+    if( streamlog2 > 31 || (streamlog2 > 0 && (uint64_t)streamindex >= ((uint64_t)1<<(32-streamlog2))) ) {
+        RAVELOG_WARN_FORMAT("stream %d with block size 2^%d is outside of the 2^32 points of the sequence", streamindex%streamlog2);
+        return false;
+    }
+    _streamindex = streamindex;
+    _streamlog2 = streamlog2;
+    _Seek(_streamindex<<_streamlog2);
+    return true;
+}
+
+void ScrambledSobolSampler::_InitDirections()
+{
+    std::mt19937 rng(_seed);
+    _vdirections.resize(32*_dof);
+    _vshift.resize(_dof);
+    uint32_t v[32], vrowmasks[32];
+    for(int idim = 0; idim < _dof; ++idim) {
+        if( idim == 0 ) {
+            for(int k = 0; k < 32; ++k) {
+                v[k] = (uint32_t)1<<(31-k);
+            }
+        }
+        else {
+            const SobolDirectionInit& init = s_sobolinit[idim-1];
+            for(int k = 0; k < init.s; ++k) {
+                v[k] = init.m[k]<<(31-k);
+            }
+            for(int k = init.s; k < 32; ++k) {
+                v[k] = v[k-init.s] ^ (v[k-init.s]>>init.s);
+                for(int l = 1; l < init.s; ++l) {
+                    if( (init.a>>(init.s-1-l)) & 1 ) {
+                        v[k] ^= v[k-l];
+                    }
+                }
+            }
+        }
+
+        // random lower triangular matrix with unit diagonal over the binary digits, row j computes digit j (bit 31-j) from the digits before it
+        for(int j = 0; j < 32; ++j) {
+            const uint32_t diagonal = (uint32_t)1<<(31-j);
+            const uint32_t previousdigits = j == 0 ? 0 : ~((diagonal<<1)-1);
+            vrowmasks[j] = diagonal | ((uint32_t)rng() & previousdigits);
+        }
+        for(int k = 0; k < 32; ++k) {
+            uint32_t scrambled = 0;
+            for(int j = 0; j < 32; ++j) {
+                scrambled |= Parity(v[k] & vrowmasks[j])<<(31-j);
+            }
+            _vdirections[k*_dof+idim] = scrambled;
+        }
+        _vshift[idim] = rng();
+    }
+    _Seek(_streamindex<<_streamlog2);
+}
+
+void ScrambledSobolSampler::_Seek(uint32_t index)
+{
+    _index = index;
+    _vpoint = _vshift;
+    const uint32_t gray = index ^ (index>>1);
+    for(int k = 0; k < 32; ++k) {
+        if( gray & ((uint32_t)1<<k) ) {
+            const uint32_t* pdirections = &_vdirections[k*_dof];
+            for(int idim = 0; idim < _dof; ++idim) {
+                _vpoint[idim] ^= pdirections[idim];
+            }
+        }
+    }
+}
+
+inline void ScrambledSobolSampler::_Advance()
+{
+    ++_index;
+    if( _index == 0 ) {
+        // wrapped around the 2^32 points
+        _vpoint = _vshift;
+        return;
+    }
+    const uint32_t* pdirections = &_vdirections[CountTrailingZeros(_index)*_dof];
+    uint32_t* ppoint = _vpoint.data();
+    for(int idim = 0; idim < _dof; ++idim) {
+        ppoint[idim] ^= pdirections[idim];
+    }
+}
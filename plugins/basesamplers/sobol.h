@@ -0,0 +1,72 @@
+// -*- coding: utf-8 --*
+// Copyright (C) 2006-2022 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef SAMPLER_SOBOL
+#define SAMPLER_SOBOL
+
+#include <openrave/openrave.h>
+
+using namespace OpenRAVE;
+
+/// \brief Sobol low-discrepancy sequence with a random linear matrix scramble and digital shift of every dimension.
+///
+/// Points are generated in gray code order, so every sample is one xor per dimension.
+class ScrambledSobolSampler : public SpaceSamplerBase
+{
+public:
+    ScrambledSobolSampler(EnvironmentBasePtr penv, std::istream& sinput);
+
+    /// \brief sets the seed of the scramble and restarts the stream
+    void SetSeed(uint32_t seed) override;
+
+    void SetSpaceDOF(int dof) override;
+    int GetDOF() const override;
+    int GetNumberOfValues() const override;
+    bool Supports(SampleDataType type) const override;
+
+    void GetLimits(std::vector<dReal>& vLowerLimit, std::vector<dReal>& vUpperLimit) const override;
+    void GetLimits(std::vector<uint32_t>& vLowerLimit, std::vector<uint32_t>& vUpperLimit) const override;
+
+    int SampleSequence(std::vector<dReal>& samples, size_t num=1,IntervalType interval=IT_Closed) override;
+    int SampleSequence(dReal* samples, size_t num, IntervalType interval=IT_Closed) override;
+    int SampleSequence(std::vector<uint32_t>& samples, size_t num=1) override;
+    int SampleSequence(uint32_t* samples, size_t num) override;
+
+    /// \brief maximum dimension supported by the direction numbers
+    static int GetMaxDOF();
+
+protected:
+    bool _SetStreamCommand(std::ostream& sout, std::istream& sinput);
+
+    /// \brief computes the scrambled direction numbers of all dimensions and restarts the stream
+    void _InitDirections();
+
+    /// \brief moves to the index-th point of the sequence
+    void _Seek(uint32_t index);
+
+    /// \brief moves to the next point of the sequence
+    inline void _Advance();
+
+    int _dof;
+    uint32_t _seed;
+    uint32_t _streamindex, _streamlog2; ///< the stream starts at point _streamindex<<_streamlog2
+    uint32_t _index; ///< index of the current point
+    std::vector<uint32_t> _vdirections; ///< 32 scrambled direction numbers for every dimension
+    std::vector<uint32_t> _vshift; ///< digital shift of every dimension
+    std::vector<uint32_t> _vpoint; ///< the current point of every dimension
+};
+
+#endif
@@ -185,12 +185,14 @@ private:
                 case GT_ConicalFrustum:
                 case GT_Axial:
                 case GT_TriMesh: {
-                    if( geom->GetCollisionMesh().indices.size() >= 3 ) {
+                    const CompactTriMesh& mesh = geom->GetCollisionMesh();
+                    const std::vector<int32_t>& indices = mesh.GetIndices();
+                    if( indices.size() >= 3 ) {
                         btTriangleMesh* ptrimesh = new btTriangleMesh();
 
                         // for some reason adding indices makes everything crash
-                        for(size_t i = 0; i < geom->GetCollisionMesh().indices.size(); i += 3) {
-                            ptrimesh->addTriangle(GetBtVector(geom->GetCollisionMesh().vertices[i]), GetBtVector(geom->GetCollisionMesh().vertices[i+1]), GetBtVector(geom->GetCollisionMesh().vertices[i+2]));
+                        for(size_t i = 0; i+2 < indices.size(); i += 3) {
+                            ptrimesh->addTriangle(GetBtVector(mesh.GetVertex(indices[i])), GetBtVector(mesh.GetVertex(indices[i+1])), GetBtVector(mesh.GetVertex(indices[i+2])));
                         }
                         //child.reset(new btBvhTriangleMeshShape(ptrimesh, true, true)); // doesn't do tri-tri collisions!
 
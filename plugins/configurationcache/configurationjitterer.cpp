@@ -23,6 +23,11 @@
 #include <boost/numeric/bindings/lapack/gesdd.hpp>
 #endif
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include "configurationjitterer.h"
 
 namespace configurationcache {
@@ -65,6 +70,10 @@ By default will sample the robot's active DOFs. Parameters part of the interface
     bias_dir is the workspace direction to bias the sampling in.\n\
     nullsampleprob, nullbiassampleprob, and deltasampleprob are in [0,1]\n\
  //");
+        RegisterCommand("SetNumThreads",boost::bind(&ConfigurationJitterer::SetNumThreadsCommand,this,_1,_2),
+                        "sets the number of sampling streams. If > 1, the streams other than the first run on cloned environments in their own threads. 0 uses one stream per hardware thread.");
+        RegisterCommand("SetMaxJitterTime",boost::bind(&ConfigurationJitterer::SetMaxJitterTimeCommand,this,_1,_2),
+                        "sets the max time in seconds to jitter for. If > 0, jittering stops at this deadline instead of after the max iterations.");
         RegisterJSONCommand("GetFailuresCount", boost::bind(&ConfigurationJitterer::GetFailuresCountCommand, this, _1, _2, _3),
                             "Gets the numbers of failing jittered configurations from the latest call categorized based on the failure reasons.");
         RegisterJSONCommand("GetCurrentParameters", boost::bind(&ConfigurationJitterer::GetCurrentParametersCommand, this, _1, _2, _3),
@@ -125,6 +134,7 @@ By default will sample the robot's active DOFs. Parameters part of the interface
             _cache.reset(new CacheTree(_probot, _probot->GetActiveDOF()));
             _cache->Init(vweights, 1);
         }
+        _vweights = vweights;
 
         _bSetResultOnRobot = true;
         _busebiasing = false;
@@ -142,15 +152,23 @@ By default will sample the robot's active DOFs. Parameters part of the interface
 
         // use for sampling, perturbations
         _curdof.resize(dof,0);
-        _newdof2.resize(dof);
-        _deltadof.resize(dof);
-        _deltadof2.resize(dof);
         _nRandomGeneratorSeed = 0;
         _nNumIterations = 0;
 
         _fulldof.resize(_probot->GetDOF(), 0);
 
         _report.reset(new CollisionReport());
+
+        // the first stream always samples with the robot of this environment
+        JitterStreamPtr pmainstream(new JitterStream());
+        pmainstream->penv = penv;
+        pmainstream->probot = _probot;
+        pmainstream->psampler = _ssampler;
+        pmainstream->report = _report;
+        _vstreams.push_back(pmainstream);
+        _nNumThreads = 1;
+        _fMaxJitterTime = 0;
+
         _maxiterations=5000;
         _maxjitter=0.02;
         _perturbation=1e-5;
@@ -169,6 +187,9 @@ By default will sample the robot's active DOFs. Parameters part of the interface
     }
 
     virtual ~ConfigurationJitterer(){
+        for(size_t istream = 1; istream < _vstreams.size(); ++istream) {
+            _vstreams[istream]->penv->Destroy();
+        }
     }
 
     virtual void SetSeed(uint32_t seed) {
@@ -222,6 +243,35 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         return true;
     }
 
+    bool SetNumThreadsCommand(std::ostream& sout, std::istream& sinput)
+    {
+        int numthreads = 0;
+        sinput >> numthreads;
+        if( !sinput || numthreads < 0 ) {
+            return false;
+        }
+        if( numthreads == 0 ) {
+            numthreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        _nNumThreads = numthreads;
+        while( (int)_vstreams.size() > _nNumThreads ) {
+            _vstreams.back()->penv->Destroy();
+            _vstreams.pop_back();
+        }
+        return true;
+    }
+
+    bool SetMaxJitterTimeCommand(std::ostream& sout, std::istream& sinput)
+    {
+        dReal fMaxJitterTime = 0;
+        sinput >> fMaxJitterTime;
+        if( !sinput || fMaxJitterTime < 0 ) {
+            return false;
+        }
+        _fMaxJitterTime = fMaxJitterTime;
+        return true;
+    }
+
     bool SetMaxLinkDistThreshCommand(std::ostream& sout, std::istream& sinput)
     {
         dReal linkdistthresh=0;
@@ -434,6 +484,8 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         orjson::SetJsonValueByKey(output, "currentJointValues", _fulldof, alloc);
         orjson::SetJsonValueByKey(output, "maxJitter", _maxjitter, alloc);
         orjson::SetJsonValueByKey(output, "maxJitterIterations", _maxiterations, alloc);
+        orjson::SetJsonValueByKey(output, "maxJitterTime", _fMaxJitterTime, alloc);
+        orjson::SetJsonValueByKey(output, "numJitterThreads", _nNumThreads, alloc);
         orjson::SetJsonValueByKey(output, "maxJitterLinkDist", _linkdistthresh, alloc);
         orjson::SetJsonValueByKey(output, "jitterPerturbation", _perturbation, alloc);
         orjson::SetJsonValueByKey(output, "jitterNeighDistThresh", _neighdistthresh, alloc);
@@ -471,10 +523,13 @@ By default will sample the robot's active DOFs. Parameters part of the interface
     ///
     int Sample(std::vector<dReal>& vnewdof, IntervalType interval=IT_Closed)
     {
+        if( !_pSampleStatistics ) {
+            // the xml id is only known after construction
+            _pSampleStatistics = GetEnv()->GetStatisticsRegistry().GetCounter(GetXMLId(), "Sample");
+        }
+        StatisticsTimer timer(_pSampleStatistics);
         RobotBase::RobotStateSaver robotsaver(_probot, KinBody::Save_LinkTransformation|KinBody::Save_ActiveDOF);
         _InitRobotState();
-        const dReal linkdistthresh = _linkdistthresh;
-        const dReal linkdistthresh2 = _linkdistthresh2;
 
         if( _bResetIterationsOnSample ) {
             _nNumIterations = 0;
@@ -586,6 +641,81 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         BOOST_ASSERT(!_busebiasing || _vbiasdofdirection.size() > 0);
         const boost::array<dReal, 3> rayincs = {{0.2, 0.5, 0.9}};
 
+        uint64_t starttime = utils::GetNanoPerformanceTime();
+        if( _nNumThreads > 1 ) {
+            if( bConstraint ) {
+                // _neighstatefn works on the robot of this environment
+                RAVELOG_DEBUG_FORMAT("env=%s, neighstatefn is set, so jittering with one thread instead of %d", GetEnv()->GetNameId()%_nNumThreads);
+            }
+            else {
+                int ret = _SampleParallel(vnewdof, interval, perturbations, rayincs, starttime);
+                if( ret == 1 && _bSetResultOnRobot ) {
+                    // have to release the saver so it does not restore the old configuration
+                    robotsaver.Release();
+                }
+                return ret;
+            }
+        }
+
+        JitterStream& mainstream = *_vstreams.at(0);
+        mainstream.vLinks = _vLinks;
+        mainstream.pmanip = _pmanip;
+        const uint64_t deadline = _fMaxJitterTime > 0 ? starttime + (uint64_t)(_fMaxJitterTime*1e9) : 0;
+        for(int iter = 0; deadline > 0 || iter < _maxiterations; ++iter) {
+            if( (iter%10) == 0 ) { // not sure what a good rate is...
+                _CallStatusFunctions(iter);
+            }
+            if( deadline > 0 && utils::GetNanoPerformanceTime() >= deadline ) {
+                break;
+            }
+
+            _nNumIterations++;
+            dReal frayinc = 0;
+            if( _busebiasing && iter+((int)_nNumIterations-2) < (int)rayincs.size() ) {
+                frayinc = rayincs.at(iter+(_nNumIterations-2));
+            }
+            if( _SampleJitteredConfiguration(mainstream, _counter, iter, frayinc, interval, perturbations, false, vnewdof) ) {
+                if( _bSetResultOnRobot ) {
+                    // have to release the saver so it does not restore the old configuration
+                    robotsaver.Release();
+                }
+
+                RAVELOG_DEBUG_FORMAT("env=%s, succeed iterations=%d, computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, nLinkDistThreshRejections=%d",GetEnv()->GetNameId()%iter%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nLinkDistThreshRejections);
+                //RAVELOG_VERBOSE_FORMAT("succeed iterations=%d, cachehits=%d, cache size=%d, originaldist=%f, computation=%fs\n",iter%_cachehit%cache.GetNumNodes()%cache.ComputeDistance(_curdof, vnewdof)%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
+                return 1;
+            }
+        }
+
+        RAVELOG_INFO_FORMAT("env=%s, failed iterations=%d (max=%d), computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, samesamples=%d, nLinkDistThreshRejections=%d", GetEnv()->GetNameId()%_nNumIterations%_maxiterations%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nSameSamples%_counter.nLinkDistThreshRejections);
+        //RAVELOG_WARN_FORMAT("failed iterations=%d, cachehits=%d, cache size=%d, jitter time=%fs", _maxiterations%_cachehit%cache.GetNumNodes()%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
+        return 0;
+    }
+
+protected:
+    /// \brief robot and buffers that one sampling stream jitters with
+    struct JitterStream
+    {
+        EnvironmentBasePtr penv;
+        RobotBasePtr probot;
+        std::vector<KinBody::LinkPtr> vLinks; ///< links of probot and its grabbed bodies corresponding to _vLinks
+        RobotBase::ManipulatorConstPtr pmanip; ///< manipulator of probot corresponding to _pmanip
+        SpaceSamplerBasePtr psampler;
+        CollisionReportPtr report;
+        FailureCounter counter; ///< failures of the stream during the latest parallel jitter
+        std::vector<dReal> vnewdof, newdof2, deltadof;
+    };
+    typedef boost::shared_ptr<JitterStream> JitterStreamPtr;
+
+    /// \brief samples one configuration around _curdof with the robot of the stream and checks the link distances, the constraints and the collisions of all perturbations.
+    ///
+    /// \param iter index of the sample, the jitter grows with it until _maxiterations/2
+    /// \param frayinc if > 0, tests the configuration at this distance along the bias direction instead of a random one
+    /// \param bInsertTested if true, configurations that fail the constraint or collision checks are inserted into the cache so that other streams skip them
+    /// \return true if vnewdof satisfies all constraints, in which case the robot of the stream is set to vnewdof
+    bool _SampleJitteredConfiguration(JitterStream& stream, FailureCounter& counter, int iter, dReal frayinc, IntervalType interval, const std::vector<dReal>& perturbations, bool bInsertTested, std::vector<dReal>& vnewdof)
+    {
+        const dReal linkdistthresh = _linkdistthresh;
+        const dReal linkdistthresh2 = _linkdistthresh2;
         bool busebiasing = _busebiasing;
         const int nMaxIterRadiusThresh=_maxiterations/2;
         const dReal imaxiterations = 2.0/dReal(_maxiterations);
@@ -594,342 +724,468 @@ By default will sample the robot's active DOFs. Parameters part of the interface
         if( fBias > g_fEpsilon ) {
             fBias = RaveSqrt(fBias);
         }
+        vnewdof.resize(_curdof.size());
+        stream.deltadof.resize(_curdof.size());
 
-        uint64_t starttime = utils::GetNanoPerformanceTime();
-        for(int iter = 0; iter < _maxiterations; ++iter) {
-            if( (iter%10) == 0 ) { // not sure what a good rate is...
-                _CallStatusFunctions(iter);
+        if( frayinc > 0 ) {
+            // start by checking samples directly above the current configuration
+            for (size_t j = 0; j < vnewdof.size(); ++j) {
+                vnewdof[j] = _curdof[j] + (frayinc * _vbiasdofdirection.at(j));
             }
-
-            _nNumIterations++;
-            if( busebiasing && iter+((int)_nNumIterations-2) < (int)rayincs.size() ) {
-                int iray = iter+(_nNumIterations-2);
-                // start by checking samples directly above the current configuration
-                for (size_t j = 0; j < vnewdof.size(); ++j) {
-                    vnewdof[j] = _curdof[j] + (rayincs.at(iray) * _vbiasdofdirection.at(j));
-                }
+        }
+        else {
+            // ramp of the jitter as iterations increase
+            dReal jitter = _maxjitter;
+            if( iter < nMaxIterRadiusThresh ) {
+                jitter = _maxjitter*dReal(iter+1)*imaxiterations;
             }
-            else {
-                // ramp of the jitter as iterations increase
-                dReal jitter = _maxjitter;
-                if( iter < nMaxIterRadiusThresh ) {
-                    jitter = _maxjitter*dReal(iter+1)*imaxiterations;
-                }
 
-                bool samplebiasdir = false;
-                bool samplenull = false;
-                bool sampledelta = false;
-                if (busebiasing && _ssampler->SampleSequenceOneReal() < _nullsampleprob)
-                {
-                    samplenull = true;
-                }
-                if (busebiasing && _ssampler->SampleSequenceOneReal() < _nullbiassampleprob) {
-                    samplebiasdir = true;
-                }
-                if( (!samplenull && !samplebiasdir) || _ssampler->SampleSequenceOneReal() < _deltasampleprob ) {
-                    sampledelta = true;
-                }
+            bool samplebiasdir = false;
+            bool samplenull = false;
+            bool sampledelta = false;
+            if (busebiasing && stream.psampler->SampleSequenceOneReal() < _nullsampleprob)
+            {
+                samplenull = true;
+            }
+            if (busebiasing && stream.psampler->SampleSequenceOneReal() < _nullbiassampleprob) {
+                samplebiasdir = true;
+            }
+            if( (!samplenull && !samplebiasdir) || stream.psampler->SampleSequenceOneReal() < _deltasampleprob ) {
+                sampledelta = true;
+            }
 
-                bool deltasuccess = false;
-                if( sampledelta ) {
-                    // check which third the sampled dof is in
-                    for(size_t j = 0; j < vnewdof.size(); ++j) {
-                        dReal f = 2*_ssampler->SampleSequenceOneReal(interval)-1; // f in [-1,1]
-                        if( RaveFabs(f) < fJitterLowerThresh ) {
-                            _deltadof[j] = 0;
-                        }
-                        else if( f < -fJitterHigherThresh ) {
-                            _deltadof[j] = -jitter;
-                        }
-                        else if( f > fJitterHigherThresh ) {
-                            _deltadof[j] = jitter;
-                        }
-                        else {
-                            _deltadof[j] = jitter*f;
-                        }
+            bool deltasuccess = false;
+            if( sampledelta ) {
+                // check which third the sampled dof is in
+                for(size_t j = 0; j < vnewdof.size(); ++j) {
+                    dReal f = 2*stream.psampler->SampleSequenceOneReal(interval)-1; // f in [-1,1]
+                    if( RaveFabs(f) < fJitterLowerThresh ) {
+                        stream.deltadof[j] = 0;
                     }
-                    deltasuccess = true;
-                }
-
-                if (!samplebiasdir && !samplenull && !deltasuccess) {
-                    _counter.nSameSamples++;
-                    continue;
-                }
-                // (lambda * biasdir) + (Nx) + delta + _curdofs
-                dReal fNullspaceMultiplier = linkdistthresh*2;
-                if( fNullspaceMultiplier <= 0 ) {
-                    fNullspaceMultiplier = fBias;
-                }
-                for (size_t k = 0; k < vnewdof.size(); ++k) {
-                    vnewdof[k] = _curdof[k];
-                    if (samplebiasdir) {
-                        vnewdof[k] += _ssampler->SampleSequenceOneReal() * _vbiasdofdirection[k];
+                    else if( f < -fJitterHigherThresh ) {
+                        stream.deltadof[j] = -jitter;
                     }
-                    if (samplenull) {
-                        for (size_t j = 0; j < _vbiasnullspace.size(); ++j) {
-                            dReal nullx = (_ssampler->SampleSequenceOneReal()*2-1)*fNullspaceMultiplier;
-                            vnewdof[k] += nullx * _vbiasnullspace[j][k];
-                        }
+                    else if( f > fJitterHigherThresh ) {
+                        stream.deltadof[j] = jitter;
                     }
-                    if (sampledelta) {
-                        vnewdof[k] += _deltadof[k];
+                    else {
+                        stream.deltadof[j] = jitter*f;
                     }
                 }
+                deltasuccess = true;
             }
 
-            // get new state
-            for(size_t j = 0; j < _deltadof.size(); ++j) {
-                if( vnewdof[j] > _upper.at(j) ) {
-                    vnewdof[j] = _upper.at(j);
+            if (!samplebiasdir && !samplenull && !deltasuccess) {
+                counter.nSameSamples++;
+                return false;
+            }
+            // (lambda * biasdir) + (Nx) + delta + _curdofs
+            dReal fNullspaceMultiplier = linkdistthresh*2;
+            if( fNullspaceMultiplier <= 0 ) {
+                fNullspaceMultiplier = fBias;
+            }
+            for (size_t k = 0; k < vnewdof.size(); ++k) {
+                vnewdof[k] = _curdof[k];
+                if (samplebiasdir) {
+                    vnewdof[k] += stream.psampler->SampleSequenceOneReal() * _vbiasdofdirection[k];
+                }
+                if (samplenull) {
+                    for (size_t j = 0; j < _vbiasnullspace.size(); ++j) {
+                        dReal nullx = (stream.psampler->SampleSequenceOneReal()*2-1)*fNullspaceMultiplier;
+                        vnewdof[k] += nullx * _vbiasnullspace[j][k];
+                    }
                 }
-                else if( vnewdof[j] < _lower.at(j) ) {
-                    vnewdof[j] = _lower.at(j);
+                if (sampledelta) {
+                    vnewdof[k] += stream.deltadof[k];
                 }
             }
+        }
 
-            // Compute a neighbor of _curdof that satisfies constraints. If _neighstatefn is not initialized, then the neighbor is vnewdof itself.
-            if( bConstraint ) {
-                // Obtain the delta dof values computed from the jittering above.
-                for(size_t idof = 0; idof < _deltadof.size(); ++idof) {
-                    _deltadof[idof] = vnewdof[idof] - _curdof[idof];
-                }
-                vnewdof = _curdof;
-                _probot->SetActiveDOFValues(vnewdof); // need to set robot configuration before calling _neighstatefn
-                if( _neighstatefn(vnewdof, _deltadof, 0) == NSS_Failed) {
-                    _counter.nNeighStateFailure++;
-                    continue;
-                }
+        // get new state
+        for(size_t j = 0; j < stream.deltadof.size(); ++j) {
+            if( vnewdof[j] > _upper.at(j) ) {
+                vnewdof[j] = _upper.at(j);
             }
+            else if( vnewdof[j] < _lower.at(j) ) {
+                vnewdof[j] = _lower.at(j);
+            }
+        }
 
-            if( !!_cache ) {
-                if( !!_cache->FindNearestNode(vnewdof, _neighdistthresh).first ) {
-                    _cachehit++;
-                    _counter.nCacheHitSamples++;
-                    continue;
-                }
+        // Compute a neighbor of _curdof that satisfies constraints. If _neighstatefn is not initialized, then the neighbor is vnewdof itself.
+        if( !!_neighstatefn ) {
+            // Obtain the delta dof values computed from the jittering above.
+            for(size_t idof = 0; idof < stream.deltadof.size(); ++idof) {
+                stream.deltadof[idof] = vnewdof[idof] - _curdof[idof];
+            }
+            vnewdof = _curdof;
+            stream.probot->SetActiveDOFValues(vnewdof); // need to set robot configuration before calling _neighstatefn
+            if( _neighstatefn(vnewdof, stream.deltadof, 0) == NSS_Failed) {
+                counter.nNeighStateFailure++;
+                return false;
+            }
+        }
+
+        if( !!_cache ) {
+            std::lock_guard<std::mutex> lock(_cachemutex);
+            if( !!_cache->FindNearestNode(vnewdof, _neighdistthresh).first ) {
+                _cachehit++;
+                counter.nCacheHitSamples++;
+                return false;
             }
+        }
 
-            //int ret = cache.InsertNode(vnewdof, CollisionReportPtr(), _neighdistthresh);
-            //BOOST_ASSERT(ret==1);
+        //int ret = cache.InsertNode(vnewdof, CollisionReportPtr(), _neighdistthresh);
+        //BOOST_ASSERT(ret==1);
 
-            _probot->SetActiveDOFValues(vnewdof);
+        stream.probot->SetActiveDOFValues(vnewdof);
 #ifdef _DEBUG
-            dReal fmaxtransdist = 0;
+        dReal fmaxtransdist = 0;
 #endif
-            bool bSuccess = true;
-            if( linkdistthresh > 0 ) {
-                for (size_t ilink = 0; ilink < _vLinkAABBs.size(); ++ilink) {
-                    // check for an elipse
-                    // L^2 (b*v)^2 + |v|^2|b|^4 - (b*v)^2 |b|^2 <= |b|^4 * L^2
-                    Transform tnewlink = _vLinks[ilink]->GetTransform();
-                    TransformMatrix projdelta = _vOriginalInvTransforms[ilink] * tnewlink;
-                    projdelta.m[0] -= 1;
-                    projdelta.m[5] -= 1;
-                    projdelta.m[10] -= 1;
-                    Vector projextents = _vLinkAABBs[ilink].extents;
-                    Vector projboxright(projdelta.m[0]*projextents.x, projdelta.m[4]*projextents.x, projdelta.m[8]*projextents.x);
-                    Vector projboxup(projdelta.m[1]*projextents.y, projdelta.m[5]*projextents.y, projdelta.m[9]*projextents.y);
-                    Vector projboxdir(projdelta.m[2]*projextents.z, projdelta.m[6]*projextents.z, projdelta.m[10]*projextents.z);
-                    Vector projboxpos = projdelta * _vLinkAABBs[ilink].pos;
-
-                    Vector b;
-                    if( busebiasing ) {
-                        b = _vOriginalInvTransforms[ilink].rotate(_vbiasdirection); // inside link coordinate system
-                    }
-                    else {
-                        // doesn't matter which vector we pick since it is just a sphere.
-                        b = Vector(0,0,linkdistthresh);
-                    }
+        bool bSuccess = true;
+        if( linkdistthresh > 0 ) {
+            for (size_t ilink = 0; ilink < _vLinkAABBs.size(); ++ilink) {
+                // check for an elipse
+                // L^2 (b*v)^2 + |v|^2|b|^4 - (b*v)^2 |b|^2 <= |b|^4 * L^2
+                Transform tnewlink = stream.vLinks[ilink]->GetTransform();
+                TransformMatrix projdelta = _vOriginalInvTransforms[ilink] * tnewlink;
+                projdelta.m[0] -= 1;
+                projdelta.m[5] -= 1;
+                projdelta.m[10] -= 1;
+                Vector projextents = _vLinkAABBs[ilink].extents;
+                Vector projboxright(projdelta.m[0]*projextents.x, projdelta.m[4]*projextents.x, projdelta.m[8]*projextents.x);
+                Vector projboxup(projdelta.m[1]*projextents.y, projdelta.m[5]*projextents.y, projdelta.m[9]*projextents.y);
+                Vector projboxdir(projdelta.m[2]*projextents.z, projdelta.m[6]*projextents.z, projdelta.m[10]*projextents.z);
+                Vector projboxpos = projdelta * _vLinkAABBs[ilink].pos;
+
+                Vector b;
+                if( busebiasing ) {
+                    b = _vOriginalInvTransforms[ilink].rotate(_vbiasdirection); // inside link coordinate system
+                }
+                else {
+                    // doesn't matter which vector we pick since it is just a sphere.
+                    b = Vector(0,0,linkdistthresh);
+                }
 
-                    dReal blength2 = b.lengthsqr3();
-                    dReal blength4 = blength2*blength2;
-                    dReal rhs = blength4 * linkdistthresh2;
-                    //dReal rhs = (b.lengthsqr3()) * linkdistthresh;
-                    dReal ellipdist = 0;
-                    // now figure out what is the max distance
-                    for(int ix = 0; ix < 2; ++ix) {
-                        Vector projvx = ix > 0 ? projboxpos + projboxright : projboxpos - projboxright;
-                        for(int iy = 0; iy < 2; ++iy) {
-                            Vector projvy = iy > 0 ? projvx + projboxup : projvx - projboxup;
-                            for(int iz = 0; iz < 2; ++iz) {
-                                Vector projvz = iz > 0 ? projvy + projboxdir : projvy - projboxdir;
-                                Vector v = projvz; // inside link coordinate system
-                                dReal bv = (v.dot3(b));
-                                dReal bv2 = bv*bv;
-                                dReal flen2 = (linkdistthresh2 - blength2) * bv2 + v.lengthsqr3()*blength4;
-
-                                if( ellipdist < flen2 ) {
-                                    ellipdist = flen2;
+                dReal blength2 = b.lengthsqr3();
+                dReal blength4 = blength2*blength2;
+                dReal rhs = blength4 * linkdistthresh2;
+                //dReal rhs = (b.lengthsqr3()) * linkdistthresh;
+                dReal ellipdist = 0;
+                // now figure out what is the max distance
+                for(int ix = 0; ix < 2; ++ix) {
+                    Vector projvx = ix > 0 ? projboxpos + projboxright : projboxpos - projboxright;
+                    for(int iy = 0; iy < 2; ++iy) {
+                        Vector projvy = iy > 0 ? projvx + projboxup : projvx - projboxup;
+                        for(int iz = 0; iz < 2; ++iz) {
+                            Vector projvz = iz > 0 ? projvy + projboxdir : projvy - projboxdir;
+                            Vector v = projvz; // inside link coordinate system
+                            dReal bv = (v.dot3(b));
+                            dReal bv2 = bv*bv;
+                            dReal flen2 = (linkdistthresh2 - blength2) * bv2 + v.lengthsqr3()*blength4;
+
+                            if( ellipdist < flen2 ) {
+                                ellipdist = flen2;
 #ifdef _DEBUG
-                                    fmaxtransdist = flen2;
+                                fmaxtransdist = flen2;
 #endif
-                                    if (ellipdist > rhs) {
-                                        bSuccess = false;
-                                        break;
-                                    }
+                                if (ellipdist > rhs) {
+                                    bSuccess = false;
+                                    break;
                                 }
                             }
-
-                            if (ellipdist > rhs) {
-                                bSuccess = false;
-                                break;
-                            }
                         }
+
                         if (ellipdist > rhs) {
                             bSuccess = false;
                             break;
                         }
                     }
-                    if( !bSuccess ) {
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                            ss << "dofvalues=[";
-                            for(size_t i = 0; i < vnewdof.size(); ++i ) {
-                                ss << vnewdof[i];
-                                if( i < vnewdof.size() - 1 ) {
-                                    ss << ", ";
-                                }
+                    if (ellipdist > rhs) {
+                        bSuccess = false;
+                        break;
+                    }
+                }
+                if( !bSuccess ) {
+                    if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                        stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
+                        ss << "dofvalues=[";
+                        for(size_t i = 0; i < vnewdof.size(); ++i ) {
+                            ss << vnewdof[i];
+                            if( i < vnewdof.size() - 1 ) {
+                                ss << ", ";
                             }
-                            ss << "]";
-                            RAVELOG_VERBOSE_FORMAT("env=%s, link '%s' exceeded linkdisthresh=%e. ellipdist[%e] > rhs[%e], %s", GetEnv()->GetNameId()%_vLinks[ilink]->GetName()%_linkdistthresh%ellipdist%rhs%ss.str());
                         }
-                        break;
+                        ss << "]";
+                        RAVELOG_VERBOSE_FORMAT("env=%s, link '%s' exceeded linkdisthresh=%e. ellipdist[%e] > rhs[%e], %s", stream.penv->GetNameId()%stream.vLinks[ilink]->GetName()%_linkdistthresh%ellipdist%rhs%ss.str());
                     }
+                    break;
                 }
+            }
 
-                if (!bSuccess) {
-                    _counter.nLinkDistThreshRejections++;
-                    continue;
-                }
+            if (!bSuccess) {
+                counter.nLinkDistThreshRejections++;
+                return false;
             }
+        }
 
-            // check perturbation
-            bCollision = false;
-            bConstraintFailed = false;
-            FOREACH(itperturbation,perturbations) {
-                // Perturbation is added to a config to make sure that the config is not too close to collision and tool
-                // direction/position constraint boundaries. So we do not use _neighstatefn to compute perturbed
-                // configurations.
-                _newdof2 = vnewdof;
-                for(size_t idof = 0; idof < _newdof2.size(); ++idof) {
-                    _newdof2[idof] += *itperturbation;
-                    if( _newdof2[idof] > _upper.at(idof) ) {
-                        _newdof2[idof] = _upper.at(idof);
-                    }
-                    else if( _newdof2[idof] < _lower.at(idof) ) {
-                        _newdof2[idof] = _lower.at(idof);
-                    }
+        // check perturbation
+        bool bCollision = false;
+        bool bConstraintFailed = false;
+        FOREACH(itperturbation,perturbations) {
+            // Perturbation is added to a config to make sure that the config is not too close to collision and tool
+            // direction/position constraint boundaries. So we do not use _neighstatefn to compute perturbed
+            // configurations.
+            stream.newdof2 = vnewdof;
+            for(size_t idof = 0; idof < stream.newdof2.size(); ++idof) {
+                stream.newdof2[idof] += *itperturbation;
+                if( stream.newdof2[idof] > _upper.at(idof) ) {
+                    stream.newdof2[idof] = _upper.at(idof);
                 }
-                _probot->SetActiveDOFValues(_newdof2);
-                if( !!_pConstraintToolDirection ) {
-                    if( !_pConstraintToolDirection->IsInConstraints(_pmanip->GetTransform()) ) {
-                        bConstraintFailed = true;
-                        _counter.nConstraintToolDirFailure++;
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                            ss << "env=" << GetEnv()->GetNameId() << ", direction constraints failed, ";
-                            for(size_t i = 0; i < _newdof2.size(); ++i ) {
-                                if( i > 0 ) {
-                                    ss << "," << _newdof2[i];
-                                }
-                                else {
-                                    ss << "colvalues=[" << _newdof2[i];
-                                }
-                            }
-                            ss << "]; cosangle=" << _pConstraintToolDirection->ComputeCosAngle(_pmanip->GetTransform()) << "; quat=[" << _pmanip->GetTransform().rot.x << ", " << _pmanip->GetTransform().rot.y << ", " << _pmanip->GetTransform().rot.z << ", " << _pmanip->GetTransform().rot.w << "]";
-                            RAVELOG_VERBOSE(ss.str());
-                        }
-                        break;
-                    }
+                else if( stream.newdof2[idof] < _lower.at(idof) ) {
+                    stream.newdof2[idof] = _lower.at(idof);
                 }
-                if( !!_pConstraintToolPosition ) {
-                    if( !_pConstraintToolPosition->IsInConstraints(_pmanip->GetTransform()) ) {
-                        bConstraintFailed = true;
-                        _counter.nConstraintToolPositionFailure++;
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                            ss << "env=" << GetEnv()->GetNameId() << ", position constraints failed, ";
-                            for(size_t i = 0; i < _newdof2.size(); ++i ) {
-                                if( i > 0 ) {
-                                    ss << "," << _newdof2[i];
-                                }
-                                else {
-                                    ss << "colvalues=[" << _newdof2[i];
-                                }
+            }
+            stream.probot->SetActiveDOFValues(stream.newdof2);
+            if( !!_pConstraintToolDirection ) {
+                if( !_pConstraintToolDirection->IsInConstraints(stream.pmanip->GetTransform()) ) {
+                    bConstraintFailed = true;
+                    counter.nConstraintToolDirFailure++;
+                    if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                        stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
+                        ss << "env=" << stream.penv->GetNameId() << ", direction constraints failed, ";
+                        for(size_t i = 0; i < stream.newdof2.size(); ++i ) {
+                            if( i > 0 ) {
+                                ss << "," << stream.newdof2[i];
+                            }
+                            else {
+                                ss << "colvalues=[" << stream.newdof2[i];
                             }
-                            ss << "]; trans=[" << _pmanip->GetTransform().trans.x << ", " << _pmanip->GetTransform().trans.y << ", " << _pmanip->GetTransform().trans.z << "]";
-                            RAVELOG_VERBOSE(ss.str());
                         }
-                        break;
+                        ss << "]; cosangle=" << _pConstraintToolDirection->ComputeCosAngle(stream.pmanip->GetTransform()) << "; quat=[" << stream.pmanip->GetTransform().rot.x << ", " << stream.pmanip->GetTransform().rot.y << ", " << stream.pmanip->GetTransform().rot.z << ", " << stream.pmanip->GetTransform().rot.w << "]";
+                        RAVELOG_VERBOSE(ss.str());
                     }
+                    break;
                 }
-
-                if( GetEnv()->CheckCollision(_probot, _report) ) {
-                    bCollision = true;
-                    _counter.nEnvCollisionFailure++;
-                }
-                if( !bCollision && _probot->CheckSelfCollision(_report)) {
-                    bCollision = true;
-                    _counter.nSelfCollisionFailure++;
-                }
-
-                if( bCollision ) {
+            }
+            if( !!_pConstraintToolPosition ) {
+                if( !_pConstraintToolPosition->IsInConstraints(stream.pmanip->GetTransform()) ) {
+                    bConstraintFailed = true;
+                    counter.nConstraintToolPositionFailure++;
                     if( IS_DEBUGLEVEL(Level_Verbose) ) {
                         stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                        ss << "env=" << _probot->GetEnv()->GetNameId() << ", iter=" << iter << "; collision failed, ";
-                        for(size_t i = 0; i < _newdof2.size(); ++i ) {
+                        ss << "env=" << stream.penv->GetNameId() << ", position constraints failed, ";
+                        for(size_t i = 0; i < stream.newdof2.size(); ++i ) {
                             if( i > 0 ) {
-                                ss << "," << _newdof2[i];
+                                ss << "," << stream.newdof2[i];
                             }
                             else {
-                                ss << "colvalues=[" << _newdof2[i];
+                                ss << "colvalues=[" << stream.newdof2[i];
                             }
                         }
-                        ss << "], report=" << _report->__str__();
+                        ss << "]; trans=[" << stream.pmanip->GetTransform().trans.x << ", " << stream.pmanip->GetTransform().trans.y << ", " << stream.pmanip->GetTransform().trans.z << "]";
                         RAVELOG_VERBOSE(ss.str());
                     }
                     break;
                 }
             }
 
-            if( !bCollision && !bConstraintFailed ) {
-                // the last perturbation is 0, so state is already set to the correct jittered value
+            if( stream.penv->CheckCollision(stream.probot, stream.report) ) {
+                bCollision = true;
+                counter.nEnvCollisionFailure++;
+            }
+            if( !bCollision && stream.probot->CheckSelfCollision(stream.report)) {
+                bCollision = true;
+                counter.nSelfCollisionFailure++;
+            }
+
+            if( bCollision ) {
                 if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                    _probot->GetActiveDOFValues(vnewdof);
                     stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
-                    ss << "env=" << GetEnv()->GetNameId() << ", jitter iter=" << iter << " ";
-#ifdef _DEBUG
-                    ss << "maxtrans=" << fmaxtransdist << " ";
-#endif
-                    for(size_t i = 0; i < vnewdof.size(); ++i ) {
+                    ss << "env=" << stream.penv->GetNameId() << ", iter=" << iter << "; collision failed, ";
+                    for(size_t i = 0; i < stream.newdof2.size(); ++i ) {
                         if( i > 0 ) {
-                            ss << "," << vnewdof[i];
+                            ss << "," << stream.newdof2[i];
                         }
                         else {
-                            ss << "jitteredvalues=[" << vnewdof[i];
+                            ss << "colvalues=[" << stream.newdof2[i];
                         }
                     }
-                    ss << "]";
+                    ss << "], report=" << stream.report->__str__();
                     RAVELOG_VERBOSE(ss.str());
                 }
+                break;
+            }
+        }
+
+
+        if( bCollision || bConstraintFailed ) {
+            if( bInsertTested && !!_cache ) {
+                std::lock_guard<std::mutex> lock(_cachemutex);
+                _cache->InsertNode(vnewdof, CollisionReportPtr(), _neighdistthresh);
+            }
+            return false;
+        }
+
+        // the last perturbation is 0, so state is already set to the correct jittered value
+        if( IS_DEBUGLEVEL(Level_Verbose) ) {
+            stringstream ss; ss << std::setprecision(std::numeric_limits<OpenRAVE::dReal>::digits10+1);
+            ss << "env=" << stream.penv->GetNameId() << ", jitter iter=" << iter << " ";
+#ifdef _DEBUG
+            ss << "maxtrans=" << fmaxtransdist << " ";
+#endif
+            for(size_t i = 0; i < vnewdof.size(); ++i ) {
+                if( i > 0 ) {
+                    ss << "," << vnewdof[i];
+                }
+                else {
+                    ss << "jitteredvalues=[" << vnewdof[i];
+                }
+            }
+            ss << "]";
+            RAVELOG_VERBOSE(ss.str());
+        }
+        return true;
+    }
 
-                if( _bSetResultOnRobot ) {
-                    // have to release the saver so it does not restore the old configuration
-                    robotsaver.Release();
+    /// \brief jitters with _nNumThreads streams at the same time, the first one with the robot of this environment and the others with robots of cloned environments.
+    ///
+    /// The samples of all streams are numbered in the order they are drawn, so the jitter grows the same way as in the serial loop. Once a stream finds a valid configuration, no sample with a larger number is started, and the valid configuration closest to _curdof among the finished samples is set on _probot.
+    /// \return same as Sample
+    int _SampleParallel(std::vector<dReal>& vnewdof, IntervalType interval, const std::vector<dReal>& perturbations, const boost::array<dReal, 3>& rayincs, uint64_t starttime)
+    {
+        _InitStreams();
+        const uint64_t deadline = _fMaxJitterTime > 0 ? starttime + (uint64_t)(_fMaxJitterTime*1e9) : 0;
+        const int nStartIterations = (int)_nNumIterations;
+        std::atomic<int> nextiter(0), numsamples(0), nFoundIter(std::numeric_limits<int>::max());
+        std::atomic<bool> bAbort(false);
+        std::mutex resultmutex;
+        std::vector<dReal> vbestdof;
+        dReal fBestDist = std::numeric_limits<dReal>::infinity();
+        std::vector<std::exception_ptr> vExceptions(_vstreams.size());
+        const auto runStream = [&](size_t istream) {
+            JitterStream& stream = *_vstreams[istream];
+            stream.counter.Reset();
+            try {
+                EnvironmentLock lock(stream.penv->GetMutex(), OpenRAVE::defer_lock_t());
+                if( istream > 0 ) {
+                    lock.lock();
                 }
+                for(int isample = 0; !bAbort; ++isample) {
+                    if( istream == 0 && (isample%10) == 0 ) {
+                        _CallStatusFunctions(nextiter);
+                    }
+                    if( deadline > 0 && utils::GetNanoPerformanceTime() >= deadline ) {
+                        break;
+                    }
+                    const int iter = nextiter++;
+                    if( (deadline == 0 && iter >= _maxiterations) || iter > nFoundIter ) {
+                        break;
+                    }
+                    numsamples++;
+                    dReal frayinc = 0;
+                    if( _busebiasing && iter+nStartIterations-1 < (int)rayincs.size() ) {
+                        frayinc = rayincs.at(iter+nStartIterations-1);
+                    }
+                    if( !_SampleJitteredConfiguration(stream, stream.counter, iter, frayinc, interval, perturbations, true, stream.vnewdof) ) {
+                        continue;
+                    }
 
-                RAVELOG_DEBUG_FORMAT("env=%s, succeed iterations=%d, computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, nLinkDistThreshRejections=%d",GetEnv()->GetNameId()%iter%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nLinkDistThreshRejections);
-                //RAVELOG_VERBOSE_FORMAT("succeed iterations=%d, cachehits=%d, cache size=%d, originaldist=%f, computation=%fs\n",iter%_cachehit%cache.GetNumNodes()%cache.ComputeDistance(_curdof, vnewdof)%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
-                return 1;
+                    dReal fDist = _ComputeJitterDistance(stream.vnewdof);
+                    std::lock_guard<std::mutex> resultlock(resultmutex);
+                    if( fDist < fBestDist ) {
+                        fBestDist = fDist;
+                        vbestdof = stream.vnewdof;
+                    }
+                    if( iter < nFoundIter ) {
+                        nFoundIter = iter;
+                    }
+                }
+            }
+            catch(...) {
+                vExceptions[istream] = std::current_exception();
+                bAbort = true;
+            }
+        };
+
+        std::vector<boost::shared_ptr<std::thread> > vThreads;
+        for(size_t istream = 1; istream < _vstreams.size(); ++istream) {
+            vThreads.push_back(boost::make_shared<std::thread>(runStream, istream));
+        }
+        runStream(0);
+        FOREACH(itThread, vThreads) {
+            (*itThread)->join();
+        }
+        _nNumIterations += numsamples;
+        FOREACHC(itstream, _vstreams) {
+            _counter += (*itstream)->counter;
+        }
+        FOREACHC(itException, vExceptions) {
+            if( !!*itException ) {
+                std::rethrow_exception(*itException);
             }
         }
 
-        RAVELOG_INFO_FORMAT("env=%s, failed iterations=%d (max=%d), computation=%fs, bConstraint=%d, neighstate=%d, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, samesamples=%d, nLinkDistThreshRejections=%d", GetEnv()->GetNameId()%_nNumIterations%_maxiterations%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%bConstraint%_counter.nNeighStateFailure%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nSameSamples%_counter.nLinkDistThreshRejections);
-        //RAVELOG_WARN_FORMAT("failed iterations=%d, cachehits=%d, cache size=%d, jitter time=%fs", _maxiterations%_cachehit%cache.GetNumNodes()%(1e-9*(utils::GetNanoPerformanceTime() - starttime)));
+        if( vbestdof.size() > 0 ) {
+            vnewdof = vbestdof;
+            _probot->SetActiveDOFValues(vnewdof);
+            RAVELOG_DEBUG_FORMAT("env=%s, succeed iterations=%d, threads=%d, distance=%f, computation=%fs, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, nLinkDistThreshRejections=%d",GetEnv()->GetNameId()%numsamples%_vstreams.size()%fBestDist%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nLinkDistThreshRejections);
+            return 1;
+        }
+
+        RAVELOG_INFO_FORMAT("env=%s, failed iterations=%d (max=%d), threads=%d, computation=%fs, constraintToolDir=%d, constraintToolPos=%d, envCollision=%d, selfCollision=%d, cachehit=%d, samesamples=%d, nLinkDistThreshRejections=%d", GetEnv()->GetNameId()%numsamples%_maxiterations%_vstreams.size()%(1e-9*(utils::GetNanoPerformanceTime() - starttime))%_counter.nConstraintToolDirFailure%_counter.nConstraintToolPositionFailure%_counter.nEnvCollisionFailure%_counter.nSelfCollisionFailure%_counter.nCacheHitSamples%_counter.nSameSamples%_counter.nLinkDistThreshRejections);
         return 0;
     }
 
-protected:
+    /// \brief creates streams until there are _nNumThreads of them, and clones this environment into the environments of the streams
+    void _InitStreams()
+    {
+        JitterStream& mainstream = *_vstreams.at(0);
+        mainstream.vLinks = _vLinks;
+        mainstream.pmanip = _pmanip;
+        for(int istream = 1; istream < _nNumThreads; ++istream) {
+            if( istream >= (int)_vstreams.size() ) {
+                JitterStreamPtr pstream(new JitterStream());
+                pstream->penv = GetEnv()->CloneSelf(Clone_Bodies);
+                pstream->psampler = RaveCreateSpaceSampler(pstream->penv, _ssampler->GetXMLId());
+                pstream->psampler->SetSpaceDOF(1);
+                pstream->report.reset(new CollisionReport());
+                _vstreams.push_back(pstream);
+            }
+            else {
+                // reuses the bodies that did not change
+                _vstreams[istream]->penv->Clone(GetEnv(), Clone_Bodies);
+            }
+
+            JitterStream& stream = *_vstreams[istream];
+            EnvironmentLock lock(stream.penv->GetMutex());
+            stream.probot = stream.penv->GetRobot(_probot->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!stream.probot, "env=%s, could not find robot %s in cloned environment", GetEnv()->GetNameId()%_probot->GetName(), ORE_Failed);
+            stream.probot->SetActiveDOFs(_vActiveIndices, _nActiveAffineDOFs, _vActiveAffineAxis);
+            stream.vLinks.resize(0);
+            FOREACHC(itlink, _vLinks) {
+                KinBodyPtr pbody = stream.penv->GetKinBody((*itlink)->GetParent()->GetName());
+                OPENRAVE_ASSERT_FORMAT(!!pbody, "env=%s, could not find body %s in cloned environment", GetEnv()->GetNameId()%(*itlink)->GetParent()->GetName(), ORE_Failed);
+                stream.vLinks.push_back(pbody->GetLinks().at((*itlink)->GetIndex()));
+            }
+            stream.pmanip.reset();
+            if( !!_pmanip ) {
+                stream.pmanip = stream.probot->GetManipulator(_pmanip->GetName());
+            }
+            // draw the seeds from the main sampler so that every call samples differently
+            stream.psampler->SetSeed((uint32_t)(_ssampler->SampleSequenceOneReal()*std::numeric_limits<uint32_t>::max()));
+        }
+    }
+
+    /// \brief weighted distance of vdof to _curdof
+    dReal _ComputeJitterDistance(const std::vector<dReal>& vdof) const
+    {
+        dReal fDist2 = 0;
+        for(size_t idof = 0; idof < vdof.size(); ++idof) {
+            dReal f = (vdof[idof] - _curdof[idof])*_vweights.at(idof);
+            fDist2 += f*f;
+        }
+        return RaveSqrt(fDist2);
+    }
 
     /// \brief extracts all used bodies from the configurationspecification and computes AABBs, transforms, and limits for links
     void _InitRobotState()
@@ -1130,10 +1386,11 @@ protected:
     dReal _perturbation; ///< Test with perturbations since very small changes in angles can produce collision inconsistencies
     dReal _linkdistthresh, _linkdistthresh2; ///< the maximum distance to allow a link to move. If 0, then will disable checking
 
-    std::vector<dReal> _curdof, _newdof2, _deltadof, _deltadof2, _vonesample;
+    std::vector<dReal> _curdof, _vonesample;
     std::vector<dReal> _fulldof; ///< full robot dof values
 
     CacheTreePtr _cache; ///< caches the visisted configurations
+    std::mutex _cachemutex; ///< protects _cache and _cachehit when jittering with several streams
     int _cachehit;
     dReal _neighdistthresh; ///< the minimum distance that nodes can be with respect to each other for the cache
 
@@ -1155,6 +1412,12 @@ protected:
 
     //Vector vManipConstraintBoxMin, vManipConstraintBoxMax; // constraint position
 
+    std::vector<dReal> _vweights; ///< inverse resolutions of the active dofs for computing distances between configurations
+    std::vector<JitterStreamPtr> _vstreams; ///< the first stream uses _probot, the others robots of cloned environments
+    int _nNumThreads; ///< number of streams to jitter with, if 1 then jitters serially
+    dReal _fMaxJitterTime; ///< if > 0, the time in seconds after which jittering stops, _maxiterations is then ignored
+    StatisticsCounter* _pSampleStatistics = nullptr; ///< counts the Sample calls
+
     bool _bSetResultOnRobot; ///< if true, will set the final result on the robot DOF values
     bool _busebiasing; ///< if true will bias the end effector along a certain direction using the jacobian and nullspace.
     bool _bResetIterationsOnSample; ///< if true, when Sample or SampleSequence is called, will reset the _nNumIterations to 0. O
@@ -98,6 +98,18 @@ struct FailureCounter
         nLinkDistThreshRejections = 0;
     }
 
+    inline FailureCounter& operator+=(const FailureCounter& other) {
+        nNeighStateFailure += other.nNeighStateFailure;
+        nConstraintToolDirFailure += other.nConstraintToolDirFailure;
+        nConstraintToolPositionFailure += other.nConstraintToolPositionFailure;
+        nEnvCollisionFailure += other.nEnvCollisionFailure;
+        nSelfCollisionFailure += other.nSelfCollisionFailure;
+        nSameSamples += other.nSameSamples;
+        nCacheHitSamples += other.nCacheHitSamples;
+        nLinkDistThreshRejections += other.nLinkDistThreshRejections;
+        return *this;
+    }
+
     void SaveToJson(rapidjson::Value& rFailureCounter, rapidjson::Document::AllocatorType& alloc) const
     {
         rFailureCounter.SetObject();
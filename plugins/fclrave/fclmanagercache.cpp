@@ -565,6 +565,9 @@ void FCLCollisionManagerInstance::Synchronize() {
                 for (uint64_t ilink = 0; ilink < kinBodyInfo.vlinks.size(); ++ilink) {
                     if (OpenRAVE::IsLinkStateBitEnabled(cache.linkEnableStatesBitmasks, ilink)) {
                         CollisionObjectPtr pcolobj = _fclspace.GetLinkBV(*pinfo, ilink);
+                        if (!!pcolobj && pcolobj == cache.vcolobjs.at(ilink)) {
+                            continue; // geometry of this link did not change, so the manager already has its object
+                        }
                         if (!!pcolobj) {
                             // RAVELOG_VERBOSE_FORMAT("env=%d, %x (self=%d), body %s adding obj %x from link %d",
                             // body.GetEnv()->GetId()%this%_fclspace.IsSelfCollisionChecker()%body.GetName()%pColObjRaw%ilink);
@@ -78,10 +78,29 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
     }
     pinfo->nLastLinkReloadStamp = pbody->GetUpdateStamp();
 
-    pinfo->vlinks.clear();
+    // links whose current geometries did not change since the last reload keep their collision objects, so that only the changed links are rebuilt
+    std::vector< boost::shared_ptr<FCLKinBodyInfo::LinkInfo> > vOldLinks;
+    vOldLinks.swap(pinfo->vlinks);
     pinfo->vlinks.reserve(pbody->GetLinks().size());
     FOREACHC(itlink, pbody->GetLinks()) {
         const KinBody::LinkPtr& plink = *itlink;
+        const size_t linkIndex = itlink - pbody->GetLinks().begin();
+        if( linkIndex < vOldLinks.size() && !!vOldLinks[linkIndex] && vOldLinks[linkIndex]->GetLink() == plink && vOldLinks[linkIndex]->nGeometryUpdateStamp == plink->GetGeometryUpdateStamp() ) {
+            if( pinfo->_geometrygroup.size() == 0 || plink->GetGroupNumGeometries(pinfo->_geometrygroup) < 0 ) {
+                boost::shared_ptr<FCLKinBodyInfo::LinkInfo>& oldlinkinfo = vOldLinks[linkIndex];
+                oldlinkinfo->bodylinkname = pbody->GetName() + "/" + plink->GetName();
+                FOREACH(itgeominfo, oldlinkinfo->vgeominfos) {
+                    KinBody::GeometryPtr pgeom = (*itgeominfo)->GetGeometry();
+                    if( !!pgeom ) {
+                        (*itgeominfo)->bodylinkgeomname = oldlinkinfo->bodylinkname + "/" + pgeom->GetName();
+                    }
+                }
+                pinfo->vlinks.push_back(oldlinkinfo);
+                oldlinkinfo.reset(); // do not reset the collision objects when vOldLinks is destroyed
+                continue;
+            }
+        }
+
         boost::shared_ptr<FCLKinBodyInfo::LinkInfo> linkinfo(new FCLKinBodyInfo::LinkInfo(plink));
 
         fcl::AABB enclosingBV;
@@ -123,6 +142,7 @@ void FCLSpace::ReloadKinBodyLinks(KinBodyConstPtr pbody, FCLKinBodyInfoPtr pinfo
             }
         }
         else {
+            linkinfo->nGeometryUpdateStamp = plink->GetGeometryUpdateStamp();
             const std::vector<KinBody::Link::GeometryPtr> & vgeometries = plink->GetGeometries();
             FOREACH(itgeom, vgeometries) {
                 const KinBody::GeometryPtr& pgeom = *itgeom;
@@ -551,11 +571,12 @@ CollisionGeometryPtr FCLSpace::_CreateFCLGeomFromGeometryInfo(const KinBody::Geo
     case OpenRAVE::GT_Prism:
     {
         std::vector<std::shared_ptr<fcl::CollisionObject> > contents;
-        const OpenRAVE::TriMesh& mesh = info._meshcollision;
-        const size_t nPoints = mesh.vertices.size();
+        const OpenRAVE::CompactTriMesh& mesh = info._meshcollision;
+        const size_t nPoints = mesh.GetNumVertices();
         for( size_t ipoint = 0; ipoint < nPoints; ipoint += 2 ) {
-            const OpenRAVE::Vector p0(mesh.vertices[ipoint].x, mesh.vertices[ipoint].y, 0);
-            const OpenRAVE::Vector p1(mesh.vertices[(ipoint + 2) % nPoints].x, mesh.vertices[(ipoint + 2) % nPoints].y, 0);
+            const OpenRAVE::Vector v0 = mesh.GetVertex(ipoint), v1 = mesh.GetVertex((ipoint + 2) % nPoints);
+            const OpenRAVE::Vector p0(v0.x, v0.y, 0);
+            const OpenRAVE::Vector p1(v1.x, v1.y, 0);
             if( (p1 - p0).lengthsqr2() < g_fEpsilon ) {
                 continue; // ipoint
             }
@@ -571,24 +592,24 @@ CollisionGeometryPtr FCLSpace::_CreateFCLGeomFromGeometryInfo(const KinBody::Geo
     case OpenRAVE::GT_Axial:
     case OpenRAVE::GT_TriMesh:
     {
-        const OpenRAVE::TriMesh& mesh = info._meshcollision;
-        if (mesh.vertices.empty() || mesh.indices.empty()) {
+        const OpenRAVE::CompactTriMesh& mesh = info._meshcollision;
+        if (mesh.GetNumVertices() == 0 || mesh.GetIndices().empty()) {
             return CollisionGeometryPtr();
         }
 
-        OPENRAVE_ASSERT_OP(mesh.indices.size() % 3, ==, 0);
-        size_t const num_points = mesh.vertices.size();
-        size_t const num_triangles = mesh.indices.size() / 3;
+        OPENRAVE_ASSERT_OP(mesh.GetIndices().size() % 3, ==, 0);
+        size_t const num_points = mesh.GetNumVertices();
+        size_t const num_triangles = mesh.GetNumTriangles();
 
         std::vector<fcl::Vec3f> fcl_points(num_points);
         for (size_t ipoint = 0; ipoint < num_points; ++ipoint) {
-            Vector v = mesh.vertices[ipoint];
+            Vector v = mesh.GetVertex(ipoint);
             fcl_points[ipoint] = fcl::Vec3f(v.x, v.y, v.z);
         }
 
         std::vector<fcl::Triangle> fcl_triangles(num_triangles);
         for (size_t itri = 0; itri < num_triangles; ++itri) {
-            int const *const tri_indices = &mesh.indices[3 * itri];
+            int const *const tri_indices = &mesh.GetIndices()[3 * itri];
             fcl_triangles[itri] = fcl::Triangle(tri_indices[0], tri_indices[1], tri_indices[2]);
         }
 
@@ -137,6 +137,7 @@ public:
             std::vector<TransformCollisionPair> vgeoms; ///< vector of transformations and collision object; one per geometries
             std::string bodylinkname; // for debugging purposes
             bool bFromKinBodyLink; ///< if true, then from kinbodylink. Otherwise from standalone object that does not have any KinBody associations
+            int nGeometryUpdateStamp = -1; ///< KinBody::Link::GetGeometryUpdateStamp() of the current geometries the collision objects were created from, -1 if created from a geometry group
         };
 
         FCLKinBodyInfo() {}
@@ -1210,8 +1210,9 @@ protected:
                     Transform t = (*itjoint)->GetHierarchyChildLink()->GetTransform();
                     t.trans -= (*itjoint)->GetAnchor();
                     vworldvertices.resize(0);
-                    FOREACHC(itvertex, (*itjoint)->GetHierarchyChildLink()->GetCollisionData().vertices) {
-                        vworldvertices.push_back(t * *itvertex);
+                    const CompactTriMesh& childmesh = (*itjoint)->GetHierarchyChildLink()->GetCompactCollisionData();
+                    for(size_t ivertex = 0; ivertex < childmesh.GetNumVertices(); ++ivertex) {
+                        vworldvertices.push_back(t * childmesh.GetVertex(ivertex));
                     }
                     FOREACHC(itchildjoint, _robot->GetJoints()) {
                         if( *itchildjoint != *itjoint ) {
@@ -339,6 +339,10 @@ public:
                         "Times the ik call of a given library.\n"
                         "Usage::\n\n  PerfTiming [options] iklibrarypath\n\n"
                         "return the set of time measurements made in nano-seconds");
+        RegisterCommand("PerfTimingBatch",boost::bind(&IkFastModule::PerfTimingBatch,this,_1,_2),
+                        "Times solving all ik solutions of many random poses of the active manipulator of a robot, once with the SolveAllBatch command of its ik solver and once with sequential SolveAll calls.\n"
+                        "Usage::\n\n  PerfTimingBatch [num N] [numthreads N] [filteroptions N] [iktype name] robot robotname\n\n"
+                        "return the poses per second of the batch and sequential calls, followed by the number of poses solved by each");
         RegisterCommand("IKTest",boost::bind(&IkFastModule::IKtest,this,_1,_2),
                         "Tests for an IK solution if active manipulation has an IK solver attached");
         RegisterCommand("DebugIK",boost::bind(&IkFastModule::DebugIK,this,_1,_2),
@@ -808,6 +812,130 @@ public:
         return true;
     }
 
+    bool PerfTimingBatch(ostream& sout, istream& sinput)
+    {
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        string cmd;
+        int num = 1000, numthreads = 0, filteroptions = 0;
+        IkParameterizationType iktype = IKP_Transform6D;
+        RobotBasePtr robot;
+        while(!sinput.eof()) {
+            sinput >> cmd;
+            if( !sinput ) {
+                break;
+            }
+            std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+
+            if( cmd == "num" ) {
+                sinput >> num;
+            }
+            else if( cmd == "numthreads" ) {
+                sinput >> numthreads;
+            }
+            else if( cmd == "filteroptions" ) {
+                sinput >> filteroptions;
+            }
+            else if( cmd == "iktype" ) {
+                string iktypename;
+                sinput >> iktypename;
+                std::transform(iktypename.begin(), iktypename.end(), iktypename.begin(), ::tolower);
+                iktype = IKP_None;
+                FOREACHC(it, RaveGetIkParameterizationMap(1)) {
+                    if( it->second == iktypename ) {
+                        iktype = it->first;
+                        break;
+                    }
+                }
+                if( iktype == IKP_None ) {
+                    RAVELOG_WARN_FORMAT("unknown iktype %s", iktypename);
+                    return false;
+                }
+            }
+            else if( cmd == "robot" ) {
+                string name;
+                sinput >> name;
+                robot = GetEnv()->GetRobot(name);
+            }
+            else {
+                RAVELOG_WARN(str(boost::format("unrecognized command: %s\n")%cmd));
+                break;
+            }
+
+            if( !sinput ) {
+                RAVELOG_ERROR(str(boost::format("failed processing command %s\n")%cmd));
+                return false;
+            }
+        }
+
+        if( !robot || num <= 0 ) {
+            return false;
+        }
+        RobotBase::ManipulatorPtr pmanip = robot->GetActiveManipulator();
+        if( !pmanip || !pmanip->GetIkSolver() ) {
+            RAVELOG_WARN_FORMAT("robot %s does not have an active manipulator with an ik solver", robot->GetName());
+            return false;
+        }
+        IkSolverBasePtr iksolver = pmanip->GetIkSolver();
+
+        // sample random poses that are reachable, in the manipulator base frame
+        std::vector<IkParameterization> vikparams(num);
+        {
+            RobotBase::RobotStateSaver saver(robot);
+            robot->SetActiveDOFs(pmanip->GetArmIndices());
+            std::vector<dReal> vlower, vupper, vvalues(pmanip->GetArmDOF());
+            robot->GetActiveDOFLimits(vlower, vupper);
+            FOREACH(itikparam, vikparams) {
+                for(size_t idof = 0; idof < vvalues.size(); ++idof) {
+                    vvalues[idof] = vlower[idof] + RaveRandomDouble()*(vupper[idof]-vlower[idof]);
+                }
+                robot->SetActiveDOFValues(vvalues, KinBody::CLA_Nothing);
+                *itikparam = pmanip->GetIkParameterization(iktype, false);
+            }
+        }
+
+        stringstream sbatchinput, sbatchoutput;
+        sbatchinput << std::setprecision(std::numeric_limits<dReal>::digits10+1);
+        sbatchinput << "SolveAllBatch " << filteroptions << " " << numthreads << " " << vikparams.size();
+        FOREACHC(itikparam, vikparams) {
+            sbatchinput << " " << *itikparam;
+        }
+
+        uint64_t starttime = utils::GetNanoPerformanceTime();
+        if( !iksolver->SendCommand(sbatchoutput, sbatchinput) ) {
+            RAVELOG_WARN_FORMAT("ik solver %s does not support SolveAllBatch", iksolver->GetXMLId());
+            return false;
+        }
+        uint64_t batchtime = utils::GetNanoPerformanceTime()-starttime;
+        std::set<int> setbatchsolvedposes;
+        size_t numsolutions = 0, armdof = 0;
+        sbatchoutput >> numsolutions >> armdof;
+        for(size_t isolution = 0; isolution < numsolutions; ++isolution) {
+            int poseindex = -1;
+            dReal f;
+            sbatchoutput >> poseindex;
+            setbatchsolvedposes.insert(poseindex);
+            for(size_t idof = 0; idof < armdof; ++idof) {
+                sbatchoutput >> f;
+            }
+        }
+
+        int numsequentialsolved = 0;
+        std::vector< std::vector<dReal> > vsolutions;
+        starttime = utils::GetNanoPerformanceTime();
+        FOREACHC(itikparam, vikparams) {
+            if( iksolver->SolveAll(*itikparam, filteroptions, vsolutions) ) {
+                ++numsequentialsolved;
+            }
+        }
+        uint64_t sequentialtime = utils::GetNanoPerformanceTime()-starttime;
+
+        dReal fbatchposespersec = vikparams.size()/(1e-9*std::max(batchtime, (uint64_t)1));
+        dReal fsequentialposespersec = vikparams.size()/(1e-9*std::max(sequentialtime, (uint64_t)1));
+        RAVELOG_INFO_FORMAT("env=%d, %d poses of %s:%s, batch %f poses/s (%d solved), sequential %f poses/s (%d solved)", GetEnv()->GetId()%vikparams.size()%robot->GetName()%pmanip->GetName()%fbatchposespersec%setbatchsolvedposes.size()%fsequentialposespersec%numsequentialsolved);
+        sout << fbatchposespersec << " " << fsequentialposespersec << " " << setbatchsolvedposes.size() << " " << numsequentialsolved;
+        return true;
+    }
+
     bool IKtest(ostream& sout, istream& sinput)
     {
         EnvironmentLock lock(GetEnv()->GetMutex());
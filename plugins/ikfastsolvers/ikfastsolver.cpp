@@ -22,10 +22,16 @@
 #include <boost/tuple/tuple.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #ifdef OPENRAVE_HAS_LAPACK
 #include "jacobianinverse.h"
 #endif
 
+#include "iksolutioncache.h"
+
 using namespace boost::placeholders;
 
 template <typename IkReal>
@@ -86,8 +92,21 @@ public:
         RegisterCommand("SetBackTraceSelfCollisionLinks",boost::bind(&IkFastSolver<IkReal>::_SetBackTraceSelfCollisionLinksCommand,this,_1,_2),
                         "format: int int\n\n\
 for numBacktraceLinksForSelfCollisionWithNonMoving numBacktraceLinksForSelfCollisionWithFree, when pruning self collisions, the number of links to look at. If the tip of the manip self collides with the base, then can safely quit the IK.");
+        RegisterCommand("SolveAllBatch",boost::bind(&IkFastSolver<IkReal>::_SolveAllBatchCommand,this,_1,_2),
+                        "format: filteroptions numthreads numposes ikparam0 ikparam1 ...\n\n\
+Solves all the ik solutions for many poses at once, computing the analytic solutions in parallel with numthreads (<= 0 uses all hardware threads). Returns a compact solution table: numsolutions armdof, then for every solution the pose index followed by armdof values.");
+        RegisterCommand("SetSolutionCache",boost::bind(&IkFastSolver<IkReal>::_SetSolutionCacheCommand,this,_1,_2),
+                        "format: cellsize maxentries [nearbydist]\n\n\
+Caches the kinematically valid solutions of solved poses so that solving an identical pose again only re-checks collisions. Poses are indexed on a grid of cellsize meters, and at most maxentries poses are kept. If nearbydist > 0, Solve seeds the jacobian refinement with the cached solutions of the closest pose within nearbydist (requires lapack and Transform6D). The cache is bypassed when custom filters are registered. cellsize <= 0 disables the cache.");
+        RegisterCommand("GetSolutionCacheStatistics",boost::bind(&IkFastSolver<IkReal>::_GetSolutionCacheStatisticsCommand,this,_1,_2),
+                        "returns numqueries numhits numnearbyhits nummisses numentries timesaved, where timesaved is the estimated time in seconds saved by the cache hits.");
+        RegisterCommand("ClearSolutionCache",boost::bind(&IkFastSolver<IkReal>::_ClearSolutionCacheCommand,this,_1,_2),
+                        "clears all the cached solutions and statistics.");
         _numBacktraceLinksForSelfCollisionWithNonMoving = 2;
         _numBacktraceLinksForSelfCollisionWithFree = 0;
+        _fSolutionCacheNearbyDist = 0;
+        _bSolvingKinematicsForCache = false;
+        _ResetSolutionCacheStatistics();
     }
     virtual ~IkFastSolver() {
     }
@@ -214,6 +233,78 @@ for numBacktraceLinksForSelfCollisionWithNonMoving numBacktraceLinksForSelfColli
         return true;
     }
 
+    bool _SolveAllBatchCommand(ostream& sout, istream& sinput)
+    {
+        int filteroptions = 0, numthreads = 0, numposes = 0;
+        sinput >> filteroptions >> numthreads >> numposes;
+        if( !sinput || numposes < 0 ) {
+            return false;
+        }
+        std::vector<IkParameterization> vparams(numposes);
+        FOREACH(itparam, vparams) {
+            sinput >> *itparam;
+        }
+        if( !sinput ) {
+            return false;
+        }
+        std::vector<int> vposeindices;
+        std::vector<dReal> vsolutions;
+        SolveAllBatch(vparams, filteroptions, numthreads, vposeindices, vsolutions);
+        size_t armdof = vposeindices.size() > 0 ? vsolutions.size()/vposeindices.size() : _pmanip.lock()->GetArmDOF();
+        sout << std::setprecision(std::numeric_limits<dReal>::digits10+1);
+        sout << vposeindices.size() << " " << armdof;
+        for(size_t isolution = 0; isolution < vposeindices.size(); ++isolution) {
+            sout << " " << vposeindices[isolution];
+            for(size_t idof = 0; idof < armdof; ++idof) {
+                sout << " " << vsolutions[isolution*armdof+idof];
+            }
+        }
+        return true;
+    }
+
+    bool _SetSolutionCacheCommand(ostream& sout, istream& sinput)
+    {
+        dReal fCellSize = 0, fNearbyDist = 0;
+        size_t maxentries = 0;
+        sinput >> fCellSize;
+        if( !sinput ) {
+            return false;
+        }
+        if( fCellSize <= 0 ) {
+            _pSolutionCache.reset();
+            _fSolutionCacheNearbyDist = 0;
+            _ResetSolutionCacheStatistics();
+            return true;
+        }
+        sinput >> maxentries;
+        if( !sinput ) {
+            return false;
+        }
+        sinput >> fNearbyDist;
+        if( !sinput ) {
+            fNearbyDist = 0; // optional
+        }
+        _pSolutionCache.reset(new ikfastsolvers::IkSolutionCache(fCellSize, maxentries));
+        _fSolutionCacheNearbyDist = fNearbyDist;
+        _ResetSolutionCacheStatistics();
+        return true;
+    }
+
+    bool _GetSolutionCacheStatisticsCommand(ostream& sout, istream& sinput)
+    {
+        sout << _nSolutionCacheQueries << " " << _nSolutionCacheHits << " " << _nSolutionCacheNearbyHits << " " << _nSolutionCacheMisses << " " << (!!_pSolutionCache ? _pSolutionCache->GetNumEntries() : 0) << " " << (_nSolutionCacheSavedNs*1e-9);
+        return true;
+    }
+
+    bool _ClearSolutionCacheCommand(ostream& sout, istream& sinput)
+    {
+        if( !!_pSolutionCache ) {
+            _pSolutionCache->Clear();
+        }
+        _ResetSolutionCacheStatistics();
+        return true;
+    }
+
     virtual IkReturnAction CallFilters(const IkParameterization& param, IkReturnPtr ikreturn, int minpriority, int maxpriority) {
         // have to convert to the manipulator's base coordinate system
         RobotBase::ManipulatorPtr pmanip = _pmanip.lock();
@@ -240,6 +331,10 @@ for numBacktraceLinksForSelfCollisionWithNonMoving numBacktraceLinksForSelfColli
 
     virtual void SetJointLimits()
     {
+        if( !!_pSolutionCache ) {
+            // cached solutions were validated against the previous limits
+            _pSolutionCache->Clear();
+        }
         RobotBase::ManipulatorPtr pmanip = _pmanip.lock();
         if( !pmanip ) {
             RAVELOG_WARN_FORMAT("env=%d iksolver points to removed manip '%s'", GetEnv()->GetId()%_manipname);
@@ -308,6 +403,9 @@ for numBacktraceLinksForSelfCollisionWithNonMoving numBacktraceLinksForSelfColli
             throw OPENRAVE_EXCEPTION_FORMAT(_("manipulator '%s' not found in robot '%s' (%d) with manips [%s]"), pmanip->GetName()%probot->GetName()%probot->GetEnvironmentBodyIndex()%smanipnames.str(), ORE_InvalidArguments);
         }
 
+        _pSolveStatistics = GetEnv()->GetStatisticsRegistry().GetCounter(GetXMLId(), "Solve");
+        _pSolveAllStatistics = GetEnv()->GetStatisticsRegistry().GetCounter(GetXMLId(), "SolveAll");
+
         _cblimits = probot->RegisterChangeCallback(KinBody::Prop_JointLimits,boost::bind(&IkFastSolver<IkReal>::SetJointLimits,boost::bind(&utils::sptr_from<IkFastSolver<IkReal> >, weak_solver())));
 
         if( _nTotalDOF != (int)pmanip->GetArmIndices().size() ) {
@@ -696,6 +794,15 @@ protected:
 
     virtual bool Solve(const IkParameterization& rawparam, const std::vector<dReal>& q0, int filteroptions, IkReturnPtr ikreturn)
     {
+        StatisticsTimer timer(_pSolveStatistics);
+        uint64_t cachestarttime = 0;
+        if( _CanUseSolutionCache(filteroptions) ) {
+            cachestarttime = utils::GetNanoPerformanceTime();
+            int cacheret = _SolveFromSolutionCache(rawparam, q0, std::vector<dReal>(), filteroptions, ikreturn, cachestarttime);
+            if( cacheret >= 0 ) {
+                return cacheret > 0;
+            }
+        }
         IkParameterization ikparamdummy;
         const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
         if( !!ikreturn ) {
@@ -712,11 +819,18 @@ protected:
         if( !!ikreturn ) {
             ikreturn->_action = retaction;
         }
+        if( cachestarttime > 0 ) {
+            _nSolutionCacheMissDurationNs += utils::GetNanoPerformanceTime() - cachestarttime;
+        }
         return retaction == IKRA_Success;
     }
 
     virtual bool SolveAll(const IkParameterization& rawparam, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
     {
+        StatisticsTimer timer(_pSolveAllStatistics);
+        if( _CanUseSolutionCache(filteroptions) ) {
+            return _SolveAllFromSolutionCache(rawparam, std::vector<dReal>(), filteroptions, vikreturns);
+        }
         vikreturns.resize(0);
         IkParameterization ikparamdummy;
         const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
@@ -737,11 +851,16 @@ protected:
 
     virtual bool Solve(const IkParameterization& rawparam, const std::vector<dReal>& q0, const std::vector<dReal>& vFreeParameters, int filteroptions, IkReturnPtr ikreturn)
     {
+        StatisticsTimer timer(_pSolveStatistics);
         IkParameterization ikparamdummy;
         const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
         if( vFreeParameters.size() != _vfreeparams.size() ) {
             throw openrave_exception(_("free parameters not equal"),ORE_InvalidArguments);
         }
+        if( _CanUseSolutionCache(filteroptions) ) {
+            // with fixed free parameters, solving all the solutions costs the same as solving one, so always go through the cache
+            return _SolveFromSolutionCache(param, q0, vFreeParameters, filteroptions, ikreturn, utils::GetNanoPerformanceTime()) > 0;
+        }
         if( !!ikreturn ) {
             ikreturn->Clear();
         }
@@ -764,12 +883,16 @@ protected:
 
     virtual bool SolveAll(const IkParameterization& rawparam, const std::vector<dReal>& vFreeParameters, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
     {
+        StatisticsTimer timer(_pSolveAllStatistics);
         vikreturns.resize(0);
         IkParameterization ikparamdummy;
         const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
         if( vFreeParameters.size() != _vfreeparams.size() ) {
             throw openrave_exception(_("free parameters not equal"),ORE_InvalidArguments);
         }
+        if( _CanUseSolutionCache(filteroptions) ) {
+            return _SolveAllFromSolutionCache(param, vFreeParameters, filteroptions, vikreturns);
+        }
         RobotBase::ManipulatorPtr pmanip(_pmanip);
         RobotBasePtr probot = pmanip->GetRobot();
         RobotBase::RobotStateSaver saver(probot);
@@ -788,6 +911,121 @@ protected:
         return vikreturns.size()>0;
     }
 
+    /** \brief solves all ik solutions for many poses at once and stores them into a compact solution table.
+
+        The generated ikfast functions are pure, so the analytic solutions for every (pose, free joint value) pair are computed in parallel by numthreads workers. The robot state, active dofs, collision options and free joint discretization are set up once, and the joint limit, filter and collision validation is run serially in the calling thread with the same semantics as \ref SolveAll.
+
+        \param vrawparams the poses to solve for
+        \param numthreads number of threads to compute the analytic solutions with. If <= 0, uses the number of hardware threads.
+        \param[out] vposeindices for every solution, the index into vrawparams that it solves
+        \param[out] vsolutions flat array of all the solutions, each solution is GetManipulator()->GetArmDOF() values.
+        \return number of poses that had at least one solution
+     */
+    int SolveAllBatch(const std::vector<IkParameterization>& vrawparams, int filteroptions, int numthreads, std::vector<int>& vposeindices, std::vector<dReal>& vsolutions)
+    {
+        vposeindices.resize(0);
+        vsolutions.resize(0);
+        if( vrawparams.size() == 0 ) {
+            return 0;
+        }
+
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+        std::vector<IkParameterization> vparams(vrawparams.size());
+        for(size_t iparam = 0; iparam < vrawparams.size(); ++iparam) {
+            IkParameterization ikparamdummy;
+            vparams[iparam] = _ConvertIkParameterization(vrawparams[iparam], ikparamdummy);
+            if( !Supports(vparams[iparam].GetType()) ) {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("ik solver %s does not support iktype 0x%x for pose %d"), GetXMLId()%vparams[iparam].GetType()%iparam, ORE_InvalidArguments);
+            }
+        }
+
+        RobotBase::RobotStateSaver saver(probot);
+        probot->SetActiveDOFs(pmanip->GetArmIndices());
+
+        // enumerate the free joint values in the same order as SolveAll would visit them
+        std::vector< std::vector<IkReal> > vvfree;
+        std::vector<IkReal> vfree(_vfreeparams.size());
+        ComposeSolution(_vfreeparams, vfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_RecordFreeValues, this, boost::cref(vfree), boost::ref(vvfree)), _vFreeInc);
+
+        Transform tIkChainEndlinkToEE;
+        if (!!pmanip->GetIkChainEndLink()) {
+            tIkChainEndlinkToEE = pmanip->GetIkChainEndLink()->GetTransform().inverse() * pmanip->GetEndEffector()->GetTransform();
+        }
+        const Transform tLocalTool = tIkChainEndlinkToEE * pmanip->GetLocalToolTransform();
+
+        // compute all the analytic solutions in parallel
+        std::vector< ikfast::IkSolutionList<IkReal> > vikfastsolutions(vparams.size()*vvfree.size());
+        std::vector<uint8_t> vikfastsuccess(vikfastsolutions.size(), 0);
+        if( numthreads <= 0 ) {
+            numthreads = std::max(1, (int)std::thread::hardware_concurrency());
+        }
+        numthreads = std::min(numthreads, (int)vikfastsolutions.size());
+        std::atomic<size_t> nextjobindex(0);
+        std::string workererror;
+        std::mutex mutexworkererror;
+        if( numthreads <= 1 ) {
+            _ComputeIkBatchWorker(vparams, vvfree, tLocalTool, vikfastsolutions, vikfastsuccess, nextjobindex, workererror, mutexworkererror);
+        }
+        else {
+            std::vector<boost::shared_ptr<std::thread> > vthreads(numthreads);
+            for(int ithread = 0; ithread < numthreads; ++ithread) {
+                vthreads[ithread] = boost::make_shared<std::thread>(std::bind(&IkFastSolver<IkReal>::_ComputeIkBatchWorker, this, std::cref(vparams), std::cref(vvfree), std::cref(tLocalTool), std::ref(vikfastsolutions), std::ref(vikfastsuccess), std::ref(nextjobindex), std::ref(workererror), std::ref(mutexworkererror)));
+            }
+            FOREACH(itthread, vthreads) {
+                (*itthread)->join();
+            }
+        }
+        if( !workererror.empty() ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("ik solver %s failed batch ik: %s"), GetXMLId()%workererror, ORE_Failed);
+        }
+
+        // validate serially since filters and collision checking use the environment
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        const size_t armdof = pmanip->GetArmIndices().size();
+        std::vector<IkReturnPtr> vikreturns;
+        std::vector<IkReal> sol(armdof), vsolfree;
+        int numsolvedposes = 0;
+        for(size_t iparam = 0; iparam < vparams.size(); ++iparam) {
+            const IkParameterization& param = vparams[iparam];
+            vikreturns.resize(0);
+            StateCheckEndEffector stateCheck(probot,_vchildlinks,_vindependentlinks,filteroptions);
+            int retaction = IKRA_Reject;
+            for(size_t ifree = 0; ifree < vvfree.size() && !(retaction & IKRA_Quit); ++ifree) {
+                size_t jobindex = iparam*vvfree.size()+ifree;
+                if( !vikfastsuccess[jobindex] ) {
+                    continue;
+                }
+                const ikfast::IkSolutionList<IkReal>& solutions = vikfastsolutions[jobindex];
+                for(size_t isolution = 0; isolution < solutions.GetNumSolutions(); ++isolution) {
+                    const ikfast::IkSolution<IkReal>& iksol = dynamic_cast<const ikfast::IkSolution<IkReal>& >(solutions.GetSolution(isolution));
+                    iksol.Validate();
+                    if( iksol.GetFree().size() > 0 ) {
+                        vsolfree.resize(iksol.GetFree().size());
+                        std::vector<dReal> vFreeInc(_GetFreeIncFromIndices(iksol.GetFree()));
+                        retaction = ComposeSolution(iksol.GetFree(), vsolfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_ValidateSolutionAll,shared_solver(), boost::ref(param), boost::ref(iksol), boost::ref(vsolfree), filteroptions, boost::ref(sol), boost::ref(vikreturns), boost::ref(stateCheck)), vFreeInc);
+                    }
+                    else {
+                        retaction = _ValidateSolutionAll(param, iksol, vector<IkReal>(), filteroptions, sol, vikreturns, stateCheck);
+                    }
+                    if( retaction & IKRA_Quit ) {
+                        break;
+                    }
+                }
+            }
+            if( (retaction & IKRA_Quit) || vikreturns.size() == 0 ) {
+                continue;
+            }
+            _SortSolutions(probot, vikreturns);
+            ++numsolvedposes;
+            FOREACHC(itikreturn, vikreturns) {
+                vposeindices.push_back(iparam);
+                vsolutions.insert(vsolutions.end(), (*itikreturn)->_vsolution.begin(), (*itikreturn)->_vsolution.end());
+            }
+        }
+        return numsolvedposes;
+    }
+
     virtual int GetNumFreeParameters() const
     {
         return (int)_vfreeparams.size();
@@ -875,9 +1113,240 @@ protected:
 #endif
 
         _bEmptyTransform6D = r->_bEmptyTransform6D;
+
+        // only the cache settings are cloned since the cached solutions depend on the robot of the reference environment
+        if( !!r->_pSolutionCache ) {
+            _pSolutionCache.reset(new ikfastsolvers::IkSolutionCache(r->_pSolutionCache->GetCellSize(), r->_pSolutionCache->GetMaxEntries()));
+        }
+        else {
+            _pSolutionCache.reset();
+        }
+        _fSolutionCacheNearbyDist = r->_fSolutionCacheNearbyDist;
+        _ResetSolutionCacheStatistics();
     }
 
 protected:
+    /// \brief returns true if the solution cache can answer a query with filteroptions. Custom filters can depend on anything, so their results are never cached.
+    inline bool _CanUseSolutionCache(int filteroptions) const
+    {
+        return !!_pSolutionCache && !_bSolvingKinematicsForCache && ((filteroptions & IKFO_IgnoreCustomFilters) || !_HasFilterInRange(IKSP_MinPriority, IKSP_MaxPriority));
+    }
+
+    void _ResetSolutionCacheStatistics()
+    {
+        _nSolutionCacheQueries = 0;
+        _nSolutionCacheHits = 0;
+        _nSolutionCacheNearbyHits = 0;
+        _nSolutionCacheMisses = 0;
+        _nSolutionCacheMissDurationNs = 0;
+        _nSolutionCacheSavedNs = 0;
+    }
+
+    /// \brief estimates the time saved by a cache hit that started at starttime by comparing with the average duration of the misses
+    void _AddSolutionCacheHitDuration(uint64_t starttime)
+    {
+        if( _nSolutionCacheMisses > 0 ) {
+            _nSolutionCacheSavedNs += (int64_t)(_nSolutionCacheMissDurationNs/_nSolutionCacheMisses) - (int64_t)(utils::GetNanoPerformanceTime() - starttime);
+        }
+    }
+
+    virtual void _CallFinishCallbacks(IkReturnPtr ikreturn, RobotBase::ManipulatorConstPtr pmanip, const IkParameterization& param)
+    {
+        if( !_bSolvingKinematicsForCache ) {
+            // the callbacks are called when the cached solutions are validated
+            IkSolverBase::_CallFinishCallbacks(ikreturn, pmanip, param);
+        }
+    }
+
+    /// \brief computes all the solutions of param that satisfy the ikfast and joint limit checks. Collisions and custom filters are not checked and finish callbacks are not called.
+    void _SolveKinematicsForSolutionCache(const IkParameterization& param, const std::vector<dReal>& vFreeParameters, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
+    {
+        const int kinematicfilteroptions = (filteroptions&IKFO_IgnoreJointLimits)|IKFO_IgnoreSelfCollisions|IKFO_IgnoreCustomFilters;
+        _bSolvingKinematicsForCache = true;
+        try {
+            if( vFreeParameters.size() > 0 ) {
+                SolveAll(param, vFreeParameters, kinematicfilteroptions, vikreturns);
+            }
+            else {
+                SolveAll(param, kinematicfilteroptions, vikreturns);
+            }
+        }
+        catch(...) {
+            _bSolvingKinematicsForCache = false;
+            throw;
+        }
+        _bSolvingKinematicsForCache = false;
+    }
+
+    /// \brief validates kinematically valid solutions of param like freshly computed ones with _ValidateKinematicSolutions, and appends the valid ones to vikreturns.
+    ///
+    /// \param q0 if it has the arm dof, the solutions are checked starting from the closest to q0
+    /// \param nMaxSolutions stop after this many valid solutions
+    /// \return IKRA_Success if at least one solution is valid, otherwise the accumulated reject actions
+    int _ValidateCachedSolutions(const IkParameterization& param, const std::vector<IkReturnPtr>& vcachedreturns, const std::vector<dReal>& q0, int filteroptions, size_t nMaxSolutions, std::vector<IkReturnPtr>& vikreturns)
+    {
+        if( vcachedreturns.size() == 0 ) {
+            return IKRA_RejectKinematics;
+        }
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+        RobotBase::RobotStateSaver saver(probot);
+        probot->SetActiveDOFs(pmanip->GetArmIndices());
+
+        std::vector< std::pair<dReal, size_t> > vorder(vcachedreturns.size());
+        for(size_t i = 0; i < vcachedreturns.size(); ++i) {
+            vorder[i].first = 0;
+            vorder[i].second = i;
+        }
+        if( q0.size() == pmanip->GetArmIndices().size() ) {
+            for(size_t i = 0; i < vcachedreturns.size(); ++i) {
+                vorder[i].first = _ComputeGeometricConfigDistSqr(probot, vcachedreturns[i]->_vsolution, q0, true);
+            }
+            std::stable_sort(vorder.begin(), vorder.end());
+        }
+
+        StateCheckEndEffector stateCheck(probot,_vchildlinks,_vindependentlinks,filteroptions);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        int retactionall = IKRA_Reject;
+        std::vector< std::pair<std::vector<dReal>, std::vector<unsigned int> > > vkinematicsols(1);
+        FOREACHC(itorder, vorder) {
+            const IkReturn& cachedreturn = *vcachedreturns[itorder->second];
+            vkinematicsols.resize(1);
+            vkinematicsols[0].first = cachedreturn._vsolution;
+            vkinematicsols[0].second.resize(0);
+            IkReturn::CustomData::const_iterator itindices = cachedreturn._mapdata.find("solutionindices");
+            if( itindices != cachedreturn._mapdata.end() ) {
+                FOREACHC(it, itindices->second) {
+                    vkinematicsols[0].second.push_back((unsigned int)(*it+0.5)); // round
+                }
+            }
+            const IkReturnAction retaction = _ValidateKinematicSolutions(param, vkinematicsols, filteroptions, vikreturns, stateCheck);
+            retactionall |= retaction;
+            if( (retaction & IKRA_Quit) || vikreturns.size() >= nMaxSolutions ) {
+                break;
+            }
+        }
+        return vikreturns.size() > 0 ? (int)IKRA_Success : retactionall;
+    }
+
+    /// \brief SolveAll through the solution cache. On a miss the kinematic solutions are computed and inserted, on a hit the cached solutions are validated with the same filters and collision checks as new ones.
+    bool _SolveAllFromSolutionCache(const IkParameterization& rawparam, const std::vector<dReal>& vFreeParameters, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
+    {
+        const uint64_t starttime = utils::GetNanoPerformanceTime();
+        vikreturns.resize(0);
+        IkParameterization ikparamdummy;
+        const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
+        const bool bIgnoreJointLimits = !!(filteroptions&IKFO_IgnoreJointLimits);
+        ++_nSolutionCacheQueries;
+        std::vector<IkReturnPtr> vcachedreturns;
+        const ikfastsolvers::IkSolutionCache::Entry* pentry = _pSolutionCache->FindIdentical(param, vFreeParameters, bIgnoreJointLimits);
+        if( !!pentry ) {
+            ++_nSolutionCacheHits;
+            vcachedreturns = pentry->vikreturns; // copy since finish callbacks can call back into the solver
+            _ValidateCachedSolutions(param, vcachedreturns, std::vector<dReal>(), filteroptions, vcachedreturns.size(), vikreturns);
+            _AddSolutionCacheHitDuration(starttime);
+            return vikreturns.size() > 0;
+        }
+
+        ++_nSolutionCacheMisses;
+        _SolveKinematicsForSolutionCache(param, vFreeParameters, filteroptions, vcachedreturns);
+        _pSolutionCache->Insert(param, vFreeParameters, bIgnoreJointLimits, vcachedreturns);
+        _ValidateCachedSolutions(param, vcachedreturns, std::vector<dReal>(), filteroptions, vcachedreturns.size(), vikreturns);
+        _nSolutionCacheMissDurationNs += utils::GetNanoPerformanceTime() - starttime;
+        return vikreturns.size() > 0;
+    }
+
+    /// \brief Solve through the solution cache.
+    ///
+    /// \return 1 if solved, 0 if failed, -1 if the query has to be solved without the cache. The last happens on misses when the free joints have to be searched, since searching from q0 is faster than enumerating all the free joint values.
+    int _SolveFromSolutionCache(const IkParameterization& rawparam, const std::vector<dReal>& q0, const std::vector<dReal>& vFreeParameters, int filteroptions, IkReturnPtr ikreturn, uint64_t starttime)
+    {
+        if( !!ikreturn ) {
+            ikreturn->Clear();
+        }
+        IkParameterization ikparamdummy;
+        const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
+        const bool bIgnoreJointLimits = !!(filteroptions&IKFO_IgnoreJointLimits);
+        ++_nSolutionCacheQueries;
+        std::vector<IkReturnPtr> vcachedreturns, vikreturns;
+        const ikfastsolvers::IkSolutionCache::Entry* pentry = _pSolutionCache->FindIdentical(param, vFreeParameters, bIgnoreJointLimits);
+        const bool bHit = !!pentry;
+        if( bHit ) {
+            ++_nSolutionCacheHits;
+            vcachedreturns = pentry->vikreturns;
+        }
+        else {
+#ifdef OPENRAVE_HAS_LAPACK
+            if( _fSolutionCacheNearbyDist > 0 && param.GetType() == IKP_Transform6D ) {
+                const ikfastsolvers::IkSolutionCache::Entry* pnearentry = _pSolutionCache->FindNearest(param, vFreeParameters, bIgnoreJointLimits, _fSolutionCacheNearbyDist*_fSolutionCacheNearbyDist);
+                if( !!pnearentry ) {
+                    std::vector<IkReturnPtr> vrefinedreturns;
+                    _RefineNearbySolutions(param, pnearentry->vikreturns, bIgnoreJointLimits, vrefinedreturns);
+                    if( _ValidateCachedSolutions(param, vrefinedreturns, q0, filteroptions, 1, vikreturns) == IKRA_Success ) {
+                        ++_nSolutionCacheNearbyHits;
+                        if( !!ikreturn ) {
+                            *ikreturn = *vikreturns.at(0);
+                        }
+                        _AddSolutionCacheHitDuration(starttime);
+                        return 1;
+                    }
+                }
+            }
+#endif
+            ++_nSolutionCacheMisses;
+            if( vFreeParameters.size() == 0 && _vfreeparams.size() > 0 ) {
+                return -1;
+            }
+            _SolveKinematicsForSolutionCache(param, vFreeParameters, filteroptions, vcachedreturns);
+            _pSolutionCache->Insert(param, vFreeParameters, bIgnoreJointLimits, vcachedreturns);
+        }
+
+        int retaction = _ValidateCachedSolutions(param, vcachedreturns, q0, filteroptions, 1, vikreturns);
+        if( !!ikreturn ) {
+            if( vikreturns.size() > 0 ) {
+                *ikreturn = *vikreturns[0];
+            }
+            ikreturn->_action = static_cast<IkReturnAction>(retaction);
+        }
+        if( bHit ) {
+            _AddSolutionCacheHitDuration(starttime);
+        }
+        else {
+            _nSolutionCacheMissDurationNs += utils::GetNanoPerformanceTime() - starttime;
+        }
+        return vikreturns.size() > 0 ? 1 : 0;
+    }
+
+#ifdef OPENRAVE_HAS_LAPACK
+    /// \brief moves the solutions of a nearby Transform6D pose to param with the jacobian inverse. Only the converged solutions within the joint limits are returned.
+    void _RefineNearbySolutions(const IkParameterization& param, const std::vector<IkReturnPtr>& vnearreturns, bool bIgnoreJointLimits, std::vector<IkReturnPtr>& vrefinedreturns)
+    {
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+        RobotBase::RobotStateSaver saver(probot);
+        probot->SetActiveDOFs(pmanip->GetArmIndices());
+        std::vector<dReal> vsolution;
+        FOREACHC(itnearreturn, vnearreturns) {
+            vsolution = (*itnearreturn)->_vsolution;
+            probot->SetActiveDOFValues(vsolution, false);
+            int ret = _jacobinvsolver.ComputeSolution(param.GetTransform6D(), *pmanip, vsolution, bIgnoreJointLimits);
+            if( ret != 1 && ret != -1 ) {
+                continue;
+            }
+            if( !bIgnoreJointLimits && !_CheckJointAngles(vsolution) ) {
+                continue;
+            }
+            probot->SetActiveDOFValues(vsolution, false);
+            if( param.ComputeDistanceSqr(pmanip->GetIkParameterization(param, false)) > _ikthreshold ) {
+                continue;
+            }
+            IkReturnPtr refinedreturn(new IkReturn(IKRA_Success));
+            refinedreturn->_vsolution.swap(vsolution);
+            vrefinedreturns.push_back(refinedreturn);
+        }
+    }
+#endif
+
     IkReturnAction ComposeSolution(const std::vector<int>& vfreeparams, vector<IkReal>& vfree, int freeindex, const vector<dReal>& q0, const boost::function<IkReturnAction()>& fn, const std::vector<dReal>& vFreeInc)
     {
         if( freeindex >= (int)vfreeparams.size()) {
@@ -966,6 +1435,31 @@ protected:
         return static_cast<IkReturnAction>(allres);
     }
 
+    IkReturnAction _RecordFreeValues(const std::vector<IkReal>& vfree, std::vector< std::vector<IkReal> >& vvfree)
+    {
+        vvfree.push_back(vfree);
+        return IKRA_Reject; // continue enumerating
+    }
+
+    /// \brief worker for SolveAllBatch, pulls (pose, free values) jobs until none are left. Only calls into the ikfast generated functions, so does not touch the environment.
+    void _ComputeIkBatchWorker(const std::vector<IkParameterization>& vparams, const std::vector< std::vector<IkReal> >& vvfree, const Transform& tLocalTool, std::vector< ikfast::IkSolutionList<IkReal> >& vikfastsolutions, std::vector<uint8_t>& vikfastsuccess, std::atomic<size_t>& nextjobindex, std::string& workererror, std::mutex& mutexworkererror)
+    {
+        try {
+            while(1) {
+                size_t jobindex = nextjobindex.fetch_add(1);
+                if( jobindex >= vikfastsolutions.size() ) {
+                    break;
+                }
+                vikfastsuccess[jobindex] = _CallIk(vparams[jobindex/vvfree.size()], vvfree[jobindex%vvfree.size()], tLocalTool, vikfastsolutions[jobindex]);
+            }
+        }
+        catch(const std::exception& ex) {
+            std::lock_guard<std::mutex> lock(mutexworkererror);
+            workererror = ex.what();
+            nextjobindex = vikfastsolutions.size(); // stop the other workers
+        }
+    }
+
     /// \param tLocalTool _pmanip->GetLocalToolTransform()
     inline bool _CallIk(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionList<IkReal>& solutions)
     {
@@ -1940,11 +2434,7 @@ protected:
         std::vector<dReal> vravesol(sol.size());
         std::copy(sol.begin(),sol.end(),vravesol.begin());
 
-        int nSameStateRepeatCount = 0;
-        _nSameStateRepeatCount = 0;
         std::vector< pair<std::vector<dReal>,int> > vravesols;
-        list< std::pair<IkReturnPtr, IkParameterization> > listlocalikreturns; // orderd with respect to vravesols
-
         // find the first valid solutino that satisfies joint constraints and collisions
         if( !(filteroptions&IKFO_IgnoreJointLimits) ) {
             _ComputeAllSimilarJointAngles(vravesols, vravesol);
@@ -1958,6 +2448,26 @@ protected:
 
         std::vector<unsigned int> vsolutionindices;
         iksol.GetSolutionIndices(vsolutionindices);
+        std::vector< std::pair<std::vector<dReal>, std::vector<unsigned int> > > vkinematicsols(vravesols.size());
+        for(size_t isol = 0; isol < vravesols.size(); ++isol) {
+            vkinematicsols[isol].first.swap(vravesols[isol].first);
+            vkinematicsols[isol].second = vsolutionindices;
+            FOREACH(it,vkinematicsols[isol].second) {
+                *it += vravesols[isol].second<<16;
+            }
+        }
+        return _ValidateKinematicSolutions(param, vkinematicsols, filteroptions, vikreturns, stateCheck);
+    }
+
+    /// \brief checks the custom filters and collisions of kinematic solutions of param that only differ in their revolute joint angles, and appends the valid ones to vikreturns.
+    ///
+    /// Used for the solutions that ikfast just computed as well as for the ones of the solution cache, so both are validated the same way.
+    /// \param vkinematicsols the joint values and ikfast solution indices of every solution. The joint values are moved into the returned solutions.
+    IkReturnAction _ValidateKinematicSolutions(const IkParameterization& param, std::vector< std::pair<std::vector<dReal>, std::vector<unsigned int> > >& vkinematicsols, int filteroptions, std::vector<IkReturnPtr>& vikreturns, StateCheckEndEffector& stateCheck)
+    {
+        int nSameStateRepeatCount = 0;
+        _nSameStateRepeatCount = 0;
+        list< std::pair<IkReturnPtr, IkParameterization> > listlocalikreturns; // orderd with respect to vkinematicsols
 
         // check for self collisions
         RobotBase::ManipulatorPtr pmanip(_pmanip);
@@ -1984,11 +2494,8 @@ protected:
 //                    maxsolutions *= m;
 //                }
 //            }
-            FOREACH(itravesol, vravesols) {
-                _vsolutionindices = vsolutionindices;
-                FOREACH(it,_vsolutionindices) {
-                    *it += itravesol->second<<16;
-                }
+            FOREACH(itravesol, vkinematicsols) {
+                _vsolutionindices = itravesol->second;
                 probot->SetActiveDOFValues(itravesol->first,false);
                 _CheckRefineSolution(param, *pmanip, itravesol->first, !!(filteroptions&IKFO_IgnoreJointLimits));
 
@@ -2024,11 +2531,8 @@ protected:
             }
         }
         else {
-            FOREACH(itravesol, vravesols) {
-                _vsolutionindices = vsolutionindices;
-                FOREACH(it,_vsolutionindices) {
-                    *it += itravesol->second<<16;
-                }
+            FOREACH(itravesol, vkinematicsols) {
+                _vsolutionindices = itravesol->second;
                 probot->SetActiveDOFValues(itravesol->first,false);
                 _CheckRefineSolution(param, *pmanip, itravesol->first, !!(filteroptions&IKFO_IgnoreJointLimits));
 
@@ -2504,6 +3008,18 @@ protected:
 
     bool _bEmptyTransform6D; ///< if true, then the iksolver has been built with identity of the manipulator transform. Only valid for Transform6D IKs.
 
+    //@{
+    // solution cache, see SetSolutionCache command
+    ikfastsolvers::IkSolutionCachePtr _pSolutionCache; ///< if set, caches the kinematically valid solutions of solved poses
+    dReal _fSolutionCacheNearbyDist; ///< if > 0, Solve refines the cached solutions of poses within this distance with the jacobian inverse
+    bool _bSolvingKinematicsForCache; ///< true while computing the solutions to insert into _pSolutionCache. Collisions are not checked and finish callbacks are not called.
+    uint64_t _nSolutionCacheQueries, _nSolutionCacheHits, _nSolutionCacheNearbyHits, _nSolutionCacheMisses;
+    uint64_t _nSolutionCacheMissDurationNs; ///< accumulated time of all cache misses, used for estimating the time saved by hits
+    StatisticsCounter* _pSolveStatistics = nullptr; ///< counts the Solve calls, set in Init
+    StatisticsCounter* _pSolveAllStatistics = nullptr; ///< counts the SolveAll calls, set in Init
+    int64_t _nSolutionCacheSavedNs; ///< estimated time saved by cache hits
+    //@}
+
 };
 
 #ifdef OPENRAVE_IKFAST_FLOAT32
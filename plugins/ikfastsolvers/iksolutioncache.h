@@ -0,0 +1,193 @@
+// -*- coding: utf-8 -*-
+#ifndef OPENRAVE_IKSOLUTIONCACHE_H
+#define OPENRAVE_IKSOLUTIONCACHE_H
+
+#include "plugindefs.h"
+
+#include <unordered_map>
+
+namespace ikfastsolvers {
+
+/// \brief caches the kinematically valid ik solutions of previously solved poses of one manipulator.
+///
+/// Only solutions that passed the ikfast and joint limit checks are stored, so entries stay valid when the environment changes and users have to re-check collisions.
+/// Entries are hashed on a grid over the position part of the ik parameterization so that identical and nearby poses are found without scanning all entries. When full, the least recently used entry is evicted.
+class IkSolutionCache
+{
+public:
+    struct Entry
+    {
+        IkParameterization ikparam; ///< pose in the manipulator base frame
+        std::vector<dReal> vfreeparameters; ///< free parameters in [0,1] the pose was solved with, empty if all the free parameters were searched
+        bool bIgnoreJointLimits;
+        std::vector<IkReturnPtr> vikreturns; ///< sorted ik solutions
+    };
+
+    /// \param fCellSize the size of the grid cells. Nearby queries should not go farther than this distance.
+    /// \param maxentries maximum number of entries stored before least recently used ones are evicted
+    IkSolutionCache(dReal fCellSize, size_t maxentries) : _fCellSize(fCellSize), _maxentries(maxentries) {
+        BOOST_ASSERT(fCellSize > 0);
+    }
+
+    void Clear() {
+        _listentries.clear();
+        _mapcells.clear();
+    }
+
+    inline size_t GetNumEntries() const {
+        return _listentries.size();
+    }
+
+    inline dReal GetCellSize() const {
+        return _fCellSize;
+    }
+
+    inline size_t GetMaxEntries() const {
+        return _maxentries;
+    }
+
+    /// \brief returns an entry with an identical pose and free parameters, or NULL if none exists. Marks the entry as recently used.
+    const Entry* FindIdentical(const IkParameterization& ikparam, const std::vector<dReal>& vfreeparameters, bool bIgnoreJointLimits)
+    {
+        CellMap::iterator itcell = _mapcells.find(_GetCellKey(ikparam));
+        if( itcell == _mapcells.end() ) {
+            return NULL;
+        }
+        FOREACH(itentry, itcell->second) {
+            const Entry& entry = **itentry;
+            if( entry.ikparam.GetType() == ikparam.GetType() && entry.bIgnoreJointLimits == bIgnoreJointLimits && entry.vfreeparameters == vfreeparameters && entry.ikparam.ComputeDistanceSqr(ikparam) <= g_fEpsilon ) {
+                _listentries.splice(_listentries.begin(), _listentries, *itentry);
+                return &entry;
+            }
+        }
+        return NULL;
+    }
+
+    /// \brief returns the entry closest to ikparam within sqrt(fMaxDistSqr), or NULL if none exists. Marks the entry as recently used.
+    const Entry* FindNearest(const IkParameterization& ikparam, const std::vector<dReal>& vfreeparameters, bool bIgnoreJointLimits, dReal fMaxDistSqr)
+    {
+        CellKey key = _GetCellKey(ikparam);
+        EntryList::iterator itbest = _listentries.end();
+        dReal fBestDistSqr = fMaxDistSqr;
+        CellKey neighborkey;
+        for(int ix = -1; ix <= 1; ++ix) {
+            neighborkey[0] = key[0]+ix;
+            for(int iy = -1; iy <= 1; ++iy) {
+                neighborkey[1] = key[1]+iy;
+                for(int iz = -1; iz <= 1; ++iz) {
+                    neighborkey[2] = key[2]+iz;
+                    CellMap::iterator itcell = _mapcells.find(neighborkey);
+                    if( itcell == _mapcells.end() ) {
+                        continue;
+                    }
+                    FOREACH(itentry, itcell->second) {
+                        const Entry& entry = **itentry;
+                        if( entry.ikparam.GetType() != ikparam.GetType() || entry.bIgnoreJointLimits != bIgnoreJointLimits || entry.vfreeparameters != vfreeparameters ) {
+                            continue;
+                        }
+                        dReal fDistSqr = entry.ikparam.ComputeDistanceSqr(ikparam);
+                        if( fDistSqr <= fBestDistSqr ) {
+                            fBestDistSqr = fDistSqr;
+                            itbest = *itentry;
+                        }
+                    }
+                }
+            }
+        }
+        if( itbest == _listentries.end() ) {
+            return NULL;
+        }
+        _listentries.splice(_listentries.begin(), _listentries, itbest);
+        return &*itbest;
+    }
+
+    /// \brief inserts a new entry, the ik returns are copied.
+    void Insert(const IkParameterization& ikparam, const std::vector<dReal>& vfreeparameters, bool bIgnoreJointLimits, const std::vector<IkReturnPtr>& vikreturns)
+    {
+        if( _maxentries == 0 ) {
+            return;
+        }
+        while( _listentries.size() >= _maxentries ) {
+            _EraseEntry(--_listentries.end());
+        }
+        _listentries.push_front(Entry());
+        Entry& entry = _listentries.front();
+        entry.ikparam = ikparam;
+        entry.ikparam.ClearCustomValues();
+        entry.vfreeparameters = vfreeparameters;
+        entry.bIgnoreJointLimits = bIgnoreJointLimits;
+        entry.vikreturns.reserve(vikreturns.size());
+        FOREACHC(itikreturn, vikreturns) {
+            entry.vikreturns.push_back(IkReturnPtr(new IkReturn(**itikreturn)));
+        }
+        _mapcells[_GetCellKey(ikparam)].push_back(_listentries.begin());
+    }
+
+private:
+    typedef std::list<Entry> EntryList;
+    typedef boost::array<int64_t, 3> CellKey;
+    struct CellKeyHash
+    {
+        size_t operator()(const CellKey& key) const {
+            return boost::hash_range(key.begin(), key.end());
+        }
+    };
+    typedef std::unordered_map<CellKey, std::vector<EntryList::iterator>, CellKeyHash> CellMap;
+
+    /// \brief returns the position part of the ik parameterization used for hashing. Types without a position all fall into the same cell.
+    static Vector _GetPosition(const IkParameterization& ikparam)
+    {
+        switch(ikparam.GetType()) {
+        case IKP_Transform6D: return ikparam.GetTransform6D().trans;
+        case IKP_Translation3D: return ikparam.GetTranslation3D();
+        case IKP_Ray4D: return ikparam.GetRay4D().pos;
+        case IKP_Lookat3D: return ikparam.GetLookat3D();
+        case IKP_TranslationDirection5D: return ikparam.GetTranslationDirection5D().pos;
+        case IKP_TranslationXY2D: return ikparam.GetTranslationXY2D();
+        case IKP_TranslationXYOrientation3D: return Vector(ikparam.GetTranslationXYOrientation3D().x, ikparam.GetTranslationXYOrientation3D().y, 0);
+        case IKP_TranslationLocalGlobal6D: return ikparam.GetTranslationLocalGlobal6D().second;
+        case IKP_TranslationXAxisAngle4D: return ikparam.GetTranslationXAxisAngle4D().first;
+        case IKP_TranslationYAxisAngle4D: return ikparam.GetTranslationYAxisAngle4D().first;
+        case IKP_TranslationZAxisAngle4D: return ikparam.GetTranslationZAxisAngle4D().first;
+        case IKP_TranslationXAxisAngleZNorm4D: return ikparam.GetTranslationXAxisAngleZNorm4D().first;
+        case IKP_TranslationYAxisAngleXNorm4D: return ikparam.GetTranslationYAxisAngleXNorm4D().first;
+        case IKP_TranslationZAxisAngleYNorm4D: return ikparam.GetTranslationZAxisAngleYNorm4D().first;
+        default:
+            return Vector();
+        }
+    }
+
+    CellKey _GetCellKey(const IkParameterization& ikparam) const
+    {
+        Vector vpos = _GetPosition(ikparam);
+        CellKey key;
+        key[0] = (int64_t)std::floor(vpos.x/_fCellSize);
+        key[1] = (int64_t)std::floor(vpos.y/_fCellSize);
+        key[2] = (int64_t)std::floor(vpos.z/_fCellSize);
+        return key;
+    }
+
+    void _EraseEntry(EntryList::iterator itentry)
+    {
+        CellMap::iterator itcell = _mapcells.find(_GetCellKey(itentry->ikparam));
+        if( itcell != _mapcells.end() ) {
+            std::vector<EntryList::iterator>& ventries = itcell->second;
+            ventries.erase(std::remove(ventries.begin(), ventries.end(), itentry), ventries.end());
+            if( ventries.size() == 0 ) {
+                _mapcells.erase(itcell);
+            }
+        }
+        _listentries.erase(itentry);
+    }
+
+    dReal _fCellSize;
+    size_t _maxentries;
+    EntryList _listentries; ///< most recently used first
+    CellMap _mapcells;
+};
+
+typedef boost::shared_ptr<IkSolutionCache> IkSolutionCachePtr;
+
+} // end namespace ikfastsolvers
+
+#endif
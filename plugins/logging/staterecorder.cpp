@@ -0,0 +1,1140 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2006-2011 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "plugindefs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <boost/bind/bind.hpp>
+
+using namespace boost::placeholders;
+
+namespace staterecorder {
+
+/// \brief records of the state log.
+///
+/// The log starts with s_headerMagic and the uint32 version. Every record is [uint8 type][uint32 payload size][payload] so that readers can skip unknown records.
+/// When the recording is stopped, the SRT_Index record is written followed by its uint64 file offset and s_indexMagic.
+enum StateRecordType
+{
+    SRT_Keyframe = 1, ///< uint64 timestamp. Followed by the SRT_BodyAdded records of all the bodies and an SRT_Frame with their full states, so replaying can start here.
+    SRT_BodyAdded = 2, ///< uint64 timestamp, uint32 id, uint8 isrobot, string name, string uri
+    SRT_BodyRemoved = 3, ///< uint64 timestamp, uint32 id
+    SRT_Frame = 4, ///< uint64 timestamp, uint32 numbodies, then for every body uint32 id, uint8 BodyStateFlags and the data of every set flag
+    SRT_Index = 5, ///< uint64 starttime, uint64 endtime, uint32 numkeyframes, then the uint64 timestamp and uint64 file offset of every SRT_Keyframe record
+};
+
+/// \brief the parts of a body state stored in an SRT_Frame. Links and dofs are delta encoded, only the values that changed since the previous frame are stored.
+enum BodyStateFlags
+{
+    BSF_Links = 1, ///< uint32 numlinks, bitmask of the stored links, 7 doubles (quaternion, translation) for every stored link
+    BSF_DOFValues = 2, ///< uint32 numdofs, bitmask of the stored dofs, one double for every stored dof
+    BSF_Grabbed = 4, ///< uint32 numgrabbed, then for every grabbed body its name, the grabbing link name, 7 doubles of the relative transform and the ignored link names
+};
+
+static const char s_headerMagic[8] = {'O','R','S','T','A','T','E','L'};
+static const char s_indexMagic[8] = {'O','R','S','T','I','D','X','L'};
+static const uint32_t s_version = 1;
+
+struct GrabbedState
+{
+    std::string grabbedname, linkname;
+    Transform trelative;
+    std::vector<std::string> vignorelinknames;
+};
+
+class BinaryWriter
+{
+public:
+    BinaryWriter(std::string& buffer) : _buffer(buffer) {
+    }
+
+    template <typename T>
+    inline void Write(const T& value) {
+        _buffer.append((const char*)&value, sizeof(T));
+    }
+
+    inline void WriteString(const std::string& s) {
+        Write<uint32_t>(s.size());
+        _buffer.append(s);
+    }
+
+    inline void WriteValue(dReal value) {
+        Write<double>(value);
+    }
+
+    inline void WriteValue(const Transform& t) {
+        const double values[7] = {t.rot.x, t.rot.y, t.rot.z, t.rot.w, t.trans.x, t.trans.y, t.trans.z};
+        _buffer.append((const char*)values, sizeof(values));
+    }
+
+    void WriteGrabbed(const std::vector<GrabbedState>& vgrabbed)
+    {
+        Write<uint32_t>(vgrabbed.size());
+        FOREACHC(itgrabbed, vgrabbed) {
+            WriteString(itgrabbed->grabbedname);
+            WriteString(itgrabbed->linkname);
+            WriteValue(itgrabbed->trelative);
+            Write<uint32_t>(itgrabbed->vignorelinknames.size());
+            FOREACHC(itname, itgrabbed->vignorelinknames) {
+                WriteString(*itname);
+            }
+        }
+    }
+
+    /// \brief writes the values of vnew that differ from vwritten and sets vwritten to vnew
+    ///
+    /// \param bFull if true, writes all the values
+    /// \return true if any value was written
+    template <typename T>
+    bool WriteChangedValues(std::vector<T>& vwritten, const std::vector<T>& vnew, bool bFull)
+    {
+        if( vwritten.size() != vnew.size() ) {
+            bFull = true;
+        }
+        _vmask.resize(0);
+        _vmask.resize((vnew.size()+7)/8, 0);
+        bool bChanged = bFull;
+        for(size_t i = 0; i < vnew.size(); ++i) {
+            if( bFull || vwritten[i] != vnew[i] ) {
+                _vmask[i>>3] |= 1<<(i&7);
+                bChanged = true;
+            }
+        }
+        if( !bChanged ) {
+            return false;
+        }
+        Write<uint32_t>(vnew.size());
+        _buffer.append((const char*)_vmask.data(), _vmask.size());
+        for(size_t i = 0; i < vnew.size(); ++i) {
+            if( _vmask[i>>3] & (1<<(i&7)) ) {
+                WriteValue(vnew[i]);
+            }
+        }
+        if( &vwritten != &vnew ) {
+            vwritten = vnew;
+        }
+        return true;
+    }
+
+    std::string& _buffer;
+    std::vector<uint8_t> _vmask;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const char* pdata, size_t size) : _pdata(pdata), _pend(pdata+size) {
+    }
+
+    template <typename T>
+    inline T Read() {
+        T value;
+        _Check(sizeof(T));
+        memcpy(&value, _pdata, sizeof(T));
+        _pdata += sizeof(T);
+        return value;
+    }
+
+    inline void ReadString(std::string& s) {
+        uint32_t size = Read<uint32_t>();
+        _Check(size);
+        s.assign(_pdata, size);
+        _pdata += size;
+    }
+
+    inline void ReadValue(dReal& value) {
+        value = Read<double>();
+    }
+
+    inline void ReadValue(Transform& t) {
+        double values[7];
+        _Check(sizeof(values));
+        memcpy(values, _pdata, sizeof(values));
+        _pdata += sizeof(values);
+        t.rot = Vector(values[0], values[1], values[2], values[3]);
+        t.trans = Vector(values[4], values[5], values[6]);
+    }
+
+    void ReadGrabbed(std::vector<GrabbedState>& vgrabbed)
+    {
+        vgrabbed.resize(Read<uint32_t>());
+        FOREACH(itgrabbed, vgrabbed) {
+            ReadString(itgrabbed->grabbedname);
+            ReadString(itgrabbed->linkname);
+            ReadValue(itgrabbed->trelative);
+            itgrabbed->vignorelinknames.resize(Read<uint32_t>());
+            FOREACH(itname, itgrabbed->vignorelinknames) {
+                ReadString(*itname);
+            }
+        }
+    }
+
+    /// \brief reads values written by BinaryWriter::WriteChangedValues into vvalues
+    template <typename T>
+    void ReadChangedValues(std::vector<T>& vvalues)
+    {
+        uint32_t num = Read<uint32_t>();
+        size_t masksize = (num+7)/8;
+        _Check(masksize);
+        const uint8_t* pmask = (const uint8_t*)_pdata;
+        _pdata += masksize;
+        vvalues.resize(num);
+        for(uint32_t i = 0; i < num; ++i) {
+            if( pmask[i>>3] & (1<<(i&7)) ) {
+                ReadValue(vvalues[i]);
+            }
+        }
+    }
+
+private:
+    inline void _Check(size_t size) const {
+        if( (size_t)(_pend - _pdata) < size ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("state log record is truncated", ORE_InvalidArguments);
+        }
+    }
+
+    const char* _pdata;
+    const char* _pend;
+};
+
+/// \brief the bodies that changed since the previous capture, copied under the environment lock and encoded by the writer thread
+struct CapturedFrame
+{
+    struct BodyEvent
+    {
+        uint32_t id;
+        bool bAdded, bRobot;
+        std::string name, uri;
+    };
+
+    struct BodySnapshot
+    {
+        uint32_t id;
+        bool bStateCaptured, bGrabbedCaptured;
+        std::vector<Transform> vlinktransforms;
+        std::vector<dReal> vdofvalues;
+        std::vector<GrabbedState> vgrabbed;
+    };
+
+    uint64_t timestamp;
+    std::vector<BodyEvent> vevents;
+    std::vector<BodySnapshot> vbodies; ///< only the first numbodies are valid, the others are kept to reuse their memory
+    size_t numbodies;
+};
+typedef boost::shared_ptr<CapturedFrame> CapturedFramePtr;
+
+class StateRecorder : public ModuleBase
+{
+    /// \brief a body of the environment tracked by the capture
+    struct TrackedBody
+    {
+        KinBodyWeakPtr pbody;
+        uint32_t id;
+        int updatestamp;
+        std::vector<std::string> vgrabbednames;
+        bool bSeen;
+    };
+
+    /// \brief the last state of a body written to the log, used for the delta encoding
+    struct WrittenBody
+    {
+        bool bRobot;
+        std::string name, uri;
+        std::vector<Transform> vlinktransforms;
+        std::vector<dReal> vdofvalues;
+        std::vector<GrabbedState> vgrabbed;
+        uint64_t framestamp;
+    };
+
+public:
+    StateRecorder(EnvironmentBasePtr penv, std::istream& sinput) : ModuleBase(penv)
+    {
+        __description = ":Interface Author: Rosen Diankov\n\nRecords the states of all bodies (link transforms, dof values, grabbed bodies, added and removed bodies) into a compact binary log that can be replayed with the StateReplayer module. Only the values that changed since the previous frame are stored, and a keyframe with the full states is stored periodically so the log can be seeked. Bodies are copied under the environment lock and encoded and written on a separate thread.";
+        RegisterCommand("Start",boost::bind(&StateRecorder::_StartCommand,this,_1,_2),
+                        "Starts recording a file, this will stop the previous recording and overwrite the file. Format::\n\n  Start timing [simtime/realtime/manual] rate [frames/sec] keyframeinterval [sec] filename [filename]\\n\n\nsimtime records on the simulation steps of the environment, which requires the module to be added to the environment. realtime records from a separate thread. manual only records on the Sample command. A rate of 0 records every simulation step. Because the filename can have spaces, it is read until a newline is encountered.");
+        RegisterCommand("Stop",boost::bind(&StateRecorder::_StopCommand,this,_1,_2),
+                        "Stops recording, writes the time index and closes the file.");
+        RegisterCommand("Sample",boost::bind(&StateRecorder::_SampleCommand,this,_1,_2),
+                        "Records the current state of the environment, for example at the rate the states are published.");
+        _nTiming = 1;
+        _framerate = 30;
+        _keyframeinterval = 1000000;
+        _lastsampletime = 0;
+        _bStopRecord = true;
+        _nextbodyid = 0;
+        _nDroppedFrames = 0;
+    }
+    virtual ~StateRecorder()
+    {
+        _Reset();
+    }
+
+    virtual void Destroy() {
+        _Reset();
+        ModuleBase::Destroy();
+    }
+
+    virtual bool SimulationStep(dReal fElapsedTime)
+    {
+        if( _nTiming == 1 && !_bStopRecord ) {
+            uint64_t simtime = GetEnv()->GetSimulationTime();
+            if( _framerate <= 0 || simtime >= _lastsampletime + (uint64_t)(1000000/_framerate) ) {
+                _lastsampletime = simtime;
+                _CaptureFrame(simtime);
+            }
+        }
+        return false;
+    }
+
+protected:
+    bool _StartCommand(ostream& sout, istream& sinput)
+    {
+        _Reset();
+        string filename;
+        dReal keyframeinterval = 1;
+        string cmd;
+        while(!sinput.eof()) {
+            sinput >> cmd;
+            if( !sinput ) {
+                break;
+            }
+            std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+            if( cmd == "timing" ) {
+                string type;
+                sinput >> type;
+                if( type == "simtime" ) {
+                    _nTiming = 1;
+                }
+                else if( type == "realtime" ) {
+                    _nTiming = 0;
+                }
+                else if( type == "manual" ) {
+                    _nTiming = 2;
+                }
+                else {
+                    RAVELOG_WARN_FORMAT("unknown timing %s", type);
+                }
+            }
+            else if( cmd == "rate" ) {
+                sinput >> _framerate;
+            }
+            else if( cmd == "keyframeinterval" ) {
+                sinput >> keyframeinterval;
+            }
+            else if( cmd == "filename" ) {
+                if( !getline(sinput, filename) ) {
+                    return false;
+                }
+                boost::trim(filename);
+            }
+            else {
+                return false;
+            }
+            if( sinput.fail() || !sinput ) {
+                break;
+            }
+        }
+        if( filename.empty() ) {
+            RAVELOG_WARN("state recorder needs a filename\n");
+            return false;
+        }
+        if( _nTiming == 0 && _framerate <= 0 ) {
+            RAVELOG_WARN("realtime recording needs a positive rate\n");
+            return false;
+        }
+
+        _ofstream.open(filename.c_str(), ios::binary|ios::out|ios::trunc);
+        if( !_ofstream ) {
+            RAVELOG_WARN_FORMAT("failed to open %s for writing", filename);
+            return false;
+        }
+        _ofstream.write(s_headerMagic, sizeof(s_headerMagic));
+        _ofstream.write((const char*)&s_version, sizeof(s_version));
+        _fileoffset = sizeof(s_headerMagic) + sizeof(s_version);
+        _keyframeinterval = (uint64_t)(keyframeinterval*1000000);
+        _vkeyframes.clear();
+        _mapwritten.clear();
+        _mapTrackedBodies.clear();
+        _nextbodyid = 0;
+        _nDroppedFrames = 0;
+        _starttime = _endtime = 0;
+        _framestamp = 0;
+        _lastkeyframetime = 0;
+        _lastsampletime = 0;
+        _bStopRecord = false;
+        _threadwrite = boost::make_shared<std::thread>(std::bind(&StateRecorder::_WriteThread, this));
+        if( _nTiming == 0 ) {
+            _threadsample = boost::make_shared<std::thread>(std::bind(&StateRecorder::_SampleThread, this));
+        }
+        RAVELOG_INFO_FORMAT("recording states to %s", filename);
+        return true;
+    }
+
+    bool _StopCommand(ostream& sout, istream& sinput)
+    {
+        _Reset();
+        return true;
+    }
+
+    bool _SampleCommand(ostream& sout, istream& sinput)
+    {
+        if( _bStopRecord ) {
+            return false;
+        }
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        _CaptureFrame(_nTiming == 1 ? GetEnv()->GetSimulationTime() : utils::GetMicroTime());
+        return true;
+    }
+
+    void _Reset()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _bStopRecord = true;
+            _condnewframe.notify_all();
+        }
+        if( !!_threadsample ) {
+            _threadsample->join();
+            _threadsample.reset();
+        }
+        if( !!_threadwrite ) {
+            // the write thread flushes the captured frames before exiting
+            _threadwrite->join();
+            _threadwrite.reset();
+        }
+        if( _ofstream.is_open() ) {
+            _WriteIndex();
+            _ofstream.close();
+            if( _nDroppedFrames > 0 ) {
+                RAVELOG_WARN_FORMAT("state recorder dropped %d frames because the writer could not keep up", _nDroppedFrames);
+            }
+        }
+        _listCapturedFrames.clear();
+    }
+
+    void _SampleThread()
+    {
+        const uint64_t frametime = (uint64_t)(1000000/_framerate);
+        uint64_t nexttime = utils::GetMicroTime();
+        while(!_bStopRecord) {
+            {
+                // try locking so that stopping the recorder with the environment locked does not dead lock
+                EnvironmentLock lockenv(GetEnv()->GetMutex(), OpenRAVE::defer_lock_t());
+                while(!_bStopRecord && !lockenv.try_lock()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(500));
+                }
+                if( _bStopRecord ) {
+                    break;
+                }
+                _CaptureFrame(utils::GetMicroTime());
+            }
+            nexttime += frametime;
+            uint64_t curtime = utils::GetMicroTime();
+            if( nexttime > curtime ) {
+                std::this_thread::sleep_for(std::chrono::microseconds(nexttime - curtime));
+            }
+            else {
+                nexttime = curtime;
+            }
+        }
+    }
+
+    /// \brief copies the bodies that changed since the previous capture and queues them for writing. The environment has to be locked.
+    void _CaptureFrame(uint64_t timestamp)
+    {
+        CapturedFramePtr pframe;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if( _bStopRecord ) {
+                return;
+            }
+            if( _listCapturedFrames.size() >= s_maxQueuedFrames ) {
+                // nothing of this capture is recorded, so the changes are picked up by the next capture
+                ++_nDroppedFrames;
+                return;
+            }
+            if( _listFreeFrames.size() > 0 ) {
+                pframe = _listFreeFrames.front();
+                _listFreeFrames.pop_front();
+            }
+        }
+        if( !pframe ) {
+            pframe.reset(new CapturedFrame());
+        }
+        pframe->timestamp = timestamp;
+        pframe->vevents.clear();
+        pframe->numbodies = 0;
+
+        FOREACH(ittracked, _mapTrackedBodies) {
+            ittracked->second.bSeen = false;
+        }
+        GetEnv()->GetBodies(_vbodiescache);
+        FOREACHC(itbody, _vbodiescache) {
+            const KinBodyPtr& pbody = *itbody;
+            std::map<int, TrackedBody>::iterator ittracked = _mapTrackedBodies.find(pbody->GetEnvironmentBodyIndex());
+            if( ittracked != _mapTrackedBodies.end() && ittracked->second.pbody.lock() != pbody ) {
+                _AddBodyEvent(*pframe, ittracked->second.id, KinBodyPtr());
+                _mapTrackedBodies.erase(ittracked);
+                ittracked = _mapTrackedBodies.end();
+            }
+            if( ittracked == _mapTrackedBodies.end() ) {
+                TrackedBody& tracked = _mapTrackedBodies[pbody->GetEnvironmentBodyIndex()];
+                tracked.pbody = pbody;
+                tracked.id = _nextbodyid++;
+                tracked.updatestamp = pbody->GetUpdateStamp()-1;
+                _AddBodyEvent(*pframe, tracked.id, pbody);
+                ittracked = _mapTrackedBodies.find(pbody->GetEnvironmentBodyIndex());
+            }
+            TrackedBody& tracked = ittracked->second;
+            tracked.bSeen = true;
+
+            const bool bStateChanged = tracked.updatestamp != pbody->GetUpdateStamp();
+            bool bGrabbedChanged = (int)tracked.vgrabbednames.size() != pbody->GetNumGrabbed();
+            for(int igrabbed = 0; igrabbed < pbody->GetNumGrabbed() && !bGrabbedChanged; ++igrabbed) {
+                KinBodyPtr pgrabbed = pbody->GetGrabbedBody(igrabbed);
+                bGrabbedChanged = !pgrabbed || pgrabbed->GetName() != tracked.vgrabbednames[igrabbed];
+            }
+            if( !bStateChanged && !bGrabbedChanged ) {
+                continue;
+            }
+
+            if( pframe->numbodies >= pframe->vbodies.size() ) {
+                pframe->vbodies.resize(pframe->numbodies+1);
+            }
+            CapturedFrame::BodySnapshot& snapshot = pframe->vbodies[pframe->numbodies++];
+            snapshot.id = tracked.id;
+            snapshot.bStateCaptured = bStateChanged;
+            snapshot.bGrabbedCaptured = bGrabbedChanged;
+            if( bStateChanged ) {
+                pbody->GetLinkTransformations(snapshot.vlinktransforms, snapshot.vdofvalues);
+                tracked.updatestamp = pbody->GetUpdateStamp();
+            }
+            if( bGrabbedChanged ) {
+                pbody->GetGrabbedInfo(_vgrabbedinfocache);
+                snapshot.vgrabbed.resize(_vgrabbedinfocache.size());
+                tracked.vgrabbednames.resize(pbody->GetNumGrabbed());
+                for(int igrabbed = 0; igrabbed < pbody->GetNumGrabbed(); ++igrabbed) {
+                    KinBodyPtr pgrabbed = pbody->GetGrabbedBody(igrabbed);
+                    tracked.vgrabbednames[igrabbed] = !!pgrabbed ? pgrabbed->GetName() : std::string();
+                }
+                for(size_t igrabbed = 0; igrabbed < _vgrabbedinfocache.size(); ++igrabbed) {
+                    const KinBody::GrabbedInfo& grabbedinfo = _vgrabbedinfocache[igrabbed];
+                    GrabbedState& grabbed = snapshot.vgrabbed[igrabbed];
+                    grabbed.grabbedname = grabbedinfo._grabbedname;
+                    grabbed.linkname = grabbedinfo._robotlinkname;
+                    grabbed.trelative = grabbedinfo._trelative;
+                    grabbed.vignorelinknames.assign(grabbedinfo._setIgnoreRobotLinkNames.begin(), grabbedinfo._setIgnoreRobotLinkNames.end());
+                }
+            }
+        }
+        _vbodiescache.clear();
+
+        FOREACH_NOINC(ittracked, _mapTrackedBodies) {
+            if( !ittracked->second.bSeen ) {
+                _AddBodyEvent(*pframe, ittracked->second.id, KinBodyPtr());
+                _mapTrackedBodies.erase(ittracked++);
+            }
+            else {
+                ++ittracked;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _listCapturedFrames.push_back(pframe);
+        _condnewframe.notify_one();
+    }
+
+    /// \param pbody the added body, or empty if the body with id was removed
+    static void _AddBodyEvent(CapturedFrame& frame, uint32_t id, KinBodyPtr pbody)
+    {
+        frame.vevents.push_back(CapturedFrame::BodyEvent());
+        CapturedFrame::BodyEvent& event = frame.vevents.back();
+        event.id = id;
+        event.bAdded = !!pbody;
+        event.bRobot = !!pbody && pbody->IsRobot();
+        if( !!pbody ) {
+            event.name = pbody->GetName();
+            event.uri = pbody->GetURI();
+        }
+    }
+
+    void _WriteThread()
+    {
+        while(1) {
+            CapturedFramePtr pframe;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                while(_listCapturedFrames.empty() && !_bStopRecord) {
+                    _condnewframe.wait(lock);
+                }
+                if( _listCapturedFrames.empty() ) {
+                    break;
+                }
+                pframe = _listCapturedFrames.front();
+                _listCapturedFrames.pop_front();
+            }
+
+            try {
+                _WriteFrame(*pframe);
+            }
+            catch(const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("failed to write state frame: %s", ex.what());
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _listFreeFrames.push_back(pframe);
+        }
+        _ofstream.flush();
+    }
+
+    void _WriteFrame(const CapturedFrame& frame)
+    {
+        const bool bKeyframe = _vkeyframes.empty() || frame.timestamp >= _lastkeyframetime + _keyframeinterval;
+        if( _vkeyframes.empty() ) {
+            _starttime = frame.timestamp;
+        }
+        _endtime = frame.timestamp;
+        ++_framestamp;
+
+        // a keyframe writes all the bodies after the events, so the events themselves do not need to be written
+        FOREACHC(itevent, frame.vevents) {
+            if( itevent->bAdded ) {
+                WrittenBody& written = _mapwritten[itevent->id];
+                written.bRobot = itevent->bRobot;
+                written.name = itevent->name;
+                written.uri = itevent->uri;
+                written.vlinktransforms.clear();
+                written.vdofvalues.clear();
+                written.vgrabbed.clear();
+                written.framestamp = 0;
+                if( !bKeyframe ) {
+                    _WriteBodyAdded(frame.timestamp, itevent->id, written);
+                }
+            }
+            else {
+                _mapwritten.erase(itevent->id);
+                if( !bKeyframe ) {
+                    _payload.resize(0);
+                    BinaryWriter writer(_payload);
+                    writer.Write<uint64_t>(frame.timestamp);
+                    writer.Write<uint32_t>(itevent->id);
+                    _WriteRecord(SRT_BodyRemoved);
+                }
+            }
+        }
+
+        if( bKeyframe ) {
+            _vkeyframes.emplace_back(frame.timestamp, _fileoffset);
+            _lastkeyframetime = frame.timestamp;
+            _payload.resize(0);
+            BinaryWriter(_payload).Write<uint64_t>(frame.timestamp);
+            _WriteRecord(SRT_Keyframe);
+            FOREACHC(itwritten, _mapwritten) {
+                _WriteBodyAdded(frame.timestamp, itwritten->first, itwritten->second);
+            }
+        }
+
+        _payload.resize(0);
+        BinaryWriter writer(_payload);
+        writer.Write<uint64_t>(frame.timestamp);
+        writer.Write<uint32_t>(0);
+        uint32_t numbodies = 0;
+        for(size_t ibody = 0; ibody < frame.numbodies; ++ibody) {
+            const CapturedFrame::BodySnapshot& snapshot = frame.vbodies[ibody];
+            std::map<uint32_t, WrittenBody>::iterator itwritten = _mapwritten.find(snapshot.id);
+            if( itwritten != _mapwritten.end() && _WriteBodyState(writer, snapshot.id, itwritten->second, &snapshot, bKeyframe) ) {
+                ++numbodies;
+            }
+        }
+        if( bKeyframe ) {
+            FOREACH(itwritten, _mapwritten) {
+                if( itwritten->second.framestamp != _framestamp && _WriteBodyState(writer, itwritten->first, itwritten->second, NULL, true) ) {
+                    ++numbodies;
+                }
+            }
+        }
+        if( numbodies > 0 || bKeyframe ) {
+            memcpy(&_payload[sizeof(uint64_t)], &numbodies, sizeof(numbodies));
+            _WriteRecord(SRT_Frame);
+        }
+    }
+
+    void _WriteBodyAdded(uint64_t timestamp, uint32_t id, const WrittenBody& written)
+    {
+        _payload.resize(0);
+        BinaryWriter writer(_payload);
+        writer.Write<uint64_t>(timestamp);
+        writer.Write<uint32_t>(id);
+        writer.Write<uint8_t>(written.bRobot);
+        writer.WriteString(written.name);
+        writer.WriteString(written.uri);
+        _WriteRecord(SRT_BodyAdded);
+    }
+
+    /// \brief appends the changes of the body to the frame and updates the written state
+    ///
+    /// \param psnapshot the captured state, if NULL the written state is used
+    /// \param bFull if true, writes the full state instead of the changes
+    /// \return true if anything was appended
+    bool _WriteBodyState(BinaryWriter& writer, uint32_t id, WrittenBody& written, const CapturedFrame::BodySnapshot* psnapshot, bool bFull)
+    {
+        written.framestamp = _framestamp;
+        const size_t startsize = _payload.size();
+        writer.Write<uint32_t>(id);
+        const size_t flagsoffset = _payload.size();
+        writer.Write<uint8_t>(0);
+        uint8_t flags = 0;
+        const bool bState = !psnapshot || psnapshot->bStateCaptured;
+        if( bState || bFull ) {
+            if( writer.WriteChangedValues(written.vlinktransforms, bState && !!psnapshot ? psnapshot->vlinktransforms : written.vlinktransforms, bFull) ) {
+                flags |= BSF_Links;
+            }
+            if( writer.WriteChangedValues(written.vdofvalues, bState && !!psnapshot ? psnapshot->vdofvalues : written.vdofvalues, bFull) ) {
+                flags |= BSF_DOFValues;
+            }
+        }
+        if( (!!psnapshot && psnapshot->bGrabbedCaptured) || bFull ) {
+            if( !!psnapshot && psnapshot->bGrabbedCaptured ) {
+                written.vgrabbed = psnapshot->vgrabbed;
+            }
+            writer.WriteGrabbed(written.vgrabbed);
+            flags |= BSF_Grabbed;
+        }
+        if( flags == 0 ) {
+            _payload.resize(startsize);
+            return false;
+        }
+        _payload[flagsoffset] = flags;
+        return true;
+    }
+
+    void _WriteRecord(StateRecordType type)
+    {
+        uint8_t recordtype = type;
+        uint32_t size = _payload.size();
+        _ofstream.write((const char*)&recordtype, sizeof(recordtype));
+        _ofstream.write((const char*)&size, sizeof(size));
+        _ofstream.write(_payload.data(), _payload.size());
+        _fileoffset += sizeof(recordtype) + sizeof(size) + _payload.size();
+    }
+
+    void _WriteIndex()
+    {
+        uint64_t indexoffset = _fileoffset;
+        _payload.resize(0);
+        BinaryWriter writer(_payload);
+        writer.Write<uint64_t>(_starttime);
+        writer.Write<uint64_t>(_endtime);
+        writer.Write<uint32_t>(_vkeyframes.size());
+        FOREACHC(itkeyframe, _vkeyframes) {
+            writer.Write<uint64_t>(itkeyframe->first);
+            writer.Write<uint64_t>(itkeyframe->second);
+        }
+        _WriteRecord(SRT_Index);
+        _ofstream.write((const char*)&indexoffset, sizeof(indexoffset));
+        _ofstream.write(s_indexMagic, sizeof(s_indexMagic));
+    }
+
+    static const size_t s_maxQueuedFrames = 256;
+
+    std::mutex _mutex; ///< protects _listCapturedFrames and _listFreeFrames
+    std::condition_variable _condnewframe;
+    boost::shared_ptr<std::thread> _threadwrite, _threadsample;
+    std::list<CapturedFramePtr> _listCapturedFrames, _listFreeFrames;
+    std::atomic<bool> _bStopRecord; ///< read by the sampling and write threads without _mutex
+    int _nTiming; ///< 0 for realtime, 1 for simulation time, 2 for manual sampling
+    dReal _framerate;
+    uint64_t _lastsampletime;
+    int _nDroppedFrames;
+
+    // capture state, accessed with the environment locked
+    std::map<int, TrackedBody> _mapTrackedBodies; ///< indexed by the environment body index
+    uint32_t _nextbodyid;
+    std::vector<KinBodyPtr> _vbodiescache;
+    std::vector<KinBody::GrabbedInfo> _vgrabbedinfocache;
+
+    // writer state, accessed by the write thread
+    std::ofstream _ofstream;
+    uint64_t _fileoffset;
+    std::string _payload;
+    std::map<uint32_t, WrittenBody> _mapwritten;
+    std::vector< std::pair<uint64_t, uint64_t> > _vkeyframes; ///< timestamp and file offset of every keyframe
+    uint64_t _keyframeinterval, _lastkeyframetime;
+    uint64_t _starttime, _endtime, _framestamp;
+};
+
+class StateReplayer : public ModuleBase
+{
+    struct ReplayedBody
+    {
+        ReplayedBody() : bRobot(false), bHasGrabbed(false) {
+        }
+        bool bRobot;
+        std::string name, uri;
+        std::vector<Transform> vlinktransforms;
+        std::vector<dReal> vdofvalues;
+        std::vector<GrabbedState> vgrabbed;
+        bool bHasGrabbed;
+    };
+
+public:
+    StateReplayer(EnvironmentBasePtr penv, std::istream& sinput) : ModuleBase(penv)
+    {
+        __description = ":Interface Author: Rosen Diankov\n\nRestores the environment to any time point of a log recorded by the StateRecorder module.";
+        RegisterCommand("Open",boost::bind(&StateReplayer::_OpenCommand,this,_1,_2),
+                        "Opens a state log. Format::\n\n  Open [filename]\n\n");
+        RegisterCommand("GetTimeRange",boost::bind(&StateReplayer::_GetTimeRangeCommand,this,_1,_2),
+                        "Returns the first and last timestamp of the log in microseconds.");
+        RegisterCommand("GetKeyframeTimes",boost::bind(&StateReplayer::_GetKeyframeTimesCommand,this,_1,_2),
+                        "Returns the timestamps of the keyframes in microseconds.");
+        RegisterCommand("Seek",boost::bind(&StateReplayer::_SeekCommand,this,_1,_2),
+                        "Restores the states of the last frame recorded at or before the timestamp. Bodies missing from the environment are loaded from their uri, bodies removed at the timestamp are removed from the environment. Format::\n\n  Seek [timestamp in microseconds]\n\n");
+        _starttime = _endtime = 0;
+    }
+
+protected:
+    bool _OpenCommand(ostream& sout, istream& sinput)
+    {
+        string filename;
+        if( !getline(sinput, filename) ) {
+            return false;
+        }
+        boost::trim(filename);
+        _ifstream.close();
+        _ifstream.clear();
+        _vkeyframes.clear();
+        _setRestoredBodyNames.clear();
+        _ifstream.open(filename.c_str(), ios::binary|ios::in);
+        if( !_ifstream ) {
+            RAVELOG_WARN_FORMAT("failed to open %s", filename);
+            return false;
+        }
+        char magic[sizeof(s_headerMagic)];
+        uint32_t version = 0;
+        _ifstream.read(magic, sizeof(magic));
+        _ifstream.read((char*)&version, sizeof(version));
+        if( !_ifstream || memcmp(magic, s_headerMagic, sizeof(magic)) != 0 || version != s_version ) {
+            RAVELOG_WARN_FORMAT("%s is not a state log", filename);
+            _ifstream.close();
+            return false;
+        }
+        _datastart = sizeof(s_headerMagic) + sizeof(version);
+        _ifstream.seekg(0, ios::end);
+        _dataend = _ifstream.tellg();
+
+        if( !_ReadIndex() ) {
+            RAVELOG_INFO_FORMAT("%s has no time index, probably because the recording did not stop, so rebuilding it", filename);
+            _RebuildIndex();
+        }
+        if( _vkeyframes.empty() ) {
+            RAVELOG_WARN_FORMAT("%s has no frames", filename);
+            _ifstream.close();
+            return false;
+        }
+        return true;
+    }
+
+    bool _GetTimeRangeCommand(ostream& sout, istream& sinput)
+    {
+        if( !_ifstream.is_open() ) {
+            return false;
+        }
+        sout << _starttime << " " << _endtime;
+        return true;
+    }
+
+    bool _GetKeyframeTimesCommand(ostream& sout, istream& sinput)
+    {
+        if( !_ifstream.is_open() ) {
+            return false;
+        }
+        FOREACHC(itkeyframe, _vkeyframes) {
+            sout << itkeyframe->first << " ";
+        }
+        return true;
+    }
+
+    bool _SeekCommand(ostream& sout, istream& sinput)
+    {
+        uint64_t timestamp = 0;
+        sinput >> timestamp;
+        if( !sinput || !_ifstream.is_open() ) {
+            return false;
+        }
+        _ReadStates(std::max(timestamp, _starttime));
+        EnvironmentLock lock(GetEnv()->GetMutex());
+        _RestoreStates();
+        return true;
+    }
+
+    /// \brief reads the record at the current position of the file into _payload. Returns false at the end of the frames.
+    bool _ReadRecord(uint8_t& type)
+    {
+        uint32_t size = 0;
+        uint64_t offset = _ifstream.tellg();
+        if( offset + sizeof(type) + sizeof(size) > _dataend ) {
+            return false;
+        }
+        _ifstream.read((char*)&type, sizeof(type));
+        _ifstream.read((char*)&size, sizeof(size));
+        if( !_ifstream || offset + sizeof(type) + sizeof(size) + size > _dataend ) {
+            // incomplete record at the end of a log that was not closed
+            return false;
+        }
+        _payload.resize(size);
+        _ifstream.read(&_payload[0], size);
+        return !!_ifstream && type != SRT_Index;
+    }
+
+    bool _ReadIndex()
+    {
+        uint64_t indexoffset = 0;
+        char magic[sizeof(s_indexMagic)];
+        if( _dataend < _datastart + sizeof(indexoffset) + sizeof(magic) ) {
+            return false;
+        }
+        _ifstream.clear();
+        _ifstream.seekg(_dataend - sizeof(indexoffset) - sizeof(magic));
+        _ifstream.read((char*)&indexoffset, sizeof(indexoffset));
+        _ifstream.read(magic, sizeof(magic));
+        if( !_ifstream || memcmp(magic, s_indexMagic, sizeof(magic)) != 0 || indexoffset < _datastart ) {
+            return false;
+        }
+        uint8_t type = 0;
+        uint32_t size = 0;
+        _ifstream.seekg(indexoffset);
+        _ifstream.read((char*)&type, sizeof(type));
+        _ifstream.read((char*)&size, sizeof(size));
+        if( !_ifstream || type != SRT_Index ) {
+            return false;
+        }
+        _payload.resize(size);
+        _ifstream.read(&_payload[0], size);
+        try {
+            BinaryReader reader(_payload.data(), _payload.size());
+            _starttime = reader.Read<uint64_t>();
+            _endtime = reader.Read<uint64_t>();
+            _vkeyframes.resize(reader.Read<uint32_t>());
+            FOREACH(itkeyframe, _vkeyframes) {
+                itkeyframe->first = reader.Read<uint64_t>();
+                itkeyframe->second = reader.Read<uint64_t>();
+            }
+        }
+        catch(const std::exception& ex) {
+            _vkeyframes.clear();
+            return false;
+        }
+        _dataend = indexoffset;
+        return true;
+    }
+
+    void _RebuildIndex()
+    {
+        _ifstream.clear();
+        _ifstream.seekg(_datastart);
+        uint8_t type = 0;
+        while(1) {
+            uint64_t offset = _ifstream.tellg();
+            if( !_ReadRecord(type) ) {
+                break;
+            }
+            if( _payload.size() < sizeof(uint64_t) ) {
+                continue;
+            }
+            uint64_t timestamp = 0;
+            memcpy(&timestamp, _payload.data(), sizeof(timestamp));
+            if( type == SRT_Keyframe ) {
+                if( _vkeyframes.empty() ) {
+                    _starttime = timestamp;
+                }
+                _vkeyframes.emplace_back(timestamp, offset);
+            }
+            else if( type == SRT_Frame ) {
+                _endtime = timestamp;
+            }
+        }
+        _ifstream.clear();
+    }
+
+    /// \brief reads the states at timestamp into _mapbodies starting from the last keyframe before it
+    void _ReadStates(uint64_t timestamp)
+    {
+        std::vector< std::pair<uint64_t, uint64_t> >::const_iterator itkeyframe = std::upper_bound(_vkeyframes.begin(), _vkeyframes.end(), std::make_pair(timestamp, std::numeric_limits<uint64_t>::max()));
+        if( itkeyframe != _vkeyframes.begin() ) {
+            --itkeyframe;
+        }
+        _mapbodies.clear();
+        _setRemovedBodyNames.clear();
+        _ifstream.clear();
+        _ifstream.seekg(itkeyframe->second);
+        bool bFirstRecord = true;
+        uint8_t type = 0;
+        while(_ReadRecord(type)) {
+            BinaryReader reader(_payload.data(), _payload.size());
+            uint64_t recordtime = reader.Read<uint64_t>();
+            if( recordtime > timestamp && !bFirstRecord ) {
+                break;
+            }
+            bFirstRecord = false;
+            if( type == SRT_BodyAdded ) {
+                uint32_t id = reader.Read<uint32_t>();
+                ReplayedBody& body = _mapbodies[id];
+                body = ReplayedBody();
+                body.bRobot = reader.Read<uint8_t>() != 0;
+                reader.ReadString(body.name);
+                reader.ReadString(body.uri);
+                _setRemovedBodyNames.erase(body.name);
+            }
+            else if( type == SRT_BodyRemoved ) {
+                std::map<uint32_t, ReplayedBody>::iterator itbody = _mapbodies.find(reader.Read<uint32_t>());
+                if( itbody != _mapbodies.end() ) {
+                    _setRemovedBodyNames.insert(itbody->second.name);
+                    _mapbodies.erase(itbody);
+                }
+            }
+            else if( type == SRT_Frame ) {
+                uint32_t numbodies = reader.Read<uint32_t>();
+                for(uint32_t ibody = 0; ibody < numbodies; ++ibody) {
+                    ReplayedBody& body = _mapbodies[reader.Read<uint32_t>()];
+                    uint8_t flags = reader.Read<uint8_t>();
+                    if( flags & BSF_Links ) {
+                        reader.ReadChangedValues(body.vlinktransforms);
+                    }
+                    if( flags & BSF_DOFValues ) {
+                        reader.ReadChangedValues(body.vdofvalues);
+                    }
+                    if( flags & BSF_Grabbed ) {
+                        reader.ReadGrabbed(body.vgrabbed);
+                        body.bHasGrabbed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    /// \brief sets the read states to the environment. The environment has to be locked.
+    void _RestoreStates()
+    {
+        std::vector< std::pair<KinBodyPtr, const ReplayedBody*> > vrestored;
+        vrestored.reserve(_mapbodies.size());
+        FOREACHC(itbody, _mapbodies) {
+            const ReplayedBody& body = itbody->second;
+            if( body.name.empty() ) {
+                continue;
+            }
+            KinBodyPtr pbody = GetEnv()->GetKinBody(body.name);
+            if( !pbody && !body.uri.empty() ) {
+                try {
+                    if( body.bRobot ) {
+                        pbody = GetEnv()->ReadRobotURI(body.uri);
+                    }
+                    else {
+                        pbody = GetEnv()->ReadKinBodyURI(body.uri);
+                    }
+                    if( !!pbody ) {
+                        pbody->SetName(body.name);
+                        GetEnv()->Add(pbody, IAM_StrictNameChecking);
+                    }
+                }
+                catch(const std::exception& ex) {
+                    RAVELOG_WARN_FORMAT("failed to load body %s from %s: %s", body.name%body.uri%ex.what());
+                    pbody.reset();
+                }
+            }
+            if( !pbody ) {
+                RAVELOG_VERBOSE_FORMAT("body %s is not in the environment", body.name);
+                continue;
+            }
+            _setRestoredBodyNames.insert(body.name);
+            vrestored.emplace_back(pbody, &body);
+        }
+
+        // release first so that moving grabbing bodies does not move the bodies they grabbed at a different time
+        FOREACH(itrestored, vrestored) {
+            if( itrestored->second->bHasGrabbed ) {
+                itrestored->first->ReleaseAllGrabbed();
+            }
+        }
+        FOREACH(itrestored, vrestored) {
+            KinBodyPtr pbody = itrestored->first;
+            const ReplayedBody& body = *itrestored->second;
+            if( body.vlinktransforms.size() != pbody->GetLinks().size() ) {
+                RAVELOG_WARN_FORMAT("body %s has %d links, but %d were recorded", body.name%pbody->GetLinks().size()%body.vlinktransforms.size());
+                continue;
+            }
+            if( (int)body.vdofvalues.size() == pbody->GetDOF() ) {
+                pbody->SetLinkTransformations(body.vlinktransforms, body.vdofvalues);
+            }
+            else {
+                pbody->SetLinkTransformations(body.vlinktransforms);
+            }
+        }
+        FOREACH(itrestored, vrestored) {
+            const ReplayedBody& body = *itrestored->second;
+            if( !body.bHasGrabbed || body.vgrabbed.empty() ) {
+                continue;
+            }
+            std::vector<KinBody::GrabbedInfoConstPtr> vgrabbedinfos;
+            FOREACHC(itgrabbed, body.vgrabbed) {
+                KinBody::GrabbedInfoPtr pinfo(new KinBody::GrabbedInfo());
+                pinfo->_grabbedname = itgrabbed->grabbedname;
+                pinfo->_robotlinkname = itgrabbed->linkname;
+                pinfo->_trelative = itgrabbed->trelative;
+                pinfo->_setIgnoreRobotLinkNames.insert(itgrabbed->vignorelinknames.begin(), itgrabbed->vignorelinknames.end());
+                vgrabbedinfos.push_back(pinfo);
+            }
+            itrestored->first->ResetGrabbed(vgrabbedinfos);
+        }
+
+        // remove the bodies that this replayer restored before but that do not exist at this time
+        std::set<std::string> setRemoveNames = _setRemovedBodyNames;
+        FOREACHC(itname, _setRestoredBodyNames) {
+            setRemoveNames.insert(*itname);
+        }
+        FOREACHC(itbody, _mapbodies) {
+            setRemoveNames.erase(itbody->second.name);
+        }
+        FOREACHC(itname, setRemoveNames) {
+            KinBodyPtr pbody = GetEnv()->GetKinBody(*itname);
+            if( !!pbody ) {
+                GetEnv()->Remove(pbody);
+            }
+            _setRestoredBodyNames.erase(*itname);
+        }
+    }
+
+    std::ifstream _ifstream;
+    uint64_t _datastart, _dataend; ///< file offsets of the records
+    uint64_t _starttime, _endtime;
+    std::vector< std::pair<uint64_t, uint64_t> > _vkeyframes; ///< timestamp and file offset of every keyframe
+    std::string _payload;
+    std::map<uint32_t, ReplayedBody> _mapbodies; ///< states read by the last seek
+    std::set<std::string> _setRemovedBodyNames; ///< bodies removed between the keyframe and the timestamp of the last seek
+    std::set<std::string> _setRestoredBodyNames; ///< bodies that the replayer set states to
+};
+
+} // end namespace staterecorder
+
+ModuleBasePtr CreateStateRecorder(EnvironmentBasePtr penv, std::istream& sinput) {
+    return ModuleBasePtr(new staterecorder::StateRecorder(penv,sinput));
+}
+
+ModuleBasePtr CreateStateReplayer(EnvironmentBasePtr penv, std::istream& sinput) {
+    return ModuleBasePtr(new staterecorder::StateReplayer(penv,sinput));
+}
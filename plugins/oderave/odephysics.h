@@ -148,6 +148,13 @@ public:
                 }
                 RAVELOG_DEBUG("Setting surface layer depth to: %f\n",_physics->_surfacelayer);
             }
+            else if( name == "numthreads") {
+                int temp=0;
+                _ss >> temp;
+                if( !!_ss ) {
+                    _physics->_SetNumThreads(temp);
+                }
+            }
             else {
                 RAVELOG_ERROR("unknown field %s\n", name.c_str());
             }
@@ -170,8 +177,8 @@ public:
             }
         }
 
-        static const boost::array<string, 11>& GetTags() {
-            static const boost::array<string, 11> tags = {{"friction","selfcollision", "gravity", "contact", "erp", "cfm", "elastic_reduction_parameter", "constraint_force_mixing", "dcontactapprox", "numiterations", "surfacelayer" }};
+        static const boost::array<string, 12>& GetTags() {
+            static const boost::array<string, 12> tags = {{"friction","selfcollision", "gravity", "contact", "erp", "cfm", "elastic_reduction_parameter", "constraint_force_mixing", "dcontactapprox", "numiterations", "surfacelayer", "numthreads" }};
             return tags;
         }
 
@@ -199,8 +206,10 @@ It is possible to set ODE physics engine and its properties inside the <environm
       <selfcollision>1</selfcollision>\n\
       <dcontactapprox>1</dcontactapprox>\n\
       <numiterations>1</numiterations>\n\
+      <numthreads>4</numthreads>\n\
     </odeproperties>\n\
   </physicsengine>\n\n\
+**numthreads** > 1 steps the independent contact islands of the world in several threads when ode has a threading implementation (ode >= 0.13), otherwise it has no effect. Contact generation (the collision of the geometry pairs and the creation of the contact joints) remains serial, so only the island stepping scales with the number of threads.\n\n\
 The possible properties that can be set are: ";
         FOREACHC(it, PhysicsPropertiesXMLReader::GetTags()) {
             ss << "**" << *it << "**, ";
@@ -216,6 +225,13 @@ The possible properties that can be set are: ";
         _surface_mode = 0;
         _surfacelayer = 0.001;
         _options = OpenRAVE::PEO_SelfCollisions;
+        _nNumThreads = 1;
+#ifdef ODE_HAVE_THREADING_IMPL
+        _threadingimpl = NULL;
+        _threadpool = NULL;
+#endif
+        RegisterCommand("SetNumThreads",boost::bind(&ODEPhysicsEngine::_SetNumThreadsCommand, this,_1,_2),
+                        "sets the number of threads used by SimulateStep to step the independent islands of the world. 0 uses one thread per hardware thread.");
 
         memset(_jointadd, 0, sizeof(_jointadd));
         _jointadd[dJointTypeBall] = DummyAddForce;
@@ -235,6 +251,7 @@ The possible properties that can be set are: ";
         _jointgetvel[dJointTypeHinge2].push_back(dJointGetHinge2Angle2Rate);
     }
     virtual ~ODEPhysicsEngine() {
+        _DestroyStepThreading();
         _odespace->Destroy();
     }
 
@@ -260,11 +277,13 @@ The possible properties that can be set are: ";
         dWorldSetCFM(_odespace->GetWorld(),_globalcfm);
         dWorldSetQuickStepNumIterations (_odespace->GetWorld(), _num_iterations);
         dWorldSetContactSurfaceLayer(_odespace->GetWorld(), _surfacelayer);
+        _InitStepThreading();
         return true;
     }
 
     virtual void DestroyEnvironment()
     {
+        _DestroyStepThreading();
         _listcallbacks.clear();
         _report.reset();
         _odespace->DestroyEnvironment();
@@ -326,6 +345,7 @@ The possible properties that can be set are: ";
             dWorldSetCFM(_odespace->GetWorld(),_globalcfm);
             dWorldSetQuickStepNumIterations (_odespace->GetWorld(), _num_iterations);
         }
+        _SetNumThreads(r->_nNumThreads);
     }
 
     virtual bool SetLinkVelocity(KinBody::LinkPtr plink, const Vector& _linearvel, const Vector& angularvel)
@@ -515,6 +535,7 @@ The possible properties that can be set are: ";
             }
         }
 
+        // with a threading implementation set, ode steps the independent islands of the world in parallel
         dWorldQuickStep(_odespace->GetWorld(), fTimeElapsed);
         dJointGroupEmpty (_odespace->GetContactGroup());
 
@@ -667,6 +688,86 @@ private:
         //        dJointAttach (c,b1,b2);
     }
 
+    bool _SetNumThreadsCommand(ostream& sout, istream& sinput)
+    {
+        int numthreads = 0;
+        sinput >> numthreads;
+        if( !sinput || numthreads < 0 ) {
+            return false;
+        }
+        _SetNumThreads(numthreads);
+        return true;
+    }
+
+    /// \param numthreads 0 uses one thread per hardware thread
+    void _SetNumThreads(int numthreads)
+    {
+        if( numthreads <= 0 ) {
+            numthreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if( numthreads == _nNumThreads ) {
+            return;
+        }
+        _nNumThreads = numthreads;
+        RAVELOG_DEBUG_FORMAT("env=%s, ode physics uses %d threads", GetEnv()->GetNameId()%_nNumThreads);
+#ifndef ODE_HAVE_THREADING_IMPL
+        if( _nNumThreads > 1 ) {
+            RAVELOG_DEBUG("ode does not have a threading implementation, so islands are stepped in one thread\n");
+        }
+#endif
+        if( !!_odespace && _odespace->IsInitialized() ) {
+            _InitStepThreading();
+        }
+    }
+
+    /// \brief lets ode step the islands of the world in _nNumThreads threads
+    void _InitStepThreading()
+    {
+        _DestroyStepThreading();
+#ifdef ODE_HAVE_THREADING_IMPL
+        if( _nNumThreads <= 1 ) {
+            return;
+        }
+        _threadingimpl = dThreadingAllocateMultiThreadedImplementation();
+        if( !_threadingimpl ) {
+            RAVELOG_WARN("ode is compiled without its threading implementation, so islands are stepped in one thread\n");
+            return;
+        }
+        // the stepping thread also processes islands
+        _threadpool = dThreadingAllocateThreadPool(_nNumThreads-1, 0, dAllocateFlagBasicData, NULL);
+        if( !_threadpool ) {
+            RAVELOG_WARN_FORMAT("env=%s, failed to allocate ode thread pool of %d threads", GetEnv()->GetNameId()%(_nNumThreads-1));
+            dThreadingFreeImplementation(_threadingimpl);
+            _threadingimpl = NULL;
+            return;
+        }
+        dThreadingThreadPoolServeMultiThreadedImplementation(_threadpool, _threadingimpl);
+        dWorldSetStepThreadingImplementation(_odespace->GetWorld(), dThreadingImplementationGetFunctions(_threadingimpl), _threadingimpl);
+        dWorldSetStepIslandsProcessingMaxThreadCount(_odespace->GetWorld(), _nNumThreads);
+#endif
+    }
+
+    void _DestroyStepThreading()
+    {
+#ifdef ODE_HAVE_THREADING_IMPL
+        if( !_threadingimpl ) {
+            return;
+        }
+        dThreadingImplementationShutdownProcessing(_threadingimpl);
+        if( !!_threadpool ) {
+            dThreadingThreadPoolWaitIdleState(_threadpool);
+            dThreadingFreeThreadPool(_threadpool);
+            _threadpool = NULL;
+        }
+        if( !!_odespace && _odespace->IsInitialized() ) {
+            dWorldSetStepThreadingImplementation(_odespace->GetWorld(), NULL, NULL);
+            dWorldSetStepIslandsProcessingMaxThreadCount(_odespace->GetWorld(), 1);
+        }
+        dThreadingFreeImplementation(_threadingimpl);
+        _threadingimpl = NULL;
+#endif
+    }
+
     void _SyncCallback(ODESpace::KinBodyInfoConstPtr pinfo)
     {
         // things very difficult when dynamics are not reset
@@ -706,6 +807,12 @@ private:
     vector<JointGetFn> _jointgetvel[12];
     std::list<EnvironmentBase::CollisionCallbackFn> _listcallbacks;
     CollisionReportPtr _report;
+
+    int _nNumThreads; ///< number of threads of SimulateStep
+#ifdef ODE_HAVE_THREADING_IMPL
+    dThreadingImplementationID _threadingimpl; ///< steps the islands of the world in parallel if _nNumThreads > 1
+    dThreadingThreadPoolID _threadpool;
+#endif
 };
 
 #endif
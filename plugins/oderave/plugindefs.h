@@ -55,6 +55,7 @@
 #include <stdint.h>
 #include <fstream>
 #include <iostream>
+#include <thread>
 
 #include <boost/assert.hpp>
 
@@ -53,6 +53,7 @@ public:
         _benablecol = true;
         _benabledis = false;
         _benabletol = false;
+        _options = 0;
     }
     virtual ~CollisionCheckerPQP() {
         DestroyEnvironment();
@@ -102,15 +103,17 @@ public:
         PQP_REAL p1[3], p2[3], p3[3];
         pinfo->vlinks.reserve(pbody->GetLinks().size());
         FOREACHC(itlink, pbody->GetLinks()) {
-            const TriMesh& trimesh = (*itlink)->GetCollisionData();
+            const CompactTriMesh& trimesh = (*itlink)->GetCompactCollisionData();
+            const std::vector<int32_t>& indices = trimesh.GetIndices();
             boost::shared_ptr<PQP_Model> pm;
-            if( trimesh.indices.size() > 0 ) {
+            if( indices.size() > 0 ) {
                 pm.reset(new PQP_Model());
-                pm->BeginModel(trimesh.indices.size()/3);
-                for(int j = 0; j < (int)trimesh.indices.size(); j+=3) {
-                    p1[0] = trimesh.vertices[trimesh.indices[j]].x;     p1[1] = trimesh.vertices[trimesh.indices[j]].y;     p1[2] = trimesh.vertices[trimesh.indices[j]].z;
-                    p2[0] = trimesh.vertices[trimesh.indices[j+1]].x;   p2[1] = trimesh.vertices[trimesh.indices[j+1]].y;     p2[2] = trimesh.vertices[trimesh.indices[j+1]].z;
-                    p3[0] = trimesh.vertices[trimesh.indices[j+2]].x;   p3[1] = trimesh.vertices[trimesh.indices[j+2]].y;     p3[2] = trimesh.vertices[trimesh.indices[j+2]].z;
+                pm->BeginModel(indices.size()/3);
+                for(int j = 0; j < (int)indices.size(); j+=3) {
+                    Vector vertex1 = trimesh.GetVertex(indices[j]), vertex2 = trimesh.GetVertex(indices[j+1]), vertex3 = trimesh.GetVertex(indices[j+2]);
+                    p1[0] = vertex1.x;     p1[1] = vertex1.y;     p1[2] = vertex1.z;
+                    p2[0] = vertex2.x;     p2[1] = vertex2.y;     p2[2] = vertex2.z;
+                    p3[0] = vertex3.x;     p3[1] = vertex3.y;     p3[2] = vertex3.z;
                     pm->AddTri(p1, p2, p3, j/3);
                 }
                 pm->EndModel();
@@ -588,14 +591,15 @@ private:
                     bcollision = true;
 
                     CollisionPairInfo& cpinfo = report->vCollisionInfos[icollision];
+                    const CompactTriMesh& trimesh1 = link1->GetCompactCollisionData(), &trimesh2 = link2->GetCompactCollisionData();
                     for(int i = 0; i < colres.NumPairs(); i++) {
-                        u1 = PQPRealToVector(link1->GetCollisionData().vertices[link1->GetCollisionData().indices[colres.Id1(i)*3]],R1,T1);
-                        u2 = PQPRealToVector(link1->GetCollisionData().vertices[link1->GetCollisionData().indices[colres.Id1(i)*3+1]],R1,T1);
-                        u3 = PQPRealToVector(link1->GetCollisionData().vertices[link1->GetCollisionData().indices[colres.Id1(i)*3+2]],R1,T1);
+                        u1 = PQPRealToVector(trimesh1.GetVertex(trimesh1.GetIndices()[colres.Id1(i)*3]),R1,T1);
+                        u2 = PQPRealToVector(trimesh1.GetVertex(trimesh1.GetIndices()[colres.Id1(i)*3+1]),R1,T1);
+                        u3 = PQPRealToVector(trimesh1.GetVertex(trimesh1.GetIndices()[colres.Id1(i)*3+2]),R1,T1);
 
-                        v1=PQPRealToVector(link2->GetCollisionData().vertices[link2->GetCollisionData().indices[colres.Id2(i)*3]],R2,T2);
-                        v2=PQPRealToVector(link2->GetCollisionData().vertices[link2->GetCollisionData().indices[colres.Id2(i)*3+1]],R2,T2);
-                        v3=PQPRealToVector(link2->GetCollisionData().vertices[link2->GetCollisionData().indices[colres.Id2(i)*3+2]],R2,T2);
+                        v1=PQPRealToVector(trimesh2.GetVertex(trimesh2.GetIndices()[colres.Id2(i)*3]),R2,T2);
+                        v2=PQPRealToVector(trimesh2.GetVertex(trimesh2.GetIndices()[colres.Id2(i)*3+1]),R2,T2);
+                        v3=PQPRealToVector(trimesh2.GetVertex(trimesh2.GetIndices()[colres.Id2(i)*3+2]),R2,T2);
 
                         if(TriTriCollision(u1,u2,u3,v1,v2,v3,contactpos,contactnorm)) {
                             cpinfo.contacts.push_back(CONTACT(contactpos,contactnorm,0.));
@@ -281,13 +281,13 @@ void KinBodyItem::Load()
                         psep->addChild(ptype);
                     }
 
-                    const TriMesh& mesh = geom->GetCollisionMesh();
+                    const CompactTriMesh& mesh = geom->GetCollisionMesh();
                     SoCoordinate3* vprop = new SoCoordinate3();
                     // this makes it crash!
-                    //vprop->point.set1Value(mesh.indices.size()-1,SbVec3f(0,0,0)); // resize
+                    //vprop->point.set1Value(mesh.GetIndices().size()-1,SbVec3f(0,0,0)); // resize
                     int i = 0;
-                    FOREACHC(itind, mesh.indices) {
-                        RaveVector<float> v = mesh.vertices[*itind];
+                    FOREACHC(itind, mesh.GetIndices()) {
+                        RaveVector<float> v = mesh.GetVertex(*itind);
                         vprop->point.set1Value(i++, SbVec3f(v.x,v.y,v.z));
                     }
 
@@ -295,8 +295,8 @@ void KinBodyItem::Load()
 
                     SoFaceSet* faceset = new SoFaceSet();
                     // this makes it crash!
-                    //faceset->numVertices.set1Value(mesh.indices.size()/3-1,3);
-                    for(size_t k = 0; k < mesh.indices.size()/3; ++k) {
+                    //faceset->numVertices.set1Value(mesh.GetIndices().size()/3-1,3);
+                    for(size_t k = 0; k < mesh.GetNumTriangles(); ++k) {
                         faceset->numVertices.set1Value(k,3);
                     }
                     psep->addChild(faceset);
@@ -465,19 +465,20 @@ void KinBodyItem::Load()
 
                     //geom->setColorBinding(osg::Geometry::BIND_OVERALL); // need to call geom->setColorArray first
 
-                    const TriMesh& mesh = orgeom->GetCollisionMesh();
+                    const CompactTriMesh& mesh = orgeom->GetCollisionMesh();
                     osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array();
-                    vertices->reserveArray(mesh.vertices.size());
-                    for(size_t i = 0; i < mesh.vertices.size(); ++i) {
-                        RaveVector<float> v = mesh.vertices[i];
+                    vertices->reserveArray(mesh.GetNumVertices());
+                    for(size_t i = 0; i < mesh.GetNumVertices(); ++i) {
+                        RaveVector<float> v = mesh.GetVertex(i);
                         vertices->push_back(osg::Vec3(v.x, v.y, v.z));
                     }
                     geom->setVertexArray(vertices.get());
 
 
-                    osg::DrawElementsUInt* geom_prim = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, mesh.indices.size());
-                    for(size_t i = 0; i < mesh.indices.size(); ++i) {
-                        (*geom_prim)[i] = mesh.indices[i];
+                    const std::vector<int32_t>& indices = mesh.GetIndices();
+                    osg::DrawElementsUInt* geom_prim = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, indices.size());
+                    for(size_t i = 0; i < indices.size(); ++i) {
+                        (*geom_prim)[i] = indices[i];
                     }
                     geom->addPrimitiveSet(geom_prim);
 
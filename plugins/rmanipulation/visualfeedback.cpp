@@ -16,31 +16,34 @@
 #include "commonmanipulation.h"
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/bind/bind.hpp>
+#include <atomic>
+#include <thread>
 
 using namespace boost::placeholders;
 
-/// samples rays from the projected OBB and returns true if the test function returns true
-/// for all the rays. Otherwise, returns false
-/// allowableoutliers - specifies the % of allowable outliying rays
-bool SampleProjectedOBBWithTest(const OBB& obb, dReal delta, const boost::function<bool(const Vector&)>& testfn,dReal allowableocclusion=0)
+/// samples ray directions from the projected OBB and appends them to vpoints
+/// obb - in the camera coordinate system
+/// allowableocclusion - specifies the % of allowable outliying rays
+/// returns the number of rays that are allowed to fail
+int SampleProjectedOBB(const OBB& obb, dReal delta, std::vector<Vector>& vpoints, dReal allowableocclusion=0)
 {
     dReal fscalefactor = 0.95f; // have to make box smaller or else rays might miss
-    Vector vpoints[8] = { obb.pos + fscalefactor*(obb.right*obb.extents.x + obb.up*obb.extents.y + obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(obb.right*obb.extents.x + obb.up*obb.extents.y - obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(obb.right*obb.extents.x - obb.up*obb.extents.y + obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(obb.right*obb.extents.x - obb.up*obb.extents.y - obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(-obb.right*obb.extents.x + obb.up*obb.extents.y + obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(-obb.right*obb.extents.x + obb.up*obb.extents.y - obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(-obb.right*obb.extents.x - obb.up*obb.extents.y + obb.dir*obb.extents.z),
-                          obb.pos + fscalefactor*(-obb.right*obb.extents.x - obb.up*obb.extents.y - obb.dir*obb.extents.z)};
+    Vector vcorners[8] = { obb.pos + fscalefactor*(obb.right*obb.extents.x + obb.up*obb.extents.y + obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(obb.right*obb.extents.x + obb.up*obb.extents.y - obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(obb.right*obb.extents.x - obb.up*obb.extents.y + obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(obb.right*obb.extents.x - obb.up*obb.extents.y - obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(-obb.right*obb.extents.x + obb.up*obb.extents.y + obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(-obb.right*obb.extents.x + obb.up*obb.extents.y - obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(-obb.right*obb.extents.x - obb.up*obb.extents.y + obb.dir*obb.extents.z),
+                           obb.pos + fscalefactor*(-obb.right*obb.extents.x - obb.up*obb.extents.y - obb.dir*obb.extents.z)};
     //    Vector vpoints3d[8];
-    //    for(int j = 0; j < 8; ++j) vpoints3d[j] = tcamera*vpoints[j];
+    //    for(int j = 0; j < 8; ++j) vpoints3d[j] = tcamera*vcorners[j];
 
     for(int i =0; i < 8; ++i) {
-        dReal fz = 1.0f/vpoints[i].z;
-        vpoints[i].x *= fz;
-        vpoints[i].y *= fz;
-        vpoints[i].z = 1;
+        dReal fz = 1.0f/vcorners[i].z;
+        vcorners[i].x *= fz;
+        vcorners[i].y *= fz;
+        vcorners[i].z = 1;
     }
 
     int faceindices[3][4];
@@ -68,9 +71,9 @@ bool SampleProjectedOBBWithTest(const OBB& obb, dReal delta, const boost::functi
         // have to compute the area of all the faces!
         dReal farea=0;
         for(int i = 0; i < 3; ++i) {
-            Vector v0 = vpoints[faceindices[i][0]];
-            Vector v1 = vpoints[faceindices[i][1]]-v0;
-            Vector v2 = vpoints[faceindices[i][2]]-v0;
+            Vector v0 = vcorners[faceindices[i][0]];
+            Vector v1 = vcorners[faceindices[i][1]]-v0;
+            Vector v2 = vcorners[faceindices[i][2]]-v0;
             Vector v = v1.cross(v2);
             farea += v.lengthsqr3();
         }
@@ -78,10 +81,10 @@ bool SampleProjectedOBBWithTest(const OBB& obb, dReal delta, const boost::functi
     }
 
     for(int i = 0; i < 3; ++i) {
-        Vector v0 = vpoints[faceindices[i][0]];
-        Vector v1 = vpoints[faceindices[i][1]]-v0;
-        Vector v2 = vpoints[faceindices[i][2]]-v0;
-        Vector v3 = vpoints[faceindices[i][3]]-v0;
+        Vector v0 = vcorners[faceindices[i][0]];
+        Vector v1 = vcorners[faceindices[i][1]]-v0;
+        Vector v2 = vcorners[faceindices[i][2]]-v0;
+        Vector v3 = vcorners[faceindices[i][3]]-v0;
         dReal f3length = RaveSqrt(v3.lengthsqr2());
         Vector v3norm = v3 * (1.0f/f3length);
         Vector v3perp(-v3norm.y,v3norm.x,0,0);
@@ -98,11 +101,7 @@ bool SampleProjectedOBBWithTest(const OBB& obb, dReal delta, const boost::functi
             int numsteps = (int)(ftotalen/delta);
             Vector vdelta = (vcur2-vcur1)*(1.0f/numsteps), vcur = vcur1;
             for(int k = 0; k <= numsteps; ++k, vcur += vdelta) {
-
-                if( !testfn(vcur) ) {
-                    if( nallowableoutliers-- <= 0 )
-                        return false;
-                }
+                vpoints.push_back(vcur);
             }
         }
 
@@ -125,15 +124,12 @@ bool SampleProjectedOBBWithTest(const OBB& obb, dReal delta, const boost::functi
             int numsteps = (int)(ftotalen/delta);
             Vector vdelta = (vcur2-vcur1)*(1.0f/numsteps), vcur = vcur1;
             for(int k = 0; k <= numsteps; ++k, vcur += vdelta) {
-                if( !testfn(vcur) ) {
-                    if( nallowableoutliers-- <= 0 )
-                        return false;
-                }
+                vpoints.push_back(vcur);
             }
         }
     }
 
-    return true;
+    return nallowableoutliers;
 }
 
 class VisualFeedback : public ModuleBase
@@ -255,6 +251,8 @@ public:
 
             _ikreturn.reset(new IkReturn(IKRA_Success));
             _bSamplingRays = false;
+            _fCameraSamplesRayDensity = 0;
+            _fCameraSamplesAllowableOcclusion = 0;
             if( _vf->_bIgnoreSensorCollision && !!_vf->_sensorrobot ) {
                 _collisionfn = _vf->_targetlink->GetParent()->GetEnv()->RegisterCollisionCallback(boost::bind(&VisibilityConstraintFunction::_IgnoreCollisionCallback,this,_1,_2));
             }
@@ -359,17 +357,16 @@ public:
         bool IsOccluded(const TransformMatrix& tCameraInTarget, bool bOutputError, std::string& errormsg)
         {
             KinBody::KinBodyStateSaver saver1(_ptargetbox), saver2(_vf->_targetlink->GetParent(),KinBody::Save_LinkEnable);
-            TransformMatrix tCameraInTargetinv = tCameraInTarget.inverse();
             Transform ttarget = _vf->_targetlink->GetTransform();
             _ptargetbox->SetTransform(ttarget); // world
             Transform tworldcamera = ttarget*tCameraInTarget;  // tCameraInTarget is in targetLink coordinates
             _ptargetbox->Enable(true);
             SampleRaysScope srs(*this);
             std::string occludingbodyandlinkname = "";
-            FOREACH(itobb,_vTargetLocalOBBs) {  // itobb is in targetlink coordinates
-                OBB cameraobb = geometry::TransformOBB(tCameraInTargetinv,*itobb);
-                // SampleProjectedOBBWithTest usually quits when first occlusion is found, so just passing occludingbodyandlinkname to _TestRay should return the initial occluding part.
-                if( !SampleProjectedOBBWithTest(cameraobb, _vf->_fSampleRayDensity, boost::bind(&VisibilityConstraintFunction::_TestRay, this, _1, boost::ref(tworldcamera), boost::ref(occludingbodyandlinkname)),_vf->_fAllowableOcclusion) ) {
+            _UpdateCameraSamples(tCameraInTarget);
+            for(size_t iobb = 0; iobb < _vTargetLocalOBBs.size(); ++iobb) {
+                // _TestRaysOneByOne quits when the allowed occlusions are exceeded, so just passing occludingbodyandlinkname to _TestRaysOneByOne should return the initial occluding part.
+                if( !_TestRaysOneByOne(_vvCameraSamples[iobb], _vCameraSamplesAllowableOutliers[iobb], tworldcamera, occludingbodyandlinkname) ) {
                     RAVELOG_VERBOSE("box is occluded\n");
                     errormsg = str(boost::format("{\"type\":\"pattern_occluded\", \"bodylinkname\":\"%s\"}")%occludingbodyandlinkname);
                     return true;
@@ -394,15 +391,13 @@ public:
                     (*itlink)->SetTransform(tsensorinv*(*itlink)->GetTransform());
                 }
             }
-            TransformMatrix tcamerainv = tcamera.inverse();
             Transform ttarget = _vf->_targetlink->GetTransform();
             _ptargetbox->SetTransform(ttarget);
-            Transform tworldcamera = ttarget*tcamera;
             _ptargetbox->Enable(true);
             SampleRaysScope srs(*this);
-            FOREACH(itobb,_vTargetLocalOBBs) {
-                OBB cameraobb = geometry::TransformOBB(tcamerainv,*itobb);
-                if( !SampleProjectedOBBWithTest(cameraobb, _vf->_fSampleRayDensity, boost::bind(&VisibilityConstraintFunction::_TestRayRigid, this, _1, boost::ref(tworldcamera),boost::ref(vattachedlinks)), 0.0f) ) {
+            _UpdateCameraSamples(tcamera);
+            FOREACHC(itsamples,_vvCameraSamples) {
+                if( !_TestRaysRigid(*itsamples) ) {
                     return true;
                 }
             }
@@ -410,16 +405,67 @@ public:
         }
 
 private:
+        /// \brief samples the ray directions of the target geometries in the camera coordinate system, unless they are already sampled for tCameraInTarget
+        ///
+        /// \param tCameraInTarget in target coordinate system
+        void _UpdateCameraSamples(const TransformMatrix& tCameraInTarget)
+        {
+            if( _vvCameraSamples.size() == _vTargetLocalOBBs.size() && _fCameraSamplesRayDensity == _vf->_fSampleRayDensity && _fCameraSamplesAllowableOcclusion == _vf->_fAllowableOcclusion && _IsSameTransform(tCameraInTarget, _tCameraSamplesInTarget) ) {
+                return;
+            }
+            TransformMatrix tCameraInTargetinv = tCameraInTarget.inverse();
+            _vvCameraSamples.resize(_vTargetLocalOBBs.size());
+            _vCameraSamplesAllowableOutliers.resize(_vTargetLocalOBBs.size());
+            for(size_t iobb = 0; iobb < _vTargetLocalOBBs.size(); ++iobb) {  // in targetlink coordinates
+                OBB cameraobb = geometry::TransformOBB(tCameraInTargetinv,_vTargetLocalOBBs[iobb]);
+                _vvCameraSamples[iobb].resize(0);
+                _vCameraSamplesAllowableOutliers[iobb] = SampleProjectedOBB(cameraobb, _vf->_fSampleRayDensity, _vvCameraSamples[iobb], _vf->_fAllowableOcclusion);
+            }
+            _tCameraSamplesInTarget = tCameraInTarget;
+            _fCameraSamplesRayDensity = _vf->_fSampleRayDensity;
+            _fCameraSamplesAllowableOcclusion = _vf->_fAllowableOcclusion;
+        }
+
+        static bool _IsSameTransform(const TransformMatrix& t0, const TransformMatrix& t1)
+        {
+            for(int i = 0; i < 12; ++i) {
+                if( t0.m[i] != t1.m[i] ) {
+                    return false;
+                }
+            }
+            return t0.trans.x == t1.trans.x && t0.trans.y == t1.trans.y && t0.trans.z == t1.trans.z;
+        }
+
+        /// \brief return true if at most nallowableoutliers rays are occluded
+        ///
+        /// This is not a batched query, every ray is a separate CheckCollision call through _TestRay. It stops at the first ray past nallowableoutliers.
+        /// \param vpoints ray directions in camera coordinate system
+        /// \param tcamera is the camera in the world coordinate system
+        bool _TestRaysOneByOne(const std::vector<Vector>& vpoints, int nallowableoutliers, const TransformMatrix& tcamera, std::string& errormsg)
+        {
+            // transform all the rays to the world first, then check them one at a time
+            _vrays.resize(vpoints.size());
+            for(size_t iray = 0; iray < vpoints.size(); ++iray) {
+                dReal filen = 1/RaveSqrt(vpoints[iray].lengthsqr3());
+                _vrays[iray].dir = tcamera.rotate((200.0f*filen)*vpoints[iray]);                 // hardcoded test ray length of 200 meters
+                _vrays[iray].pos = tcamera.trans + 0.5f*_vf->_fRayMinDist*_vrays[iray].dir;      // move the rays a little forward
+            }
+            _ttargetinv = _vf->_targetlink->GetTransform().inverse();
+            FOREACHC(itray, _vrays) {
+                if( !_TestRay(*itray, errormsg) ) {
+                    if( nallowableoutliers-- <= 0 ) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
         /// \brief return true if not occluded by any other target (ray hits the intended target box)
         ///
-        /// \brief v is in camera coordinate system
-        /// \brief tcamera is the camera in the world coordinate system
-        bool _TestRay(const Vector& v, const TransformMatrix& tcamera, std::string& errormsg)
+        /// \brief r is in the world coordinate system
+        bool _TestRay(const RAY& r, std::string& errormsg)
         {
-            RAY r;
-            dReal filen = 1/RaveSqrt(v.lengthsqr3());
-            r.dir = tcamera.rotate((200.0f*filen)*v);                     // hardcoded test ray length of 200 meters
-            r.pos = tcamera.trans + 0.5f*_vf->_fRayMinDist*r.dir;         // move the rays a little forward
             if( !_vf->_robot->GetEnv()->CheckCollision(r,_report) ) {
                 return true;         // not supposed to happen, but it is OK
             }
@@ -449,8 +495,7 @@ private:
                     // the original link is returned, have to check if the collision point is within _ptargetbox since we could be targeting one specific geometry rather than others.
                     if( cpinfo.contacts.size() > 0 ) {
                         // transform the contact point into the target link coordinate system
-                        Transform ttarget = _vf->_targetlink->GetTransform();
-                        Vector vintargetlink = ttarget.inverse()*cpinfo.contacts.at(0).pos;
+                        Vector vintargetlink = _ttargetinv*cpinfo.contacts.at(0).pos;
                         // if vertex is inside any of the OBBs, then return true. Note: assumes that the original geometries are a box
                         bool bInside = false;
                         FOREACH(itobb, _vTargetLocalOBBs) {
@@ -481,13 +526,22 @@ private:
             }
         }
 
-        bool _TestRayRigid(const Vector& v, const TransformMatrix& tcamera, const vector<KinBody::LinkPtr>& vattachedlinks)
+        /// \brief return true if none of the rays hits the robot
+        ///
+        /// \param vpoints ray directions in camera coordinate system, the robot links are in the camera coordinate system too
+        bool _TestRaysRigid(const std::vector<Vector>& vpoints)
         {
-            dReal filen = 1/RaveSqrt(v.lengthsqr3());
-            RAY r((_vf->_fRayMinDist*filen)*v,(200.0f*filen)*v);           // hardcoded test ray length of 200 meters
-            if( _vf->_robot->GetEnv()->CheckCollision(r,KinBodyConstPtr(_vf->_robot),_report) ) {
-                //RAVELOG_INFO(str(boost::format("ray col: %s\n")%_report->__str__()));
-                return false;
+            _vrays.resize(vpoints.size());
+            for(size_t iray = 0; iray < vpoints.size(); ++iray) {
+                dReal filen = 1/RaveSqrt(vpoints[iray].lengthsqr3());
+                _vrays[iray] = RAY((_vf->_fRayMinDist*filen)*vpoints[iray],(200.0f*filen)*vpoints[iray]);           // hardcoded test ray length of 200 meters
+            }
+            KinBodyConstPtr probot(_vf->_robot);
+            FOREACHC(itray, _vrays) {
+                if( _vf->_robot->GetEnv()->CheckCollision(*itray,probot,_report) ) {
+                    //RAVELOG_INFO(str(boost::format("ray col: %s\n")%_report->__str__()));
+                    return false;
+                }
             }
             return true;
         }
@@ -545,6 +599,13 @@ private:
         AABB _abTarget;         // local aabb in the targetlink coordinate system
         vector<Vector> _vconvexplanes3d; ///< the convex planes of the camera in the target link coordinate system
         PlannerBase::PlannerParameters::CheckPathVelocityConstraintFn _oldfn;
+
+        TransformMatrix _tCameraSamplesInTarget; ///< camera in the target coordinate system that _vvCameraSamples were sampled for
+        dReal _fCameraSamplesRayDensity, _fCameraSamplesAllowableOcclusion; ///< parameters that _vvCameraSamples were sampled with
+        vector< vector<Vector> > _vvCameraSamples; ///< for every target OBB, the ray directions in camera coordinate system
+        vector<int> _vCameraSamplesAllowableOutliers; ///< for every target OBB, the number of rays that can be occluded
+        vector<RAY> _vrays; ///< cache
+        Transform _ttargetinv; ///< inverse of the target link transform while testing rays
     };
 
     class GoalSampleFunction
@@ -614,6 +675,7 @@ Visibility computation checks occlusion with other objects using ray sampling in
         _fSampleRayDensity = 0.001;
         _fAllowableOcclusion = 0.1;
         _fRayMinDist = 0.02f;
+        _nNumThreads = 1;
 
         RegisterCommand("SetCameraAndTarget",boost::bind(&VisualFeedback::SetCameraAndTarget,this,_1,_2),
                         "Sets the camera index from the robot and its convex hull");
@@ -627,7 +689,10 @@ Visibility computation checks occlusion with other objects using ray sampling in
         RegisterCommand("ComputeVisibility",boost::bind(&VisualFeedback::ComputeVisibility,this,_1,_2),
                         "Computes the visibility of the current robot configuration");
         RegisterCommand("ComputeVisibleConfiguration",boost::bind(&VisualFeedback::ComputeVisibleConfiguration,this,_1,_2),
-                        "Gives a camera transformation, computes the visibility of the object and returns the robot configuration that takes the camera to its specified position, otherwise returns false");
+                        "Gives a camera transformation, computes the visibility of the object and returns the robot configuration that takes the camera to its specified position, otherwise returns false.\n\
+\n\
+:param pose: the camera transformation, either pose or poses has to be given\n\
+:param poses: number of camera transformations followed by the transformations. Returns the result of every transformation in a results list, every transformation starts from the current robot configuration. If the numthreads parameter is > 1, the transformations are processed in parallel on cloned environments.");
         RegisterCommand("SampleVisibilityGoal",boost::bind(&VisualFeedback::SampleVisibilityGoal,this,_1,_2),
                         "Samples a goal with the current manipulator maintaining camera visibility constraints");
         RegisterCommand("MoveToObserveTarget",boost::bind(&VisualFeedback::MoveToObserveTarget,this,_1,_2),
@@ -639,10 +704,12 @@ Visibility computation checks occlusion with other objects using ray sampling in
     }
 
     virtual ~VisualFeedback() {
+        _DestroyStreams();
     }
 
     void Destroy()
     {
+        _DestroyStreams();
         _robot.reset();
         _sensorrobot.reset();
         _targetlink.reset();
@@ -1188,6 +1255,16 @@ Visibility computation checks occlusion with other objects using ray sampling in
             else if( cmd == "allowableocclusion" ) {
                 sinput >> _fAllowableOcclusion;
             }
+            else if( cmd == "numthreads" ) {
+                int numthreads = 0;
+                sinput >> numthreads;
+                if( !sinput || numthreads < 0 ) {
+                    RAVELOG_ERROR_FORMAT("env=%s, numthreads needs to be >= 0", GetEnv()->GetNameId());
+                    return false;
+                }
+                // 0 uses one thread per hardware thread
+                _nNumThreads = numthreads > 0 ? numthreads : std::max(1u, std::thread::hardware_concurrency());
+            }
             else {
                 RAVELOG_WARN(str(boost::format("unrecognized command: %s\n")%cmd));
                 break;
@@ -1204,7 +1281,8 @@ Visibility computation checks occlusion with other objects using ray sampling in
     bool ComputeVisibleConfiguration(ostream& sout, istream& sinput)
     {
         string cmd;
-        Transform t;  // In world coordinate system
+        vector<Transform> vposes;  // In world coordinate system
+        bool bMultiplePoses = false;
         while(!sinput.eof()) {
             sinput >> cmd;
             if( !sinput ) {
@@ -1213,7 +1291,17 @@ Visibility computation checks occlusion with other objects using ray sampling in
             std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
 
             if( cmd == "pose" ) {
-                sinput >> t;
+                vposes.resize(1);
+                sinput >> vposes[0];
+            }
+            else if( cmd == "poses" ) {
+                size_t numposes=0;
+                sinput >> numposes;
+                vposes.resize(numposes);
+                for(size_t i = 0; i < numposes; ++i) {
+                    sinput >> vposes[i];
+                }
+                bMultiplePoses = true;
             }
             else {
                 RAVELOG_WARN(str(boost::format("unrecognized command: %s\n")%cmd));
@@ -1225,27 +1313,103 @@ Visibility computation checks occlusion with other objects using ray sampling in
                 return false;
             }
         }
+        if( vposes.size() == 0 && !bMultiplePoses ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("ComputeVisibleConfiguration needs pose or poses", ORE_InvalidArguments);
+        }
 
-        vector<dReal> vsample;
-        RobotBase::RobotStateSaver saver(_robot);
-        _robot->SetActiveManipulator(_pmanip);
-        _robot->SetActiveDOFs(_pmanip->GetArmIndices());
-        boost::shared_ptr<VisibilityConstraintFunction> pconstraintfn(new VisibilityConstraintFunction(shared_problem()));
+        vector<string> vresults(vposes.size());
+        _ComputeVisibleConfigurations(vposes, vresults, sout.precision());
+        if( !bMultiplePoses ) {
+            sout << vresults.at(0);
+            return true;
+        }
+
+        sout << "{\"results\":[";
+        for(size_t i = 0; i < vresults.size(); ++i) {
+            if( i > 0 ) {
+                sout << ",";
+            }
+            sout << vresults[i];
+        }
+        sout << "]}";
+        return true;
+    }
+
+    /// \brief computes the result of ComputeVisibleConfiguration for every camera pose in vposes
+    ///
+    /// Every pose starts from the current robot configuration, so the results do not depend on the order the poses are processed in.
+    /// If _nNumThreads > 1, the poses are distributed over this environment and _nNumThreads-1 cloned environments that are each processed in their own thread.
+    void _ComputeVisibleConfigurations(const vector<Transform>& vposes, vector<string>& vresults, std::streamsize precision)
+    {
+        if( vposes.empty() ) {
+            return;
+        }
+        const size_t numstreams = std::min((size_t)_nNumThreads, vposes.size());
+        if( numstreams > 1 ) {
+            _InitStreams(numstreams-1);
+        }
+        std::atomic<size_t> nextpose(0);
+        std::atomic<bool> bAbort(false);
+        std::vector<std::exception_ptr> vExceptions(numstreams);
+        const auto runStream = [&](size_t istream) {
+            try {
+                EnvironmentLock lock(istream > 0 ? _vstreams[istream-1]->penv->GetMutex() : GetEnv()->GetMutex(), OpenRAVE::defer_lock_t());
+                if( istream > 0 ) {
+                    lock.lock();
+                }
+                VisualFeedback& vf = istream > 0 ? *_vstreams[istream-1]->pvf : *this;
+                RobotBase::RobotStateSaver saver(vf._robot);
+                vf._robot->SetActiveManipulator(vf._pmanip);
+                vf._robot->SetActiveDOFs(vf._pmanip->GetArmIndices());
+                VisibilityConstraintFunction constraintfn(vf.shared_problem());
+                size_t ipose;
+                while( !bAbort && (ipose = nextpose++) < vposes.size() ) {
+                    RobotBase::RobotStateSaver posesaver(vf._robot);
+                    stringstream ss;
+                    ss.precision(precision);
+                    vf._ComputeVisibleConfiguration(constraintfn, vposes[ipose], ss);
+                    vresults[ipose] = ss.str();
+                }
+            }
+            catch(...) {
+                vExceptions[istream] = std::current_exception();
+                bAbort = true;
+            }
+        };
+
+        std::vector<boost::shared_ptr<std::thread> > vThreads;
+        for(size_t istream = 1; istream < numstreams; ++istream) {
+            vThreads.push_back(boost::make_shared<std::thread>(runStream, istream));
+        }
+        runStream(0);
+        FOREACH(itThread, vThreads) {
+            (*itThread)->join();
+        }
+        FOREACHC(itException, vExceptions) {
+            if( !!*itException ) {
+                std::rethrow_exception(*itException);
+            }
+        }
+    }
 
+    /// \brief writes the json result of ComputeVisibleConfiguration for the camera pose t
+    void _ComputeVisibleConfiguration(VisibilityConstraintFunction& constraintfn, const Transform& t, ostream& sout)
+    {
         if( _pmanip->CheckEndEffectorCollision(t*_tToManip, _preport) ) {
             RAVELOG_VERBOSE_FORMAT("endeffector is in collision, %s\n",_preport->__str__());
             std::string errormsg = _preport->__str__();
             boost::replace_all(errormsg, "\"", "\\\"");
             sout << "{\"error\":{\"type\":\"endeffector\", \"report\":\"" << errormsg << "\"}}";
-            return true;
+            return;
         }
+        vector<dReal> vsample;
         std::string errormsg;
-        if( !pconstraintfn->SampleWithCamera(t,vsample, true, errormsg) ) {
+        if( !constraintfn.SampleWithCamera(t,vsample, true, errormsg) ) {
             // TODO have better error message on why this failed!
             //boost::replace_all(errormsg, "\"", "\\\"");   // error message
             //already has escape characters at this point
             sout << "{\"error\":" << errormsg << "}";
-            return true;
+            return;
         }
 
         // have a sample!
@@ -1257,7 +1421,53 @@ Visibility computation checks occlusion with other objects using ray sampling in
             sout << vsample[i];
         }
         sout << "]}";
-        return true;
+    }
+
+    /// \brief creates streams until there are numstreams of them, and clones this environment and the visibility parameters into them
+    ///
+    /// The VisualFeedback of a stream is created once and kept, later calls only update its robot, sensor and target pointers and its parameters.
+    void _InitStreams(size_t numstreams)
+    {
+        for(size_t istream = 0; istream < numstreams; ++istream) {
+            if( istream >= _vstreams.size() ) {
+                VisibilityStreamPtr pstream(new VisibilityStream());
+                pstream->penv = GetEnv()->CloneSelf(Clone_Bodies);
+                _vstreams.push_back(pstream);
+            }
+            else {
+                // reuses the bodies that did not change
+                _vstreams[istream]->penv->Clone(GetEnv(), Clone_Bodies);
+            }
+
+            VisibilityStream& stream = *_vstreams[istream];
+            EnvironmentLock lock(stream.penv->GetMutex());
+            if( !stream.pvf ) {
+                stream.pvf.reset(new VisualFeedback(stream.penv));
+            }
+            VisualFeedback& vf = *stream.pvf;
+            vf._robot = stream.penv->GetRobot(_robot->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!vf._robot, "env=%s, could not find robot %s in cloned environment", GetEnv()->GetNameId()%_robot->GetName(), ORE_Failed);
+            vf._sensorrobot = stream.penv->GetRobot(_sensorrobot->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!vf._sensorrobot, "env=%s, could not find robot %s in cloned environment", GetEnv()->GetNameId()%_sensorrobot->GetName(), ORE_Failed);
+            KinBodyPtr ptarget = stream.penv->GetKinBody(_targetlink->GetParent()->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!ptarget, "env=%s, could not find body %s in cloned environment", GetEnv()->GetNameId()%_targetlink->GetParent()->GetName(), ORE_Failed);
+            vf._targetlink = ptarget->GetLinks().at(_targetlink->GetIndex());
+            vf._psensor = vf._sensorrobot->GetAttachedSensor(_psensor->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!vf._psensor, "env=%s, could not find sensor %s in cloned environment", GetEnv()->GetNameId()%_psensor->GetName(), ORE_Failed);
+            vf._pmanip = vf._robot->GetManipulator(_pmanip->GetName());
+            OPENRAVE_ASSERT_FORMAT(!!vf._pmanip, "env=%s, could not find manipulator %s in cloned environment", GetEnv()->GetNameId()%_pmanip->GetName(), ORE_Failed);
+            vf._bIgnoreSensorCollision = _bIgnoreSensorCollision;
+            vf._targetGeomName = _targetGeomName;
+            vf._fMaxVelMult = _fMaxVelMult;
+            vf._bCameraOnManip = _bCameraOnManip;
+            vf._pcamerageom = _pcamerageom;
+            vf._tToManip = _tToManip;
+            vf._fRayMinDist = _fRayMinDist;
+            vf._fAllowableOcclusion = _fAllowableOcclusion;
+            vf._fSampleRayDensity = _fSampleRayDensity;
+            vf._vconvexplanes = _vconvexplanes;
+            vf._vcenterconvex = _vcenterconvex;
+        }
     }
 
     bool SampleVisibilityGoal(ostream& sout, istream& sinput)
@@ -1554,6 +1764,15 @@ Visibility computation checks occlusion with other objects using ray sampling in
         return false;
     }
 
+    void _DestroyStreams()
+    {
+        FOREACH(itstream, _vstreams) {
+            (*itstream)->pvf.reset();
+            (*itstream)->penv->Destroy();
+        }
+        _vstreams.clear();
+    }
+
 protected:
     RobotBasePtr _robot, _sensorrobot;
     bool _bIgnoreSensorCollision; ///< if true will ignore any collisions with vf->_sensorrobot
@@ -1572,6 +1791,17 @@ protected:
 
     vector<Vector> _vconvexplanes;     ///< the planes defining the bounding visibility region (posive is inside). Inside camera coordinate system
     Vector _vcenterconvex;     ///< center point on the z=1 plane of the convex region
+
+    int _nNumThreads; ///< number of threads evaluating camera poses in parallel
+
+    /// \brief cloned environment for evaluating camera poses in parallel
+    struct VisibilityStream
+    {
+        EnvironmentBasePtr penv;
+        boost::shared_ptr<VisualFeedback> pvf; ///< has the robot, sensor and target of penv and the parameters of this module
+    };
+    typedef boost::shared_ptr<VisibilityStream> VisibilityStreamPtr;
+    std::vector<VisibilityStreamPtr> _vstreams;
 };
 
 ModuleBasePtr CreateVisualFeedback(EnvironmentBasePtr penv) {
@@ -29,7 +29,7 @@ struct ManipConstraintInfo2
 
     RobotBase::ManipulatorPtr pmanip; ///< the manipulator
     KinBody::LinkPtr plink; ///< the end-effector of the manipulator
-    std::list<Vector> checkpoints; ///< points (in EE frame) at which to check
+    std::vector<Vector> checkpoints; ///< points (in EE frame) at which to check
                                    ///manipconstraints. Currently they are vertices of the bounding
                                    ///box but they can be more general, e.g., the vertices of the
                                    ///convex hull.
@@ -45,7 +45,7 @@ public:
     }
 
     /// \brief Given a world AABB oriented, return its 8 vertices. All vertices are describted in the parent frame (see ComputeEnclosingAABB).
-    static void ConvertAABBtoCheckPoints(const AABB& ab, std::list<Vector>& checkpoints)
+    static void ConvertAABBtoCheckPoints(const AABB& ab, std::vector<Vector>& checkpoints)
     {
         dReal signextents[24] = {1,1,1,   1,1,-1,  1,-1,1,   1,-1,-1,  -1,1,1,   -1,1,-1,  -1,-1,1,   -1,-1,-1};
         Vector incr;
@@ -373,8 +373,8 @@ public:
                                            // usual procedure.
         dReal fMaxReductionFactor = 1; // scaling factor for the DOF with least contribution to constriant violation
 
-        Vector endeffvellin, endeffvelang, endeffacclin, endeffaccang;
         dReal maxactualmanipspeed = 0, maxactualmanipaccel = 0;
+        dReal maxactualmanipspeed2 = 0, maxactualmanipaccel2 = 0; // squared maxima, the square root is only taken once per ramp end
 
         dReal multiplier = 0.85;     // a multiplier to the scaling factor computed from the ratio between the violating value and the bound
         int retcode = 0;
@@ -385,7 +385,6 @@ public:
         int velViolationIndex = -1; // index to manipinfo that violates manip vel constraint (-1 if constraints are respected)
         int accelViolationIndex = -1; // index to manipinfo that violates manip accel constraint (-1 if constraints are respected)
         Vector vVelViolation, vAccelViolation;
-        int curmanipindex = 0;
         bool bBoundExceeded = false;
 
         std::vector<dReal>& vDOFValuesAtViolation = _vdofvalues, &vDOFVelAtViolation = _vdofvelocities, &vDOFAccelAtViolation = _vdofaccelerations;
@@ -394,70 +393,9 @@ public:
         vDOFAccelAtViolation.resize(0);
 
         if( !(interval == IT_OpenStart) ) {
-            FOREACHC(itmanipinfo, _listCheckManips) {
-                bBoundExceeded = false;
-                KinBodyPtr probot = itmanipinfo->plink->GetParent();
-                itrampnd->GetAVect(ac);
-                qfillactive.resize(itmanipinfo->vuseddofindices.size());
-                _vfillactive.resize(itmanipinfo->vuseddofindices.size());
-                _afill.resize(probot->GetDOF());
-                for(size_t index = 0; index < itmanipinfo->vuseddofindices.size(); ++index) {
-                    qfillactive[index] = itrampnd->GetX0At(itmanipinfo->vconfigindices.at(index));
-                    _vfillactive[index] = itrampnd->GetV0At(itmanipinfo->vconfigindices[index]);
-                    _afill[itmanipinfo->vuseddofindices.at(index)] = ac.at(itmanipinfo->vconfigindices[index]);
-                }
-
-                int endeffindex = itmanipinfo->plink->GetIndex();
-                KinBody::KinBodyStateSaver saver(probot, KinBody::Save_LinkTransformation|KinBody::Save_LinkVelocities);
-
-                // Set the robot to the new state
-                probot->SetDOFValues(qfillactive, KinBody::CLA_CheckLimits, itmanipinfo->vuseddofindices);
-                probot->SetDOFVelocities(_vfillactive, KinBody::CLA_CheckLimits, itmanipinfo->vuseddofindices);
-                probot->GetLinkVelocities(endeffvels);
-                probot->GetLinkAccelerations(_afill,endeffaccs);
-                endeffvellin = endeffvels.at(endeffindex).first;
-                endeffvelang = endeffvels.at(endeffindex).second;
-                endeffacclin = endeffaccs.at(endeffindex).first;
-                endeffaccang = endeffaccs.at(endeffindex).second;
-                Transform R = itmanipinfo->plink->GetTransform();
-
-                FOREACH(itpoint, itmanipinfo->checkpoints) {
-                    Vector point = R.rotate(*itpoint);
-
-                    if( _maxmanipspeed > 0 ) {
-                        // Compute the linear velocity: v_total = v + w x r
-                        Vector vpoint = endeffvellin + endeffvelang.cross(point);
-                        dReal actualmanipspeed = RaveSqrt(vpoint.lengthsqr3());
-                        if( actualmanipspeed > maxactualmanipspeed ) {
-                            bBoundExceeded = true;
-                            maxactualmanipspeed = actualmanipspeed;
-                            velViolationIndex = curmanipindex;
-                            vVelViolation = vpoint;
-                        }
-                    }
-
-                    if( _maxmanipaccel > 0 ) {
-                        // Compute the linear acceleration: a_total = a + w x (w x r) + (alpha x r)
-                        Vector apoint = endeffacclin + endeffvelang.cross(endeffvelang.cross(point)) + endeffaccang.cross(point);
-                        dReal actualmanipaccel = RaveSqrt(apoint.lengthsqr3());
-                        if( actualmanipaccel > maxactualmanipaccel ) {
-                            bBoundExceeded = true;
-                            maxactualmanipaccel = actualmanipaccel;
-                            accelViolationIndex = curmanipindex;
-                            vAccelViolation = apoint;
-                        }
-                    }
-                }
-                if( bBoundExceeded ) {
-                    // Keep these values for later computation if constraints are violated
-                    vDOFValuesAtViolation = qfillactive;
-                    vDOFVelAtViolation = _vfillactive;
-                    vDOFAccelAtViolation = _afill;
-                }
-                // Finished iterating through all checkpoints
-                ++curmanipindex;
-            }
-            // Finished iterating through all manipulators
+            _CheckManipsAtRampEnd(*itrampnd, true, maxactualmanipspeed2, maxactualmanipaccel2, velViolationIndex, accelViolationIndex, vVelViolation, vAccelViolation);
+            maxactualmanipspeed = RaveSqrt(maxactualmanipspeed2);
+            maxactualmanipaccel = RaveSqrt(maxactualmanipaccel2);
 
             if( bUseNewHeuristic ) {
                 RampOptimizerInternal::CheckReturn retcheck;
@@ -677,70 +615,9 @@ public:
 
         // Check manipspeed and manipaccel at the end of the segment
         itrampnd = rampndVect.end() - 1;
-        curmanipindex = 0;
-        FOREACHC(itmanipinfo, _listCheckManips) {
-            bBoundExceeded = false;
-            KinBodyPtr probot = itmanipinfo->plink->GetParent();
-            itrampnd->GetAVect(ac);
-            qfillactive.resize(itmanipinfo->vuseddofindices.size());
-            _vfillactive.resize(itmanipinfo->vuseddofindices.size());
-            _afill.resize(probot->GetDOF());
-            for(size_t index = 0; index < itmanipinfo->vuseddofindices.size(); ++index) {
-                qfillactive[index] = itrampnd->GetX1At(itmanipinfo->vconfigindices.at(index));
-                _vfillactive[index] = itrampnd->GetV1At(itmanipinfo->vconfigindices[index]);
-                _afill[itmanipinfo->vuseddofindices.at(index)] = ac.at(itmanipinfo->vconfigindices[index]);
-            }
-
-            int endeffindex = itmanipinfo->plink->GetIndex();
-            KinBody::KinBodyStateSaver saver(probot, KinBody::Save_LinkTransformation|KinBody::Save_LinkVelocities);
-
-            // Set the robot to the new state
-            probot->SetDOFValues(qfillactive, KinBody::CLA_CheckLimits, itmanipinfo->vuseddofindices);
-            probot->SetDOFVelocities(_vfillactive, KinBody::CLA_CheckLimits, itmanipinfo->vuseddofindices);
-            probot->GetLinkVelocities(endeffvels);
-            probot->GetLinkAccelerations(_afill,endeffaccs);
-            endeffvellin = endeffvels.at(endeffindex).first;
-            endeffvelang = endeffvels.at(endeffindex).second;
-            endeffacclin = endeffaccs.at(endeffindex).first;
-            endeffaccang = endeffaccs.at(endeffindex).second;
-            Transform R = itmanipinfo->plink->GetTransform();
-
-            FOREACH(itpoint, itmanipinfo->checkpoints) {
-                Vector point = R.rotate(*itpoint);
-
-                if( _maxmanipspeed > 0 ) {
-                    // Compute the linear velocity: v_total = v + w x r
-                    Vector vpoint = endeffvellin + endeffvelang.cross(point);
-                    dReal actualmanipspeed = RaveSqrt(vpoint.lengthsqr3());
-                    if( actualmanipspeed > maxactualmanipspeed ) {
-                        bBoundExceeded = true;
-                        maxactualmanipspeed = actualmanipspeed;
-                        velViolationIndex = curmanipindex;
-                        vVelViolation = vpoint;
-                    }
-                }
-
-                if( _maxmanipaccel > 0 ) {
-                    // Compute the linear acceleration: a_total = a + w x (w x r) + (alpha x r)
-                    Vector apoint = endeffacclin + endeffvelang.cross(endeffvelang.cross(point)) + endeffaccang.cross(point);
-                    dReal actualmanipaccel = RaveSqrt(apoint.lengthsqr3());
-                    if( actualmanipaccel > maxactualmanipaccel ) {
-                        bBoundExceeded = true;
-                        maxactualmanipaccel = actualmanipaccel;
-                        accelViolationIndex = curmanipindex;
-                        vAccelViolation = apoint;
-                    }
-                }
-            }
-            if( bBoundExceeded ) {
-                vDOFValuesAtViolation = qfillactive;
-                vDOFVelAtViolation = _vfillactive;
-                vDOFAccelAtViolation = _afill;
-            }
-            // Finished iterating through all checkpoints
-            ++curmanipindex;
-        }
-        // Finished iterating through all manipulators
+        _CheckManipsAtRampEnd(*itrampnd, false, maxactualmanipspeed2, maxactualmanipaccel2, velViolationIndex, accelViolationIndex, vVelViolation, vAccelViolation);
+        maxactualmanipspeed = RaveSqrt(maxactualmanipspeed2);
+        maxactualmanipaccel = RaveSqrt(maxactualmanipaccel2);
 
         if( bUseNewHeuristic ) {
             RampOptimizerInternal::CheckReturn retcheck;
@@ -944,6 +821,96 @@ public:
     }
 
 private:
+    /// \brief evaluates the speed and acceleration of every checkpoint of every manipulator at one end of rampnd
+    ///
+    /// The velocity and acceleration of a point p fixed in the end-effector frame are affine in p:
+    ///   v(p) = v + w x (R*p)
+    ///   a(p) = a + alpha x (R*p) + w x (w x (R*p))
+    /// so the columns of both maps are computed once per manipulator and applied to all the contiguous checkpoints.
+    /// Only squared norms are compared, and link accelerations are only computed when there is an acceleration limit.
+    ///
+    /// \param bstart if true, evaluates at the start of rampnd, otherwise at its end
+    /// \param maxactualmanipspeed2, maxactualmanipaccel2 the current maximum squared speed and acceleration, updated in place
+    /// \param velViolationIndex, accelViolationIndex index into _listCheckManips of the manipulator having the maximum, updated in place
+    /// \param vVelViolation, vAccelViolation the velocity and acceleration of the checkpoint having the maximum, updated in place
+    void _CheckManipsAtRampEnd(const RampOptimizerInternal::RampND& rampnd, bool bstart, dReal& maxactualmanipspeed2, dReal& maxactualmanipaccel2, int& velViolationIndex, int& accelViolationIndex, Vector& vVelViolation, Vector& vAccelViolation)
+    {
+        rampnd.GetAVect(ac);
+        int curmanipindex = 0;
+        FOREACHC(itmanipinfo, _listCheckManips) {
+            bool bBoundExceeded = false;
+            KinBodyPtr probot = itmanipinfo->plink->GetParent();
+            qfillactive.resize(itmanipinfo->vuseddofindices.size());
+            _vfillactive.resize(itmanipinfo->vuseddofindices.size());
+            _afill.resize(probot->GetDOF());
+            for(size_t index = 0; index < itmanipinfo->vuseddofindices.size(); ++index) {
+                const int configindex = itmanipinfo->vconfigindices.at(index);
+                qfillactive[index] = bstart ? rampnd.GetX0At(configindex) : rampnd.GetX1At(configindex);
+                _vfillactive[index] = bstart ? rampnd.GetV0At(configindex) : rampnd.GetV1At(configindex);
+                _afill[itmanipinfo->vuseddofindices.at(index)] = ac.at(configindex);
+            }
+
+            int endeffindex = itmanipinfo->plink->GetIndex();
+            KinBody::KinBodyStateSaver saver(probot, KinBody::Save_LinkTransformation|KinBody::Save_LinkVelocities);
+
+            // Set the robot to the new state
+            probot->SetDOFValues(qfillactive, KinBody::CLA_CheckLimits, itmanipinfo->vuseddofindices);
+            probot->SetDOFVelocities(_vfillactive, KinBody::CLA_CheckLimits, itmanipinfo->vuseddofindices);
+            probot->GetLinkVelocities(endeffvels);
+            const Vector& endeffvellin = endeffvels.at(endeffindex).first;
+            const Vector& endeffvelang = endeffvels.at(endeffindex).second;
+            const TransformMatrix tlink(itmanipinfo->plink->GetTransform());
+
+            Vector vvelcolumns[3]; // columns of the map from a checkpoint to its velocity relative to the end-effector origin, w x R
+            for(int icolumn = 0; icolumn < 3; ++icolumn) {
+                vvelcolumns[icolumn] = endeffvelang.cross(Vector(tlink.m[icolumn], tlink.m[4+icolumn], tlink.m[8+icolumn]));
+            }
+            const std::vector<Vector>& vcheckpoints = itmanipinfo->checkpoints;
+
+            if( _maxmanipspeed > 0 ) {
+                for(size_t ipoint = 0; ipoint < vcheckpoints.size(); ++ipoint) {
+                    const Vector& p = vcheckpoints[ipoint];
+                    Vector vpoint = endeffvellin + vvelcolumns[0]*p.x + vvelcolumns[1]*p.y + vvelcolumns[2]*p.z;
+                    dReal actualmanipspeed2 = vpoint.lengthsqr3();
+                    if( actualmanipspeed2 > maxactualmanipspeed2 ) {
+                        bBoundExceeded = true;
+                        maxactualmanipspeed2 = actualmanipspeed2;
+                        velViolationIndex = curmanipindex;
+                        vVelViolation = vpoint;
+                    }
+                }
+            }
+
+            if( _maxmanipaccel > 0 ) {
+                probot->GetLinkAccelerations(_afill,endeffaccs);
+                const Vector& endeffacclin = endeffaccs.at(endeffindex).first;
+                const Vector& endeffaccang = endeffaccs.at(endeffindex).second;
+                Vector vaccelcolumns[3]; // alpha x R + w x (w x R)
+                for(int icolumn = 0; icolumn < 3; ++icolumn) {
+                    vaccelcolumns[icolumn] = endeffaccang.cross(Vector(tlink.m[icolumn], tlink.m[4+icolumn], tlink.m[8+icolumn])) + endeffvelang.cross(vvelcolumns[icolumn]);
+                }
+                for(size_t ipoint = 0; ipoint < vcheckpoints.size(); ++ipoint) {
+                    const Vector& p = vcheckpoints[ipoint];
+                    Vector apoint = endeffacclin + vaccelcolumns[0]*p.x + vaccelcolumns[1]*p.y + vaccelcolumns[2]*p.z;
+                    dReal actualmanipaccel2 = apoint.lengthsqr3();
+                    if( actualmanipaccel2 > maxactualmanipaccel2 ) {
+                        bBoundExceeded = true;
+                        maxactualmanipaccel2 = actualmanipaccel2;
+                        accelViolationIndex = curmanipindex;
+                        vAccelViolation = apoint;
+                    }
+                }
+            }
+            if( bBoundExceeded ) {
+                // Keep these values for later computation if constraints are violated
+                _vdofvalues = qfillactive;
+                _vdofvelocities = _vfillactive;
+                _vdofaccelerations = _afill;
+            }
+            ++curmanipindex;
+        }
+    }
+
     EnvironmentBasePtr _penv;
     std::string _manipname;
     std::vector<KinBodyPtr> listUsedBodies;
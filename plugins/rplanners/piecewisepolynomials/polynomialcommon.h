@@ -147,6 +147,136 @@ inline bool ClampValueToLimit(dReal& x, const dReal ul, const dReal epsilon)
     return true;
 }
 
+/// \brief Evaluate the polynomial of the given degree at x with Horner's rule. Strongest coefficient first.
+inline dReal polyeval(const int degree, const dReal* rawcoeffs, const dReal x)
+{
+    dReal value = rawcoeffs[0];
+    for( int i = 1; i <= degree; ++i ) {
+        value = value*x + rawcoeffs[i];
+    }
+    return value;
+}
+
+/// \brief Find the root of a polynomial that is monotonic on [lower, upper] and has opposite signs at
+/// the two ends with Newton's method, falling back to bisection whenever a step leaves the bracket.
+inline dReal polyrootbracketed(const int degree, const dReal* rawcoeffs, dReal lower, dReal upper, const dReal flowervalue, const dReal fuppervalue)
+{
+    const dReal tol = 4*std::numeric_limits<dReal>::epsilon();
+    dReal x = lower - flowervalue*(upper - lower)/(fuppervalue - flowervalue); // regula falsi
+    if( !(x > lower && x < upper) ) {
+        x = 0.5*(lower + upper);
+    }
+    for( int iter = 0; iter < 100; ++iter ) {
+        dReal value = rawcoeffs[0], deriv = 0, ferrorbound = RaveFabs(rawcoeffs[0]);
+        const dReal fabsx = RaveFabs(x);
+        for( int i = 1; i <= degree; ++i ) {
+            deriv = deriv*x + value;
+            value = value*x + rawcoeffs[i];
+            ferrorbound = ferrorbound*fabsx + RaveFabs(rawcoeffs[i]);
+        }
+        if( RaveFabs(value) <= tol*ferrorbound ) {
+            // value is within the rounding error of evaluating the polynomial
+            return x;
+        }
+        if( (value < 0) == (flowervalue < 0) ) {
+            lower = x;
+        }
+        else {
+            upper = x;
+        }
+        dReal xnew = deriv != 0 ? x - value/deriv : lower;
+        if( !(xnew > lower && xnew < upper) ) {
+            xnew = 0.5*(lower + upper);
+        }
+        if( RaveFabs(xnew - x) <= tol*RaveFabs(xnew) || upper - lower <= tol*Max(RaveFabs(lower), RaveFabs(upper)) ) {
+            return xnew;
+        }
+        x = xnew;
+    }
+    return x;
+}
+
+/// \brief Find all distinct real roots of a polynomial of degree at most 5 without allocating. Strongest
+/// coefficient first, same as polyroots. Roots are returned in ascending order.
+///
+/// The real roots of the derivative (found recursively) split the real line into intervals on which the
+/// polynomial is monotonic, so every interval has at most one root, which is found with bracketed
+/// Newton iterations. Critical points at which the polynomial vanishes are multiple roots. Roots of
+/// degree 1 and 2 polynomials are computed in closed form.
+inline void polyrootslowdegree(const int degree, const dReal* rawcoeffs, dReal* rawroots, int& numroots)
+{
+    BOOST_ASSERT(degree >= 1 && degree <= 5);
+    BOOST_ASSERT(rawcoeffs[0] != 0);
+    const dReal tol = 64*std::numeric_limits<dReal>::epsilon();
+    numroots = 0;
+
+    // Work with the monic polynomial. Every root x satisfies |x| < 1 + max|coeffs[i]| (Cauchy's bound).
+    dReal coeffs[6];
+    dReal fbound = 0;
+    coeffs[0] = 1;
+    for( int i = 1; i <= degree; ++i ) {
+        coeffs[i] = rawcoeffs[i]/rawcoeffs[0];
+        fbound = Max(fbound, RaveFabs(coeffs[i]));
+    }
+    fbound += 1;
+    if( degree == 1 ) {
+        rawroots[numroots++] = -coeffs[1];
+        return;
+    }
+
+    dReal vcritical[5];
+    int numcritical = 0;
+    if( degree == 2 ) {
+        vcritical[numcritical++] = -0.5*coeffs[1];
+    }
+    else {
+        dReal dcoeffs[5];
+        for( int i = 0; i < degree; ++i ) {
+            dcoeffs[i] = coeffs[i]*(degree - i)/degree;
+        }
+        polyrootslowdegree(degree - 1, dcoeffs, vcritical, numcritical);
+    }
+
+    dReal prevpoint = -fbound, prevvalue = polyeval(degree, coeffs, -fbound);
+    bool bprevroot = false;
+    for( int icritical = 0; icritical <= numcritical; ++icritical ) {
+        dReal point = fbound, value;
+        bool broot = false;
+        if( icritical < numcritical ) {
+            point = Min(Max(vcritical[icritical], -fbound), fbound);
+            value = polyeval(degree, coeffs, point);
+            // a critical point is a multiple root if |p(x)| is within the rounding error of evaluating p(x)
+            dReal ferrorbound = 0, fabspoint = RaveFabs(point);
+            for( int i = 0; i <= degree; ++i ) {
+                ferrorbound = ferrorbound*fabspoint + RaveFabs(coeffs[i]);
+            }
+            broot = RaveFabs(value) <= tol*ferrorbound;
+        }
+        else {
+            value = polyeval(degree, coeffs, point);
+        }
+
+        if( !bprevroot && !broot && ((prevvalue < 0 && value > 0) || (prevvalue > 0 && value < 0)) ) {
+            if( degree == 2 ) {
+                // closed form, avoiding cancellation
+                dReal det = coeffs[1]*coeffs[1] - 4*coeffs[2];
+                dReal temp = coeffs[1] >= 0 ? -0.5*(coeffs[1] + RaveSqrt(det)) : -0.5*(coeffs[1] - RaveSqrt(det));
+                dReal root0 = temp, root1 = temp != 0 ? coeffs[2]/temp : 0;
+                rawroots[numroots++] = icritical == 0 ? Min(root0, root1) : Max(root0, root1);
+            }
+            else {
+                rawroots[numroots++] = polyrootbracketed(degree, coeffs, prevpoint, point, prevvalue, value);
+            }
+        }
+        if( broot ) {
+            rawroots[numroots++] = point;
+        }
+        prevpoint = point;
+        prevvalue = value;
+        bprevroot = broot;
+    }
+}
+
 #ifdef PIECEWISE_POLY_POLY_COMMON_H_USE_EIGEN
 // Weakest coeff first. This eigenvalue-method, however, is prone to numerical errors in some cases,
 // for example, when there are repeating roots. According to my test, solving x^3 - 3x^2 + 3x - 1 =
@@ -157,6 +287,14 @@ inline void polyrealroots(const int degree, const dReal* vcoeffs, dReal* vroots,
     if( degree == 0 ) {
         return;
     }
+    if( degree <= 5 ) {
+        dReal rawcoeffs[6];
+        for( int i = 0; i <= degree; ++i ) {
+            rawcoeffs[i] = vcoeffs[degree - i];
+        }
+        polyrootslowdegree(degree, rawcoeffs, vroots, numroots);
+        return;
+    }
 
     // Construct the companion matrix
     MatrixXT<dReal> companion = MatrixXT<dReal>::Zero(degree, degree);
@@ -183,7 +321,7 @@ inline void polyrealroots(const int degree, const dReal* vcoeffs, dReal* vroots,
 #else
 // Strongest coefficient first (openrave convention). Modified from mathextra.h. Using Durand-Kerner
 // method for finding polynomial roots.
-inline void polyroots(const int degree, const dReal* rawcoeffs, dReal* rawroots, int& numroots)
+inline void polyrootsdurandkerner(const int degree, const dReal* rawcoeffs, dReal* rawroots, int& numroots)
 {
     using std::complex;
     BOOST_ASSERT(rawcoeffs[0] != 0);
@@ -260,6 +398,19 @@ inline void polyroots(const int degree, const dReal* rawcoeffs, dReal* rawroots,
         }
     }
 }
+
+// Strongest coefficient first (openrave convention). Polynomials of degree at most 5, which include the
+// derivatives of all cubic and quintic trajectories, go through polyrootslowdegree. Higher degrees
+// use the Durand-Kerner method.
+inline void polyroots(const int degree, const dReal* rawcoeffs, dReal* rawroots, int& numroots)
+{
+    if( degree >= 1 && degree <= 5 ) {
+        polyrootslowdegree(degree, rawcoeffs, rawroots, numroots);
+    }
+    else {
+        polyrootsdurandkerner(degree, rawcoeffs, rawroots, numroots);
+    }
+}
 #endif
 
 } // end namespace PiecewisePolynomialsInternal
@@ -390,35 +390,8 @@ void Polynomial::_FindAllLocalExtrema() const
         return;
     }
     int numroots = 0;
-    if( degree - 1 - iNonZeroLeadCoeff == 2 ) {
-        // Use a closed-form formula for quadratic equations to speed up.
-        dReal a = rawcoeffs[iNonZeroLeadCoeff], b = rawcoeffs[iNonZeroLeadCoeff + 1], c = rawcoeffs[iNonZeroLeadCoeff + 2];
-        dReal det = b*b - 4*a*c;
-        const dReal tol = 64.0*std::numeric_limits<dReal>::epsilon();
-        if( det >= -tol ) {
-            if( det <= tol ) {
-                numroots = 1;
-                rawroots[0] = -0.5*b/a;
-            }
-            else {
-                numroots = 2;
-                dReal temp;
-                if( b >= 0 ) {
-                    temp = -0.5*(b + RaveSqrt(det));
-                }
-                else {
-                    temp = -0.5*(b - RaveSqrt(det));
-                }
-                rawroots[0] = temp/a;
-                rawroots[1] = c/temp;
-            }
-        }
-        rawroots.resize(numroots);
-    }
-    else {
-        polyroots((int)degree - 1 - iNonZeroLeadCoeff, &rawcoeffs[iNonZeroLeadCoeff], &rawroots[0], numroots);
-        rawroots.resize(numroots);
-    }
+    polyroots((int)degree - 1 - iNonZeroLeadCoeff, &rawcoeffs[iNonZeroLeadCoeff], &rawroots[0], numroots);
+    rawroots.resize(numroots);
 
     if( numroots == 0 ) {
         return;
@@ -429,7 +402,7 @@ void Polynomial::_FindAllLocalExtrema() const
     for( int iroot = 0; iroot < numroots; ++iroot ) {
         Coordinate c(rawroots[iroot], Eval(rawroots[iroot]));
         std::vector<Coordinate>::const_iterator it = std::lower_bound(vcextrema.begin(), vcextrema.end(), c);
-        if( !FuzzyEquals(it->point, c.point, g_fPolynomialEpsilon) ) {
+        if( it == vcextrema.end() || !FuzzyEquals(it->point, c.point, g_fPolynomialEpsilon) ) {
             // Insert this point only if not already in the list
             vcextrema.insert(it, c);
         }
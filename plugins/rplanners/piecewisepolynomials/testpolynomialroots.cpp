@@ -0,0 +1,96 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 Rosen Diankov <rosen.diankov@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+// of the License, or at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+// even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+#include "polynomialcommon.h"
+
+#include <algorithm>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+using namespace OpenRAVE;
+using namespace OpenRAVE::PiecewisePolynomialsInternal;
+
+/// Compares polyrootslowdegree with polyrootsdurandkerner on polynomials built from known real roots
+/// (some of them repeated) and complex conjugate pairs. Returns the number of failures.
+int main()
+{
+    boost::random::mt19937 rng(0);
+    boost::random::uniform_real_distribution<dReal> dist(-3, 3);
+    const int numtrials = 100000;
+    int numfailures = 0, numdurandkernerfailures = 0;
+    dReal fmaxerror = 0;
+    for( int itrial = 0; itrial < numtrials; ++itrial ) {
+        const int degree = 1 + itrial % 5;
+        dReal coeffs[6] = {1, 0, 0, 0, 0, 0}, vexpectedroots[5];
+        int numexpectedroots = 0, curdegree = 0;
+        while( curdegree < degree ) {
+            // quantized roots make repeated roots likely
+            dReal r = std::floor(4*dist(rng) + 0.5)/4;
+            int numfactorcoeffs;
+            dReal factor[3];
+            if( curdegree + 2 <= degree && itrial % 3 == 0 ) {
+                dReal imag = RaveFabs(dist(rng)) + 0.1;
+                factor[0] = 1; factor[1] = -2*r; factor[2] = r*r + imag*imag;
+                numfactorcoeffs = 3;
+            }
+            else {
+                factor[0] = 1; factor[1] = -r;
+                numfactorcoeffs = 2;
+                vexpectedroots[numexpectedroots++] = r;
+            }
+            dReal newcoeffs[6] = {0, 0, 0, 0, 0, 0};
+            for( int i = 0; i <= curdegree; ++i ) {
+                for( int j = 0; j < numfactorcoeffs; ++j ) {
+                    newcoeffs[i + j] += coeffs[i]*factor[j];
+                }
+            }
+            std::copy(newcoeffs, newcoeffs + 6, coeffs);
+            curdegree += numfactorcoeffs - 1;
+        }
+        dReal fscale = dist(rng);
+        for( int i = 0; i <= degree; ++i ) {
+            coeffs[i] *= fscale;
+        }
+        std::sort(vexpectedroots, vexpectedroots + numexpectedroots);
+        numexpectedroots = std::unique(vexpectedroots, vexpectedroots + numexpectedroots) - vexpectedroots;
+
+        dReal vroots[5];
+        int numroots = 0;
+        polyrootslowdegree(degree, coeffs, vroots, numroots);
+        bool bsuccess = numroots == numexpectedroots;
+        for( int iroot = 0; bsuccess && iroot < numroots; ++iroot ) {
+            dReal ferror = RaveFabs(vroots[iroot] - vexpectedroots[iroot]);
+            fmaxerror = std::max(fmaxerror, ferror);
+            // a root of multiplicity m can only be found up to eps^(1/m)
+            bsuccess = ferror <= 1e-4;
+        }
+        if( !bsuccess ) {
+            ++numfailures;
+            RAVELOG_WARN_FORMAT("trial %d, degree %d: found %d roots, expected %d", itrial%degree%numroots%numexpectedroots);
+        }
+
+        if( degree >= 2 ) {
+            polyrootsdurandkerner(degree, coeffs, vroots, numroots);
+            if( numroots != numexpectedroots ) {
+                ++numdurandkernerfailures;
+            }
+        }
+    }
+    if( numfailures > 0 ) {
+        RAVELOG_ERROR_FORMAT("polyrootslowdegree failed %d/%d trials with max error %.15e, polyrootsdurandkerner failed %d/%d trials", numfailures%numtrials%fmaxerror%numdurandkernerfailures%numtrials);
+    }
+    else {
+        RAVELOG_INFO_FORMAT("polyrootslowdegree passed %d trials with max error %.15e, polyrootsdurandkerner failed %d/%d trials", numtrials%fmaxerror%numdurandkernerfailures%numtrials);
+    }
+    return numfailures;
+}
@@ -18,8 +18,11 @@
 #define OPENRAVE_TEXTSERVER
 
 #include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <shared_mutex>
 #include <openrave/planningutils.h>
+#include <openrave/utils.h>
 #include <cstdlib>
 #include <boost/bind/bind.hpp>
 
@@ -43,10 +46,20 @@ using namespace boost::placeholders;
 typedef int socklen_t;
 #else
 #include <fcntl.h>
+#include <unistd.h>
 #define CLOSESOCKET close
 #endif
 
-/// manages all connections. At the moment, server can handle only one connectino at a time
+#ifdef __linux__
+#include <sys/epoll.h>
+#define OPENRAVE_TEXTSERVER_USE_EPOLL
+#endif
+
+/// \brief manages all connections.
+///
+/// On linux, one epoll loop reads all the connections and a fixed pool of threads executes the commands. Clients can pipeline commands,
+/// the commands of one connection are executed in order and their results are returned in order. Commands that only read the environment
+/// run concurrently, commands that modify it are serialized. On other systems, every connection is read by its own thread.
 class SimpleTextServer : public ModuleBase
 {
     // socket just accepts connections
@@ -255,19 +268,63 @@ private:
     typedef boost::function<bool (istream&, ostream&, boost::shared_ptr<void>&)> OpenRaveNetworkFn;
     typedef boost::function<bool (boost::shared_ptr<istream>, boost::shared_ptr<void>)> OpenRaveWorkerFn;
 
+    /// \brief how the socket function of a command is synchronized with the socket functions of other commands
+    enum CommandLockMode
+    {
+        CLM_Exclusive = 0, ///< modifies the environment or the server state, runs alone
+        CLM_Shared = 1, ///< only reads, runs concurrently with other CLM_Shared commands
+        CLM_None = 2, ///< does its own synchronization, for example waits for a long time without blocking other commands
+    };
+
     /// each network function has a function to intially processes the data on the socket function
     /// and one that is executed on the main worker thread to avoid multithreading data synchronization issues
     struct RAVENETWORKFN
     {
-        RAVENETWORKFN() : bReturnResult(false) {
+        RAVENETWORKFN() : bReturnResult(false), lockMode(CLM_Exclusive) {
         }
-        RAVENETWORKFN(const OpenRaveNetworkFn& socket, const OpenRaveWorkerFn& worker, bool bReturnResult_) : fnSocketThread(socket), fnWorker(worker), bReturnResult(bReturnResult_) {
+        RAVENETWORKFN(const OpenRaveNetworkFn& socket, const OpenRaveWorkerFn& worker, bool bReturnResult_, CommandLockMode lockMode_=CLM_Exclusive) : fnSocketThread(socket), fnWorker(worker), bReturnResult(bReturnResult_), lockMode(lockMode_) {
         }
 
         OpenRaveNetworkFn fnSocketThread;
         OpenRaveWorkerFn fnWorker;
         bool bReturnResult;     // if true, function is expected to return a result
+        CommandLockMode lockMode;
+    };
+
+    /// \brief latencies of the recent calls of one command, from receiving the request until sending its result
+    struct CommandStatistics
+    {
+        uint64_t numCalls = 0;
+        std::vector<uint32_t> vRecentLatenciesUS; ///< ring buffer of at most s_numRecentLatencies samples
+        size_t nextSampleIndex = 0;
     };
+    static const size_t s_numRecentLatencies = 1024;
+
+#ifdef OPENRAVE_TEXTSERVER_USE_EPOLL
+    /// \brief connection served by the epoll loop.
+    ///
+    /// The socket is closed when the last reference is released, so pool threads can still write to it after the loop dropped the connection.
+    class Connection
+    {
+public:
+        Connection(int sockfd) : _sockfd(sockfd) {
+        }
+        ~Connection() {
+            CLOSESOCKET(_sockfd);
+        }
+
+        const int _sockfd;
+        std::string _inputbuffer; ///< received bytes of the incomplete line, only accessed by the epoll thread
+
+        std::mutex _mutex; ///< protects the members below
+        std::deque< std::pair<std::string, uint64_t> > _requests; ///< pipelined request lines and the time they were received
+        bool _bScheduled = false; ///< true if the connection is queued or processed by a pool thread. Only one thread processes a connection so that its requests run in order
+        std::string _outputbuffer; ///< framed results that the socket did not accept yet
+        bool _bWaitingWritable = false; ///< true if the epoll loop waits for the socket to become writable
+        bool _bClosed = false;
+    };
+    typedef boost::shared_ptr<Connection> ConnectionPtr;
+#endif
 
 public:
     SimpleTextServer(EnvironmentBasePtr penv) : ModuleBase(penv) {
@@ -275,15 +332,20 @@ public:
         _nNextFigureId = 1;
         _bWorking = false;
         bDestroying = false;
+        bInitThread = false;
+        bCloseThread = false;
+#ifdef OPENRAVE_TEXTSERVER_USE_EPOLL
+        _epollfd = -1;
+#endif
         __description=":Interface Author: Rosen Diankov\n\nSimple text-based server using sockets.";
-        mapNetworkFns["body_checkcollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvCheckCollision, this, _1, _2, _3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["body_getjoints"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetJointValues, this,_1, _2, _3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["body_checkcollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvCheckCollision, this, _1, _2, _3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["body_getjoints"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetJointValues, this,_1, _2, _3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["body_destroy"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyDestroy,this,_1,_2,_3), OpenRaveWorkerFn(), false);
         mapNetworkFns["body_enable"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyEnable,this,_1,_2,_3), OpenRaveWorkerFn(), false);
-        mapNetworkFns["body_getaabb"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetAABB,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["body_getaabbs"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetAABBs,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["body_getlinks"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetLinks,this,_1,_2,_3),OpenRaveWorkerFn(), true);
-        mapNetworkFns["body_getdof"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetDOF,this,_1,_2,_3),OpenRaveWorkerFn(), true);
+        mapNetworkFns["body_getaabb"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetAABB,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["body_getaabbs"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetAABBs,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["body_getlinks"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetLinks,this,_1,_2,_3),OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["body_getdof"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodyGetDOF,this,_1,_2,_3),OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["body_settransform"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orKinBodySetTransform,this,_1,_2,_3),OpenRaveWorkerFn(), false);
         mapNetworkFns["body_setjoints"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodySetJointValues,this,_1,_2,_3), OpenRaveWorkerFn(), false);
         mapNetworkFns["body_setjointtorques"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orBodySetJointTorques,this,_1,_2,_3), OpenRaveWorkerFn(), false);
@@ -292,35 +354,38 @@ public:
         mapNetworkFns["createbody"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvCreateKinBody,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["createmodule"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvCreateModule,this,_1,_2,_3), boost::bind(&SimpleTextServer::worEnvCreateModule,this,_1,_2), true);
         mapNetworkFns["env_dstrprob"] = RAVENETWORKFN(OpenRaveNetworkFn(), boost::bind(&SimpleTextServer::worEnvDestroyProblem,this,_1,_2), false);
-        mapNetworkFns["env_getbodies"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvGetBodies,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["env_getrobots"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvGetRobots,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["env_getbody"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvGetBody,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["env_getbodies"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvGetBodies,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["env_getrobots"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvGetRobots,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["env_getbody"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvGetBody,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["env_loadplugin"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvLoadPlugin,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["env_raycollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvRayCollision,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["env_raycollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvRayCollision,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["env_stepsimulation"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvStepSimulation,this,_1,_2,_3), boost::bind(&SimpleTextServer::worEnvStepSimulation,this,_1,_2), false);
-        mapNetworkFns["env_triangulate"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvTriangulate,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["env_triangulate"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvTriangulate,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["loadscene"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvLoadScene,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["plot"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvPlot,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["problem_sendcmd"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orProblemSendCommand,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_checkselfcollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotCheckSelfCollision,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["robot_checkselfcollision"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotCheckSelfCollision,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["robot_controllersend"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotControllerSend,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["robot_controllerset"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotControllerSet,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_getactivedof"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetActiveDOF,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_getdofvalues"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetDOFValues,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_getlimits"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetDOFLimits,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_getmanipulators"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetManipulators,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_getsensors"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetAttachedSensors,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["robot_getactivedof"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetActiveDOF,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["robot_getdofvalues"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetDOFValues,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["robot_getlimits"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetDOFLimits,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["robot_getmanipulators"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetManipulators,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
+        mapNetworkFns["robot_getsensors"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotGetAttachedSensors,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["robot_sensorsend"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSensorSend,this,_1,_2,_3), OpenRaveWorkerFn(), true);
         mapNetworkFns["robot_sensorconfigure"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSensorConfigure,this,_1,_2,_3), OpenRaveWorkerFn(), true);
-        mapNetworkFns["robot_sensordata"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSensorData,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["robot_sensordata"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSensorData,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_Shared);
         mapNetworkFns["robot_setactivedofs"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSetActiveDOFs,this,_1,_2,_3), OpenRaveWorkerFn(), false);
         mapNetworkFns["robot_setactivemanipulator"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSetActiveManipulator,this,_1,_2,_3), OpenRaveWorkerFn(), false);
         mapNetworkFns["robot_setdof"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orRobotSetDOFValues,this,_1,_2,_3), OpenRaveWorkerFn(), false);
         mapNetworkFns["robot_traj"] = RAVENETWORKFN(OpenRaveNetworkFn(), boost::bind(&SimpleTextServer::worRobotStartActiveTrajectory,this,_1,_2), false);
         mapNetworkFns["render"] = RAVENETWORKFN(OpenRaveNetworkFn(), boost::bind(&SimpleTextServer::worRender,this,_1,_2), false);
         mapNetworkFns["setoptions"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvSetOptions,this,_1,_2,_3), boost::bind(&SimpleTextServer::worSetOptions,this,_1,_2), false);
-        mapNetworkFns["test"] = RAVENETWORKFN(OpenRaveNetworkFn(), OpenRaveWorkerFn(), false);
-        mapNetworkFns["wait"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvWait,this,_1,_2,_3), OpenRaveWorkerFn(), true);
+        mapNetworkFns["test"] = RAVENETWORKFN(OpenRaveNetworkFn(), OpenRaveWorkerFn(), false, CLM_Shared);
+        mapNetworkFns["wait"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orEnvWait,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_None);
+        mapNetworkFns["server_getlatencies"] = RAVENETWORKFN(boost::bind(&SimpleTextServer::orServerGetLatencies,this,_1,_2,_3), OpenRaveWorkerFn(), true, CLM_None);
+        RegisterCommand("GetCommandLatencies",boost::bind(&SimpleTextServer::_GetCommandLatenciesCommand,this,_1,_2),
+                        "Returns one line per command with its name, the number of calls, and the 50th, 90th and 99th percentile and maximum latency in microseconds of the recent calls. The latency is measured from receiving a request until sending its result.");
 
         string logfilename = RaveGetHomeDirectory() + string("/textserver.log");
         flog.open(logfilename.c_str());
@@ -332,11 +397,16 @@ public:
         Destroy();
     }
 
+    /// \param cmd "port [numthreads]", numthreads is the number of threads executing commands and defaults to the number of cores
     virtual int main(const std::string& cmd)
     {
         _nPort = 4765;
+        int numthreads = 0;
         stringstream ss(cmd);
-        ss >> _nPort;
+        ss >> _nPort >> numthreads;
+        if( numthreads <= 0 ) {
+            numthreads = std::max(4, (int)std::thread::hardware_concurrency());
+        }
 
         Destroy();
 
@@ -406,7 +476,27 @@ public:
 #endif
 
         RAVELOG_DEBUG("text server listening on port %d\n",_nPort);
+#ifdef OPENRAVE_TEXTSERVER_USE_EPOLL
+        _epollfd = epoll_create1(0);
+        if( _epollfd < 0 ) {
+            RAVELOG_ERROR("failed to create epoll instance, errno=%d\n", errno);
+            return -1;
+        }
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = server_sockfd;
+        if( epoll_ctl(_epollfd, EPOLL_CTL_ADD, server_sockfd, &event) < 0 ) {
+            RAVELOG_ERROR("failed to add server socket to epoll, errno=%d\n", errno);
+            return -1;
+        }
+        _servthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_epoll_threadcb, this));
+        for(int ithread = 0; ithread < numthreads; ++ithread) {
+            _vPoolThreads.push_back(boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_pool_threadcb, this)));
+        }
+#else
         _servthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_listen_threadcb, this));
+#endif
         _workerthread = boost::make_shared<std::thread>(std::bind(&SimpleTextServer::_worker_threadcb, this));
         bInitThread = true;
         return 0;
@@ -439,6 +529,21 @@ public:
                 (*it)->join();
             }
             _listReadThreads.clear();
+#ifdef OPENRAVE_TEXTSERVER_USE_EPOLL
+            {
+                std::lock_guard<std::mutex> lock(_mutexPool);
+                _condPool.notify_all();
+            }
+            FOREACH(it, _vPoolThreads) {
+                (*it)->join();
+            }
+            _vPoolThreads.clear();
+            _queueScheduledConnections.clear();
+            if( _epollfd >= 0 ) {
+                CLOSESOCKET(_epollfd);
+                _epollfd = -1;
+            }
+#endif
             _condHasWork.notify_all();
             if( !!_workerthread ) {
                 _workerthread->join();
@@ -538,6 +643,214 @@ private:
         }
     }
 
+#ifdef OPENRAVE_TEXTSERVER_USE_EPOLL
+    /// \brief accepts connections and reads the requests of all of them
+    void _epoll_threadcb()
+    {
+        std::map<int, ConnectionPtr> mapConnections;
+        std::vector<struct epoll_event> vevents(64);
+        std::vector<char> vreadbuffer(65536);
+        while(!bCloseThread) {
+            int numevents = epoll_wait(_epollfd, vevents.data(), vevents.size(), 100);
+            if( numevents < 0 ) {
+                if( errno == EINTR ) {
+                    continue;
+                }
+                RAVELOG_ERROR("epoll_wait failed, errno=%d\n", errno);
+                break;
+            }
+
+            for(int ievent = 0; ievent < numevents; ++ievent) {
+                const int sockfd = vevents[ievent].data.fd;
+                const uint32_t events = vevents[ievent].events;
+                if( sockfd == server_sockfd ) {
+                    for(;;) {
+                        int client_sockfd = accept(server_sockfd, NULL, NULL);
+                        if( client_sockfd < 0 ) {
+                            break;
+                        }
+                        int flags = fcntl(client_sockfd, F_GETFL, 0);
+                        fcntl(client_sockfd, F_SETFL, (flags < 0 ? 0 : flags) | O_NONBLOCK);
+                        struct epoll_event event;
+                        memset(&event, 0, sizeof(event));
+                        event.events = EPOLLIN|EPOLLRDHUP;
+                        event.data.fd = client_sockfd;
+                        if( epoll_ctl(_epollfd, EPOLL_CTL_ADD, client_sockfd, &event) < 0 ) {
+                            RAVELOG_WARN("failed to add connection to epoll, errno=%d\n", errno);
+                            CLOSESOCKET(client_sockfd);
+                            continue;
+                        }
+                        mapConnections[client_sockfd] = boost::make_shared<Connection>(client_sockfd);
+                        RAVELOG_VERBOSE("started new server connection\n");
+                    }
+                    continue;
+                }
+
+                std::map<int, ConnectionPtr>::iterator itconnection = mapConnections.find(sockfd);
+                if( itconnection == mapConnections.end() ) {
+                    continue;
+                }
+                ConnectionPtr pconnection = itconnection->second;
+                bool bClose = !!(events & (EPOLLERR|EPOLLHUP));
+                if( !bClose && (events & (EPOLLIN|EPOLLRDHUP)) ) {
+                    for(;;) {
+                        ssize_t numread = recv(sockfd, vreadbuffer.data(), vreadbuffer.size(), 0);
+                        if( numread > 0 ) {
+                            _ReceiveData(pconnection, vreadbuffer.data(), numread);
+                        }
+                        else if( numread == 0 ) {
+                            bClose = true;
+                            break;
+                        }
+                        else if( errno == EINTR ) {
+                            continue;
+                        }
+                        else {
+                            bClose = errno != EAGAIN && errno != EWOULDBLOCK;
+                            break;
+                        }
+                    }
+                }
+                if( !bClose && (events & EPOLLOUT) ) {
+                    std::lock_guard<std::mutex> lock(pconnection->_mutex);
+                    _FlushOutput(*pconnection);
+                }
+                if( bClose ) {
+                    epoll_ctl(_epollfd, EPOLL_CTL_DEL, sockfd, NULL);
+                    {
+                        std::lock_guard<std::mutex> lock(pconnection->_mutex);
+                        pconnection->_bClosed = true;
+                    }
+                    mapConnections.erase(itconnection);
+                    RAVELOG_VERBOSE("Closing socket connection\n");
+                }
+            }
+        }
+
+        RAVELOG_DEBUG("**Server thread exiting\n");
+    }
+
+    /// \brief splits the received data into request lines and schedules the connection to execute them
+    void _ReceiveData(ConnectionPtr pconnection, const char* pdata, size_t size)
+    {
+        const uint64_t timestampUS = OpenRAVE::utils::GetMonotonicTime();
+        Connection& connection = *pconnection;
+        bool bSchedule = false;
+        for(size_t i = 0; i < size; ++i) {
+            const char c = pdata[i];
+            if( c != '\n' && c != '\r' ) {
+                connection._inputbuffer.push_back(c);
+                continue;
+            }
+            if( connection._inputbuffer.empty() ) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(connection._mutex);
+            connection._requests.emplace_back(std::string(), timestampUS);
+            connection._requests.back().first.swap(connection._inputbuffer);
+            if( !connection._bScheduled ) {
+                connection._bScheduled = true;
+                bSchedule = true;
+            }
+        }
+        if( bSchedule ) {
+            std::lock_guard<std::mutex> lock(_mutexPool);
+            _queueScheduledConnections.push_back(pconnection);
+            _condPool.notify_one();
+        }
+    }
+
+    /// \brief executes the requests of scheduled connections
+    void _pool_threadcb()
+    {
+        // number of requests executed before letting other connections run
+        const int maxRequestsPerTurn = 16;
+        while(!bCloseThread) {
+            ConnectionPtr pconnection;
+            {
+                std::unique_lock<std::mutex> lock(_mutexPool);
+                while(_queueScheduledConnections.empty() && !bCloseThread) {
+                    _condPool.wait(lock);
+                }
+                if( bCloseThread ) {
+                    break;
+                }
+                pconnection = _queueScheduledConnections.front();
+                _queueScheduledConnections.pop_front();
+            }
+
+            Connection& connection = *pconnection;
+            bool bReschedule = false;
+            for(int irequest = 0; irequest <= maxRequestsPerTurn; ++irequest) {
+                std::pair<std::string, uint64_t> request;
+                {
+                    std::lock_guard<std::mutex> lock(connection._mutex);
+                    if( connection._requests.empty() ) {
+                        connection._bScheduled = false;
+                        break;
+                    }
+                    if( irequest == maxRequestsPerTurn ) {
+                        bReschedule = true;
+                        break;
+                    }
+                    request.swap(connection._requests.front());
+                    connection._requests.pop_front();
+                }
+                _ProcessLine(request.first, request.second, boost::bind(&SimpleTextServer::_SendToConnection, this, pconnection, _1, _2));
+            }
+            if( bReschedule ) {
+                std::lock_guard<std::mutex> lock(_mutexPool);
+                _queueScheduledConnections.push_back(pconnection);
+                _condPool.notify_one();
+            }
+        }
+    }
+
+    void _SendToConnection(ConnectionPtr pconnection, const char* pdata, int size)
+    {
+        std::lock_guard<std::mutex> lock(pconnection->_mutex);
+        if( pconnection->_bClosed ) {
+            return;
+        }
+        // same framing as Socket::SendData
+        pconnection->_outputbuffer.append((const char*)&size, 4);
+        pconnection->_outputbuffer.append(pdata, size);
+        _FlushOutput(*pconnection);
+    }
+
+    /// \brief sends as much of the buffered results as the socket accepts and waits for the socket to become writable if some are left. connection._mutex has to be locked.
+    void _FlushOutput(Connection& connection)
+    {
+        size_t numsent = 0;
+        while( numsent < connection._outputbuffer.size() ) {
+            ssize_t ret = send(connection._sockfd, connection._outputbuffer.data() + numsent, connection._outputbuffer.size() - numsent, MSG_NOSIGNAL);
+            if( ret > 0 ) {
+                numsent += ret;
+            }
+            else if( ret < 0 && errno == EINTR ) {
+                continue;
+            }
+            else {
+                if( ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK ) {
+                    // broken connection, the epoll loop closes it
+                    numsent = connection._outputbuffer.size();
+                }
+                break;
+            }
+        }
+        connection._outputbuffer.erase(0, numsent);
+
+        const bool bWaitWritable = !connection._outputbuffer.empty();
+        if( bWaitWritable != connection._bWaitingWritable && !connection._bClosed ) {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN|EPOLLRDHUP|(bWaitWritable ? EPOLLOUT : 0);
+            event.data.fd = connection._sockfd;
+            epoll_ctl(_epollfd, EPOLL_CTL_MOD, connection._sockfd, &event);
+            connection._bWaitingWritable = bWaitWritable;
+        }
+    }
+#else
     void _listen_threadcb()
     {
         SocketPtr psocket(new Socket());
@@ -561,95 +874,165 @@ private:
     void _read_threadcb(SocketPtr psocket)
     {
         RAVELOG_VERBOSE("started new server connection\n");
-        string cmd, line;
-        stringstream sout;
+        string line;
         while(!bCloseThread) {
             if( psocket->ReadLine(line) && line.length() ) {
+                _ProcessLine(line, OpenRAVE::utils::GetMonotonicTime(), boost::bind(&Socket::SendData, psocket, _1, _2));
+            }
+            else if( !psocket->IsInit() ) {
+                break;
+            }
+            usleep(1000);
+        }
 
-                if( !!flog &&( GetEnv()->GetDebugLevel()>0) ) {
-                    static int index=0;
-                    flog << index++ << ": " << line << endl;
-                }
+        RAVELOG_VERBOSE("Closing socket connection\n");
+    }
+#endif
 
-                boost::shared_ptr<istream> is(new stringstream(line));
-                *is >> cmd;
-                if( !*is ) {
-                    RAVELOG_ERROR("Failed to get command\n");
-                    psocket->SendData("error\n",1);
-                    continue;
-                }
-                std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
-                stringstream::pos_type inputpos = is->tellg();
-
-                map<string, RAVENETWORKFN>::iterator itfn = mapNetworkFns.find(cmd);
-                if( itfn != mapNetworkFns.end() ) {
-                    bool bCallWorker = true;
-                    boost::shared_ptr<void> pdata;
-
-                    // need to set w.args before pcmdend is modified
-                    sout.str(""); sout.clear();
-                    if( !!itfn->second.fnSocketThread ) {
-                        bool bSuccess = false;
-                        try {
-                            bSuccess = itfn->second.fnSocketThread(*is, sout, pdata);
-                        }
-                        catch(const std::exception& ex) {
-                            RAVELOG_FATAL("server caught exception: %s\n",ex.what());
-                        }
-                        catch(...) {
-                            RAVELOG_FATAL("unknown exception!!\n");
-                        }
+    /// \brief executes one request line and sends its result
+    ///
+    /// \param receivedTimestampUS monotonic time the request was received, used for the latency statistics
+    /// \param sendfn sends data to the client of the request
+    void _ProcessLine(const std::string& line, uint64_t receivedTimestampUS, const boost::function<void(const char*, int)>& sendfn)
+    {
+        if( !!flog &&( GetEnv()->GetDebugLevel()>0) ) {
+            std::lock_guard<std::mutex> lock(_mutexLog);
+            static int index=0;
+            flog << index++ << ": " << line << endl;
+        }
 
-                        if( bSuccess ) {
-                            if( itfn->second.bReturnResult ) {
-                                psocket->SendData(sout.str().c_str(), sout.str().size());
-                            }
-                            if( !itfn->second.fnWorker ) {
-                                bCallWorker = false;
-                            }
-                        }
-                        else {
-                            bCallWorker = false;
-                            if( !!flog  ) {
-                                flog << " error" << endl;
-                            }
-                            if( itfn->second.bReturnResult ) {
-                                psocket->SendData("error\n", 6);
-                            }
-                        }
-                    }
-                    else {
-                        if( itfn->second.bReturnResult ) {
-                            psocket->SendData(sout.str().c_str(), sout.str().size());     // return dummy
-                        }
-                        bCallWorker = !!itfn->second.fnWorker;
-                    }
+        string cmd;
+        boost::shared_ptr<istream> is(new stringstream(line));
+        *is >> cmd;
+        if( !*is ) {
+            RAVELOG_ERROR("Failed to get command\n");
+            sendfn("error\n",1);
+            return;
+        }
+        std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+        stringstream::pos_type inputpos = is->tellg();
 
-                    if( bCallWorker ) {
-                        BOOST_ASSERT(!!itfn->second.fnWorker);
-                        is->clear();
-                        is->seekg(inputpos);
-                        ScheduleWorker(boost::bind(itfn->second.fnWorker,is,pdata));
-                    }
+        map<string, RAVENETWORKFN>::iterator itfn = mapNetworkFns.find(cmd);
+        if( itfn == mapNetworkFns.end() ) {
+            RAVELOG_ERROR("Failed to recognize command: %s\n", cmd.c_str());
+            sendfn("error\n",1);
+            return;
+        }
+
+        bool bCallWorker = true;
+        boost::shared_ptr<void> pdata;
+        stringstream sout;
+        if( !!itfn->second.fnSocketThread ) {
+            bool bSuccess = false;
+            {
+                std::unique_lock<std::shared_timed_mutex> exclusivelock(_mutexCommands, std::defer_lock);
+                std::shared_lock<std::shared_timed_mutex> sharedlock(_mutexCommands, std::defer_lock);
+                if( itfn->second.lockMode == CLM_Exclusive ) {
+                    exclusivelock.lock();
                 }
-                else {
-                    RAVELOG_ERROR("Failed to recognize command: %s\n", cmd.c_str());
-                    psocket->SendData("error\n",1);
+                else if( itfn->second.lockMode == CLM_Shared ) {
+                    sharedlock.lock();
+                }
+                try {
+                    bSuccess = itfn->second.fnSocketThread(*is, sout, pdata);
+                }
+                catch(const std::exception& ex) {
+                    RAVELOG_FATAL("server caught exception: %s\n",ex.what());
+                }
+                catch(...) {
+                    RAVELOG_FATAL("unknown exception!!\n");
                 }
             }
-            else if( !psocket->IsInit() ) {
-                break;
+
+            if( bSuccess ) {
+                if( itfn->second.bReturnResult ) {
+                    sendfn(sout.str().c_str(), sout.str().size());
+                }
+                if( !itfn->second.fnWorker ) {
+                    bCallWorker = false;
+                }
             }
-            usleep(1000);
+            else {
+                bCallWorker = false;
+                if( !!flog  ) {
+                    std::lock_guard<std::mutex> lock(_mutexLog);
+                    flog << " error" << endl;
+                }
+                if( itfn->second.bReturnResult ) {
+                    sendfn("error\n", 6);
+                }
+            }
+        }
+        else {
+            if( itfn->second.bReturnResult ) {
+                sendfn(sout.str().c_str(), sout.str().size());     // return dummy
+            }
+            bCallWorker = !!itfn->second.fnWorker;
         }
 
-        RAVELOG_VERBOSE("Closing socket connection\n");
+        if( bCallWorker ) {
+            BOOST_ASSERT(!!itfn->second.fnWorker);
+            is->clear();
+            is->seekg(inputpos);
+            ScheduleWorker(boost::bind(itfn->second.fnWorker,is,pdata));
+        }
+
+        _AddLatencySample(cmd, OpenRAVE::utils::GetMonotonicTime() - receivedTimestampUS);
+    }
+
+    void _AddLatencySample(const std::string& cmd, uint64_t latencyUS)
+    {
+        std::lock_guard<std::mutex> lock(_mutexStatistics);
+        CommandStatistics& statistics = _mapCommandStatistics[cmd];
+        ++statistics.numCalls;
+        const uint32_t sample = (uint32_t)std::min(latencyUS, (uint64_t)std::numeric_limits<uint32_t>::max());
+        if( statistics.vRecentLatenciesUS.size() < s_numRecentLatencies ) {
+            statistics.vRecentLatenciesUS.push_back(sample);
+        }
+        else {
+            statistics.vRecentLatenciesUS[statistics.nextSampleIndex] = sample;
+            statistics.nextSampleIndex = (statistics.nextSampleIndex + 1) % s_numRecentLatencies;
+        }
+    }
+
+    /// \brief writes one line per command: name numcalls p50 p90 p99 max, latencies in microseconds
+    void _WriteCommandLatencies(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(_mutexStatistics);
+        std::vector<uint32_t> vsorted;
+        FOREACHC(itstatistics, _mapCommandStatistics) {
+            vsorted = itstatistics->second.vRecentLatenciesUS;
+            std::sort(vsorted.begin(), vsorted.end());
+            os << itstatistics->first << " " << itstatistics->second.numCalls;
+            const double percentiles[] = {0.5, 0.9, 0.99, 1.0};
+            for(double percentile : percentiles) {
+                os << " " << (vsorted.empty() ? 0 : vsorted.at(std::min(vsorted.size()-1, (size_t)(percentile*vsorted.size()))));
+            }
+            os << endl;
+        }
+    }
+
+    bool _GetCommandLatenciesCommand(ostream& sout, istream& sinput)
+    {
+        _WriteCommandLatencies(sout);
+        return true;
     }
 
     int _nPort;     ///< port used for listening to incoming connections
 
     boost::shared_ptr<std::thread> _servthread, _workerthread;
     list<boost::shared_ptr<std::thread> > _listReadThreads;
+#ifdef OPENRAVE_TEXTSERVER_USE_EPOLL
+    int _epollfd; ///< epoll instance of all the sockets
+    std::vector<boost::shared_ptr<std::thread> > _vPoolThreads; ///< threads executing the requests
+    std::deque<ConnectionPtr> _queueScheduledConnections; ///< connections with requests to execute, protected by _mutexPool
+    std::mutex _mutexPool;
+    std::condition_variable _condPool;
+#endif
+    std::shared_timed_mutex _mutexCommands; ///< locked shared by commands that only read and exclusively by the others, see CommandLockMode
+    std::mutex _mutexLog; ///< protects flog
+    std::mutex _mutexStatistics; ///< protects _mapCommandStatistics
+    std::map<std::string, CommandStatistics> _mapCommandStatistics;
 
     std::mutex _mutexWorker;
     std::condition_variable _condWorker;
@@ -2264,6 +2647,13 @@ protected:
         return true;
     }
 
+    // returns the latencies of the recent commands in the format of the GetCommandLatencies command
+    bool orServerGetLatencies(istream& is, ostream& os, boost::shared_ptr<void>& pdata)
+    {
+        _WriteCommandLatencies(os);
+        return true;
+    }
+
     /// sends a comment to the problem
     bool orProblemSendCommand(istream& is, ostream& os, boost::shared_ptr<void>& pdata)
     {
@@ -66,6 +66,7 @@
 
 #include <complex>
 #include <algorithm>
+#include <type_traits>
 // openrave
 #include <openrave/config.h>
 #include <openrave/logging.h>
@@ -257,6 +258,50 @@ inline std::vector<int8_t> ExtractArrayInt8(const py::object& o)
     return v;
 }
 
+/// \brief converts a numpy array of a numeric dtype to T with a single contiguous copy, without indexing the python object per element
+///
+/// Only same-kind casts are done, so float arrays are not truncated into integral T.
+/// \param ndim the number of dimensions the array has to have, its values are stored into v in C order
+/// \return false if o is not a numpy array with ndim dimensions or its dtype cannot be cast to T with a same-kind cast
+template <typename T>
+inline bool ExtractNumpyArray(const py::object& o, std::vector<T>& v, int ndim=1)
+{
+    PyObject* pyo = o.ptr();
+    if( !PyArray_Check(pyo) || PyArray_NDIM((PyArrayObject*)pyo) != ndim ) {
+        return false;
+    }
+    PyArray_Descr* pydescr = PyArray_DescrFromType(select_npy_type<T>::type);
+    if( !PyArray_CanCastTypeTo(PyArray_DESCR((PyArrayObject*)pyo), pydescr, NPY_SAME_KIND_CASTING) ) {
+        Py_DECREF(pydescr);
+        return false;
+    }
+    // steals the reference to pydescr
+    PyArrayObject* pyarr = (PyArrayObject*)PyArray_FromAny(pyo, pydescr, ndim, ndim, NPY_ARRAY_CARRAY_RO|NPY_ARRAY_FORCECAST, nullptr);
+    if( !pyarr ) {
+        PyErr_Clear();
+        return false;
+    }
+    const size_t n = PyArray_SIZE(pyarr);
+    v.resize(n);
+    if( n > 0 ) {
+        memcpy(v.data(), PyArray_DATA(pyarr), n*sizeof(T));
+    }
+    Py_DECREF(pyarr);
+    return true;
+}
+
+template <typename T>
+inline bool _ExtractNumpyArray(const py::object& o, std::vector<T>& v, std::true_type)
+{
+    return ExtractNumpyArray(o, v);
+}
+
+template <typename T>
+inline bool _ExtractNumpyArray(const py::object& o, std::vector<T>& v, std::false_type)
+{
+    return false;
+}
+
 template <typename T>
 inline std::vector<T> ExtractArray(const py::object& o)
 {
@@ -264,6 +309,9 @@ inline std::vector<T> ExtractArray(const py::object& o)
         return {};
     }
     std::vector<T> v;
+    if( _ExtractNumpyArray(o, v, std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>()) ) {
+        return v;
+    }
     try {
         const size_t n = len(o);
         v.resize(n);
@@ -125,6 +125,48 @@ inline py::numeric::array toPyArray(const boost::array<T, N>& v)
     return toPyArrayN(v.data(), N);
 }
 
+inline void _DeletePyArrayViewOwner(PyObject* pycapsule)
+{
+    delete reinterpret_cast<OPENRAVE_SHARED_PTR<void const>*>(PyCapsule_GetPointer(pycapsule, nullptr));
+}
+
+/// \brief returns a numpy array viewing pvalues without copying them
+///
+/// \param strides the byte strides of every dimension, if empty the array is C-contiguous
+/// \param powner keeps pvalues alive for as long as the array or any view of it is referenced in python
+template <typename T>
+inline py::numeric::array toPyArrayView(const T* pvalues, const std::vector<npy_intp>& dims, const std::vector<npy_intp>& strides, OPENRAVE_SHARED_PTR<void const> powner, bool bWriteable=true)
+{
+    if( pvalues == nullptr ) {
+        return static_cast<py::numeric::array>(py::handle<>(PyArray_SimpleNew(dims.size(), const_cast<npy_intp*>(dims.data()), select_npy_type<T>::type)));
+    }
+    PyObject *pyvalues = PyArray_New(&PyArray_Type, dims.size(), const_cast<npy_intp*>(dims.data()), select_npy_type<T>::type, strides.empty() ? nullptr : const_cast<npy_intp*>(strides.data()), const_cast<T*>(pvalues), 0, bWriteable ? NPY_ARRAY_WRITEABLE : 0, nullptr);
+    if( pyvalues == nullptr ) {
+        py::throw_error_already_set();
+    }
+    OPENRAVE_SHARED_PTR<void const>* ppowner = new OPENRAVE_SHARED_PTR<void const>(powner);
+    PyObject *pycapsule = PyCapsule_New(ppowner, nullptr, _DeletePyArrayViewOwner);
+    if( pycapsule == nullptr ) {
+        delete ppowner;
+        Py_DECREF(pyvalues);
+        py::throw_error_already_set();
+    }
+    // steals the reference to pycapsule even when it fails, in which case the array must not be returned since nothing keeps pvalues alive
+    if( PyArray_SetBaseObject((PyArrayObject*)pyvalues, pycapsule) < 0 ) {
+        Py_DECREF(pyvalues);
+        py::throw_error_already_set();
+    }
+    return static_cast<py::numeric::array>(py::handle<>(pyvalues));
+}
+
+/// \brief moves v into a numpy array without copying its data
+template <typename T>
+inline py::numeric::array toPyArrayView(std::vector<T>&& v, const std::vector<npy_intp>& dims)
+{
+    OPENRAVE_SHARED_PTR<std::vector<T> > pvalues(new std::vector<T>(std::move(v)));
+    return toPyArrayView(pvalues->data(), dims, std::vector<npy_intp>(), pvalues);
+}
+
 #endif // OPENRAVE_BINDINGS_PYARRAY
 
 template <typename T>
@@ -381,6 +381,10 @@ public:
 
     uint64_t GetUInt64Parameter(const std::string& parameterName, uint64_t defaultValue) const;
 
+    object GetStatistics(const std::string& interfaceName=std::string()) const;
+
+    void ResetStatistics(const std::string& interfaceName=std::string());
+
     int _revision = 0;
     py::list _keywords;
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
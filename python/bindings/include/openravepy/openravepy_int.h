@@ -340,6 +340,49 @@ inline RaveTransformMatrix<T> ExtractTransformMatrixType(const py::object& o)
     return t;
 }
 
+/// \brief extracts a (N,7) array of poses or a (N,4,4) array of matrices with one conversion of the whole array
+///
+/// \return false if o is not a numpy array of either shape
+inline bool ExtractTransformArray(const py::object& o, std::vector<Transform>& vtransforms)
+{
+    PyObject* pyo = o.ptr();
+    if( !PyArray_Check(pyo) ) {
+        return false;
+    }
+    PyArrayObject* pyarr = (PyArrayObject*)pyo;
+    const int ndim = PyArray_NDIM(pyarr);
+    const bool bPoses = ndim == 2 && PyArray_DIM(pyarr, 1) == 7;
+    const bool bMatrices = ndim == 3 && PyArray_DIM(pyarr, 1) >= 3 && PyArray_DIM(pyarr, 2) == 4;
+    std::vector<dReal> vvalues;
+    if( (!bPoses && !bMatrices) || !ExtractNumpyArray(o, vvalues, ndim) ) {
+        return false;
+    }
+    const size_t num = PyArray_DIM(pyarr, 0);
+    vtransforms.resize(num);
+    if( bPoses ) {
+        for(size_t i = 0; i < num; ++i) {
+            const dReal* p = &vvalues[7*i];
+            vtransforms[i].rot = Vector(p[0], p[1], p[2], p[3]);
+            vtransforms[i].trans = Vector(p[4], p[5], p[6]);
+        }
+    }
+    else {
+        const size_t stride = 4*PyArray_DIM(pyarr, 1);
+        TransformMatrix t;
+        for(size_t i = 0; i < num; ++i) {
+            const dReal* p = &vvalues[stride*i];
+            for(int j = 0; j < 3; ++j) {
+                t.m[4*j+0] = p[4*j+0];
+                t.m[4*j+1] = p[4*j+1];
+                t.m[4*j+2] = p[4*j+2];
+                t.trans[j] = p[4*j+3];
+            }
+            vtransforms[i] = t;
+        }
+    }
+    return true;
+}
+
 inline py::object toPyArrayRotation(const TransformMatrix& t)
 {
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
@@ -612,7 +655,11 @@ OPENRAVEPY_API RAY ExtractRay(py::object o);
 OPENRAVEPY_API bool ExtractRay(py::object o, RAY& r);
 
 OPENRAVEPY_API py::object toPyTriMesh(const TriMesh& mesh);
+/// \brief returns a TriMesh whose vertices and indices view pmesh without copying, pmesh should not be modified afterwards
+OPENRAVEPY_API py::object toPyTriMesh(OPENRAVE_SHARED_PTR<TriMesh> pmesh);
 OPENRAVEPY_API bool ExtractTriMesh(py::object o, TriMesh& mesh);
+/// \brief returns a CompactTriMesh sharing the buffers of mesh
+OPENRAVEPY_API py::object toPyCompactTriMesh(const CompactTriMesh& mesh);
 
 /// \brief extracts the geometries from pyGeometryInfoList into vGeometryInfos
 OPENRAVEPY_API void ExtractGeometryInfoArray(py::object pyGeometryInfoList, std::vector<KinBody::GeometryInfo>& vGeometryInfos);
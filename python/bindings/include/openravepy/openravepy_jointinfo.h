@@ -348,6 +348,7 @@ public:
     std::string GetId() const;
     object GetName() const;
     int GetIndex();
+    int GetGeometryUpdateStamp() const;
     void Enable(bool bEnable);
     bool IsEnabled() const;
     bool SetVisible(bool visible);
@@ -363,6 +364,7 @@ public:
     bool IsParentLink(OPENRAVE_SHARED_PTR<PyLink> pylink) const;
 
     object GetCollisionData();
+    object GetCompactCollisionData();
     object ComputeLocalAABB() const;
 
     object ComputeAABB() const;
@@ -245,6 +245,9 @@ public:
     py::object GetTransform() const;
     py::object GetTransformPose() const;
     py::object GetLinkTransformations(bool returndoflastvlaues=false) const;
+    /// \brief returns the link transforms as a (N,7) array of poses viewing the queried transforms without copying
+    py::object GetLinkTransformPoses(bool returndoflastvalues=false) const;
+    /// \brief transforms can be a list of transforms, or a (N,7) array of poses or (N,4,4) array of matrices that is converted at once
     void SetLinkTransformations(py::object transforms, py::object odoflastvalues=py::none_());
     void SetLinkVelocities(py::object ovelocities);
     py::object GetLinkEnableStates() const;
@@ -297,6 +300,8 @@ public:
     py::object ComputeHessianTranslation(int index, py::object oposition, py::object oindices=py::none_());
     py::object ComputeHessianAxisAngle(int index, py::object oindices=py::none_());
     py::object ComputeInverseDynamics(py::object odofaccelerations, py::object oexternalforcetorque=py::none_(), bool returncomponents=false);
+    py::object ComputeMassMatrix();
+    py::object ComputeForwardDynamics(py::object odoftorques, py::object oexternalforcetorque=py::none_());
     py::object GetDOFDynamicAccelerationJerkLimits(py::object oDOFPositions, py::object oDOFVelocities) const;
     void SetSelfCollisionChecker(PyCollisionCheckerBasePtr pycollisionchecker);
     PyInterfaceBasePtr GetSelfCollisionChecker();
@@ -179,6 +179,31 @@ inline py::array_t<T> toPyArray(const boost::array<T, N>& v)
     return toPyArrayN(v.data(), N);
 }
 
+/// \brief returns a numpy array viewing pvalues without copying them
+///
+/// \param strides the byte strides of every dimension, if empty the array is C-contiguous
+/// \param powner keeps pvalues alive for as long as the array or any view of it is referenced in python
+template <typename T>
+inline py::array_t<T> toPyArrayView(const T* pvalues, const std::vector<npy_intp>& dims, const std::vector<npy_intp>& strides, OPENRAVE_SHARED_PTR<void const> powner, bool bWriteable=true)
+{
+    py::capsule pyowner(new OPENRAVE_SHARED_PTR<void const>(powner), [](void* p) {
+            delete reinterpret_cast<OPENRAVE_SHARED_PTR<void const>*>(p);
+        });
+    py::array_t<T> pyvalues = strides.empty() ? py::array_t<T>(dims, pvalues, pyowner) : py::array_t<T>(dims, strides, pvalues, pyowner);
+    if( !bWriteable ) {
+        py::detail::array_proxy(pyvalues.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    }
+    return pyvalues;
+}
+
+/// \brief moves v into a numpy array without copying its data
+template <typename T>
+inline py::array_t<T> toPyArrayView(std::vector<T>&& v, const std::vector<npy_intp>& dims)
+{
+    OPENRAVE_SHARED_PTR<std::vector<T> > pvalues(new std::vector<T>(std::move(v)));
+    return toPyArrayView(pvalues->data(), dims, std::vector<npy_intp>(), pvalues);
+}
+
 #endif // OPENRAVE_BINDINGS_PYARRAY
 
 template <typename type>
@@ -419,6 +419,17 @@ public:
 #endif // USE_PYBIND11_PYTHON_BINDINGS
     }
 
+    /// \brief views the vertices and indices of pmesh without copying them, the arrays take ownership of pmesh
+    PyTriMesh(OPENRAVE_SHARED_PTR<TriMesh> pmesh) {
+        // vertices are stored with a 4th unused component, which the row stride skips
+        BOOST_STATIC_ASSERT(sizeof(Vector) == 4*sizeof(dReal));
+        const std::vector<npy_intp> vertexdims {npy_intp(pmesh->vertices.size()), npy_intp(3)};
+        const std::vector<npy_intp> vertexstrides {npy_intp(sizeof(Vector)), npy_intp(sizeof(dReal))};
+        vertices = toPyArrayView(pmesh->vertices.empty() ? nullptr : &pmesh->vertices[0].x, vertexdims, vertexstrides, pmesh);
+        const std::vector<npy_intp> indexdims {npy_intp(pmesh->indices.size()/3), npy_intp(3)};
+        indices = toPyArrayView(pmesh->indices.empty() ? nullptr : pmesh->indices.data(), indexdims, std::vector<npy_intp>(), pmesh);
+    }
+
     void GetTriMesh(TriMesh& mesh) const {
         if( IS_PYTHONOBJECT_NONE(vertices) ) {
             throw OPENRAVE_EXCEPTION_FORMAT0("python TriMesh 'vertices' is not initialized correctly", ORE_InvalidState);
@@ -553,6 +564,11 @@ object toPyTriMesh(const TriMesh& mesh)
     return py::to_object(OPENRAVE_SHARED_PTR<PyTriMesh>(new PyTriMesh(mesh)));
 }
 
+object toPyTriMesh(OPENRAVE_SHARED_PTR<TriMesh> pmesh)
+{
+    return py::to_object(OPENRAVE_SHARED_PTR<PyTriMesh>(new PyTriMesh(pmesh)));
+}
+
 class TriMesh_pickle_suite
 #ifndef USE_PYBIND11_PYTHON_BINDINGS
     : public pickle_suite
@@ -565,6 +581,98 @@ public:
     }
 };
 
+class PyCompactTriMesh
+{
+public:
+    PyCompactTriMesh(bool bSinglePrecision=false) : _mesh(bSinglePrecision) {
+    }
+    PyCompactTriMesh(object otrimesh, bool bSinglePrecision=false) : _mesh(bSinglePrecision) {
+        TriMesh mesh;
+        if( !ExtractTriMesh(otrimesh, mesh) ) {
+            throw openrave_exception(_("expected a TriMesh"), ORE_InvalidArguments);
+        }
+        _mesh.SetTriMesh(mesh);
+    }
+    PyCompactTriMesh(const CompactTriMesh& mesh) : _mesh(mesh) {
+    }
+
+    /// \brief returns a copy that shares the buffers until one of the copies is modified
+    OPENRAVE_SHARED_PTR<PyCompactTriMesh> __copy__() const {
+        return OPENRAVE_SHARED_PTR<PyCompactTriMesh>(new PyCompactTriMesh(_mesh));
+    }
+
+    object GetTriMesh() const {
+        OPENRAVE_SHARED_PTR<TriMesh> pmesh(new TriMesh());
+        _mesh.GetTriMesh(*pmesh);
+        return toPyTriMesh(pmesh);
+    }
+
+    /// \brief returns a read-only (N,3) array viewing the vertex buffer in its precision
+    object GetVertices() const {
+        // the array keeps its own copy of the mesh, which holds a reference to the buffers
+        OPENRAVE_SHARED_PTR<CompactTriMesh const> pmesh(new CompactTriMesh(_mesh));
+        const std::vector<npy_intp> dims {npy_intp(pmesh->GetNumVertices()), npy_intp(3)};
+        if( pmesh->IsSinglePrecision() ) {
+            return toPyArrayView(pmesh->GetVertexDataFloat(), dims, std::vector<npy_intp>(), pmesh, false);
+        }
+        return toPyArrayView(pmesh->GetVertexData(), dims, std::vector<npy_intp>(), pmesh, false);
+    }
+
+    /// \brief returns a read-only (N,3) array viewing the index buffer
+    object GetIndices() const {
+        OPENRAVE_SHARED_PTR<CompactTriMesh const> pmesh(new CompactTriMesh(_mesh));
+        const std::vector<npy_intp> dims {npy_intp(pmesh->GetNumTriangles()), npy_intp(3)};
+        return toPyArrayView(pmesh->GetIndices().empty() ? nullptr : pmesh->GetIndices().data(), dims, std::vector<npy_intp>(), pmesh, false);
+    }
+
+    void Append(object omesh, object otransform) {
+        extract_<OPENRAVE_SHARED_PTR<PyCompactTriMesh> > pycompactmesh(omesh);
+        if( pycompactmesh.check() ) {
+            _mesh.Append(((OPENRAVE_SHARED_PTR<PyCompactTriMesh>)pycompactmesh)->_mesh, ExtractTransform(otransform));
+            return;
+        }
+        TriMesh mesh;
+        if( !ExtractTriMesh(omesh, mesh) ) {
+            throw openrave_exception(_("expected a TriMesh or CompactTriMesh"), ORE_InvalidArguments);
+        }
+        _mesh.Append(mesh, ExtractTransform(otransform));
+    }
+
+    void ApplyTransform(object otransform) {
+        _mesh.ApplyTransform(ExtractTransform(otransform));
+    }
+
+    bool IsSinglePrecision() const {
+        return _mesh.IsSinglePrecision();
+    }
+    size_t GetNumVertices() const {
+        return _mesh.GetNumVertices();
+    }
+    size_t GetNumTriangles() const {
+        return _mesh.GetNumTriangles();
+    }
+    size_t GetMemoryUsage() const {
+        return _mesh.GetMemoryUsage();
+    }
+    bool IsShared() const {
+        return _mesh.IsShared();
+    }
+
+    std::string __str__() {
+        return boost::str(boost::format("<compacttrimesh: verts %d, tris=%d>")%_mesh.GetNumVertices()%_mesh.GetNumTriangles());
+    }
+    object __unicode__() {
+        return ConvertStringToUnicode(__str__());
+    }
+
+    CompactTriMesh _mesh;
+};
+
+object toPyCompactTriMesh(const CompactTriMesh& mesh)
+{
+    return py::to_object(OPENRAVE_SHARED_PTR<PyCompactTriMesh>(new PyCompactTriMesh(mesh)));
+}
+
 PyConfigurationSpecification::PyConfigurationSpecification() {
 }
 PyConfigurationSpecification::PyConfigurationSpecification(const std::string &s) {
@@ -2032,6 +2140,29 @@ void init_openravepy_global()
     .def_pickle(TriMesh_pickle_suite())
 #endif
     ;
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+    class_<PyCompactTriMesh, OPENRAVE_SHARED_PTR<PyCompactTriMesh> >(m, "CompactTriMesh", DOXY_CLASS(CompactTriMesh))
+    .def(init<bool>(), "singleprecision"_a = false)
+    .def(init<object, bool>(), "trimesh"_a, "singleprecision"_a = false)
+#else
+    class_<PyCompactTriMesh, OPENRAVE_SHARED_PTR<PyCompactTriMesh> >("CompactTriMesh", DOXY_CLASS(CompactTriMesh))
+    .def(init<bool>(py::args("singleprecision")))
+    .def(init<object, bool>(py::args("trimesh","singleprecision")))
+#endif
+    .def("__copy__",&PyCompactTriMesh::__copy__, "Returns a copy that shares the vertex and index buffers until one of the copies is modified.")
+    .def("GetTriMesh",&PyCompactTriMesh::GetTriMesh, DOXY_FN(CompactTriMesh,GetTriMesh))
+    .def("GetVertices",&PyCompactTriMesh::GetVertices, "Returns a read-only (N,3) array viewing the vertices, in float32 if the mesh is in single precision.")
+    .def("GetIndices",&PyCompactTriMesh::GetIndices, "Returns a read-only (N,3) array viewing the triangle indices.")
+    .def("Append",&PyCompactTriMesh::Append, PY_ARGS("mesh","transform") DOXY_FN(CompactTriMesh,Append))
+    .def("ApplyTransform",&PyCompactTriMesh::ApplyTransform, PY_ARGS("transform") DOXY_FN(CompactTriMesh,ApplyTransform))
+    .def("IsSinglePrecision",&PyCompactTriMesh::IsSinglePrecision, DOXY_FN(CompactTriMesh,IsSinglePrecision))
+    .def("GetNumVertices",&PyCompactTriMesh::GetNumVertices, DOXY_FN(CompactTriMesh,GetNumVertices))
+    .def("GetNumTriangles",&PyCompactTriMesh::GetNumTriangles, DOXY_FN(CompactTriMesh,GetNumTriangles))
+    .def("GetMemoryUsage",&PyCompactTriMesh::GetMemoryUsage, DOXY_FN(CompactTriMesh,GetMemoryUsage))
+    .def("IsShared",&PyCompactTriMesh::IsShared, DOXY_FN(CompactTriMesh,IsShared))
+    .def("__str__",&PyCompactTriMesh::__str__)
+    .def("__unicode__",&PyCompactTriMesh::__unicode__)
+    ;
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
     class_<InterfaceBase, InterfaceBasePtr>(m, "InterfaceBase", DOXY_CLASS(InterfaceBase))
 #else
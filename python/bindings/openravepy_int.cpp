@@ -2117,7 +2117,7 @@ object PyEnvironmentBase::ReadTrimeshURI(const std::string& filename)
     if( !ptrimesh ) {
         return py::none_();
     }
-    return toPyTriMesh(*ptrimesh);
+    return toPyTriMesh(ptrimesh);
 }
 object PyEnvironmentBase::ReadTrimeshURI(const std::string& filename, object odictatts)
 {
@@ -2125,7 +2125,7 @@ object PyEnvironmentBase::ReadTrimeshURI(const std::string& filename, object odi
     if( !ptrimesh ) {
         return py::none_();
     }
-    return toPyTriMesh(*ptrimesh);
+    return toPyTriMesh(ptrimesh);
 }
 
 object PyEnvironmentBase::ReadTrimeshData(const std::string& data, const std::string& formathint)
@@ -2134,7 +2134,7 @@ object PyEnvironmentBase::ReadTrimeshData(const std::string& data, const std::st
     if( !ptrimesh ) {
         return py::none_();
     }
-    return toPyTriMesh(*ptrimesh);
+    return toPyTriMesh(ptrimesh);
 }
 object PyEnvironmentBase::ReadTrimeshData(const std::string& data, const std::string& formathint, object odictatts)
 {
@@ -2142,7 +2142,7 @@ object PyEnvironmentBase::ReadTrimeshData(const std::string& data, const std::st
     if( !ptrimesh ) {
         return py::none_();
     }
-    return toPyTriMesh(*ptrimesh);
+    return toPyTriMesh(ptrimesh);
 }
 
 void PyEnvironmentBase::Add(PyInterfaceBasePtr pinterface, py::object oAddMode, const std::string& cmdargs)
@@ -2962,16 +2962,16 @@ object PyEnvironmentBase::GetPublishedBodyTransformsMatchingPrefix(const string
 object PyEnvironmentBase::Triangulate(PyKinBodyPtr pbody)
 {
     CHECK_POINTER(pbody);
-    TriMesh mesh;
-    _penv->Triangulate(mesh, *openravepy::GetKinBody(pbody));
-    return toPyTriMesh(mesh);
+    OPENRAVE_SHARED_PTR<TriMesh> pmesh(new TriMesh());
+    _penv->Triangulate(*pmesh, *openravepy::GetKinBody(pbody));
+    return toPyTriMesh(pmesh);
 }
 
 object PyEnvironmentBase::TriangulateScene(const int options, const std::string &name)
 {
-    TriMesh mesh;
-    _penv->TriangulateScene(mesh, (EnvironmentBase::SelectionOptions) options, name);
-    return toPyTriMesh(mesh);
+    OPENRAVE_SHARED_PTR<TriMesh> pmesh(new TriMesh());
+    _penv->TriangulateScene(*pmesh, (EnvironmentBase::SelectionOptions) options, name);
+    return toPyTriMesh(pmesh);
 }
 
 void PyEnvironmentBase::SetDebugLevel(object olevel) {
@@ -3114,6 +3114,18 @@ uint64_t PyEnvironmentBase::GetUInt64Parameter(const std::string& parameterName,
     return _penv->GetUInt64Parameter(parameterName, defaultValue);
 }
 
+object PyEnvironmentBase::GetStatistics(const std::string& interfaceName) const
+{
+    rapidjson::Document rStatistics;
+    _penv->GetStatisticsRegistry().SerializeJSON(rStatistics, rStatistics.GetAllocator(), interfaceName);
+    return toPyObject(rStatistics);
+}
+
+void PyEnvironmentBase::ResetStatistics(const std::string& interfaceName)
+{
+    _penv->GetStatisticsRegistry().Reset(interfaceName);
+}
+
 bool PyEnvironmentBase::__eq__(PyEnvironmentBasePtr p) {
     return !!p && _penv==p->_penv;
 }
@@ -3269,6 +3281,8 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(StartSimulation_overloads, StartSimulatio
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(StopSimulation_overloads, StopSimulation, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SetViewer_overloads, SetViewer, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SetDefaultViewer_overloads, SetDefaultViewer, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetStatistics_overloads, GetStatistics, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ResetStatistics_overloads, ResetStatistics, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(CheckCollisionRays_overloads, CheckCollisionRays, 2, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(plot3_overloads, plot3, 2, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(drawlinestrip_overloads, drawlinestrip, 2, 4)
@@ -4014,6 +4028,19 @@ Because race conditions can pop up when trying to lock the openrave environment
                      .def("SetUInt64Parameter", &PyEnvironmentBase::SetUInt64Parameter, PY_ARGS("parameterName", "value") DOXY_FN(EnvironmentBase,SetUInt64Parameter))
                      .def("RemoveUInt64Parameter", &PyEnvironmentBase::RemoveUInt64Parameter, PY_ARGS("parameterName") DOXY_FN(EnvironmentBase,RemoveUInt64Parameter))
                      .def("GetUInt64Parameter", &PyEnvironmentBase::GetUInt64Parameter, PY_ARGS("parameterName", "defaultValue") DOXY_FN(EnvironmentBase,GetUInt64Parameter))
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                     .def("GetStatistics", &PyEnvironmentBase::GetStatistics,
+                          "interfaceName"_a = "",
+                          DOXY_FN(StatisticsRegistry, SerializeJSON)
+                          )
+                     .def("ResetStatistics", &PyEnvironmentBase::ResetStatistics,
+                          "interfaceName"_a = "",
+                          DOXY_FN(StatisticsRegistry, Reset)
+                          )
+#else
+                     .def("GetStatistics", &PyEnvironmentBase::GetStatistics, GetStatistics_overloads(PY_ARGS("interfaceName") DOXY_FN(StatisticsRegistry, SerializeJSON)))
+                     .def("ResetStatistics", &PyEnvironmentBase::ResetStatistics, ResetStatistics_overloads(PY_ARGS("interfaceName") DOXY_FN(StatisticsRegistry, Reset)))
+#endif
                      .def("__enter__",&PyEnvironmentBase::__enter__)
                      .def("__exit__",&PyEnvironmentBase::__exit__)
                      .def("__hash__",&PyEnvironmentBase::__hash__)
@@ -312,7 +312,9 @@ void PyGeometryInfo::Init(const KinBody::GeometryInfo& info) {
 
     _vDiffuseColor = toPyVector3(info._vDiffuseColor);
     _vAmbientColor = toPyVector3(info._vAmbientColor);
-    _meshcollision = toPyTriMesh(info._meshcollision);
+    TriMesh meshcollision;
+    info._meshcollision.GetTriMesh(meshcollision);
+    _meshcollision = toPyTriMesh(meshcollision);
     _id = ConvertStringToUnicode(info._id);
     _type = info._type;
     _name = ConvertStringToUnicode(info._name);
@@ -423,7 +425,10 @@ void PyGeometryInfo::FillGeometryInfo(KinBody::GeometryInfo& info)
     info._vDiffuseColor = ExtractVector34<dReal>(_vDiffuseColor,0);
     info._vAmbientColor = ExtractVector34<dReal>(_vAmbientColor,0);
     if( !IS_PYTHONOBJECT_NONE(_meshcollision) ) {
-        ExtractTriMesh(_meshcollision,info._meshcollision);
+        TriMesh meshcollision;
+        if( ExtractTriMesh(_meshcollision,meshcollision) ) {
+            info._meshcollision.SetTriMesh(meshcollision);
+        }
     }
     info._type = _type;
 
@@ -561,7 +566,9 @@ object PyGeometryInfo::GetCollisionMesh()
 {
     KinBody::GeometryInfoPtr pgeominfo = GetGeometryInfo();
     pgeominfo->InitCollisionMesh();
-    return toPyTriMesh(pgeominfo->_meshcollision);
+    OPENRAVE_SHARED_PTR<TriMesh> pmesh(new TriMesh());
+    pgeominfo->_meshcollision.GetTriMesh(*pmesh);
+    return toPyTriMesh(pmesh);
 }
 
 std::string PyGeometryInfo::__repr__()
@@ -1444,7 +1451,9 @@ uint8_t PyGeometry::GetSideWallExists() const {
 }
 
 object PyGeometry::GetCollisionMesh() {
-    return toPyTriMesh(_pgeometry->GetCollisionMesh());
+    OPENRAVE_SHARED_PTR<TriMesh> pmesh(new TriMesh());
+    _pgeometry->GetCollisionMesh().GetTriMesh(*pmesh);
+    return toPyTriMesh(pmesh);
 }
 object PyGeometry::ComputeAABB(object otransform) const {
     return toPyAABB(_pgeometry->ComputeAABB(ExtractTransform(otransform)));
@@ -1635,6 +1644,9 @@ object PyLink::GetName() const {
 int PyLink::GetIndex() {
     return _plink->GetIndex();
 }
+int PyLink::GetGeometryUpdateStamp() const {
+    return _plink->GetGeometryUpdateStamp();
+}
 bool PyLink::IsEnabled() const {
     return _plink->IsEnabled();
 }
@@ -1685,7 +1697,12 @@ bool PyLink::IsParentLink(OPENRAVE_SHARED_PTR<PyLink> pylink) const {
 }
 
 object PyLink::GetCollisionData() {
-    return toPyTriMesh(_plink->GetCollisionData());
+    OPENRAVE_SHARED_PTR<TriMesh> pmesh(new TriMesh());
+    _plink->GetCompactCollisionData().GetTriMesh(*pmesh);
+    return toPyTriMesh(pmesh);
+}
+object PyLink::GetCompactCollisionData() {
+    return toPyCompactTriMesh(_plink->GetCompactCollisionData());
 }
 object PyLink::ComputeLocalAABB() const { // TODO object otransform=py::none_()
     //if( IS_PYTHONOBJECT_NONE(otransform) ) {
@@ -3412,15 +3429,34 @@ object PyKinBody::GetLinkTransformations(bool returndoflastvlaues) const
     return otransforms;
 }
 
+object PyKinBody::GetLinkTransformPoses(bool returndoflastvalues) const
+{
+    OPENRAVE_SHARED_PTR<std::vector<Transform> > pvtransforms(new std::vector<Transform>());
+    std::vector<dReal> vdoflastsetvalues;
+    _pbody->GetLinkTransformations(*pvtransforms, vdoflastsetvalues);
+    // view rot and trans of every transform as one row of 7 values, trans.w is skipped by the row stride
+    BOOST_STATIC_ASSERT(sizeof(Transform) == 8*sizeof(dReal));
+    const std::vector<npy_intp> dims {npy_intp(pvtransforms->size()), npy_intp(7)};
+    const std::vector<npy_intp> strides {npy_intp(sizeof(Transform)), npy_intp(sizeof(dReal))};
+    const dReal* pvalues = pvtransforms->empty() ? nullptr : &pvtransforms->at(0).rot.x;
+    object oposes = toPyArrayView(pvalues, dims, strides, pvtransforms);
+    if( returndoflastvalues ) {
+        return py::make_tuple(oposes, toPyArray(vdoflastsetvalues));
+    }
+    return oposes;
+}
+
 void PyKinBody::SetLinkTransformations(object transforms, object odoflastvalues)
 {
-    size_t numtransforms = len(transforms);
-    if( numtransforms != _pbody->GetLinks().size() ) {
-        throw openrave_exception(_("number of input transforms not equal to links"));
+    std::vector<Transform> vtransforms;
+    if( !ExtractTransformArray(transforms, vtransforms) ) {
+        vtransforms.resize(len(transforms));
+        for(size_t i = 0; i < vtransforms.size(); ++i) {
+            vtransforms[i] = ExtractTransform(transforms[py::to_object(i)]);
+        }
     }
-    std::vector<Transform> vtransforms(numtransforms);
-    for(size_t i = 0; i < numtransforms; ++i) {
-        vtransforms[i] = ExtractTransform(transforms[py::to_object(i)]);
+    if( vtransforms.size() != _pbody->GetLinks().size() ) {
+        throw openrave_exception(_("number of input transforms not equal to links"));
     }
     if( IS_PYTHONOBJECT_NONE(odoflastvalues) ) {
         _pbody->SetLinkTransformations(vtransforms);
@@ -3958,13 +3994,9 @@ object PyKinBody::ComputeHessianAxisAngle(int index, object oindices)
     return toPyArray(vhessian,dims);
 }
 
-object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexternalforcetorque, bool returncomponents)
+/// \brief extracts a dictionary of link indices and 6-element force/torque arrays
+static void ExtractForceTorqueMap(object oexternalforcetorque, KinBody::ForceTorqueMap& mapExternalForceTorque)
 {
-    std::vector<dReal> vDOFAccelerations;
-    if( !IS_PYTHONOBJECT_NONE(odofaccelerations) ) {
-        vDOFAccelerations = ExtractArray<dReal>(odofaccelerations);
-    }
-    KinBody::ForceTorqueMap mapExternalForceTorque;
     if( !IS_PYTHONOBJECT_NONE(oexternalforcetorque) ) {
         py::dict odict = (py::dict)oexternalforcetorque;
         std::vector<dReal> v;
@@ -3985,6 +4017,16 @@ object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexter
         }
 #endif
     }
+}
+
+object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexternalforcetorque, bool returncomponents)
+{
+    std::vector<dReal> vDOFAccelerations;
+    if( !IS_PYTHONOBJECT_NONE(odofaccelerations) ) {
+        vDOFAccelerations = ExtractArray<dReal>(odofaccelerations);
+    }
+    KinBody::ForceTorqueMap mapExternalForceTorque;
+    ExtractForceTorqueMap(oexternalforcetorque, mapExternalForceTorque);
     if( returncomponents ) {
         boost::array< std::vector<dReal>, 3> vDOFTorqueComponents;
         _pbody->ComputeInverseDynamics(vDOFTorqueComponents,vDOFAccelerations,mapExternalForceTorque);
@@ -3997,6 +4039,24 @@ object PyKinBody::ComputeInverseDynamics(object odofaccelerations, object oexter
     }
 }
 
+object PyKinBody::ComputeMassMatrix()
+{
+    std::vector<dReal> vmassmatrix;
+    _pbody->ComputeMassMatrix(vmassmatrix);
+    std::vector<npy_intp> dims(2); dims[0] = _pbody->GetDOF(); dims[1] = _pbody->GetDOF();
+    return toPyArray(vmassmatrix,dims);
+}
+
+object PyKinBody::ComputeForwardDynamics(object odoftorques, object oexternalforcetorque)
+{
+    std::vector<dReal> vDOFTorques = ExtractArray<dReal>(odoftorques);
+    KinBody::ForceTorqueMap mapExternalForceTorque;
+    ExtractForceTorqueMap(oexternalforcetorque, mapExternalForceTorque);
+    std::vector<dReal> vDOFAccelerations;
+    _pbody->ComputeForwardDynamics(vDOFAccelerations,vDOFTorques,mapExternalForceTorque);
+    return toPyArray(vDOFAccelerations);
+}
+
 object PyKinBody::GetDOFDynamicAccelerationJerkLimits(py::object oDOFPositions, py::object oDOFVelocities) const
 {
     if( IS_PYTHONOBJECT_NONE(oDOFPositions) || IS_PYTHONOBJECT_NONE(oDOFVelocities) ) {
@@ -4887,6 +4947,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetInstantaneousTorqueLimits_overloads, G
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetNominalTorqueLimits_overloads, GetNominalTorqueLimits, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetMaxInertia_overloads, GetMaxInertia, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetLinkTransformations_overloads, GetLinkTransformations, 0, 1)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetLinkTransformPoses_overloads, GetLinkTransformPoses, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SetLinkTransformations_overloads, SetLinkTransformations, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SetDOFLimits_overloads, SetDOFLimits, 2, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(SubtractDOFValues_overloads, SubtractDOFValues, 2, 3)
@@ -4895,6 +4956,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeJacobianAxisAngle_overloads, Compu
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeHessianTranslation_overloads, ComputeHessianTranslation, 2, 3)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeHessianAxisAngle_overloads, ComputeHessianAxisAngle, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeInverseDynamics_overloads, ComputeInverseDynamics, 1, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ComputeForwardDynamics_overloads, ComputeForwardDynamics, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Restore_overloads, Restore, 0,1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ExtractInfo_overloads, ExtractInfo, 0,1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(CreateKinBodyStateSaver_overloads, CreateKinBodyStateSaver, 0,1)
@@ -5691,6 +5753,7 @@ void init_openravepy_kinbody()
         std::string sInitFromBoxesDoc = std::string(DOXY_FN(KinBody,InitFromBoxes "const std::vector< AABB; bool")) + std::string("\nboxes is a Nx6 array, first 3 columsn are position, last 3 are extents");
         std::string sGetChainDoc = std::string(DOXY_FN(KinBody,GetChain)) + std::string("If returnjoints is false will return a list of links, otherwise will return a list of links (default is true)");
         std::string sComputeInverseDynamicsDoc = std::string(":param returncomponents: If True will return three N-element arrays that represents the torque contributions to M, C, and G.\n\n:param externalforcetorque: A dictionary of link indices and a 6-element array of forces/torques in that order.\n\n") + std::string(DOXY_FN(KinBody, ComputeInverseDynamics));
+        std::string sComputeForwardDynamicsDoc = std::string(":param externalforcetorque: A dictionary of link indices and a 6-element array of forces/torques in that order.\n\n") + std::string(DOXY_FN(KinBody, ComputeForwardDynamics));
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
         scope_ kinbody = class_<PyKinBody, OPENRAVE_SHARED_PTR<PyKinBody>, PyInterfaceBase>(m, "KinBody", py::dynamic_attr(), DOXY_CLASS(KinBody))
 #else
@@ -5849,6 +5912,14 @@ void init_openravepy_kinbody()
                          .def("GetLinkTransformations",&PyKinBody::GetLinkTransformations, GetLinkTransformations_overloads(PY_ARGS("returndoflastvlaues") DOXY_FN(KinBody,GetLinkTransformations)))
 #endif
                          .def("GetBodyTransformations",&PyKinBody::GetLinkTransformations, DOXY_FN(KinBody,GetLinkTransformations))
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                         .def("GetLinkTransformPoses", &PyKinBody::GetLinkTransformPoses,
+                              "returndoflastvalues"_a = false,
+                              "Returns the link transforms as a (N,7) array of [quaternion, translation] poses that shares memory with the queried transforms. SetLinkTransformations accepts the same array."
+                              )
+#else
+                         .def("GetLinkTransformPoses",&PyKinBody::GetLinkTransformPoses, GetLinkTransformPoses_overloads(PY_ARGS("returndoflastvalues") "Returns the link transforms as a (N,7) array of [quaternion, translation] poses that shares memory with the queried transforms. SetLinkTransformations accepts the same array."))
+#endif
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
                          .def("SetLinkTransformations",&PyKinBody::SetLinkTransformations,
                               "transforms"_a,
@@ -6047,6 +6118,16 @@ void init_openravepy_kinbody()
                               )
 #else
                          .def("ComputeInverseDynamics",&PyKinBody::ComputeInverseDynamics, ComputeInverseDynamics_overloads(PY_ARGS("dofaccelerations","externalforcetorque","returncomponents") sComputeInverseDynamicsDoc.c_str()))
+#endif
+                         .def("ComputeMassMatrix",&PyKinBody::ComputeMassMatrix, DOXY_FN(KinBody,ComputeMassMatrix))
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                         .def("ComputeForwardDynamics", &PyKinBody::ComputeForwardDynamics,
+                              "doftorques"_a,
+                              "externalforcetorque"_a = py::none_(),
+                              sComputeForwardDynamicsDoc.c_str()
+                              )
+#else
+                         .def("ComputeForwardDynamics",&PyKinBody::ComputeForwardDynamics, ComputeForwardDynamics_overloads(PY_ARGS("doftorques","externalforcetorque") sComputeForwardDynamicsDoc.c_str()))
 #endif
                          .def("GetDOFDynamicAccelerationJerkLimits",&PyKinBody::GetDOFDynamicAccelerationJerkLimits, PY_ARGS("dofPositions","dofVelocities") DOXY_FN(KinBody,ComputeDynamicLimits))
                          .def("SetSelfCollisionChecker",&PyKinBody::SetSelfCollisionChecker,PY_ARGS("collisionchecker") DOXY_FN(KinBody,SetSelfCollisionChecker))
@@ -6188,6 +6269,7 @@ void init_openravepy_kinbody()
                           .def("GetId",&PyLink::GetId, DOXY_FN(KinBody::Link,GetId))
                           .def("GetName",&PyLink::GetName, DOXY_FN(KinBody::Link,GetName))
                           .def("GetIndex",&PyLink::GetIndex, DOXY_FN(KinBody::Link,GetIndex))
+                          .def("GetGeometryUpdateStamp",&PyLink::GetGeometryUpdateStamp, DOXY_FN(KinBody::Link,GetGeometryUpdateStamp))
                           .def("Enable",&PyLink::Enable,PY_ARGS("enable") DOXY_FN(KinBody::Link,Enable))
                           .def("IsEnabled",&PyLink::IsEnabled, DOXY_FN(KinBody::Link,IsEnabled))
                           .def("SetIgnoreSelfCollision",&PyLink::SetIgnoreSelfCollision,PY_ARGS("ignore") DOXY_FN(KinBody::Link,SetIgnoreSelfCollision))
@@ -6199,6 +6281,7 @@ void init_openravepy_kinbody()
                           .def("GetParentLinks",&PyLink::GetParentLinks, DOXY_FN(KinBody::Link,GetParentLinks))
                           .def("IsParentLink",&PyLink::IsParentLink, DOXY_FN(KinBody::Link,IsParentLink))
                           .def("GetCollisionData",&PyLink::GetCollisionData, DOXY_FN(KinBody::Link,GetCollisionData))
+                          .def("GetCompactCollisionData",&PyLink::GetCompactCollisionData, DOXY_FN(KinBody::Link,GetCompactCollisionData))
                           .def("ComputeAABB",&PyLink::ComputeAABB, DOXY_FN(KinBody::Link,ComputeAABB))
                           .def("ComputeAABBFromTransform",&PyLink::ComputeAABBFromTransform, PY_ARGS("transform") DOXY_FN(KinBody::Link,ComputeAABB))
                           .def("ComputeLocalAABB",&PyLink::ComputeLocalAABB, DOXY_FN(KinBody::Link,ComputeLocalAABB))
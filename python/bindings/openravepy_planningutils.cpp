@@ -99,6 +99,15 @@ void pyVerifyTrajectory(object pyparameters, PyTrajectoryBasePtr pytraj, dReal s
     OpenRAVE::planningutils::VerifyTrajectory(openravepy::GetPlannerParametersConst(pyparameters), openravepy::GetTrajectory(pytraj),samplingstep);
 }
 
+void pyVerifyTrajectoryParallel(object pyparameters, PyTrajectoryBasePtr pytraj, dReal samplingstep=0.002, int numthreads=0, bool releasegil=true)
+{
+    openravepy::PythonThreadSaverPtr statesaver;
+    if( releasegil ) {
+        statesaver.reset(new openravepy::PythonThreadSaver());
+    }
+    OpenRAVE::planningutils::VerifyTrajectoryParallel(openravepy::GetPlannerParametersConst(pyparameters), openravepy::GetTrajectory(pytraj),samplingstep,numthreads);
+}
+
 // GIL is assumed locked
 object pySmoothActiveDOFTrajectory(PyTrajectoryBasePtr pytraj, PyRobotBasePtr pyrobot, dReal fmaxvelmult=1.0, dReal fmaxaccelmult=1.0, const std::string& plannername="", const std::string& plannerparameters="")
 {
@@ -314,6 +323,10 @@ public:
         _pconstraints->SetTorqueLimitMode(static_cast<DynamicsConstraintsType>(torquelimitmode));
     }
 
+    void SetCheckOrder(OpenRAVE::planningutils::DynamicsCollisionCheckOrder checkorder) {
+        _pconstraints->SetCheckOrder(checkorder);
+    }
+
 
     PyEnvironmentBasePtr _pyenv;
     OpenRAVE::planningutils::DynamicsCollisionConstraintPtr _pconstraints;
@@ -526,6 +539,7 @@ BOOST_PYTHON_FUNCTION_OVERLOADS(ExtendActiveDOFWaypoint_overloads, planningutils
 BOOST_PYTHON_FUNCTION_OVERLOADS(InsertActiveDOFWaypointWithRetiming_overloads, planningutils::pyInsertActiveDOFWaypointWithRetiming, 5, 9)
 BOOST_PYTHON_FUNCTION_OVERLOADS(InsertWaypointWithSmoothing_overloads, planningutils::pyInsertWaypointWithSmoothing, 4, 7)
 BOOST_PYTHON_FUNCTION_OVERLOADS(VerifyTrajectory_overloads, planningutils::pyVerifyTrajectory, 3, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(VerifyTrajectoryParallel_overloads, planningutils::pyVerifyTrajectoryParallel, 2, 5)
 
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Check_overloads, Check, 5, 8)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(CheckWithAccelerations_overloads, CheckWithAccelerations, 7, 10)
@@ -601,6 +615,17 @@ void InitPlanningUtils()
                                .def("VerifyTrajectory",planningutils::pyVerifyTrajectory, PY_ARGS("parameters","trajectory","samplingstep", "releasegil") DOXY_FN1(VerifyTrajectory))
                                .staticmethod("VerifyTrajectory")
 #endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                               .def_static("VerifyTrajectoryParallel",planningutils::pyVerifyTrajectoryParallel,
+                                           "parameters"_a,
+                                           "trajectory"_a,
+                                           "samplingstep"_a=0.002,
+                                           "numthreads"_a=0,
+                                           "releasegil"_a=true, DOXY_FN1(VerifyTrajectoryParallel))
+#else
+                               .def("VerifyTrajectoryParallel",planningutils::pyVerifyTrajectoryParallel, VerifyTrajectoryParallel_overloads(PY_ARGS("parameters","trajectory","samplingstep","numthreads","releasegil") DOXY_FN1(VerifyTrajectoryParallel)))
+                               .staticmethod("VerifyTrajectoryParallel")
+#endif
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
                                .def_static("SmoothActiveDOFTrajectory", planningutils::pySmoothActiveDOFTrajectory,
                                            "trajectory"_a,
@@ -935,6 +960,15 @@ void InitPlanningUtils()
 #endif
         ;
 
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        enum_<OpenRAVE::planningutils::DynamicsCollisionCheckOrder>(planningutils, "DynamicsCollisionCheckOrder", py::arithmetic() DOXY_ENUM(DynamicsCollisionCheckOrder))
+#else
+        enum_<OpenRAVE::planningutils::DynamicsCollisionCheckOrder>("DynamicsCollisionCheckOrder" DOXY_ENUM(DynamicsCollisionCheckOrder))
+#endif
+        .value("Sequential", OpenRAVE::planningutils::DCCO_Sequential)
+        .value("Bisection", OpenRAVE::planningutils::DCCO_Bisection)
+        ;
+
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
         class_<planningutils::PyDynamicsCollisionConstraint, planningutils::PyDynamicsCollisionConstraintPtr >(planningutils, "DynamicsCollisionConstraint", DOXY_CLASS(planningutils::DynamicsCollisionConstraint))
         .def(init<object, object, uint32_t>(),
@@ -980,6 +1014,7 @@ void InitPlanningUtils()
         .def("SetFilterMask", &planningutils::PyDynamicsCollisionConstraint::SetFilterMask, PY_ARGS("filtermask") DOXY_FN(planningutils::DynamicsCollisionConstraint,SetFilterMask))
         .def("SetPerturbation", &planningutils::PyDynamicsCollisionConstraint::SetPerturbation, PY_ARGS("parameters") DOXY_FN(planningutils::DynamicsCollisionConstraint,SetPerturbation))
         .def("SetTorqueLimitMode", &planningutils::PyDynamicsCollisionConstraint::SetTorqueLimitMode, PY_ARGS("torquelimitmode") DOXY_FN(planningutils::DynamicsCollisionConstraint,SetTorqueLimitMode))
+        .def("SetCheckOrder", &planningutils::PyDynamicsCollisionConstraint::SetCheckOrder, PY_ARGS("checkorder") DOXY_FN(planningutils::DynamicsCollisionConstraint,SetCheckOrder))
         ;
     }
 }
@@ -106,9 +106,34 @@ object PySpaceSamplerBase::SampleSequence(SampleDataType type, size_t num, int i
 object PySpaceSamplerBase::SampleSequence2D(SampleDataType type, size_t num, int interval)
 {
     if( type == SDT_Real ) {
-        std::vector<dReal> samples;
-        _pspacesampler->SampleSequence(samples,num, (IntervalType) interval);
-        return _ReturnSamples2D(samples);
+        if( num == 0 ) {
+            return py::empty_array_astype<dReal>();
+        }
+        // sample straight into the returned array with the buffer version of SampleSequence
+        const int dim = _pspacesampler->GetNumberOfValues();
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        py::array_t<dReal> pyvalues({(int) num, dim});
+        py::buffer_info bufvalues = pyvalues.request();
+        dReal* pvalues = (dReal*) bufvalues.ptr;
+#else // USE_PYBIND11_PYTHON_BINDINGS
+        npy_intp dims[] = { npy_intp(num), npy_intp(dim) };
+        PyObject *pyvalues = PyArray_SimpleNew(2, dims, sizeof(dReal)==8 ? PyArray_DOUBLE : PyArray_FLOAT);
+        dReal* pvalues = (dReal*)PyArray_DATA(pyvalues);
+#endif // USE_PYBIND11_PYTHON_BINDINGS
+        const int ret = _pspacesampler->SampleSequence(pvalues, num, (IntervalType) interval);
+        if( ret != (int)num ) {
+            // only return the completed samples
+            const std::vector<dReal> samples(pvalues, pvalues + std::max(0, ret)*dim);
+#ifndef USE_PYBIND11_PYTHON_BINDINGS
+            Py_DECREF(pyvalues);
+#endif
+            return _ReturnSamples2D(samples);
+        }
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        return pyvalues;
+#else
+        return py::to_array_astype<dReal>(pyvalues);
+#endif
     }
     else if( type == SDT_Uint32 ) {
         std::vector<uint32_t> samples;
@@ -178,7 +203,7 @@ object PySpaceSamplerBase::_ReturnSamples2D(const std::vector<dReal>&samples)
 
 object PySpaceSamplerBase::_ReturnSamples2D(const std::vector<uint32_t>&samples)
 {
-    if( samples.empty() == 0 ) {
+    if( samples.empty() ) {
         return py::empty_array_astype<uint32_t>();
     }
     const int dim = _pspacesampler->GetNumberOfValues();
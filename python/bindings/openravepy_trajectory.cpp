@@ -400,16 +400,18 @@ size_t PyTrajectoryBase::GetNumWaypoints() const {
 
 object PyTrajectoryBase::GetWaypoints(size_t startindex, size_t endindex) const
 {
-    std::vector<dReal>& values = _vdataCache;
+    std::vector<dReal> values;
     _ptrajectory->GetWaypoints(startindex,endindex,values);
-    return toPyArray(values);
+    const std::vector<npy_intp> dims {npy_intp(values.size())};
+    return toPyArrayView(std::move(values), dims);
 }
 
 object PyTrajectoryBase::GetWaypoints(size_t startindex, size_t endindex, PyConfigurationSpecificationPtr pyspec) const
 {
-    std::vector<dReal>& values = _vdataCache;
+    std::vector<dReal> values;
     _ptrajectory->GetWaypoints(startindex,endindex,values,openravepy::GetConfigurationSpecification(pyspec));
-    return toPyArray(values);
+    const std::vector<npy_intp> dims {npy_intp(values.size())};
+    return toPyArrayView(std::move(values), dims);
 }
 
 object PyTrajectoryBase::GetWaypoints(size_t startindex, size_t endindex, OPENRAVE_SHARED_PTR<ConfigurationSpecification::Group> pygroup) const
@@ -418,25 +420,14 @@ object PyTrajectoryBase::GetWaypoints(size_t startindex, size_t endindex, OPENRA
     return this->GetWaypoints(startindex, endindex, pyspec);
 }
 
-// similar to GetWaypoints except returns a 2D array, one row for every waypoint
+// similar to GetWaypoints except returns a 2D array, one row for every waypoint. the array takes over the queried values without copying them
 object PyTrajectoryBase::GetWaypoints2D(size_t startindex, size_t endindex) const
 {
-    std::vector<dReal>& values = _vdataCache;
+    std::vector<dReal> values;
     _ptrajectory->GetWaypoints(startindex,endindex,values);
     const int numdof = _ptrajectory->GetConfigurationSpecification().GetDOF();
-
-#ifdef USE_PYBIND11_PYTHON_BINDINGS
-    py::array_t<dReal> pypos = toPyArray(values);
-    pypos.resize({(int) values.size()/numdof, numdof});
-    return pypos;
-#else // USE_PYBIND11_PYTHON_BINDINGS
-    npy_intp dims[] = { npy_intp(values.size()/numdof), npy_intp(numdof) };
-    PyObject *pypos = PyArray_SimpleNew(2,dims, sizeof(dReal)==8 ? PyArray_DOUBLE : PyArray_FLOAT);
-    if( !values.empty() ) {
-        memcpy(PyArray_DATA(pypos), values.data(), values.size()*sizeof(values[0]));
-    }
-    return py::to_array_astype<dReal>(pypos);
-#endif // USE_PYBIND11_PYTHON_BINDINGS
+    const std::vector<npy_intp> dims {npy_intp(values.size()/numdof), npy_intp(numdof)};
+    return toPyArrayView(std::move(values), dims);
 }
 
 object PyTrajectoryBase::__getitem__(int index) const
@@ -512,23 +503,12 @@ object PyTrajectoryBase::GetAllWaypoints2D() const
 
 object PyTrajectoryBase::GetWaypoints2D(size_t startindex, size_t endindex, PyConfigurationSpecificationPtr pyspec) const
 {
-    std::vector<dReal>& values = _vdataCache;
+    std::vector<dReal> values;
     ConfigurationSpecification spec = openravepy::GetConfigurationSpecification(pyspec);
     _ptrajectory->GetWaypoints(startindex,endindex,values,spec);
     const int numdof = spec.GetDOF();
-    const int nvalues = values.size();
-#ifdef USE_PYBIND11_PYTHON_BINDINGS
-    py::array_t<dReal> pypos = toPyArray(values);
-    pypos.resize({nvalues/numdof, numdof});
-    return pypos;
-#else // USE_PYBIND11_PYTHON_BINDINGS
-    npy_intp dims[] = { npy_intp(nvalues/numdof), npy_intp(numdof) };
-    PyObject *pypos = PyArray_SimpleNew(2,dims, sizeof(dReal)==8 ? PyArray_DOUBLE : PyArray_FLOAT);
-    if( !values.empty() ) {
-        memcpy(PyArray_DATA(pypos), values.data(), nvalues*sizeof(values[0]));
-    }
-    return py::to_array_astype<dReal>(pypos);
-#endif // USE_PYBIND11_PYTHON_BINDINGS
+    const std::vector<npy_intp> dims {npy_intp(values.size()/numdof), npy_intp(numdof)};
+    return toPyArrayView(std::move(values), dims);
 }
 
 object PyTrajectoryBase::GetWaypoints2D(size_t startindex, size_t endindex, OPENRAVE_SHARED_PTR<ConfigurationSpecification::Group> pygroup) const
@@ -17,6 +17,7 @@ from ..openravepy_int import RaveCreateModule, RaveCreateTrajectory, matrixSeria
 from .. import PlanningError
 
 import numpy
+import json
 from copy import copy as shallowcopy
 
 import logging
@@ -129,17 +130,29 @@ class VisualFeedback:
         
         return int(res)
     
-    def ComputeVisibleConfiguration(self,pose):
+    def ComputeVisibleConfiguration(self,pose=None,poses=None):
         """See :ref:`module-visualfeedback-computevisibleconfiguration`
+
+        Either pose or poses has to be given.
+
+        :param pose: camera pose, returns the json string of its result
+        :param poses: camera poses, returns a list with the parsed json result of every pose in the same order
         """
         cmd = 'ComputeVisibleConfiguration '
-        cmd += 'pose '
-        for i in range(7):
-            cmd += str(pose[i]) + ' '
+        if pose is not None:
+            cmd += 'pose '
+            for i in range(7):
+                cmd += str(pose[i]) + ' '
+        if poses is not None:
+            cmd += 'poses %d '%len(poses)
+            for f in numpy.reshape(poses,len(poses)*7):
+                cmd += str(f) + ' '
         res = self.prob.SendCommand(cmd)
         log.info('result of compute visible conf: %s' % res)
         if res is None:
             raise PlanningError()
+        if poses is not None:
+            return json.loads(res)['results']
         return res
 
     def SampleVisibilityGoal(self,numsamples=None):
@@ -204,7 +217,7 @@ class VisualFeedback:
         if res is None:
             raise PlanningError()
         return res
-    def SetParameter(self,raydensity=None,raymindist=None,allowableocclusion=None):
+    def SetParameter(self,raydensity=None,raymindist=None,allowableocclusion=None,numthreads=None):
         """See :ref:`module-visualfeedback-setparameter`
         """
         cmd = 'SetParameter '
@@ -214,4 +227,6 @@ class VisualFeedback:
             cmd += 'raymindist %.15e '%raymindist
         if allowableocclusion is not None:
             cmd += 'allowableocclusion %.15e '%allowableocclusion
+        if numthreads is not None:
+            cmd += 'numthreads %d '%numthreads
         return self.prob.SendCommand(cmd)
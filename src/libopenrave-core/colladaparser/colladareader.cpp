@@ -2510,10 +2510,6 @@ public:
             pgeom->_info._id = str(boost::format("geom%d")%plink->_vGeometries.size());
             pgeom->_info.InitCollisionMesh();
             plink->_vGeometries.push_back(pgeom);
-            //  Append the collision mesh
-            TriMesh trimesh = pgeom->GetCollisionMesh();
-            trimesh.ApplyTransform(pgeom->_info.GetTransform());
-            plink->_collision.Append(trimesh);
         }
 
         return bhasgeometry || listGeometryInfos.size() > 0;
@@ -2569,7 +2565,8 @@ public:
             return false;
         }
 
-        TriMesh& trimesh = geom._meshcollision;
+        TriMesh trimesh;
+        geom._meshcollision.GetTriMesh(trimesh);
         geom._type = GT_TriMesh;
 
         // resolve the material and assign correct colors to the geometry
@@ -2636,6 +2633,7 @@ public:
         if( trimesh.indices.size() != 3*triRef->getCount() ) {
             RAVELOG_WARN("triangles declares wrong count!\n");
         }
+        geom._meshcollision.SetTriMesh(trimesh);
         return true;
     }
 
@@ -2650,7 +2648,8 @@ public:
         if( !triRef ) {
             return false;
         }
-        TriMesh& trimesh = geom._meshcollision;
+        TriMesh trimesh;
+        geom._meshcollision.GetTriMesh(trimesh);
         geom._type = GT_TriMesh;
 
         // resolve the material and assign correct colors to the geometry
@@ -2726,6 +2725,7 @@ public:
                 }
             }
         }
+        geom._meshcollision.SetTriMesh(trimesh);
         return true;
     }
 
@@ -2740,7 +2740,8 @@ public:
         if( !triRef ) {
             return false;
         }
-        TriMesh& trimesh = geom._meshcollision;
+        TriMesh trimesh;
+        geom._meshcollision.GetTriMesh(trimesh);
         geom._type = GT_TriMesh;
 
         // resolve the material and assign correct colors to the geometry
@@ -2819,6 +2820,7 @@ public:
                 }
             }
         }
+        geom._meshcollision.SetTriMesh(trimesh);
         return true;
     }
 
@@ -2833,7 +2835,8 @@ public:
         if( !triRef ) {
             return false;
         }
-        TriMesh& trimesh = geom._meshcollision;
+        TriMesh trimesh;
+        geom._meshcollision.GetTriMesh(trimesh);
         geom._type = GT_TriMesh;
 
         // resolve the material and assign correct colors to the geometry
@@ -2899,6 +2902,7 @@ public:
                 break;
             }
         }
+        geom._meshcollision.SetTriMesh(trimesh);
         return true;
     }
 
@@ -3339,8 +3343,8 @@ public:
                 FOREACH(itgeominfo,listNewGeometryInfos) {
                     itgeominfo->InitCollisionMesh();
                     Transform tnew = tlocalgeominv * itgeominfo->GetTransform();
-                    FOREACH(itvertex, itgeominfo->_meshcollision.vertices) {
-                        vconvexhull.push_back(tnew * *itvertex);
+                    for(size_t ivertex = 0; ivertex < itgeominfo->_meshcollision.GetNumVertices(); ++ivertex) {
+                        vconvexhull.push_back(tnew * itgeominfo->_meshcollision.GetVertex(ivertex));
                     }
                 }
             }
@@ -3377,7 +3381,9 @@ public:
                 listGeometryInfos.back()._type = GT_TriMesh;
                 listGeometryInfos.back().SetTransform(tlocalgeom);
                 listGeometryInfos.back()._bVisible = bgeomvisible;
-                _computeConvexHull(vconvexhull,listGeometryInfos.back()._meshcollision);
+                TriMesh meshcollision;
+                _computeConvexHull(vconvexhull,meshcollision);
+                listGeometryInfos.back()._meshcollision.SetTriMesh(meshcollision);
             }
             return true;
         }
@@ -1938,7 +1938,8 @@ private:
     /// \param parentid Parent Identifier
     virtual domGeometryRef WriteGeometry(KinBody::Link::GeometryConstPtr geom, const string& parentid)
     {
-        const TriMesh& mesh = geom->GetCollisionMesh();
+        TriMesh mesh;
+        geom->GetCollisionMesh().GetTriMesh(mesh);
         Transform tgeom = geom->GetTransform();
 
         string effid = parentid+string("_eff");
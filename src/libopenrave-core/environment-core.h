@@ -270,6 +270,7 @@ public:
         if( !_pCurrentChecker ) {
             _pCurrentChecker = RaveCreateCollisionChecker(shared_from_this(), "GenericCollisionChecker");
         }
+        _UpdateCollisionCheckerStatistics();
         if( !_pPhysicsEngine ) {
             _pPhysicsEngine = RaveCreatePhysicsEngine(shared_from_this(), "GenericPhysicsEngine");
             _SetDefaultGravity();
@@ -416,6 +417,7 @@ public:
 
         // release all other interfaces, not necessary to hold a mutex?
         _pCurrentChecker.reset();
+        _UpdateCollisionCheckerStatistics();
         _pPhysicsEngine.reset();
         RAVELOG_VERBOSE("Environment destroyed\n");
     }
@@ -1481,6 +1483,7 @@ public:
                 pbody->_ResetInternalCollisionCache();
             }
         }
+        _UpdateCollisionCheckerStatistics();
         return _pCurrentChecker->InitEnvironment();
     }
 
@@ -1492,6 +1495,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody1);
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(pbody1,report);
     }
 
@@ -1500,6 +1504,7 @@ public:
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody1);
         CHECK_COLLISION_BODY(pbody2);
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(pbody1,pbody2,report);
     }
 
@@ -1507,6 +1512,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink->GetParent());
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(plink,report);
     }
 
@@ -1515,6 +1521,7 @@ public:
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink1->GetParent());
         CHECK_COLLISION_BODY(plink2->GetParent());
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(plink1,plink2,report);
     }
 
@@ -1523,6 +1530,7 @@ public:
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink->GetParent());
         CHECK_COLLISION_BODY(pbody);
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(plink,pbody,report);
     }
 
@@ -1530,6 +1538,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink->GetParent());
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(plink,vbodyexcluded,vlinkexcluded,report);
     }
 
@@ -1537,6 +1546,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody);
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(pbody,vbodyexcluded,vlinkexcluded,report);
     }
 
@@ -1544,16 +1554,19 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink->GetParent());
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(ray,plink,report);
     }
     virtual bool CheckCollision(const RAY& ray, KinBodyConstPtr pbody, CollisionReportPtr report) override
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody);
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(ray,pbody,report);
     }
     virtual bool CheckCollision(const RAY& ray, CollisionReportPtr report) override
     {
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(ray,report);
     }
 
@@ -1561,6 +1574,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody);
+        StatisticsTimer timer(_pCheckCollisionStatistics);
         return _pCurrentChecker->CheckCollision(trimesh,pbody,report);
     }
 
@@ -1568,6 +1582,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody);
+        StatisticsTimer timer(_pCheckStandaloneSelfCollisionStatistics);
         return _pCurrentChecker->CheckStandaloneSelfCollision(pbody,report);
     }
 
@@ -1690,7 +1705,7 @@ public:
     {
         EnvironmentLock lockenv(GetMutex());     // reading collision data, so don't want anyone modifying it
         FOREACHC(it, body.GetLinks()) {
-            trimesh.Append((*it)->GetCollisionData(), (*it)->GetTransform());
+            trimesh.Append((*it)->GetCompactCollisionData(), (*it)->GetTransform());
         }
     }
 
@@ -4431,6 +4446,19 @@ protected:
         return data.size() > 0 && !std::isprint(data[0]);
     }
 
+    /// \brief points the collision counters to the counters of the xml id of _pCurrentChecker
+    void _UpdateCollisionCheckerStatistics()
+    {
+        if( !!_pCurrentChecker ) {
+            _pCheckCollisionStatistics = GetStatisticsRegistry().GetCounter(_pCurrentChecker->GetXMLId(), "CheckCollision");
+            _pCheckStandaloneSelfCollisionStatistics = GetStatisticsRegistry().GetCounter(_pCurrentChecker->GetXMLId(), "CheckStandaloneSelfCollision");
+        }
+        else {
+            _pCheckCollisionStatistics = nullptr;
+            _pCheckStandaloneSelfCollisionStatistics = nullptr;
+        }
+    }
+
     void _ClearRapidJsonBuffer()
     {
         // TODO resize smartly
@@ -4456,6 +4484,8 @@ protected:
     int _nBodiesModifiedStamp;     ///< incremented every tiem bodies vector is modified
 
     CollisionCheckerBasePtr _pCurrentChecker;
+    StatisticsCounter* _pCheckCollisionStatistics = nullptr; ///< counts the CheckCollision calls of _pCurrentChecker, see _UpdateCollisionCheckerStatistics
+    StatisticsCounter* _pCheckStandaloneSelfCollisionStatistics = nullptr; ///< counts the CheckStandaloneSelfCollision calls of _pCurrentChecker
     PhysicsEngineBasePtr _pPhysicsEngine;
 
     boost::shared_ptr<std::thread> _threadSimulation;                      ///< main loop for environment simulation
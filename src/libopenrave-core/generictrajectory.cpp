@@ -232,6 +232,7 @@ public:
             _vdddoffsets.resize(0);
             _vintegraloffsets.resize(0);
             _viioffsets.resize(0);
+            _ClearConverters();
             _spec = spec; // what if this pointer is the same?
             // order the groups based on computation order
             stable_sort(_spec._vgroups.begin(),_spec._vgroups.end(),boost::bind(&GenericTrajectory::SortGroups,this,_1,_2));
@@ -317,17 +318,14 @@ public:
             Insert(index, pdata, nDataElements, bOverwrite);
         }
         else {
-            std::vector< std::vector<ConfigurationSpecification::Group>::const_iterator > vconvertgroups(_spec._vgroups.size());
-            for(size_t i = 0; i < vconvertgroups.size(); ++i) {
-                vconvertgroups[i] = spec.FindCompatibleGroup(_spec._vgroups[i]);
-            }
+            ConfigurationSpecification::ConverterConstPtr pconverter = _GetConverterFrom(spec);
             size_t numpoints = nDataElements/spec.GetDOF();
             size_t sourceindex = 0;
             std::vector<dReal>::iterator ittargetdata;
             if( bOverwrite && index*_spec.GetDOF() < _vtrajdata.size() ) {
                 size_t copyelements = min(numpoints,_vtrajdata.size()/_spec.GetDOF()-index);
                 ittargetdata = _vtrajdata.begin()+index*_spec.GetDOF();
-                _ConvertData(ittargetdata, pdata, vconvertgroups, spec, copyelements, false);
+                _ConvertData(ittargetdata, pdata, *pconverter, spec, copyelements, false);
                 sourceindex = copyelements*spec.GetDOF();
                 index += copyelements;
             }
@@ -335,7 +333,7 @@ public:
                 size_t numelements = (nDataElements-sourceindex)/spec.GetDOF();
                 std::vector<dReal> vtemp(numelements*_spec.GetDOF());
                 ittargetdata = vtemp.begin();
-                _ConvertData(ittargetdata, pdata+sourceindex, vconvertgroups, spec, numelements, true);
+                _ConvertData(ittargetdata, pdata+sourceindex, *pconverter, spec, numelements, true);
                 _vtrajdata.insert(_vtrajdata.begin()+index*_spec.GetDOF(),vtemp.begin(),vtemp.end());
             }
             _bChanged = true;
@@ -412,13 +410,14 @@ public:
             data.resize(0);
         }
         data.resize(spec.GetDOF(),0);
+        ConfigurationSpecification::ConverterConstPtr pconverter = _GetConverterTo(spec);
         if( time >= GetDuration() ) {
-            ConfigurationSpecification::ConvertData(data.begin(),spec,_vtrajdata.end()-_spec.GetDOF(),_spec,1,GetEnv());
+            pconverter->Convert(data.begin(),_vtrajdata.end()-_spec.GetDOF(),1,GetEnv());
         }
         else {
             std::vector<dReal>::iterator it = std::lower_bound(_vaccumtime.begin(),_vaccumtime.end(),time);
             if( it == _vaccumtime.begin() ) {
-                ConfigurationSpecification::ConvertData(data.begin(),spec,_vtrajdata.begin(),_spec,1,GetEnv());
+                pconverter->Convert(data.begin(),_vtrajdata.begin(),1,GetEnv());
             }
             else {
                 // could be faster
@@ -442,7 +441,7 @@ public:
                 // should return the sample time relative to the last endpoint so it is easier to re-insert in the trajectory
                 vinternaldata.at(_timeoffset) = deltatime;
 
-                ConfigurationSpecification::ConvertData(data.begin(),spec,vinternaldata.begin(),_spec,1,GetEnv());
+                pconverter->Convert(data.begin(),vinternaldata.begin(),1,GetEnv());
             }
         }
     }
@@ -468,12 +467,7 @@ public:
         int dof = spec.GetDOF();
         data.resize(dof*numPoints);
 
-        ConfigurationSpecification::ConvertData(data.begin(),
-                                                spec,
-                                                dataInSourceSpec.begin(),
-                                                _spec,
-                                                numPoints,
-                                                GetEnv());
+        _GetConverterTo(spec)->Convert(data.begin(), dataInSourceSpec.begin(), numPoints, GetEnv());
     }
 
     void SampleRangeSameDeltaTime(std::vector<dReal>& data, dReal deltatime, dReal startTime, dReal stopTime, bool ensureLastPoint) const override
@@ -496,12 +490,7 @@ public:
         int dof = spec.GetDOF();
         data.resize(dof*numPoints);
 
-        ConfigurationSpecification::ConvertData(data.begin(),
-                                                spec,
-                                                dataInSourceSpec.begin(),
-                                                _spec,
-                                                numPoints,
-                                                GetEnv());
+        _GetConverterTo(spec)->Convert(data.begin(), dataInSourceSpec.begin(), numPoints, GetEnv());
     }
 
     const ConfigurationSpecification& GetConfigurationSpecification() const override
@@ -529,7 +518,7 @@ public:
         BOOST_ASSERT(startindex<=endindex && startindex*_spec.GetDOF() <= _vtrajdata.size() && endindex*_spec.GetDOF() <= _vtrajdata.size());
         data.resize(spec.GetDOF()*(endindex-startindex),0);
         if( startindex < endindex ) {
-            ConfigurationSpecification::ConvertData(data.begin(),spec,_vtrajdata.begin()+startindex*_spec.GetDOF(),_spec,endindex-startindex,GetEnv());
+            _GetConverterTo(spec)->Convert(data.begin(),_vtrajdata.begin()+startindex*_spec.GetDOF(),endindex-startindex,GetEnv());
         }
     }
 
@@ -846,6 +835,8 @@ public:
         OPENRAVE_ASSERT_OP(GetXMLId(),==,rawtraj->GetXMLId());
         boost::shared_ptr<GenericTrajectory> traj = boost::dynamic_pointer_cast<GenericTrajectory>(rawtraj);
         _spec.Swap(traj->_spec);
+        _ClearConverters();
+        traj->_ClearConverters();
         _vderivoffsets.swap(traj->_vderivoffsets);
         _vddoffsets.swap(traj->_vddoffsets);
         _vdddoffsets.swap(traj->_vdddoffsets);
@@ -862,13 +853,15 @@ public:
     }
 
 protected:
-    void _ConvertData(std::vector<dReal>::iterator ittargetdata, const dReal* psourcedata, const std::vector< std::vector<ConfigurationSpecification::Group>::const_iterator >& vconvertgroups, const ConfigurationSpecification& spec, size_t numelements, bool filluninitialized)
+    /// \brief converts data of spec to _spec with a converter from \ref _GetConverterFrom. Groups of _spec missing in spec are filled with identity transforms and zeros.
+    void _ConvertData(std::vector<dReal>::iterator ittargetdata, const dReal* psourcedata, const ConfigurationSpecification::Converter& converter, const ConfigurationSpecification& spec, size_t numelements, bool filluninitialized)
     {
-        for(size_t igroup = 0; igroup < vconvertgroups.size(); ++igroup) {
-            if( vconvertgroups[igroup] != spec._vgroups.end() ) {
-                ConfigurationSpecification::ConvertGroupData(ittargetdata+_spec._vgroups[igroup].offset, _spec.GetDOF(), _spec._vgroups[igroup], psourcedata+vconvertgroups[igroup]->offset, spec.GetDOF(), *vconvertgroups[igroup],numelements,GetEnv(),filluninitialized);
-            }
-            else if( filluninitialized ) {
+        converter.Convert(ittargetdata, _spec.GetDOF(), psourcedata, spec.GetDOF(), numelements, GetEnv(), filluninitialized);
+        if( !filluninitialized ) {
+            return;
+        }
+        for(size_t igroup = 0; igroup < _spec._vgroups.size(); ++igroup) {
+            if( spec.FindCompatibleGroup(_spec._vgroups[igroup]) == spec._vgroups.end() ) {
                 vector<dReal> vdefaultvalues(_spec._vgroups[igroup].dof,0);
                 const string& groupname = _spec._vgroups[igroup].name;
                 if( groupname.size() >= 16 && groupname.substr(0,16) == "affine_transform" ) {
@@ -894,6 +887,44 @@ protected:
         }
     }
 
+    /// \brief returns a converter from _spec to spec, reusing the ones of previous calls
+    ConfigurationSpecification::ConverterConstPtr _GetConverterTo(const ConfigurationSpecification& spec) const
+    {
+        std::lock_guard<std::mutex> lock(_mutexconverters);
+        return _GetCachedConverter(_listconvertersto, spec, _spec, true);
+    }
+
+    /// \brief returns a converter from spec to _spec that leaves missing groups untouched, reusing the ones of previous calls
+    ConfigurationSpecification::ConverterConstPtr _GetConverterFrom(const ConfigurationSpecification& spec) const
+    {
+        std::lock_guard<std::mutex> lock(_mutexconverters);
+        return _GetCachedConverter(_listconvertersfrom, _spec, spec, false);
+    }
+
+    static ConfigurationSpecification::ConverterConstPtr _GetCachedConverter(std::list<ConfigurationSpecification::ConverterPtr>& listconverters, const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups)
+    {
+        // the cache is cleared whenever _spec changes, so only the other specification has to be compared
+        const bool bCompareTarget = bFillMissingGroups;
+        for(std::list<ConfigurationSpecification::ConverterPtr>::iterator it = listconverters.begin(); it != listconverters.end(); ++it) {
+            if( bCompareTarget ? (*it)->GetTargetSpecification() == targetspec : (*it)->GetSourceSpecification() == sourcespec ) {
+                listconverters.splice(listconverters.begin(), listconverters, it);
+                return listconverters.front();
+            }
+        }
+        if( listconverters.size() >= s_nMaxCachedConverters ) {
+            listconverters.pop_back();
+        }
+        listconverters.push_front(ConfigurationSpecification::ConverterPtr(new ConfigurationSpecification::Converter(targetspec, sourcespec, bFillMissingGroups)));
+        return listconverters.front();
+    }
+
+    void _ClearConverters()
+    {
+        std::lock_guard<std::mutex> lock(_mutexconverters);
+        _listconvertersto.clear();
+        _listconvertersfrom.clear();
+    }
+
     void _ComputeInternal() const
     {
         if( !_bChanged ) {
@@ -1818,6 +1849,11 @@ protected:
     bool _bInit;
     mutable bool _bChanged; ///< if true, then _ComputeInternal() has to be called in order to compute _vaccumtime and _vdeltainvtime
     mutable bool _bSamplingVerified; ///< if false, then _VerifySampling() has not be called yet to verify that all points can be sampled.
+
+    static const size_t s_nMaxCachedConverters = 4; ///< maximum number of converters cached in each of _listconvertersto and _listconvertersfrom
+    mutable std::list<ConfigurationSpecification::ConverterPtr> _listconvertersto; ///< converters from _spec to other specifications, most recently used first
+    mutable std::list<ConfigurationSpecification::ConverterPtr> _listconvertersfrom; ///< converters from other specifications to _spec, most recently used first
+    mutable std::mutex _mutexconverters; ///< protects the converter caches since they are modified in const functions
 };
 
 TrajectoryBasePtr CreateGenericTrajectory(EnvironmentBasePtr penv, std::istream& sinput)
@@ -22,44 +22,243 @@
 
 #include <openrave/openravemsgpack.h>
 
+#include <boost/algorithm/string.hpp>
+#include <fstream>
+
+#ifdef HAVE_BOOST_FILESYSTEM
+#include <boost/filesystem/operations.hpp>
+#endif
+
 namespace OpenRAVE {
 
 // Need to forward declare this
-static void _ParseDocument(OpenRAVE::JSONDownloadContextPtr pContext);
+static void _ParseDocument(std::string uri, std::string& buffer, rapidjson::Document& doc);
 
-static void _DecryptDocument(OpenRAVE::JSONDownloadContextPtr pContext)
+static void _DecryptDocument(std::string uri, const std::string& buffer, rapidjson::Document& doc)
 {
-    std::istringstream iss(pContext->buffer, std::ios::in | std::ios::binary);
+    std::istringstream iss(buffer, std::ios::in | std::ios::binary);
     std::ostringstream oss;
     if (GpgDecrypt(iss, oss)) {
-        if (RemoveSuffix(pContext->uri, ".gpg")) {
-            pContext->buffer = oss.str();
-            _ParseDocument(pContext);
+        if (RemoveSuffix(uri, ".gpg")) {
+            std::string decryptedBuffer = oss.str();
+            _ParseDocument(uri, decryptedBuffer, doc);
         }
     } else {
         RAVELOG_ERROR("Failed to decrypt document.");
     }
 }
 
-static void _ParseDocument(OpenRAVE::JSONDownloadContextPtr pContext)
+/// \brief parses the downloaded data of uri into doc, the format is determined by the suffix of uri
+static void _ParseDocument(std::string uri, std::string& buffer, rapidjson::Document& doc)
 {
-    if (StringEndsWith(pContext->uri, ".json")) {
-        rapidjson::ParseResult ok = pContext->pDoc->Parse<rapidjson::kParseFullPrecisionFlag>(pContext->buffer.data(), pContext->buffer.size());
+    if (StringEndsWith(uri, ".json")) {
+        rapidjson::ParseResult ok = doc.Parse<rapidjson::kParseFullPrecisionFlag>(buffer.data(), buffer.size());
         if (!ok) {
-            throw OPENRAVE_EXCEPTION_FORMAT("failed to parse json document \"%s\"", pContext->uri, ORE_CurlInvalidResponse);
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to parse json document \"%s\"", uri, ORE_CurlInvalidResponse);
         }
     }
-    else if (StringEndsWith(pContext->uri, ".msgpack")) {
-        MsgPack::ParseMsgPack(*(pContext->pDoc), pContext->buffer.data(), pContext->buffer.size());
+    else if (StringEndsWith(uri, ".msgpack")) {
+        MsgPack::ParseMsgPack(doc, buffer.data(), buffer.size());
     }
-    else if (StringEndsWith(pContext->uri, ".gpg")) {
-        _DecryptDocument(pContext);
+    else if (StringEndsWith(uri, ".gpg")) {
+        _DecryptDocument(uri, buffer, doc);
     }
     else {
-        throw OPENRAVE_EXCEPTION_FORMAT("Do not know how to parse data from uri '%s', supported is json/msgpack", pContext->uri, ORE_EnvironmentFormatUnrecognized);
+        throw OPENRAVE_EXCEPTION_FORMAT("Do not know how to parse data from uri '%s', supported is json/msgpack", uri, ORE_EnvironmentFormatUnrecognized);
+    }
+}
+
+#ifdef HAVE_BOOST_FILESYSTEM
+
+/// \brief reads a whole file into buffer, returns false if the file cannot be opened
+static bool _ReadFileToBuffer(const std::string& filename, std::string& buffer)
+{
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!ifs) {
+        return false;
+    }
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    if (ifs.bad()) {
+        return false;
+    }
+    buffer = oss.str();
+    return true;
+}
+
+/// \brief writes buffer to a temporary file and renames it to filename, so that other processes never see a partially written file
+static void _WriteBufferToFileAtomically(const std::string& filename, const std::string& buffer)
+{
+    // random name so that threads and processes never write the same temporary file
+    const std::string tempFilename = filename + "." + boost::filesystem::unique_path().string() + ".tmp";
+    {
+        std::ofstream ofs(tempFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        ofs.write(buffer.data(), buffer.size());
+        if (!ofs) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to write download cache file \"%s\"", tempFilename, ORE_Failed);
+        }
+    }
+    if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        std::remove(tempFilename.c_str());
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to rename download cache file to \"%s\"", filename, ORE_Failed);
+    }
+}
+
+JSONDownloadCache::JSONDownloadCache(const std::string& cacheDirectory, uint64_t maxSizeBytes) :
+    _cacheDirectory(cacheDirectory),
+    _maxSizeBytes(maxSizeBytes)
+{
+    boost::system::error_code errorCode;
+    boost::filesystem::create_directories(_cacheDirectory, errorCode);
+    if (!boost::filesystem::is_directory(_cacheDirectory)) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to create download cache directory \"%s\": %s", _cacheDirectory%errorCode.message(), ORE_InvalidArguments);
+    }
+}
+
+bool JSONDownloadCache::Read(const std::string& uri, std::string& buffer) const
+{
+    const std::string entryPath = _GetEntryPath(uri);
+    std::string etag, lastModified;
+    if (!_ReadMetadata(entryPath, uri, etag, lastModified)) {
+        return false;
+    }
+    const std::string dataFilename = entryPath + ".data";
+    if (!_ReadFileToBuffer(dataFilename, buffer)) {
+        return false;
     }
+    // the modification time of the data file is the last access time used for eviction
+    boost::system::error_code errorCode;
+    boost::filesystem::last_write_time(dataFilename, std::time(nullptr), errorCode);
+    return true;
 }
 
+bool JSONDownloadCache::ReadValidators(const std::string& uri, std::string& etag, std::string& lastModified) const
+{
+    const std::string entryPath = _GetEntryPath(uri);
+    if (!boost::filesystem::exists(entryPath + ".data")) {
+        return false;
+    }
+    return _ReadMetadata(entryPath, uri, etag, lastModified);
+}
+
+void JSONDownloadCache::Write(const std::string& uri, const std::string& buffer, const std::string& etag, const std::string& lastModified)
+{
+    const std::string entryPath = _GetEntryPath(uri);
+    // write the data before the metadata, readers check the metadata uri so a concurrently replaced entry is never served for a different uri
+    _WriteBufferToFileAtomically(entryPath + ".data", buffer);
+    _WriteBufferToFileAtomically(entryPath + ".meta", uri + "\n" + etag + "\n" + lastModified + "\n");
+    _Evict();
+}
+
+bool JSONDownloadCache::_ReadMetadata(const std::string& entryPath, const std::string& uri, std::string& etag, std::string& lastModified) const
+{
+    std::ifstream ifs((entryPath + ".meta").c_str());
+    std::string cachedUri;
+    if (!std::getline(ifs, cachedUri) || cachedUri != uri) {
+        return false; // hash collision or entry being replaced
+    }
+    std::getline(ifs, etag);
+    std::getline(ifs, lastModified);
+    return true;
+}
+
+std::string JSONDownloadCache::_GetEntryPath(const std::string& uri) const
+{
+    // 64-bit FNV-1a, stable across processes and library versions unlike std::hash
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char c : uri) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+    return (boost::filesystem::path(_cacheDirectory) / boost::str(boost::format("%016x")%hash)).string();
+}
+
+void JSONDownloadCache::_Evict()
+{
+    struct CachedFile
+    {
+        std::time_t accessTime;
+        uint64_t size;
+        boost::filesystem::path path;
+    };
+    // writing a temporary file takes far less than this, so older ones were left by processes that died while writing
+    static const std::time_t s_staleTempFileAgeSeconds = 3600;
+    const std::time_t now = std::time(nullptr);
+    std::vector<CachedFile> vCachedFiles;
+    uint64_t totalSize = 0;
+    boost::system::error_code errorCode;
+    for (boost::filesystem::directory_iterator it(_cacheDirectory, errorCode), itEnd; it != itEnd; it.increment(errorCode)) {
+        if (errorCode) {
+            break;
+        }
+        if (it->path().extension() == ".tmp") {
+            const std::time_t writeTime = boost::filesystem::last_write_time(it->path(), errorCode);
+            if (!errorCode && writeTime + s_staleTempFileAgeSeconds < now) {
+                RAVELOG_VERBOSE_FORMAT("removing stale temporary file \"%s\" from download cache", it->path().string());
+                boost::filesystem::remove(it->path(), errorCode);
+            }
+            errorCode.clear();
+            continue;
+        }
+        if (it->path().extension() != ".data") {
+            continue;
+        }
+        CachedFile cachedFile;
+        cachedFile.path = it->path();
+        cachedFile.size = boost::filesystem::file_size(cachedFile.path, errorCode);
+        cachedFile.accessTime = boost::filesystem::last_write_time(cachedFile.path, errorCode);
+        if (errorCode) {
+            errorCode.clear();
+            continue; // removed by another process
+        }
+        totalSize += cachedFile.size;
+        vCachedFiles.push_back(cachedFile);
+    }
+    if (totalSize <= _maxSizeBytes) {
+        return;
+    }
+
+    std::sort(vCachedFiles.begin(), vCachedFiles.end(), [](const CachedFile& a, const CachedFile& b) {
+        return a.accessTime < b.accessTime;
+    });
+    for (const CachedFile& cachedFile : vCachedFiles) {
+        if (totalSize <= _maxSizeBytes) {
+            break;
+        }
+        RAVELOG_VERBOSE_FORMAT("evicting \"%s\" from download cache", cachedFile.path.string());
+        boost::filesystem::path metaPath = cachedFile.path;
+        metaPath.replace_extension(".meta");
+        boost::filesystem::remove(metaPath, errorCode);
+        boost::filesystem::remove(cachedFile.path, errorCode);
+        totalSize -= cachedFile.size;
+    }
+}
+
+#else
+
+JSONDownloadCache::JSONDownloadCache(const std::string& cacheDirectory, uint64_t maxSizeBytes) :
+    _cacheDirectory(cacheDirectory),
+    _maxSizeBytes(maxSizeBytes)
+{
+    throw OPENRAVE_EXCEPTION_FORMAT0("download cache requires boost filesystem", ORE_NotImplemented);
+}
+
+bool JSONDownloadCache::Read(const std::string& uri, std::string& buffer) const
+{
+    return false;
+}
+
+bool JSONDownloadCache::ReadValidators(const std::string& uri, std::string& etag, std::string& lastModified) const
+{
+    return false;
+}
+
+void JSONDownloadCache::Write(const std::string& uri, const std::string& buffer, const std::string& etag, const std::string& lastModified)
+{
+}
+
+#endif
+
 JSONDownloadContext::JSONDownloadContext()
 {
     curl = curl_easy_init();
@@ -70,6 +269,10 @@ JSONDownloadContext::JSONDownloadContext()
 
 JSONDownloadContext::~JSONDownloadContext()
 {
+    if (!!pHeaders) {
+        curl_slist_free_all(pHeaders);
+        pHeaders = nullptr;
+    }
     if (!!curl) {
         curl_easy_cleanup(curl);
         curl = nullptr;
@@ -98,6 +301,28 @@ JSONDownloader::~JSONDownloader()
     }
 }
 
+void JSONDownloader::SetDiskCache(const std::string& cacheDirectory, uint64_t maxSizeBytes, bool offline)
+{
+    if (cacheDirectory.empty()) {
+        if (offline) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("offline downloading requires a download cache directory", ORE_InvalidArguments);
+        }
+        _pDiskCache.reset();
+    }
+    else {
+#ifdef HAVE_BOOST_FILESYSTEM
+        _pDiskCache = boost::make_shared<JSONDownloadCache>(cacheDirectory, maxSizeBytes);
+#else
+        if (offline) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("offline downloading requires a download cache, which needs boost filesystem", ORE_NotImplemented);
+        }
+        RAVELOG_WARN_FORMAT("download cache \"%s\" requires boost filesystem, so downloaded documents are not cached", cacheDirectory);
+        _pDiskCache.reset();
+#endif
+    }
+    _offline = offline;
+}
+
 JSONDownloaderScope::JSONDownloaderScope(JSONDownloader& downloader, rapidjson::Document::AllocatorType& alloc, bool downloadRecursively) :
     _downloader(downloader),
     _alloc(alloc),
@@ -185,13 +410,23 @@ void JSONDownloaderScope::WaitForDownloads(uint64_t timeoutUS)
             if (getInfoCode != CURLE_OK) {
                 throw OPENRAVE_EXCEPTION_FORMAT("failed to get response status code for uri \"%s\": %s", pContext->uri%curl_easy_strerror(getInfoCode), ORE_CurlInvalidHandle);
             }
-            if (responseCode != 0 && responseCode != 200) {
+            if (responseCode == 304 && pContext->hasCachedEntry) {
+                // not modified since it was cached
+                if (!_downloader._pDiskCache->Read(pContext->uri, pContext->buffer)) {
+                    throw OPENRAVE_EXCEPTION_FORMAT("uri \"%s\" was not modified, but its entry was removed from the download cache", pContext->uri, ORE_CurlInvalidResponse);
+                }
+                RAVELOG_DEBUG_FORMAT("uri \"%s\" was not modified, using download cache", pContext->uri);
+            }
+            else if (responseCode != 0 && responseCode != 200) {
                 // file scheme downloads have a zero response code
                 throw OPENRAVE_EXCEPTION_FORMAT("failed to download uri \"%s\", received http %d response", pContext->uri%responseCode, ORE_CurlInvalidResponse);
             }
+            else if (responseCode == 200 && !!_downloader._pDiskCache) {
+                _downloader._pDiskCache->Write(pContext->uri, pContext->buffer, pContext->etag, pContext->lastModified);
+            }
 
             // parse data
-            _ParseDocument(pContext);
+            _ParseDocument(pContext->uri, pContext->buffer, *pContext->pDoc);
 
             RAVELOG_DEBUG_FORMAT("successfully downloaded \"%s\", took %d[us]", pContext->uri%(currentTimestampUS-pContext->startTimestampUS));
             ++numDownloads;
@@ -221,6 +456,30 @@ static size_t _WriteBackDataFromCurl(const char *data, size_t size, size_t dataS
     return numBytes;
 }
 
+static size_t _ReadHeaderFromCurl(const char *data, size_t size, size_t dataSize, JSONDownloadContext* pContext)
+{
+    const size_t numBytes = size * dataSize;
+    const std::string header(data, numBytes);
+    if (header.compare(0, 5, "HTTP/") == 0) {
+        // status line of a new response when following redirects
+        pContext->etag.clear();
+        pContext->lastModified.clear();
+        return numBytes;
+    }
+    const size_t colonIndex = header.find(':');
+    if (colonIndex == std::string::npos) {
+        return numBytes;
+    }
+    const std::string name = header.substr(0, colonIndex);
+    if (boost::iequals(name, "ETag")) {
+        pContext->etag = boost::trim_copy(header.substr(colonIndex+1));
+    }
+    else if (boost::iequals(name, "Last-Modified")) {
+        pContext->lastModified = boost::trim_copy(header.substr(colonIndex+1));
+    }
+    return numBytes;
+}
+
 void JSONDownloaderScope::_QueueDownloadURI(const char* pUri, rapidjson::Document* pDoc)
 {
     if( !pUri[0] ) {
@@ -265,6 +524,20 @@ void JSONDownloaderScope::_QueueDownloadURI(const char* pUri, rapidjson::Documen
         pDoc = pNewDoc.get();
     }
 
+    const bool isRemote = scheme != "file";
+    if (isRemote && _downloader._offline) {
+        std::string buffer;
+        if (!_downloader._pDiskCache->Read(canonicalUri, buffer)) {
+            throw OPENRAVE_EXCEPTION_FORMAT("uri \"%s\" is not in the download cache, cannot download it while offline", canonicalUri, ORE_CurlInvalidResponse);
+        }
+        _ParseDocument(canonicalUri, buffer, *pDoc);
+        RAVELOG_DEBUG_FORMAT("loaded uri \"%s\" from download cache", canonicalUri);
+        if (_downloadRecursively) {
+            QueueDownloadReferenceURIs(*pDoc);
+        }
+        return;
+    }
+
     JSONDownloadContextPtr pContext;
     if (!_downloader._vDownloadContextPool.empty()) {
         pContext.swap(_downloader._vDownloadContextPool.back());
@@ -276,6 +549,25 @@ void JSONDownloaderScope::_QueueDownloadURI(const char* pUri, rapidjson::Documen
     pContext->uri = canonicalUri;
     pContext->pDoc = pDoc;
     pContext->startTimestampUS = utils::GetMonotonicTime();
+    pContext->etag.clear();
+    pContext->lastModified.clear();
+    pContext->hasCachedEntry = false;
+    if (!!pContext->pHeaders) {
+        curl_slist_free_all(pContext->pHeaders);
+        pContext->pHeaders = nullptr;
+    }
+
+    // revalidate a cached entry instead of downloading it again
+    std::string cachedEtag, cachedLastModified;
+    if (isRemote && !!_downloader._pDiskCache && _downloader._pDiskCache->ReadValidators(canonicalUri, cachedEtag, cachedLastModified)) {
+        if (!cachedEtag.empty()) {
+            pContext->pHeaders = curl_slist_append(pContext->pHeaders, ("If-None-Match: " + cachedEtag).c_str());
+        }
+        if (!cachedLastModified.empty()) {
+            pContext->pHeaders = curl_slist_append(pContext->pHeaders, ("If-Modified-Since: " + cachedLastModified).c_str());
+        }
+        pContext->hasCachedEntry = !!pContext->pHeaders;
+    }
 
     // set curl options
     CURLcode curlCode;
@@ -311,6 +603,19 @@ void JSONDownloaderScope::_QueueDownloadURI(const char* pUri, rapidjson::Documen
     if (curlCode != CURLE_OK) {
         throw OPENRAVE_EXCEPTION_FORMAT("failed to curl_easy_setopt(CURLOPT_WRITEDATA) for uri \"%s\": %s", canonicalUri%curl_easy_strerror(curlCode), ORE_CurlInvalidHandle);
     }
+    curlCode = curl_easy_setopt(pContext->curl, CURLOPT_HEADERFUNCTION, _ReadHeaderFromCurl);
+    if (curlCode != CURLE_OK) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to curl_easy_setopt(CURLOPT_HEADERFUNCTION) for uri \"%s\": %s", canonicalUri%curl_easy_strerror(curlCode), ORE_CurlInvalidHandle);
+    }
+    curlCode = curl_easy_setopt(pContext->curl, CURLOPT_HEADERDATA, pContext.get());
+    if (curlCode != CURLE_OK) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to curl_easy_setopt(CURLOPT_HEADERDATA) for uri \"%s\": %s", canonicalUri%curl_easy_strerror(curlCode), ORE_CurlInvalidHandle);
+    }
+    // always set, the context may be reused from the pool with the headers of a previous download
+    curlCode = curl_easy_setopt(pContext->curl, CURLOPT_HTTPHEADER, pContext->pHeaders);
+    if (curlCode != CURLE_OK) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to curl_easy_setopt(CURLOPT_HTTPHEADER) for uri \"%s\": %s", canonicalUri%curl_easy_strerror(curlCode), ORE_CurlInvalidHandle);
+    }
     if (!_downloader._unixEndpoint.empty()) {
         curlCode = curl_easy_setopt(pContext->curl, CURLOPT_UNIX_SOCKET_PATH, _downloader._unixEndpoint.c_str());
         if (curlCode != CURLE_OK) {
@@ -41,15 +41,60 @@ public:
     std::string buffer; ///< buffer used to receive downloaded data
     rapidjson::Document* pDoc = nullptr; ///< if non-null, the caller-supplied document to put results into
     uint64_t startTimestampUS = 0; ///< start timestamp in microseconds
+    curl_slist* pHeaders = nullptr; ///< extra request headers, used to revalidate cached entries
+    bool hasCachedEntry = false; ///< true if the disk cache has an entry for the uri, so a 304 response can be served from it
+    std::string etag; ///< ETag header of the response
+    std::string lastModified; ///< Last-Modified header of the response
 };
 typedef boost::shared_ptr<JSONDownloadContext> JSONDownloadContextPtr;
 
+/// \brief Persistent cache of downloaded documents on the local disk, can be shared by several processes.
+///
+/// Entries are keyed by the canonical uri and keep the ETag and Last-Modified headers of the response so that they can be revalidated with the server.
+/// When the total size of the cached data exceeds the limit, the least recently used entries are removed.
+class JSONDownloadCache
+{
+public:
+    /// \param cacheDirectory directory to store the entries in, created if it does not exist
+    /// \param maxSizeBytes maximum total size of the cached data
+    JSONDownloadCache(const std::string& cacheDirectory, uint64_t maxSizeBytes);
+
+    /// \brief reads the data of an entry and marks it as recently used, returns false if there is no entry for the uri or the entry belongs to another uri
+    bool Read(const std::string& uri, std::string& buffer) const;
+
+    /// \brief reads the validators of an entry, returns false if there is no entry for the uri
+    bool ReadValidators(const std::string& uri, std::string& etag, std::string& lastModified) const;
+
+    /// \brief stores a downloaded document, then removes the least recently used entries if the cache is too large
+    void Write(const std::string& uri, const std::string& buffer, const std::string& etag, const std::string& lastModified);
+
+protected:
+    /// \brief returns the path of the entry files without extension
+    std::string _GetEntryPath(const std::string& uri) const;
+
+    /// \brief reads the metadata file of an entry, returns false if there is none or it belongs to a different uri
+    bool _ReadMetadata(const std::string& entryPath, const std::string& uri, std::string& etag, std::string& lastModified) const;
+
+    /// \brief removes the least recently used entries until the size of the cached data is within the limit, and temporary files left by writers that died
+    void _Evict();
+
+    std::string _cacheDirectory;
+    uint64_t _maxSizeBytes;
+};
+typedef boost::shared_ptr<JSONDownloadCache> JSONDownloadCachePtr;
+
 /// \brief Downloader to download one or multiple uris and their references, used by JSONDownloaderScope to share keep-alive connections and other resources
 class JSONDownloader {
 public:
     JSONDownloader(std::map<std::string, boost::shared_ptr<const rapidjson::Document> >& rapidJSONDocuments, const std::vector<std::string>& vOpenRAVESchemeAliases, const std::string& remoteUrl, const std::string& unixEndpoint);
     ~JSONDownloader();
 
+    /// \brief keeps downloaded documents in a cache on the local disk and revalidates them instead of downloading again
+    /// \param cacheDirectory directory of the cache, if empty then disables the cache
+    /// \param maxSizeBytes maximum total size of the cached data
+    /// \param offline if true, remote documents are only read from the cache and never downloaded
+    void SetDiskCache(const std::string& cacheDirectory, uint64_t maxSizeBytes, bool offline);
+
 protected:
     std::map<std::string, boost::shared_ptr<const rapidjson::Document> >& _rapidJSONDocuments; ///< cache for opened rapidjson Documents, newly downloaded documents will be inserted here, passed in via constructor
     const std::vector<std::string>& _vOpenRAVESchemeAliases; ///< list of scheme aliases, passed in via constructor
@@ -61,6 +106,9 @@ protected:
 
     std::vector<JSONDownloadContextPtr> _vDownloadContextPool; ///< pool of JSONDownloadContext objects to be reused
 
+    JSONDownloadCachePtr _pDiskCache; ///< if set, cache of downloaded documents on the local disk
+    bool _offline = false; ///< if true, remote documents are only read from _pDiskCache
+
     friend class JSONDownloaderScope;
 };
 typedef boost::shared_ptr<JSONDownloader> JSONDownloaderPtr;
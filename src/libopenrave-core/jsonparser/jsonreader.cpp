@@ -154,6 +154,9 @@ public:
     {
         std::string remoteUrl;
         std::string unixEndpoint;
+        std::string downloadCacheDirectory;
+        uint64_t downloadCacheSizeBytes = 1ull << 30;
+        bool downloadOffline = false;
 
         FOREACHC(itatt, atts) {
             if (itatt->first == "openravescheme") {
@@ -177,6 +180,17 @@ public:
             else if (itatt->first == "unixendpoint") {
                 unixEndpoint = itatt->second;
             }
+            else if (itatt->first == "downloadcachedir") {
+                downloadCacheDirectory = itatt->second;
+            }
+            else if (itatt->first == "downloadcachesize") {
+                // maximum size of the download cache in bytes
+                stringstream ss(itatt->second);
+                ss >> downloadCacheSizeBytes;
+            }
+            else if (itatt->first == "downloadoffline") {
+                downloadOffline = _stricmp(itatt->second.c_str(), "true") == 0 || itatt->second=="1";
+            }
             else if (itatt->first == "timeout") {
                 dReal timeout = 0;
                 stringstream ss(itatt->second);
@@ -199,6 +213,7 @@ public:
         if (!remoteUrl.empty()) {
 #if OPENRAVE_CURL
             _pDownloader = boost::make_shared<JSONDownloader>(_rapidJSONDocuments, _vOpenRAVESchemeAliases, remoteUrl, unixEndpoint);
+            _pDownloader->SetDiskCache(downloadCacheDirectory, downloadCacheSizeBytes, downloadOffline);
 #else
             throw OPENRAVE_EXCEPTION_FORMAT("\"remoteurl\" option is not supported, have to compile openrave with CURL support first", _filename, ORE_InvalidArguments);
 #endif
@@ -366,17 +366,18 @@ protected:
     void _ExtractGeometry(const Assimp::XFile::Mesh* pmesh, KinBody::GeometryInfo& g)
     {
         g._type = GT_TriMesh;
-        g._meshcollision.vertices.resize(pmesh->mPositions.size());
+        TriMesh meshcollision;
+        meshcollision.vertices.resize(pmesh->mPositions.size());
         // faces are defined clockwise in X file, so flip Z and change the order of indices!
         for(size_t i = 0; i < pmesh->mPositions.size(); ++i) {
-            g._meshcollision.vertices[i] = Vector(pmesh->mPositions[i].x*_vScaleGeometry.x,pmesh->mPositions[i].y*_vScaleGeometry.y, -pmesh->mPositions[i].z*_vScaleGeometry.z);
+            meshcollision.vertices[i] = Vector(pmesh->mPositions[i].x*_vScaleGeometry.x,pmesh->mPositions[i].y*_vScaleGeometry.y, -pmesh->mPositions[i].z*_vScaleGeometry.z);
         }
         size_t numindices = 0;
         for(size_t iface = 0; iface < pmesh->mPosFaces.size(); ++iface) {
             numindices += 3*(pmesh->mPosFaces[iface].mIndices.size()-2);
         }
-        g._meshcollision.indices.resize(numindices);
-        std::vector<int>::iterator itindex = g._meshcollision.indices.begin();
+        meshcollision.indices.resize(numindices);
+        std::vector<int>::iterator itindex = meshcollision.indices.begin();
         for(size_t iface = 0; iface < pmesh->mPosFaces.size(); ++iface) {
             for(size_t i = 2; i < pmesh->mPosFaces[iface].mIndices.size(); ++i) {
                 *itindex++ = pmesh->mPosFaces[iface].mIndices.at(1);
@@ -384,6 +385,7 @@ protected:
                 *itindex++ = pmesh->mPosFaces[iface].mIndices.at(i);
             }
         }
+        g._meshcollision.SetTriMesh(meshcollision);
 
         size_t matindex = 0;
         if( pmesh->mFaceMaterials.size() > 0 ) {
@@ -253,33 +253,35 @@ static bool _AssimpCreateGeometries(const aiScene* scene, aiNode* node, const Ve
         g._type = GT_TriMesh;
         g._vRenderScale = scale;
         aiMesh* input_mesh = scene->mMeshes[node->mMeshes[i]];
-        g._meshcollision.vertices.resize(input_mesh->mNumVertices);
+        TriMesh meshcollision;
+        meshcollision.vertices.resize(input_mesh->mNumVertices);
         for (size_t j = 0; j < input_mesh->mNumVertices; j++) {
             aiVector3D p = input_mesh->mVertices[j];
             p *= transform;
-            g._meshcollision.vertices[j] = Vector(p.x*scale.x,p.y*scale.y,p.z*scale.z);
+            meshcollision.vertices[j] = Vector(p.x*scale.x,p.y*scale.y,p.z*scale.z);
         }
         size_t indexCount = 0;
         for (size_t j = 0; j < input_mesh->mNumFaces; j++) {
             aiFace& face = input_mesh->mFaces[j];
             indexCount += 3*(face.mNumIndices-2);
         }
-        g._meshcollision.indices.reserve(indexCount);
+        meshcollision.indices.reserve(indexCount);
         for (size_t j = 0; j < input_mesh->mNumFaces; j++) {
             aiFace& face = input_mesh->mFaces[j];
             if( face.mNumIndices == 3 ) {
-                g._meshcollision.indices.push_back(face.mIndices[0]);
-                g._meshcollision.indices.push_back(face.mIndices[1]);
-                g._meshcollision.indices.push_back(face.mIndices[2]);
+                meshcollision.indices.push_back(face.mIndices[0]);
+                meshcollision.indices.push_back(face.mIndices[1]);
+                meshcollision.indices.push_back(face.mIndices[2]);
             }
             else {
                 for (size_t k = 2; k < face.mNumIndices; ++k) {
-                    g._meshcollision.indices.push_back(face.mIndices[0]);
-                    g._meshcollision.indices.push_back(face.mIndices[k-1]);
-                    g._meshcollision.indices.push_back(face.mIndices[k]);
+                    meshcollision.indices.push_back(face.mIndices[0]);
+                    meshcollision.indices.push_back(face.mIndices[k-1]);
+                    meshcollision.indices.push_back(face.mIndices[k]);
                 }
             }
         }
+        g._meshcollision.SetTriMesh(meshcollision);
 
         if( !!scene->mMaterials&& input_mesh->mMaterialIndex<scene->mNumMaterials) {
             aiMaterial* mtrl = scene->mMaterials[input_mesh->mMaterialIndex];
@@ -812,9 +814,11 @@ public:
         g._vDiffuseColor=Vector(1,0.5f,0.5f,1);
         g._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         g._vRenderScale = vscale;
-        if( !CreateTriMeshFromFile(penv,filename,vscale,g._meshcollision,g._vDiffuseColor,g._vAmbientColor,g._fTransparency) ) {
+        TriMesh meshcollision;
+        if( !CreateTriMeshFromFile(penv,filename,vscale,meshcollision,g._vDiffuseColor,g._vAmbientColor,g._fTransparency) ) {
             return false;
         }
+        g._meshcollision.SetTriMesh(meshcollision);
         return true;
     }
 
@@ -965,7 +969,7 @@ public:
                     FOREACH(itgeom, _plink->_vGeometries) {
                         (*itgeom)->_info.SetTransform(tnew * (*itgeom)->_info.GetTransform());
                     }
-                    _plink->_collision.ApplyTransform(tnew);
+                    _plink->_ResetCollisionData();
                     _plink->SetTransform(tOrigTrans);
                 }
 
@@ -1032,9 +1036,7 @@ public:
                                 itnewgeom->_bModifiable = info->_bModifiable;
                                 itnewgeom->_fTransparency = info->_fTransparency;
                                 itnewgeom->_filenamerender = string("__norenderif__:")+extension;
-                                FOREACH(it,itnewgeom->_meshcollision.vertices) {
-                                    *it = tmres * *it;
-                                }
+                                itnewgeom->_meshcollision.ApplyTransform(tmres);
                                 if( geomreader->IsOverwriteDiffuse() ) {
                                     itnewgeom->_vDiffuseColor = info->_vDiffuseColor;
                                 }
@@ -1048,7 +1050,6 @@ public:
                                 Transform t = info->GetTransform();
                                 t.trans *= _vScaleGeometry;
                                 itnewgeom->SetTransform(t);
-                                _plink->_collision.Append(itnewgeom->_meshcollision, itnewgeom->GetTransform());
                             }
                             vGeometryInfos.front()._vRenderScale = info->_vRenderScale*geomspacescale;
                             vGeometryInfos.front()._filenamerender = info->_filenamerender;
@@ -1062,13 +1063,10 @@ public:
                         }
                         else {
                             info->_vRenderScale = info->_vRenderScale*geomspacescale;
-                            FOREACH(it,info->_meshcollision.vertices) {
-                                *it = tmres * *it;
-                            }
+                            info->_meshcollision.ApplyTransform(tmres);
                             Transform t = info->GetTransform();
                             t.trans  *= _vScaleGeometry;
                             info->SetTransform(t);
-                            _plink->_collision.Append(info->_meshcollision, info->GetTransform());
                             _plink->_vGeometries.push_back(KinBody::Link::GeometryPtr(new KinBody::Link::Geometry(_plink,*info)));
                         }
                     }
@@ -1088,15 +1086,12 @@ public:
                         // call before attaching the geom
                         KinBody::Link::GeometryPtr geom(new KinBody::Link::Geometry(_plink,*info));
                         geom->_info.InitCollisionMesh();
-                        FOREACH(it,info->_meshcollision.vertices) {
-                            *it = tmres * *it;
-                        }
+                        info->_meshcollision.ApplyTransform(tmres);
 
                         Transform t = info->GetTransform();
                         t.trans *= _vScaleGeometry;
                         info->SetTransform(t);
                         info->_vGeomData *= geomspacescale;
-                        _plink->_collision.Append(geom->GetCollisionMesh(), info->GetTransform());
                         _plink->_vGeometries.push_back(geom);
                     }
                 }
@@ -1457,406 +1457,543 @@ static void ConvertDOFRotation_QuatFrom3D(std::vector<dReal>::iterator ittarget,
     *(ittarget+3) = quat[3];
 }
 
-void ConfigurationSpecification::ConvertGroupData(std::vector<dReal>::iterator ittargetdata, size_t targetstride, const ConfigurationSpecification::Group& gtarget, std::vector<dReal>::const_iterator itsourcedata, size_t sourcestride, const ConfigurationSpecification::Group& gsource, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized)
+ConfigurationSpecification::Converter::Converter() : _numdefaultvalues(0), _bFillMissingGroups(true)
 {
-    ConvertGroupData(ittargetdata, targetstride, gtarget, &(*itsourcedata), sourcestride, gsource, numpoints, penv, filluninitialized);
 }
 
-void ConfigurationSpecification::ConvertGroupData(std::vector<dReal>::iterator ittargetdata, size_t targetstride, const Group& gtarget, const dReal* psourcedata, size_t sourcestride, const Group& gsource, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized)
+ConfigurationSpecification::Converter::Converter(const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups) : _numdefaultvalues(0), _bFillMissingGroups(true)
 {
-    if( numpoints > 1 ) {
-        BOOST_ASSERT(targetstride != 0 && sourcestride != 0 );
+    Init(targetspec, sourcespec, bFillMissingGroups);
+}
+
+void ConfigurationSpecification::Converter::_Reset()
+{
+    _targetspec._vgroups.resize(0);
+    _sourcespec._vgroups.resize(0);
+    _vcopyranges.resize(0);
+    _vrotationconversions.resize(0);
+    _vdefaultvalues.resize(0);
+    _numdefaultvalues = 0;
+}
+
+void ConfigurationSpecification::Converter::Init(const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups)
+{
+    _Reset();
+    _Compile(targetspec, sourcespec, bFillMissingGroups);
+    _targetspec = targetspec;
+    _sourcespec = sourcespec;
+}
+
+void ConfigurationSpecification::Converter::_Compile(const ConfigurationSpecification& targetspec, const ConfigurationSpecification& sourcespec, bool bFillMissingGroups)
+{
+    _bFillMissingGroups = bFillMissingGroups;
+    for(size_t igroup = 0; igroup < targetspec._vgroups.size(); ++igroup) {
+        const Group& gtarget = targetspec._vgroups[igroup];
+        std::vector<Group>::const_iterator itcompatgroup = sourcespec.FindCompatibleGroup(gtarget);
+        if( itcompatgroup != sourcespec._vgroups.end() ) {
+            _AddGroup(gtarget.offset, gtarget, itcompatgroup->offset, *itcompatgroup);
+        }
+        else if( bFillMissingGroups ) {
+            _AddMissingGroup(gtarget.offset, gtarget);
+        }
     }
+}
+
+void ConfigurationSpecification::Converter::InitGroup(const Group& gtarget, const Group& gsource)
+{
+    _Reset();
+    _AddGroup(0, gtarget, 0, gsource);
+}
+
+void ConfigurationSpecification::Converter::_AddTransfer(int targetoffset, int sourceoffset)
+{
+    // merge with the previous range if both the source and target are consecutive
+    if( _vcopyranges.size() > 0 ) {
+        CopyRange& range = _vcopyranges.back();
+        if( range.targetoffset+range.length == targetoffset && range.sourceoffset+range.length == sourceoffset ) {
+            ++range.length;
+            return;
+        }
+    }
+    CopyRange range;
+    range.targetoffset = targetoffset;
+    range.sourceoffset = sourceoffset;
+    range.length = 1;
+    _vcopyranges.push_back(range);
+}
+
+void ConfigurationSpecification::Converter::_AddGroup(int targetoffset, const Group& gtarget, int sourceoffset, const Group& gsource)
+{
     if( gsource.name == gtarget.name ) {
         BOOST_ASSERT(gsource.dof==gtarget.dof);
-        for(size_t i = 0; i < numpoints; ++i) {
-            if( i != 0 ) {
-                psourcedata += sourcestride;
-                ittargetdata += targetstride;
-            }
-            std::copy(psourcedata,psourcedata+gsource.dof,ittargetdata);
+        for(int i = 0; i < gtarget.dof; ++i) {
+            _AddTransfer(targetoffset+i, sourceoffset+i);
         }
+        return;
     }
-    else {
-        stringstream ss(gtarget.name);
-        std::vector<std::string> targettokens((istream_iterator<std::string>(ss)), istream_iterator<std::string>());
-        ss.clear();
-        ss.str(gsource.name);
-        std::vector<std::string> sourcetokens((istream_iterator<std::string>(ss)), istream_iterator<std::string>());
-
-        BOOST_ASSERT(targettokens.at(0) == sourcetokens.at(0));
-        vector<int> vtransferindices; vtransferindices.reserve(gtarget.dof);
-        std::vector<dReal> vdefaultvalues;
-        if( targettokens.at(0).size() >= 6 && targettokens.at(0).substr(0,6) == "joint_") {
-            std::vector<int> vsourceindices(gsource.dof), vtargetindices(gtarget.dof);
-            if( (int)sourcetokens.size() < gsource.dof+2 ) {
-                RAVELOG_DEBUG(str(boost::format("source tokens '%s' do not have %d dof indices, guessing....")%gsource.name%gsource.dof));
-                for(int i = 0; i < gsource.dof; ++i) {
-                    vsourceindices[i] = i;
-                }
+
+    stringstream ss(gtarget.name);
+    std::vector<std::string> targettokens((istream_iterator<std::string>(ss)), istream_iterator<std::string>());
+    ss.clear();
+    ss.str(gsource.name);
+    std::vector<std::string> sourcetokens((istream_iterator<std::string>(ss)), istream_iterator<std::string>());
+
+    BOOST_ASSERT(targettokens.at(0) == sourcetokens.at(0));
+    vector<int> vtransferindices; vtransferindices.reserve(gtarget.dof);
+    DefaultValues defaultvalues;
+    defaultvalues.type = DefaultValues::DV_Constant;
+    defaultvalues.fconstant = 0;
+    defaultvalues.bWarnMissingBody = true;
+    defaultvalues.groupname = gtarget.name;
+    defaultvalues.affinedofs = 0;
+    bool bHasDefaultValues = false;
+    std::vector<int> vdefaultindices; // for every target index, the index to pass to DefaultValues::vindices
+    if( targettokens.at(0).size() >= 6 && targettokens.at(0).substr(0,6) == "joint_") {
+        std::vector<int> vsourceindices(gsource.dof), vtargetindices(gtarget.dof);
+        if( (int)sourcetokens.size() < gsource.dof+2 ) {
+            RAVELOG_DEBUG(str(boost::format("source tokens '%s' do not have %d dof indices, guessing....")%gsource.name%gsource.dof));
+            for(int i = 0; i < gsource.dof; ++i) {
+                vsourceindices[i] = i;
             }
-            else {
-                for(int i = 0; i < gsource.dof; ++i) {
-                    vsourceindices[i] = boost::lexical_cast<int>(sourcetokens.at(i+2));
-                }
+        }
+        else {
+            for(int i = 0; i < gsource.dof; ++i) {
+                vsourceindices[i] = boost::lexical_cast<int>(sourcetokens.at(i+2));
             }
-            if( (int)targettokens.size() < gtarget.dof+2 ) {
-                RAVELOG_WARN(str(boost::format("target tokens '%s' do not match dof '%d', guessing....")%gtarget.name%gtarget.dof));
-                for(int i = 0; i < gtarget.dof; ++i) {
-                    vtargetindices[i] = i;
-                }
+        }
+        if( (int)targettokens.size() < gtarget.dof+2 ) {
+            RAVELOG_WARN(str(boost::format("target tokens '%s' do not match dof '%d', guessing....")%gtarget.name%gtarget.dof));
+            for(int i = 0; i < gtarget.dof; ++i) {
+                vtargetindices[i] = i;
             }
-            else {
-                for(int i = 0; i < gtarget.dof; ++i) {
-                    vtargetindices[i] = boost::lexical_cast<int>(targettokens.at(i+2));
-                }
+        }
+        else {
+            for(int i = 0; i < gtarget.dof; ++i) {
+                vtargetindices[i] = boost::lexical_cast<int>(targettokens.at(i+2));
             }
+        }
 
-            bool bUninitializedData=false;
-            FOREACH(ittargetindex,vtargetindices) {
-                std::vector<int>::iterator it = find(vsourceindices.begin(),vsourceindices.end(),*ittargetindex);
-                if( it == vsourceindices.end() ) {
-                    bUninitializedData = true;
-                    vtransferindices.push_back(-1);
-                }
-                else {
-                    vtransferindices.push_back(static_cast<int>(it-vsourceindices.begin()));
-                }
+        FOREACH(ittargetindex,vtargetindices) {
+            std::vector<int>::iterator it = find(vsourceindices.begin(),vsourceindices.end(),*ittargetindex);
+            if( it == vsourceindices.end() ) {
+                bHasDefaultValues = true;
+                vtransferindices.push_back(-1);
+            }
+            else {
+                vtransferindices.push_back(static_cast<int>(it-vsourceindices.begin()));
             }
+        }
 
-            if( bUninitializedData && filluninitialized ) {
-                KinBodyPtr pbody;
-                if( targettokens.size() > 1 ) {
-                    pbody = penv->GetKinBody(targettokens.at(1));
-                }
-                if( !pbody && sourcetokens.size() > 1 ) {
-                    pbody = penv->GetKinBody(sourcetokens.at(1));
-                }
-                if( !pbody ) {
-                    RAVELOG_WARN(str(boost::format("could not find body '%s' or '%s'")%gtarget.name%gsource.name));
-                    vdefaultvalues.resize(vtargetindices.size(),0);
-                }
-                else {
-                    std::vector<dReal> vbodyvalues;
-                    vdefaultvalues.resize(vtargetindices.size(),0);
-                    if( targettokens[0] == "joint_values" ) {
-                        pbody->GetDOFValues(vbodyvalues);
-                    }
-                    else if( targettokens[0] == "joint_velocities" ) {
-                        pbody->GetDOFVelocities(vbodyvalues);
-                    }
-                    if( vbodyvalues.size() > 0 ) {
-                        for(size_t i = 0; i < vdefaultvalues.size(); ++i) {
-                            if( vtargetindices[i] >= 0 ) { // sometimes index can be -1 to indicate that no robot value is mapped. This is used when trying to preserve an output order of values
-                                vdefaultvalues[i] = vbodyvalues.at(vtargetindices[i]);
-                            }
-                        }
-                    }
-                }
+        if( bHasDefaultValues ) {
+            if( targettokens[0] == "joint_values" ) {
+                defaultvalues.type = DefaultValues::DV_JointValues;
+            }
+            else if( targettokens[0] == "joint_velocities" ) {
+                defaultvalues.type = DefaultValues::DV_JointVelocities;
+            }
+            if( targettokens.size() > 1 ) {
+                defaultvalues.vbodynames.push_back(targettokens[1]);
+            }
+            if( sourcetokens.size() > 1 ) {
+                defaultvalues.vbodynames.push_back(sourcetokens[1]);
             }
+            // sometimes index can be -1 to indicate that no robot value is mapped. This is used when trying to preserve an output order of values
+            vdefaultindices = vtargetindices;
         }
-        else if( targettokens.at(0).size() >= 13 && targettokens.at(0).substr(0,13) == "outputSignals") {
-            std::vector<std::string> vSourceSignalNames(gsource.dof), vTargetSignalNames(gtarget.dof);
-            if( (int)sourcetokens.size() < gsource.dof+1 ) {
-                throw OPENRAVE_EXCEPTION_FORMAT("source tokens '%s' do not have %d dof indices, guessing....", gsource.name%gsource.dof, ORE_InvalidArguments);
+    }
+    else if( targettokens.at(0).size() >= 13 && targettokens.at(0).substr(0,13) == "outputSignals") {
+        std::vector<std::string> vSourceSignalNames(gsource.dof), vTargetSignalNames(gtarget.dof);
+        if( (int)sourcetokens.size() < gsource.dof+1 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("source tokens '%s' do not have %d dof indices, guessing....", gsource.name%gsource.dof, ORE_InvalidArguments);
+        }
+        else {
+            for(int i = 0; i < gsource.dof; ++i) {
+                vSourceSignalNames[i] = sourcetokens.at(i+1);
             }
-            else {
-                for(int i = 0; i < gsource.dof; ++i) {
-                    vSourceSignalNames[i] = sourcetokens.at(i+1);
-                }
+        }
+        if( (int)targettokens.size() < gtarget.dof+1 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("target tokens '%s' do not match dof '%d', guessing....", gtarget.name%gtarget.dof, ORE_InvalidArguments);
+        }
+        else {
+            for(int i = 0; i < gtarget.dof; ++i) {
+                vTargetSignalNames[i] = targettokens.at(i+1);
             }
-            if( (int)targettokens.size() < gtarget.dof+1 ) {
-                throw OPENRAVE_EXCEPTION_FORMAT("target tokens '%s' do not match dof '%d', guessing....", gtarget.name%gtarget.dof, ORE_InvalidArguments);
+        }
+
+        FOREACH(itTargetSignalName,vTargetSignalNames) {
+            std::vector<std::string>::iterator itSourceSignalName = find(vSourceSignalNames.begin(),vSourceSignalNames.end(),*itTargetSignalName);
+            if( itSourceSignalName == vSourceSignalNames.end() ) {
+                bHasDefaultValues = true;
+                vtransferindices.push_back(-1); // nothing mapped
             }
             else {
+                vtransferindices.push_back(static_cast<int>(itSourceSignalName-vSourceSignalNames.begin()));
+            }
+        }
+        defaultvalues.fconstant = -1;
+    }
+    else if( targettokens.at(0).size() >= 7 && targettokens.at(0).substr(0,7) == "affine_") {
+        int affinesource = 0, affinetarget = 0;
+        Vector sourceaxis(0,0,1), targetaxis(0,0,1);
+        if( sourcetokens.size() < 3 ) {
+            if( targettokens.size() < 3 && gsource.dof == gtarget.dof ) {
                 for(int i = 0; i < gtarget.dof; ++i) {
-                    vTargetSignalNames[i] = targettokens.at(i+1);
+                    vtransferindices.push_back(i);
                 }
             }
-
-            bool bUninitializedData=false;
-            FOREACH(itTargetSignalName,vTargetSignalNames) {
-                std::vector<std::string>::iterator itSourceSignalName = find(vSourceSignalNames.begin(),vSourceSignalNames.end(),*itTargetSignalName);
-                if( itSourceSignalName == vSourceSignalNames.end() ) {
-                    bUninitializedData = true;
-                    vtransferindices.push_back(-1); // nothing mapped
-                }
-                else {
-                    vtransferindices.push_back(static_cast<int>(itSourceSignalName-vSourceSignalNames.begin()));
-                }
+            else {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("source affine information not present '%s'\n"),gsource.name,ORE_InvalidArguments);
             }
-
-            if( bUninitializedData && filluninitialized ) {
-                vdefaultvalues.resize(vTargetSignalNames.size(),-1);
+        }
+        else {
+            affinesource = boost::lexical_cast<int>(sourcetokens.at(2));
+            BOOST_ASSERT(RaveGetAffineDOF(affinesource) == gsource.dof);
+            if( (affinesource & DOF_RotationAxis) && sourcetokens.size() >= 6 ) {
+                sourceaxis.x = boost::lexical_cast<dReal>(sourcetokens.at(3));
+                sourceaxis.y = boost::lexical_cast<dReal>(sourcetokens.at(4));
+                sourceaxis.z = boost::lexical_cast<dReal>(sourcetokens.at(5));
             }
         }
-        else if( targettokens.at(0).size() >= 7 && targettokens.at(0).substr(0,7) == "affine_") {
-            int affinesource = 0, affinetarget = 0;
-            Vector sourceaxis(0,0,1), targetaxis(0,0,1);
-            if( sourcetokens.size() < 3 ) {
-                if( targettokens.size() < 3 && gsource.dof == gtarget.dof ) {
-                    for(size_t i = 0; i < targettokens.size(); ++i) {
-                        vtransferindices[i] = i;
-                    }
-                }
-                else {
-                    throw OPENRAVE_EXCEPTION_FORMAT(_("source affine information not present '%s'\n"),gsource.name,ORE_InvalidArguments);
-                }
+        if( vtransferindices.size() == 0 ) {
+            if( targettokens.size() < 3 ) {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("target affine information not present '%s'\n"),gtarget.name,ORE_InvalidArguments);
             }
             else {
-                affinesource = boost::lexical_cast<int>(sourcetokens.at(2));
-                BOOST_ASSERT(RaveGetAffineDOF(affinesource) == gsource.dof);
-                if( (affinesource & DOF_RotationAxis) && sourcetokens.size() >= 6 ) {
-                    sourceaxis.x = boost::lexical_cast<dReal>(sourcetokens.at(3));
-                    sourceaxis.y = boost::lexical_cast<dReal>(sourcetokens.at(4));
-                    sourceaxis.z = boost::lexical_cast<dReal>(sourcetokens.at(5));
-                }
-            }
-            if( vtransferindices.size() == 0 ) {
-                if( targettokens.size() < 3 ) {
-                    throw OPENRAVE_EXCEPTION_FORMAT(_("target affine information not present '%s'\n"),gtarget.name,ORE_InvalidArguments);
-                }
-                else {
-                    affinetarget = boost::lexical_cast<int>(targettokens.at(2));
-                    BOOST_ASSERT(RaveGetAffineDOF(affinetarget) == gtarget.dof);
-                    if( (affinetarget & DOF_RotationAxis) && targettokens.size() >= 6 ) {
-                        targetaxis.x = boost::lexical_cast<dReal>(targettokens.at(3));
-                        targetaxis.y = boost::lexical_cast<dReal>(targettokens.at(4));
-                        targetaxis.z = boost::lexical_cast<dReal>(targettokens.at(5));
+                affinetarget = boost::lexical_cast<int>(targettokens.at(2));
+                BOOST_ASSERT(RaveGetAffineDOF(affinetarget) == gtarget.dof);
+                if( (affinetarget & DOF_RotationAxis) && targettokens.size() >= 6 ) {
+                    targetaxis.x = boost::lexical_cast<dReal>(targettokens.at(3));
+                    targetaxis.y = boost::lexical_cast<dReal>(targettokens.at(4));
+                    targetaxis.z = boost::lexical_cast<dReal>(targettokens.at(5));
+                }
+            }
+
+            int commondata = affinesource&affinetarget;
+            int uninitdata = affinetarget&(~commondata);
+            int targetrotationstart = -1, targetrotationend = -1;
+            if( (uninitdata & DOF_RotationMask) && (affinetarget & DOF_RotationMask) && (affinesource & DOF_RotationMask) ) {
+                // both hold rotations, but need to convert
+                uninitdata &= ~DOF_RotationMask;
+                RotationConversion rotationconversion;
+                rotationconversion.sourceoffset = sourceoffset + RaveGetIndexFromAffineDOF(affinesource,DOF_RotationMask);
+                targetrotationstart = RaveGetIndexFromAffineDOF(affinetarget,DOF_RotationMask);
+                targetrotationend = targetrotationstart+RaveGetAffineDOF(affinetarget&DOF_RotationMask);
+                rotationconversion.targetoffset = targetoffset + targetrotationstart;
+                if( affinetarget & DOF_RotationAxis ) {
+                    if( affinesource & DOF_Rotation3D ) {
+                        rotationconversion.convertfn = boost::bind(ConvertDOFRotation_AxisFrom3D,_1,_2,targetaxis);
                     }
-                }
-
-                int commondata = affinesource&affinetarget;
-                int uninitdata = affinetarget&(~commondata);
-                int sourcerotationstart = -1, targetrotationstart = -1, targetrotationend = -1;
-                boost::function< void(std::vector<dReal>::iterator, const dReal*) > rotconverterfn;
-                if( (uninitdata & DOF_RotationMask) && (affinetarget & DOF_RotationMask) && (affinesource & DOF_RotationMask) ) {
-                    // both hold rotations, but need to convert
-                    uninitdata &= ~DOF_RotationMask;
-                    sourcerotationstart = RaveGetIndexFromAffineDOF(affinesource,DOF_RotationMask);
-                    targetrotationstart = RaveGetIndexFromAffineDOF(affinetarget,DOF_RotationMask);
-                    targetrotationend = targetrotationstart+RaveGetAffineDOF(affinetarget&DOF_RotationMask);
-                    if( affinetarget & DOF_RotationAxis ) {
-                        if( affinesource & DOF_Rotation3D ) {
-                            rotconverterfn = boost::bind(ConvertDOFRotation_AxisFrom3D,_1,_2,targetaxis);
-                        }
-                        else if( affinesource & DOF_RotationQuat ) {
-                            rotconverterfn = boost::bind(ConvertDOFRotation_AxisFromQuat,_1,_2,targetaxis);
-                        }
-                    }
-                    else if( affinetarget & DOF_Rotation3D ) {
-                        if( affinesource & DOF_RotationAxis ) {
-                            rotconverterfn = boost::bind(ConvertDOFRotation_3DFromAxis,_1,_2,sourceaxis);
-                        }
-                        else if( affinesource & DOF_RotationQuat ) {
-                            rotconverterfn = ConvertDOFRotation_3DFromQuat;
-                        }
-                    }
-                    else if( affinetarget & DOF_RotationQuat ) {
-                        if( affinesource & DOF_RotationAxis ) {
-                            rotconverterfn = boost::bind(ConvertDOFRotation_QuatFromAxis,_1,_2,sourceaxis);
-                        }
-                        else if( affinesource & DOF_Rotation3D ) {
-                            rotconverterfn = ConvertDOFRotation_QuatFrom3D;
-                        }
+                    else if( affinesource & DOF_RotationQuat ) {
+                        rotationconversion.convertfn = boost::bind(ConvertDOFRotation_AxisFromQuat,_1,_2,targetaxis);
                     }
-                    BOOST_ASSERT(!!rotconverterfn);
                 }
-                if( uninitdata && filluninitialized ) {
-                    // initialize with the current body values
-                    KinBodyPtr pbody;
-                    if( targettokens.size() > 1 ) {
-                        pbody = penv->GetKinBody(targettokens.at(1));
+                else if( affinetarget & DOF_Rotation3D ) {
+                    if( affinesource & DOF_RotationAxis ) {
+                        rotationconversion.convertfn = boost::bind(ConvertDOFRotation_3DFromAxis,_1,_2,sourceaxis);
                     }
-                    if( !pbody && sourcetokens.size() > 1 ) {
-                        pbody = penv->GetKinBody(sourcetokens.at(1));
+                    else if( affinesource & DOF_RotationQuat ) {
+                        rotationconversion.convertfn = ConvertDOFRotation_3DFromQuat;
                     }
-                    if( !pbody ) {
-                        RAVELOG_WARN(str(boost::format("could not find body '%s' or '%s'")%gtarget.name%gsource.name));
-                        vdefaultvalues.resize(gtarget.dof,0);
+                }
+                else if( affinetarget & DOF_RotationQuat ) {
+                    if( affinesource & DOF_RotationAxis ) {
+                        rotationconversion.convertfn = boost::bind(ConvertDOFRotation_QuatFromAxis,_1,_2,sourceaxis);
                     }
-                    else {
-                        vdefaultvalues.resize(gtarget.dof);
-                        RaveGetAffineDOFValuesFromTransform(vdefaultvalues.begin(),pbody->GetTransform(),affinetarget);
+                    else if( affinesource & DOF_Rotation3D ) {
+                        rotationconversion.convertfn = ConvertDOFRotation_QuatFrom3D;
                     }
                 }
+                BOOST_ASSERT(!!rotationconversion.convertfn);
+                _vrotationconversions.push_back(rotationconversion);
+            }
 
-                for(int index = 0; index < gtarget.dof; ++index) {
-                    DOFAffine dof = RaveGetAffineDOFFromIndex(affinetarget,index);
-                    int startindex = RaveGetIndexFromAffineDOF(affinetarget,dof);
-                    if( affinesource & dof ) {
-                        int sourceindex = RaveGetIndexFromAffineDOF(affinesource,dof);
-                        vtransferindices.push_back(sourceindex + (index-startindex));
-                    }
-                    else {
-                        vtransferindices.push_back(-1);
-                    }
+            for(int index = 0; index < gtarget.dof; ++index) {
+                DOFAffine dof = RaveGetAffineDOFFromIndex(affinetarget,index);
+                int startindex = RaveGetIndexFromAffineDOF(affinetarget,dof);
+                if( affinesource & dof ) {
+                    int sourceindex = RaveGetIndexFromAffineDOF(affinesource,dof);
+                    vtransferindices.push_back(sourceindex + (index-startindex));
                 }
+                else if( index >= targetrotationstart && index < targetrotationend ) {
+                    // set by the rotation conversion
+                    vtransferindices.push_back(-2);
+                }
+                else {
+                    vtransferindices.push_back(-1);
+                }
+            }
 
-                for(size_t i = 0; i < numpoints; ++i, psourcedata += sourcestride, ittargetdata += targetstride) {
-                    for(int j = 0; j < (int)vtransferindices.size(); ++j) {
-                        if( vtransferindices[j] >= 0 ) {
-                            *(ittargetdata+j) = *(psourcedata+vtransferindices[j]);
-                        }
-                        else {
-                            if( j >= targetrotationstart && j < targetrotationend ) {
-                                if( j == targetrotationstart ) {
-                                    // only convert when at first index
-                                    rotconverterfn(ittargetdata+targetrotationstart,psourcedata+sourcerotationstart);
-                                }
-                            }
-                            else if( filluninitialized ) {
-                                *(ittargetdata+j) = vdefaultvalues.at(j);
-                            }
-                        }
-                    }
+            if( uninitdata ) {
+                // initialize with the current body values
+                bHasDefaultValues = true;
+                defaultvalues.type = DefaultValues::DV_AffineTransform;
+                defaultvalues.affinedofs = affinetarget;
+                if( targettokens.size() > 1 ) {
+                    defaultvalues.vbodynames.push_back(targettokens[1]);
+                }
+                if( sourcetokens.size() > 1 ) {
+                    defaultvalues.vbodynames.push_back(sourcetokens[1]);
+                }
+                vdefaultindices.resize(gtarget.dof);
+                for(int index = 0; index < gtarget.dof; ++index) {
+                    vdefaultindices[index] = index;
                 }
-                return;
             }
         }
-        else if( targettokens.at(0).size() >= 8 && targettokens.at(0).substr(0,8) == "ikparam_") {
-            IkParameterizationType iktypesource, iktypetarget;
-            if( sourcetokens.size() >= 2 ) {
-                iktypesource = static_cast<IkParameterizationType>(boost::lexical_cast<int>(sourcetokens[1]));
-            }
-            else {
-                throw OPENRAVE_EXCEPTION_FORMAT(_("ikparam type not present '%s'\n"),gsource.name,ORE_InvalidArguments);
+    }
+    else if( targettokens.at(0).size() >= 8 && targettokens.at(0).substr(0,8) == "ikparam_") {
+        IkParameterizationType iktypesource, iktypetarget;
+        if( sourcetokens.size() >= 2 ) {
+            iktypesource = static_cast<IkParameterizationType>(boost::lexical_cast<int>(sourcetokens[1]));
+        }
+        else {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("ikparam type not present '%s'\n"),gsource.name,ORE_InvalidArguments);
+        }
+        if( targettokens.size() >= 2 ) {
+            iktypetarget = static_cast<IkParameterizationType>(boost::lexical_cast<int>(targettokens[1]));
+        }
+        else {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("ikparam type not present '%s'\n"),gtarget.name,ORE_InvalidArguments);
+        }
+
+        if( iktypetarget == iktypesource ) {
+            vtransferindices.resize(IkParameterization::GetDOF(iktypetarget));
+            for(size_t i = 0; i < vtransferindices.size(); ++i) {
+                vtransferindices[i] = i;
             }
-            if( targettokens.size() >= 2 ) {
-                iktypetarget = static_cast<IkParameterizationType>(boost::lexical_cast<int>(targettokens[1]));
+        }
+        else {
+            RAVELOG_WARN("ikparam types do not match");
+        }
+    }
+    // need a space since grabbody is also a group
+    else if( targettokens.at(0) == std::string("grab") ) {
+        std::vector<int> vsourceindices(gsource.dof), vtargetindices(gtarget.dof);
+        if( (int)sourcetokens.size() < gsource.dof+2 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("source tokens '%s' do not have %d dof indices, guessing...."), gsource.name%gsource.dof, ORE_InvalidArguments);
+        }
+        else {
+            for(int i = 0; i < gsource.dof; ++i) {
+                vsourceindices[i] = boost::lexical_cast<int>(sourcetokens.at(i+2));
             }
-            else {
-                throw OPENRAVE_EXCEPTION_FORMAT(_("ikparam type not present '%s'\n"),gtarget.name,ORE_InvalidArguments);
+        }
+        if( (int)targettokens.size() < gtarget.dof+2 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("target tokens '%s' do not match dof '%d', guessing...."), gtarget.name%gtarget.dof, ORE_InvalidArguments);
+        }
+        else {
+            for(int i = 0; i < gtarget.dof; ++i) {
+                vtargetindices[i] = boost::lexical_cast<int>(targettokens.at(i+2));
             }
+        }
 
-            if( iktypetarget == iktypesource ) {
-                vtransferindices.resize(IkParameterization::GetDOF(iktypetarget));
-                for(size_t i = 0; i < vtransferindices.size(); ++i) {
-                    vtransferindices[i] = i;
-                }
+        FOREACH(ittargetindex,vtargetindices) {
+            std::vector<int>::iterator it = find(vsourceindices.begin(),vsourceindices.end(),*ittargetindex);
+            if( it == vsourceindices.end() ) {
+                bHasDefaultValues = true;
+                vtransferindices.push_back(-1);
             }
             else {
-                RAVELOG_WARN("ikparam types do not match");
+                vtransferindices.push_back(static_cast<int>(it-vsourceindices.begin()));
             }
         }
-        // need a space since grabbody is also a group
-        else if( targettokens.at(0) == std::string("grab") ) {
-            std::vector<int> vsourceindices(gsource.dof), vtargetindices(gtarget.dof);
-            if( (int)sourcetokens.size() < gsource.dof+2 ) {
-                throw OPENRAVE_EXCEPTION_FORMAT(_("source tokens '%s' do not have %d dof indices, guessing...."), gsource.name%gsource.dof, ORE_InvalidArguments);
-            }
-            else {
-                for(int i = 0; i < gsource.dof; ++i) {
-                    vsourceindices[i] = boost::lexical_cast<int>(sourcetokens.at(i+2));
-                }
-            }
-            if( (int)targettokens.size() < gtarget.dof+2 ) {
-                throw OPENRAVE_EXCEPTION_FORMAT(_("target tokens '%s' do not match dof '%d', guessing...."), gtarget.name%gtarget.dof, ORE_InvalidArguments);
+    }
+    else if( targettokens.at(0) == std::string("grabbody") ) {
+        // TODO
+    }
+    else {
+        throw OPENRAVE_EXCEPTION_FORMAT(_("unsupported token conversion: %s"),gtarget.name,ORE_InvalidArguments);
+    }
+
+    for(size_t j = 0; j < vtransferindices.size(); ++j) {
+        if( vtransferindices[j] >= 0 ) {
+            _AddTransfer(targetoffset+j, sourceoffset+vtransferindices[j]);
+        }
+        else if( vtransferindices[j] == -1 && bHasDefaultValues ) {
+            defaultvalues.vtargetoffsets.push_back(targetoffset+j);
+            defaultvalues.vindices.push_back(vdefaultindices.size() > 0 ? vdefaultindices.at(j) : -1);
+        }
+    }
+    if( defaultvalues.vtargetoffsets.size() > 0 ) {
+        _numdefaultvalues += defaultvalues.vtargetoffsets.size();
+        _vdefaultvalues.push_back(defaultvalues);
+    }
+}
+
+void ConfigurationSpecification::Converter::_AddMissingGroup(int targetoffset, const Group& gtarget)
+{
+    DefaultValues defaultvalues;
+    defaultvalues.type = DefaultValues::DV_Constant;
+    defaultvalues.fconstant = 0;
+    defaultvalues.bWarnMissingBody = false;
+    defaultvalues.groupname = gtarget.name;
+    defaultvalues.affinedofs = 0;
+    defaultvalues.vtargetoffsets.resize(gtarget.dof);
+    defaultvalues.vindices.resize(gtarget.dof, -1);
+    for(int i = 0; i < gtarget.dof; ++i) {
+        defaultvalues.vtargetoffsets[i] = targetoffset+i;
+    }
+    const string& name = gtarget.name;
+    if( name.size() >= 12 && name.substr(0,12) == "joint_values" ) {
+        string bodyname;
+        stringstream ss(name.substr(12));
+        ss >> bodyname;
+        if( !!ss ) {
+            defaultvalues.type = DefaultValues::DV_JointValues;
+            defaultvalues.vbodynames.push_back(bodyname);
+            std::vector<int> indices((istream_iterator<int>(ss)), istream_iterator<int>());
+            for(size_t i = 0; i < indices.size(); ++i) {
+                defaultvalues.vindices.at(i) = indices[i];
             }
-            else {
-                for(int i = 0; i < gtarget.dof; ++i) {
-                    vtargetindices[i] = boost::lexical_cast<int>(targettokens.at(i+2));
-                }
+        }
+    }
+    else if( name.size() >= 16 && name.substr(0,16) == "affine_transform" ) {
+        string bodyname;
+        int affinedofs;
+        stringstream ss(name.substr(16));
+        ss >> bodyname >> affinedofs;
+        if( !!ss ) {
+            BOOST_ASSERT(gtarget.dof == RaveGetAffineDOF(affinedofs));
+            defaultvalues.type = DefaultValues::DV_AffineTransform;
+            defaultvalues.affinedofs = affinedofs;
+            defaultvalues.vbodynames.push_back(bodyname);
+            for(int i = 0; i < gtarget.dof; ++i) {
+                defaultvalues.vindices[i] = i;
             }
+        }
+    }
+    else if( name.size() >= 13 && name.substr(0,13) == "outputSignals") {
+        defaultvalues.fconstant = -1;
+    }
+    _numdefaultvalues += defaultvalues.vtargetoffsets.size();
+    _vdefaultvalues.push_back(defaultvalues);
+}
 
-            bool bUninitializedData=false;
-            FOREACH(ittargetindex,vtargetindices) {
-                std::vector<int>::iterator it = find(vsourceindices.begin(),vsourceindices.end(),*ittargetindex);
-                if( it == vsourceindices.end() ) {
-                    bUninitializedData = true;
-                    vtransferindices.push_back(-1);
-                }
-                else {
-                    vtransferindices.push_back(static_cast<int>(it-vsourceindices.begin()));
-                }
-            }
+void ConfigurationSpecification::Converter::_ComputeDefaultValues(const DefaultValues& defaultvalues, EnvironmentBaseConstPtr penv, std::vector<dReal>::iterator itvalues) const
+{
+    const size_t numvalues = defaultvalues.vtargetoffsets.size();
+    if( defaultvalues.type == DefaultValues::DV_Constant ) {
+        std::fill(itvalues, itvalues+numvalues, defaultvalues.fconstant);
+        return;
+    }
 
-            if( bUninitializedData && filluninitialized ) {
-                vdefaultvalues.resize(vtargetindices.size(),0);
+    std::fill(itvalues, itvalues+numvalues, dReal(0));
+    KinBodyPtr pbody;
+    if( !!penv ) {
+        FOREACHC(itname, defaultvalues.vbodynames) {
+            pbody = penv->GetKinBody(*itname);
+            if( !!pbody ) {
+                break;
             }
         }
-        else if( targettokens.at(0) == std::string("grabbody") ) {
-            // TODO
+    }
+    if( defaultvalues.type == DefaultValues::DV_AffineTransform ) {
+        Transform t;
+        if( !!pbody ) {
+            t = pbody->GetTransform();
+        }
+        else if( defaultvalues.bWarnMissingBody ) {
+            RAVELOG_WARN(str(boost::format("could not find body for '%s'")%defaultvalues.groupname));
+            return;
         }
-        else {
-            throw OPENRAVE_EXCEPTION_FORMAT(_("unsupported token conversion: %s"),gtarget.name,ORE_InvalidArguments);
+        std::vector<dReal> vaffinevalues(RaveGetAffineDOF(defaultvalues.affinedofs));
+        RaveGetAffineDOFValuesFromTransform(vaffinevalues.begin(),t,defaultvalues.affinedofs);
+        for(size_t i = 0; i < numvalues; ++i) {
+            *(itvalues+i) = vaffinevalues.at(defaultvalues.vindices[i]);
         }
+        return;
+    }
 
-        for(size_t i = 0; i < numpoints; ++i, psourcedata += sourcestride, ittargetdata += targetstride) {
-            for(size_t j = 0; j < vtransferindices.size(); ++j) {
-                if( vtransferindices[j] >= 0 ) {
-                    *(ittargetdata+j) = *(psourcedata+vtransferindices[j]);
-                }
-                else if( filluninitialized ) {
-                    *(ittargetdata+j) = vdefaultvalues.at(j);
-                }
+    if( !pbody ) {
+        if( defaultvalues.bWarnMissingBody ) {
+            RAVELOG_WARN(str(boost::format("could not find body for '%s'")%defaultvalues.groupname));
+        }
+        return;
+    }
+    std::vector<dReal> vbodyvalues;
+    if( defaultvalues.type == DefaultValues::DV_JointValues ) {
+        pbody->GetDOFValues(vbodyvalues);
+    }
+    else if( defaultvalues.type == DefaultValues::DV_JointVelocities ) {
+        pbody->GetDOFVelocities(vbodyvalues);
+    }
+    if( vbodyvalues.size() > 0 ) {
+        for(size_t i = 0; i < numvalues; ++i) {
+            if( defaultvalues.vindices[i] >= 0 ) {
+                *(itvalues+i) = vbodyvalues.at(defaultvalues.vindices[i]);
             }
         }
     }
 }
 
-void ConfigurationSpecification::ConvertData(std::vector<dReal>::iterator ittargetdata, const ConfigurationSpecification &targetspec, std::vector<dReal>::const_iterator itsourcedata, const ConfigurationSpecification &sourcespec, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized)
+void ConfigurationSpecification::Converter::Convert(std::vector<dReal>::iterator ittargetdata, std::vector<dReal>::const_iterator itsourcedata, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized) const
 {
-    for(size_t igroup = 0; igroup < targetspec._vgroups.size(); ++igroup) {
-        std::vector<ConfigurationSpecification::Group>::const_iterator itcompatgroup = sourcespec.FindCompatibleGroup(targetspec._vgroups[igroup]);
-        if( itcompatgroup != sourcespec._vgroups.end() ) {
-            ConfigurationSpecification::ConvertGroupData(ittargetdata+targetspec._vgroups[igroup].offset, targetspec.GetDOF(), targetspec._vgroups[igroup], itsourcedata+itcompatgroup->offset, sourcespec.GetDOF(), *itcompatgroup,numpoints,penv,filluninitialized);
-        }
-        else if( filluninitialized ) {
-            vector<dReal> vdefaultvalues(targetspec._vgroups[igroup].dof,0);
-            const string& name = targetspec._vgroups[igroup].name;
-            if( name.size() >= 12 && name.substr(0,12) == "joint_values" ) {
-                string bodyname;
-                stringstream ss(name.substr(12));
-                ss >> bodyname;
-                if( !!ss ) {
-                    if( !!penv ) {
-                        KinBodyPtr body = penv->GetKinBody(bodyname);
-                        if( !!body ) {
-                            vector<dReal> values;
-                            body->GetDOFValues(values);
-                            std::vector<int> indices((istream_iterator<int>(ss)), istream_iterator<int>());
-                            for(size_t i = 0; i < indices.size(); ++i) {
-                                vdefaultvalues.at(i) = values.at(indices[i]);
-                            }
-                        }
-                    }
-                }
-            }
-            else if( name.size() >= 16 && name.substr(0,16) == "affine_transform" ) {
-                string bodyname;
-                int affinedofs;
-                stringstream ss(name.substr(16));
-                ss >> bodyname >> affinedofs;
-                if( !!ss ) {
-                    Transform tdefault;
-                    if( !!penv ) {
-                        KinBodyPtr body = penv->GetKinBody(bodyname);
-                        if( !!body ) {
-                            tdefault = body->GetTransform();
-                        }
-                    }
-                    BOOST_ASSERT((int)vdefaultvalues.size() == RaveGetAffineDOF(affinedofs));
-                    RaveGetAffineDOFValuesFromTransform(vdefaultvalues.begin(),tdefault,affinedofs);
-                }
-            }
-            else if( name.size() >= 13 && name.substr(0,13) == "outputSignals") {
-                std::fill(vdefaultvalues.begin(), vdefaultvalues.end(), -1);
-            }
-            else if( name != "deltatime" ) {
-                // messages are too frequent
-                //RAVELOG_VERBOSE(str(boost::format("cannot initialize unknown group '%s'")%name));
-            }
-            int offset = targetspec._vgroups[igroup].offset;
-            for(size_t i = 0; i < numpoints; ++i, offset += targetspec.GetDOF()) {
-                for(size_t j = 0; j < vdefaultvalues.size(); ++j) {
-                    *(ittargetdata+offset+j) = vdefaultvalues[j];
+    if( numpoints == 0 ) {
+        return;
+    }
+    Convert(ittargetdata, _targetspec.GetDOF(), &(*itsourcedata), _sourcespec.GetDOF(), numpoints, penv, filluninitialized);
+}
+
+void ConfigurationSpecification::Converter::Convert(std::vector<dReal>::iterator ittargetdata, size_t targetstride, const dReal* psourcedata, size_t sourcestride, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized) const
+{
+    if( numpoints > 1 ) {
+        BOOST_ASSERT(targetstride != 0 && sourcestride != 0 );
+    }
+    // default values only depend on the environment, so compute them once for all points
+    std::vector<dReal> vdefaultvalues;
+    if( filluninitialized && _numdefaultvalues > 0 ) {
+        vdefaultvalues.resize(_numdefaultvalues);
+        std::vector<dReal>::iterator itvalues = vdefaultvalues.begin();
+        FOREACHC(itdefaultvalues, _vdefaultvalues) {
+            _ComputeDefaultValues(*itdefaultvalues, penv, itvalues);
+            itvalues += itdefaultvalues->vtargetoffsets.size();
+        }
+    }
+
+    for(size_t ipoint = 0; ipoint < numpoints; ++ipoint) {
+        if( ipoint != 0 ) {
+            psourcedata += sourcestride;
+            ittargetdata += targetstride;
+        }
+        FOREACHC(itrange, _vcopyranges) {
+            std::copy(psourcedata+itrange->sourceoffset, psourcedata+itrange->sourceoffset+itrange->length, ittargetdata+itrange->targetoffset);
+        }
+        FOREACHC(itconversion, _vrotationconversions) {
+            itconversion->convertfn(ittargetdata+itconversion->targetoffset, psourcedata+itconversion->sourceoffset);
+        }
+        if( vdefaultvalues.size() > 0 ) {
+            std::vector<dReal>::const_iterator itvalue = vdefaultvalues.begin();
+            FOREACHC(itdefaultvalues, _vdefaultvalues) {
+                FOREACHC(itoffset, itdefaultvalues->vtargetoffsets) {
+                    *(ittargetdata+*itoffset) = *itvalue++;
                 }
             }
         }
     }
 }
 
+void ConfigurationSpecification::ConvertGroupData(std::vector<dReal>::iterator ittargetdata, size_t targetstride, const ConfigurationSpecification::Group& gtarget, std::vector<dReal>::const_iterator itsourcedata, size_t sourcestride, const ConfigurationSpecification::Group& gsource, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized)
+{
+    ConvertGroupData(ittargetdata, targetstride, gtarget, &(*itsourcedata), sourcestride, gsource, numpoints, penv, filluninitialized);
+}
+
+void ConfigurationSpecification::ConvertGroupData(std::vector<dReal>::iterator ittargetdata, size_t targetstride, const Group& gtarget, const dReal* psourcedata, size_t sourcestride, const Group& gsource, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized)
+{
+    Converter converter;
+    converter.InitGroup(gtarget, gsource);
+    converter.Convert(ittargetdata, targetstride, psourcedata, sourcestride, numpoints, penv, filluninitialized);
+}
+
+void ConfigurationSpecification::ConvertData(std::vector<dReal>::iterator ittargetdata, const ConfigurationSpecification &targetspec, std::vector<dReal>::const_iterator itsourcedata, const ConfigurationSpecification &sourcespec, size_t numpoints, EnvironmentBaseConstPtr penv, bool filluninitialized)
+{
+    if( numpoints == 0 ) {
+        return;
+    }
+    // do not copy the specifications since the converter is only used once
+    Converter converter;
+    converter._Compile(targetspec, sourcespec, true);
+    converter.Convert(ittargetdata, targetspec.GetDOF(), &(*itsourcedata), sourcespec.GetDOF(), numpoints, penv, filluninitialized);
+}
+
 std::string ConfigurationSpecification::GetInterpolationDerivative(const std::string& interpolation, int deriv)
 {
     const static boost::array<std::string,7> s_InterpolationOrder = {{"next","linear","quadratic","cubic","quartic","quintic","sextic"}};
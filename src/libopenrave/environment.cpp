@@ -16,6 +16,160 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "libopenrave.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+/// \brief json values to deserialize into one body info, in input order
+struct BodyInfoDeserializationJob
+{
+    void Run(dReal fUnitScale, int options)
+    {
+        FOREACHC(itValue, vValues) {
+            pKinBodyInfo->DeserializeJSON(*itValue->first, fUnitScale, options);
+            pKinBodyInfo->_id = itValue->second;
+        }
+        vValues.clear();
+        if( bInitCollisionMeshes ) {
+            // tessellate here instead of when the body is added, which only initializes the geometries with empty meshes
+            FOREACHC(itLinkInfo, pKinBodyInfo->_vLinkInfos) {
+                FOREACHC(itGeometryInfo, (*itLinkInfo)->_vgeometryinfos) {
+                    if( (*itGeometryInfo)->_meshcollision.GetNumVertices() == 0 ) {
+                        (*itGeometryInfo)->InitCollisionMesh();
+                    }
+                }
+            }
+        }
+    }
+
+    KinBody::KinBodyInfoPtr pKinBodyInfo;
+    std::vector< std::pair<const rapidjson::Value*, std::string> > vValues; ///< json value and the id to set afterwards
+    bool bInitCollisionMeshes = false; ///< true if pKinBodyInfo is created by this deserialization, so the collision meshes of its geometries are initialized after deserializing
+};
+
+/// \brief threads kept between DeserializeJSONWithMapping calls, so loading many documents does not create threads every time
+class BodyInfoDeserializationWorkers
+{
+public:
+    ~BodyInfoDeserializationWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _bStop = true;
+        }
+        _conditionStart.notify_all();
+        FOREACH(itThread, _vThreads) {
+            (*itThread)->join();
+        }
+    }
+
+    /// \brief calls fn on the calling thread and on numWorkers worker threads, and returns once all calls finished.
+    ///
+    /// fn must not throw and has to claim its work from shared state, since workers that did not start before the calling thread's call returns are not run.
+    /// \return false without calling fn if another thread is using the workers
+    bool Run(const std::function<void()>& fn, size_t numWorkers)
+    {
+        std::unique_lock<std::mutex> lockRun(_mutexRun, std::try_to_lock);
+        if( !lockRun.owns_lock() ) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            while( _vThreads.size() < numWorkers ) {
+                _vThreads.push_back(boost::make_shared<std::thread>(std::bind(&BodyInfoDeserializationWorkers::_WorkerThread, this)));
+            }
+            _fn = fn;
+            _numToStart = numWorkers;
+        }
+        _conditionStart.notify_all();
+        fn();
+        std::unique_lock<std::mutex> lock(_mutex);
+        _numToStart = 0;
+        _conditionFinished.wait(lock, [this]() {
+            return _numRunning == 0;
+        });
+        _fn = nullptr;
+        return true;
+    }
+
+private:
+    void _WorkerThread()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while( true ) {
+            _conditionStart.wait(lock, [this]() {
+                return _bStop || _numToStart > 0;
+            });
+            if( _bStop ) {
+                return;
+            }
+            --_numToStart;
+            ++_numRunning;
+            const std::function<void()> fn = _fn;
+            lock.unlock();
+            fn();
+            lock.lock();
+            if( --_numRunning == 0 ) {
+                _conditionFinished.notify_all();
+            }
+        }
+    }
+
+    std::mutex _mutexRun; ///< held by the thread calling Run
+    std::mutex _mutex; ///< protects the members below
+    std::condition_variable _conditionStart, _conditionFinished;
+    std::vector<boost::shared_ptr<std::thread> > _vThreads;
+    std::function<void()> _fn;
+    size_t _numToStart = 0; ///< number of workers that still have to call _fn
+    size_t _numRunning = 0; ///< number of workers calling _fn
+    bool _bStop = false;
+};
+
+/// \brief runs the jobs on several threads since every job touches a different body info.
+///
+/// Few jobs are run on the calling thread since waking up workers costs more than deserializing small documents.
+/// If jobs throw, the exception of the first failing job in input order is rethrown after all jobs finished.
+void _RunBodyInfoDeserializationJobs(std::vector<BodyInfoDeserializationJob>& vJobs, const std::vector<size_t>& vJobIndices, dReal fUnitScale, int options)
+{
+    static const size_t s_nMinJobsForThreads = 8;
+    std::vector<std::exception_ptr> vExceptions(vJobIndices.size());
+    std::atomic<size_t> nextIndex(0);
+    const std::function<void()> runJobs = [&]() {
+        for (size_t index = nextIndex++; index < vJobIndices.size(); index = nextIndex++) {
+            try {
+                vJobs[vJobIndices[index]].Run(fUnitScale, options);
+            }
+            catch (...) {
+                vExceptions[index] = std::current_exception();
+            }
+        }
+    };
+
+    const size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), vJobIndices.size());
+    bool bRan = false;
+    if( numThreads > 1 && vJobIndices.size() >= s_nMinJobsForThreads ) {
+        static BodyInfoDeserializationWorkers s_workers;
+        bRan = s_workers.Run(runJobs, numThreads-1);
+    }
+    if( !bRan ) {
+        // few jobs, or the workers are used by another call, so do not wait for them
+        runJobs();
+    }
+    FOREACHC(itException, vExceptions) {
+        if( !!*itException ) {
+            std::rethrow_exception(*itException);
+        }
+    }
+}
+
+} // end namespace
+
 EnvironmentBase::EnvironmentBaseInfo::EnvironmentBaseInfo()
 {
     _gravity = Vector(0,0,-9.797930195020351);
@@ -185,6 +339,36 @@ void EnvironmentBase::EnvironmentBaseInfo::DeserializeJSONWithMapping(const rapi
     if (rEnvInfo.HasMember("bodies")) {
         _vBodyInfos.reserve(_vBodyInfos.size() + rEnvInfo["bodies"].Size());
         const rapidjson::Value& rBodies = rEnvInfo["bodies"];
+
+        // First decide which info every input body updates, then deserialize the infos in parallel. Later bodies are matched by the
+        // ids and names of earlier ones, so those are set right away. Inputs updating the same info are deserialized in order.
+        std::vector<BodyInfoDeserializationJob> vJobs;
+        std::unordered_map<KinBody::KinBodyInfo*, size_t> mapInfoToJobIndex;
+        const auto addToJob = [&vJobs, &mapInfoToJobIndex](const KinBody::KinBodyInfoPtr& pKinBodyInfo, const rapidjson::Value& rKinBodyInfo, const std::string& id) {
+            std::unordered_map<KinBody::KinBodyInfo*, size_t>::iterator itJobIndex = mapInfoToJobIndex.find(pKinBodyInfo.get());
+            if( itJobIndex == mapInfoToJobIndex.end() ) {
+                itJobIndex = mapInfoToJobIndex.emplace(pKinBodyInfo.get(), vJobs.size()).first;
+                vJobs.emplace_back();
+                vJobs.back().pKinBodyInfo = pKinBodyInfo;
+            }
+            vJobs[itJobIndex->second].vValues.emplace_back(&rKinBodyInfo, id);
+            orjson::LoadJsonValueByKey(rKinBodyInfo, "name", pKinBodyInfo->_name);
+            pKinBodyInfo->_id = id;
+        };
+        // removes the job of an info that is deleted or replaced. If replaced, its pending values are applied first since they are copied into the new info.
+        const auto removeJob = [&vJobs, &mapInfoToJobIndex, fUnitScale, options](const KinBody::KinBodyInfoPtr& pKinBodyInfo, bool bRunPending) {
+            std::unordered_map<KinBody::KinBodyInfo*, size_t>::iterator itJobIndex = mapInfoToJobIndex.find(pKinBodyInfo.get());
+            if( itJobIndex != mapInfoToJobIndex.end() ) {
+                BodyInfoDeserializationJob& job = vJobs[itJobIndex->second];
+                if( bRunPending ) {
+                    job.Run(fUnitScale, options);
+                }
+                job.pKinBodyInfo.reset();
+                job.vValues.clear();
+                mapInfoToJobIndex.erase(itJobIndex);
+            }
+        };
+
         for(int iInputBodyIndex = 0; iInputBodyIndex < (int)rBodies.Size(); ++iInputBodyIndex) {
             const rapidjson::Value& rKinBodyInfo = rBodies[iInputBodyIndex];
 
@@ -230,77 +414,66 @@ void EnvironmentBase::EnvironmentBaseInfo::DeserializeJSONWithMapping(const rapi
 
             bool isRobot = orjson::GetJsonValueByKey<bool>(rKinBodyInfo, "isRobot", isExistingRobot);
             RAVELOG_VERBOSE_FORMAT("body id='%s', isRobot=%d", id%isRobot);
-            if (isRobot) {
-                if (itExistingBodyInfo == _vBodyInfos.end()) {
-                    // in case no such id
-                    if (!isDeleted) {
-                        RobotBase::RobotBaseInfoPtr pRobotBaseInfo(new RobotBase::RobotBaseInfo());
-                        pRobotBaseInfo->DeserializeJSON(rKinBodyInfo, fUnitScale, options);
-                        if (!pRobotBaseInfo->_name.empty()) {
-                            pRobotBaseInfo->_id = id;
-                            _vBodyInfos.push_back(pRobotBaseInfo);
-                            RAVELOG_VERBOSE_FORMAT("created new robot id='%s'", id);
-                        } else {
-                            RAVELOG_WARN_FORMAT("new robot id='%s' does not have a name, so skip creating", id);
-                        }
+            if (itExistingBodyInfo == _vBodyInfos.end()) {
+                // in case no such id
+                if (!isDeleted) {
+                    KinBody::KinBodyInfoPtr pKinBodyInfo;
+                    if (isRobot) {
+                        pKinBodyInfo.reset(new RobotBase::RobotBaseInfo());
                     }
-                    continue;
-                }
-                // in case same id exists before
-                if (isDeleted) {
-                    RAVELOG_VERBOSE_FORMAT("deleted robot id ='%s'", id);
-                    _vBodyInfos.erase(itExistingBodyInfo);
-                    continue;
-                }
-                KinBody::KinBodyInfoPtr pKinBodyInfo = *itExistingBodyInfo;
-                RobotBase::RobotBaseInfoPtr pRobotBaseInfo = OPENRAVE_DYNAMIC_POINTER_CAST<RobotBase::RobotBaseInfo>(pKinBodyInfo);
-                if (!pRobotBaseInfo) {
-                    // previous body was not a robot
-                    // need to replace with a new RobotBaseInfo
-                    pRobotBaseInfo.reset(new RobotBase::RobotBaseInfo());
-                    *itExistingBodyInfo = pRobotBaseInfo;
-                    *((KinBody::KinBodyInfo*)pRobotBaseInfo.get()) = *pKinBodyInfo;
-                    RAVELOG_VERBOSE_FORMAT("replaced body as a robot id='%s'", id);
-                }
-                pRobotBaseInfo->DeserializeJSON(rKinBodyInfo, fUnitScale, options);
-                pRobotBaseInfo->_id = id;
-            }
-            else {
-                // not a robot
-                if (itExistingBodyInfo == _vBodyInfos.end()) {
-                    // in case no such id
-                    if (!isDeleted) {
-                        KinBody::KinBodyInfoPtr pKinBodyInfo(new KinBody::KinBodyInfo());
-                        pKinBodyInfo->DeserializeJSON(rKinBodyInfo, fUnitScale, options);
-                        if (!pKinBodyInfo->_name.empty()) {
-                            pKinBodyInfo->_id = id;
-                            _vBodyInfos.push_back(pKinBodyInfo);
-                            RAVELOG_VERBOSE_FORMAT("created new body id='%s'", id);
-                        } else {
-                            RAVELOG_WARN_FORMAT("new body id='%s' does not have a name, so skip creating", id);
-                        }
+                    else {
+                        pKinBodyInfo.reset(new KinBody::KinBodyInfo());
+                    }
+                    orjson::LoadJsonValueByKey(rKinBodyInfo, "name", pKinBodyInfo->_name);
+                    if (!pKinBodyInfo->_name.empty()) {
+                        _vBodyInfos.push_back(pKinBodyInfo);
+                        addToJob(pKinBodyInfo, rKinBodyInfo, id);
+                        vJobs[mapInfoToJobIndex[pKinBodyInfo.get()]].bInitCollisionMeshes = true;
+                        RAVELOG_VERBOSE_FORMAT("created new %s id='%s'", (isRobot ? "robot" : "body")%id);
+                    } else {
+                        RAVELOG_WARN_FORMAT("new %s id='%s' does not have a name, so skip creating", (isRobot ? "robot" : "body")%id);
                     }
-                    continue;
-                }
-                // in case same id exists before
-                if (isDeleted) {
-                    RAVELOG_VERBOSE_FORMAT("deleted body id='%s'", id);
-                    _vBodyInfos.erase(itExistingBodyInfo);
-                    continue;
-                }
-                KinBody::KinBodyInfoPtr pKinBodyInfo = *itExistingBodyInfo;
-                RobotBase::RobotBaseInfoPtr pRobotBaseInfo = OPENRAVE_DYNAMIC_POINTER_CAST<RobotBase::RobotBaseInfo>(pKinBodyInfo);
-                if (!!pRobotBaseInfo) {
-                    // previous body was a robot
-                    // need to replace with a new KinBodyInfo
-                    pKinBodyInfo.reset(new KinBody::KinBodyInfo());
-                    *itExistingBodyInfo = pKinBodyInfo;
-                    *pKinBodyInfo = *((KinBody::KinBodyInfo*)pRobotBaseInfo.get());
-                    RAVELOG_VERBOSE_FORMAT("replaced robot as a body id='%s'", id);
                 }
-                pKinBodyInfo->DeserializeJSON(rKinBodyInfo, fUnitScale, options);
-                pKinBodyInfo->_id = id;
+                continue;
+            }
+            // in case same id exists before
+            if (isDeleted) {
+                RAVELOG_VERBOSE_FORMAT("deleted %s id='%s'", (isRobot ? "robot" : "body")%id);
+                removeJob(*itExistingBodyInfo, false);
+                _vBodyInfos.erase(itExistingBodyInfo);
+                continue;
+            }
+            KinBody::KinBodyInfoPtr pKinBodyInfo = *itExistingBodyInfo;
+            RobotBase::RobotBaseInfoPtr pRobotBaseInfo = OPENRAVE_DYNAMIC_POINTER_CAST<RobotBase::RobotBaseInfo>(pKinBodyInfo);
+            if (isRobot && !pRobotBaseInfo) {
+                // previous body was not a robot
+                // need to replace with a new RobotBaseInfo
+                removeJob(pKinBodyInfo, true);
+                pRobotBaseInfo.reset(new RobotBase::RobotBaseInfo());
+                *itExistingBodyInfo = pRobotBaseInfo;
+                *((KinBody::KinBodyInfo*)pRobotBaseInfo.get()) = *pKinBodyInfo;
+                pKinBodyInfo = pRobotBaseInfo;
+                RAVELOG_VERBOSE_FORMAT("replaced body as a robot id='%s'", id);
+            }
+            else if (!isRobot && !!pRobotBaseInfo) {
+                // previous body was a robot
+                // need to replace with a new KinBodyInfo
+                removeJob(pKinBodyInfo, true);
+                pKinBodyInfo.reset(new KinBody::KinBodyInfo());
+                *itExistingBodyInfo = pKinBodyInfo;
+                *pKinBodyInfo = *((KinBody::KinBodyInfo*)pRobotBaseInfo.get());
+                RAVELOG_VERBOSE_FORMAT("replaced robot as a body id='%s'", id);
+            }
+            addToJob(pKinBodyInfo, rKinBodyInfo, id);
+        }
+
+        std::vector<size_t> vJobIndices;
+        vJobIndices.reserve(mapInfoToJobIndex.size());
+        for (size_t iJob = 0; iJob < vJobs.size(); ++iJob) {
+            if( !!vJobs[iJob].pKinBodyInfo ) {
+                vJobIndices.push_back(iJob);
             }
         }
+        _RunBodyInfoDeserializationJobs(vJobs, vJobIndices, fUnitScale, options);
     }
 }
@@ -26,6 +26,8 @@ InterfaceBase::InterfaceBase(InterfaceType type, EnvironmentBasePtr penv) : __ty
     RaveInitializeFromState(penv->GlobalState()); // make sure global state is set
     RegisterCommand("help",boost::bind(&InterfaceBase::_GetCommandHelp,this,_1,_2), "display help commands.");
     RegisterJSONCommand("help",boost::bind(&InterfaceBase::_GetJSONCommandHelp,this,_1,_2,_3), "display help commands.");
+    RegisterJSONCommand("GetStatistics",boost::bind(&InterfaceBase::_GetJSONStatistics,this,_1,_2,_3), "returns the hot path counters of the environment, only the ones of input[\"interfaceName\"] if given.");
+    RegisterJSONCommand("ResetStatistics",boost::bind(&InterfaceBase::_ResetJSONStatistics,this,_1,_2,_3), "sets the hot path counters of the environment to 0, only the ones of input[\"interfaceName\"] if given.");
 }
 
 InterfaceBase::~InterfaceBase()
@@ -259,6 +261,24 @@ void InterfaceBase::_GetJSONCommandHelp(const rapidjson::Value& input, rapidjson
     }
 }
 
+void InterfaceBase::_GetJSONStatistics(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator) const
+{
+    std::string interfaceName;
+    if( input.IsObject() ) {
+        orjson::LoadJsonValueByKey(input, "interfaceName", interfaceName);
+    }
+    GetEnv()->GetStatisticsRegistry().SerializeJSON(output, allocator, interfaceName);
+}
+
+void InterfaceBase::_ResetJSONStatistics(const rapidjson::Value& input, rapidjson::Value& output, rapidjson::Document::AllocatorType& allocator)
+{
+    std::string interfaceName;
+    if( input.IsObject() ) {
+        orjson::LoadJsonValueByKey(input, "interfaceName", interfaceName);
+    }
+    GetEnv()->GetStatisticsRegistry().Reset(interfaceName);
+}
+
 ReadablePtr ReadablesContainer::GetReadableInterface(const std::string& id) const
 {
     boost::shared_lock< boost::shared_mutex > lock(_mutexInterface);
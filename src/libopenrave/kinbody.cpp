@@ -15,6 +15,7 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "libopenrave.h"
+#include "kinbodydynamics.h"
 #include <algorithm>
 #include <unordered_set>
 
@@ -444,6 +445,7 @@ KinBody::KinBody(InterfaceType type, EnvironmentBasePtr penv) : InterfaceBase(ty
     _bAreAllJoints1DOFAndNonCircular = false;
     _lastModifiedAtUS = 0;
     _revisionId = 0;
+    _pSetDOFValuesStatistics = penv->GetStatisticsRegistry().GetCounter(RaveGetInterfaceName(type), "SetDOFValues");
 }
 
 KinBody::~KinBody()
@@ -508,7 +510,6 @@ bool KinBody::InitFromBoxes(const std::vector<AABB>& vaabbs, bool visible, const
     plink->_index = 0;
     plink->_info._name = "base";
     plink->_info._bStatic = true;
-    size_t numvertices=0, numindices=0;
     FOREACHC(itab, vaabbs) {
         GeometryInfo info;
         info._type = GT_Box;
@@ -519,19 +520,9 @@ bool KinBody::InitFromBoxes(const std::vector<AABB>& vaabbs, bool visible, const
         info._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         Link::GeometryPtr geom(new Link::Geometry(plink,info));
         geom->_info.InitCollisionMesh();
-        numvertices += geom->GetCollisionMesh().vertices.size();
-        numindices += geom->GetCollisionMesh().indices.size();
         plink->_vGeometries.push_back(geom);
     }
 
-    plink->_collision.vertices.reserve(numvertices);
-    plink->_collision.indices.reserve(numindices);
-    TriMesh trimesh;
-    FOREACH(itgeom,plink->_vGeometries) {
-        trimesh = (*itgeom)->GetCollisionMesh();
-        trimesh.ApplyTransform((*itgeom)->GetTransform());
-        plink->_collision.Append(trimesh);
-    }
     _veclinks.push_back(plink);
     _vLinkTransformPointers.clear();
     __struri = uri;
@@ -548,7 +539,6 @@ bool KinBody::InitFromBoxes(const std::vector<OBB>& vobbs, bool visible, const s
     plink->_index = 0;
     plink->_info._name = "base";
     plink->_info._bStatic = true;
-    size_t numvertices=0, numindices=0;
     FOREACHC(itobb, vobbs) {
         TransformMatrix tm;
         tm.trans = itobb->pos;
@@ -564,19 +554,9 @@ bool KinBody::InitFromBoxes(const std::vector<OBB>& vobbs, bool visible, const s
         info._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         Link::GeometryPtr geom(new Link::Geometry(plink,info));
         geom->_info.InitCollisionMesh();
-        numvertices += geom->GetCollisionMesh().vertices.size();
-        numindices += geom->GetCollisionMesh().indices.size();
         plink->_vGeometries.push_back(geom);
     }
 
-    plink->_collision.vertices.reserve(numvertices);
-    plink->_collision.indices.reserve(numindices);
-    TriMesh trimesh;
-    FOREACH(itgeom,plink->_vGeometries) {
-        trimesh = (*itgeom)->GetCollisionMesh();
-        trimesh.ApplyTransform((*itgeom)->GetTransform());
-        plink->_collision.Append(trimesh);
-    }
     _veclinks.push_back(plink);
     _vLinkTransformPointers.clear();
     __struri = uri;
@@ -593,7 +573,6 @@ bool KinBody::InitFromSpheres(const std::vector<Vector>& vspheres, bool visible,
     plink->_index = 0;
     plink->_info._name = "base";
     plink->_info._bStatic = true;
-    TriMesh trimesh;
     FOREACHC(itv, vspheres) {
         GeometryInfo info;
         info._type = GT_Sphere;
@@ -605,9 +584,6 @@ bool KinBody::InitFromSpheres(const std::vector<Vector>& vspheres, bool visible,
         Link::GeometryPtr geom(new Link::Geometry(plink,info));
         geom->_info.InitCollisionMesh();
         plink->_vGeometries.push_back(geom);
-        trimesh = geom->GetCollisionMesh();
-        trimesh.ApplyTransform(geom->GetTransform());
-        plink->_collision.Append(trimesh);
     }
     _veclinks.push_back(plink);
     _vLinkTransformPointers.clear();
@@ -625,13 +601,12 @@ bool KinBody::InitFromTrimesh(const TriMesh& trimesh, bool visible, const std::s
     plink->_index = 0;
     plink->_info._name = "base";
     plink->_info._bStatic = true;
-    plink->_collision = trimesh;
     GeometryInfo info;
     info._type = GT_TriMesh;
     info._bVisible = visible;
     info._vDiffuseColor=Vector(1,0.5f,0.5f,1);
     info._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
-    info._meshcollision = trimesh;
+    info._meshcollision.SetTriMesh(trimesh);
     Link::GeometryPtr geom(new Link::Geometry(plink,info));
     plink->_vGeometries.push_back(geom);
     _veclinks.push_back(plink);
@@ -653,23 +628,11 @@ bool KinBody::InitFromGeometries(const std::vector<KinBody::GeometryInfo>& geome
     plink->_vGeometries.reserve(geometries.size());
     plink->_info._bStatic = true;
 
-    // Initialize each of our geometries and track the total vertex/index count
-    unsigned totalVertices = 0, totalIndices = 0;
+    // Initialize each of our geometries, the unified collision mesh of the link is computed from them on first use
     FOREACHC(geomIt, geometries) {
-        Link::GeometryPtr geom {new KinBody::Link::Geometry(plink, *geomIt)};
-        geom->_info.InitCollisionMesh();
-        const TriMesh& mesh = geom->GetCollisionMesh();
-        totalVertices += mesh.vertices.size();
-        totalIndices += mesh.indices.size();
-        plink->_vGeometries.push_back(geom);
-    }
-
-    // Once we have all of the geometries initialized and know their total size, reserve space in our unified collision mesh and append them all at once to reduce reallocs
-    plink->_collision.vertices.reserve(totalVertices);
-    plink->_collision.indices.reserve(totalIndices);
-    for (const KinBody::GeometryPtr& geom : plink->_vGeometries) {
-        plink->_collision.Append(geom->GetCollisionMesh(), geom->GetTransform());
+        plink->_vGeometries.push_back(Link::GeometryPtr(new KinBody::Link::Geometry(plink, *geomIt)));
     }
+    InitCollisionMeshes(plink->_vGeometries);
 
     _veclinks.push_back(plink);
     _vLinkTransformPointers.clear();
@@ -698,12 +661,10 @@ void KinBody::SetLinkGeometriesFromGroup(const std::string& geomname, const bool
         (*itlink)->_vGeometries.resize(pvinfos->size());
         for(size_t i = 0; i < pvinfos->size(); ++i) {
             (*itlink)->_vGeometries[i].reset(new Link::Geometry(*itlink,*pvinfos->at(i)));
-            if( (*itlink)->_vGeometries[i]->GetCollisionMesh().vertices.size() == 0 ) { // try to avoid recomputing
-                (*itlink)->_vGeometries[i]->InitCollisionMesh();
-            }
         }
         (*itlink)->_Update(false);
     }
+    InitMissingCollisionMeshes(_veclinks);
     // have to reset the adjacency cache
     _ResetInternalCollisionCache();
 
@@ -736,6 +697,7 @@ bool KinBody::Init(const std::vector<KinBody::LinkInfoConstPtr>& linkinfos, cons
         plink->_info = **itlinkinfo;
         _InitAndAddLink(plink);
     }
+    InitMissingCollisionMeshes(_veclinks);
     _vecjoints.reserve(jointinfos.size());
     FOREACHC(itjointinfo, jointinfos) {
         JointInfoConstPtr rawinfo = *itjointinfo;
@@ -761,6 +723,7 @@ void KinBody::InitFromLinkInfos(const std::vector<LinkInfo>& linkinfos, const st
         plink->_info = *itlinkinfo;
         _InitAndAddLink(plink);
     }
+    InitMissingCollisionMeshes(_veclinks);
     if( linkinfos.size() > 1 ) {
         // create static joints
         _vecjoints.clear();
@@ -2121,6 +2084,7 @@ void KinBody::SetDOFValues(const std::vector<dReal>& vJointValues, uint32_t chec
 void KinBody::SetDOFValues(const dReal* pJointValues, int dof, uint32_t checklimits, const std::vector<int>& dofindices)
 {
     CHECK_INTERNAL_COMPUTATION;
+    StatisticsTimer timer(_pSetDOFValuesStatistics);
     if( dof == 0 || _veclinks.size() == 0) {
         return;
     }
@@ -3472,6 +3436,12 @@ void KinBody::ComputeInverseDynamics(std::vector<dReal>& doftorques, const std::
         return;
     }
 
+    DynamicsWorkspace& workspace = _GetDynamicsWorkspace();
+    if( workspace.IsSupported() ) {
+        workspace.ComputeInverseDynamics(*this, doftorques, vDOFAccelerations, mapExternalForceTorque);
+        return;
+    }
+
     Vector vgravity = GetEnv()->GetPhysicsEngine()->GetGravity();
     std::vector<dReal> vDOFVelocities;
     std::vector<pair<Vector, Vector> > vLinkVelocities, vLinkAccelerations; // linear, angular
@@ -4114,6 +4084,7 @@ void KinBody::_ComputeInternalInformation()
 {
     uint64_t starttime = utils::GetMicroTime();
     _nHierarchyComputed = 1;
+    _pDynamicsWorkspace.reset();
 
     _vLinkTransformPointers.clear();
     if( !!_pCurrentKinematicsFunctions ) {
@@ -5134,6 +5105,7 @@ void KinBody::_ComputeInternalInformation()
 void KinBody::_DeinitializeInternalInformation()
 {
     _nHierarchyComputed = 0; // should reset to inform other elements that kinematics information might not be accurate
+    _pDynamicsWorkspace.reset();
 }
 
 bool KinBody::IsAttached(const KinBody &body) const
@@ -5888,6 +5860,9 @@ void KinBody::Clone(InterfaceBaseConstPtr preference, int cloningoptions)
 void KinBody::_PostprocessChangedParameters(uint32_t parameters)
 {
     _nUpdateStampId++;
+    if( !!(parameters & (Prop_LinkDynamics|Prop_JointMimic)) ) {
+        _pDynamicsWorkspace.reset();
+    }
     if( _nHierarchyComputed == 1 ) {
         _nParametersChanged |= parameters;
         return;
@@ -6071,16 +6046,11 @@ void KinBody::_InitAndAddLink(LinkPtr plink)
     }
 
     plink->_index = static_cast<int>(_veclinks.size());
+    ++plink->_nGeometryUpdateStamp;
     plink->_vGeometries.clear();
-    plink->_collision.vertices.clear();
-    plink->_collision.indices.clear();
+    plink->_ResetCollisionData();
     FOREACHC(itgeominfo,info._vgeometryinfos) {
-        Link::GeometryPtr geom(new Link::Geometry(plink,**itgeominfo));
-        if( geom->_info._meshcollision.vertices.size() == 0 ) { // try to avoid recomputing
-            geom->_info.InitCollisionMesh();
-        }
-        plink->_vGeometries.push_back(geom);
-        plink->_collision.Append(geom->GetCollisionMesh(),geom->GetTransform());
+        plink->_vGeometries.push_back(Link::GeometryPtr(new Link::Geometry(plink,**itgeominfo)));
     }
 
     FOREACH(it, info._mReadableInterfaces) {
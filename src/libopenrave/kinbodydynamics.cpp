@@ -0,0 +1,426 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2006-2022 Rosen Diankov (rosen.diankov@gmail.com)
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "kinbodydynamics.h"
+
+namespace OpenRAVE {
+
+namespace {
+
+/// \brief returns m*v for a row-major 3x3 matrix
+inline Vector MultiplyMatrix3(const boost::array<dReal, 9>& m, const Vector& v)
+{
+    return Vector(m[0]*v.x + m[1]*v.y + m[2]*v.z, m[3]*v.x + m[4]*v.y + m[5]*v.z, m[6]*v.x + m[7]*v.y + m[8]*v.z);
+}
+
+} // end namespace
+
+KinBody::DynamicsWorkspace::DynamicsWorkspace(const KinBody& body) : _bSupported(true), _bHasVelocity(false)
+{
+    const size_t numlinks = body._veclinks.size();
+    _vlinkmasses.resize(numlinks);
+    _vlinkmassframes.resize(numlinks);
+    _vlinkinertiamoments.resize(numlinks);
+    for(size_t ilink = 0; ilink < numlinks; ++ilink) {
+        const LinkInfo& info = body._veclinks[ilink]->_info;
+        _vlinkmasses[ilink] = info._mass;
+        _vlinkmassframes[ilink] = info._tMassFrame;
+        _vlinkinertiamoments[ilink] = info._vinertiamoments;
+    }
+
+    _vdofscales.resize(body.GetDOF(), 1);
+    if( body._vPassiveJoints.size() > 0 ) {
+        // passive joints get their motion from mimic equations or the physics engine
+        _bSupported = false;
+    }
+
+    // the joint moving every link, used to find the ancestors of a joint
+    std::vector<int> vlinkjointindices(numlinks, -1);
+    _vjoints.reserve(body._vTopologicallySortedJointsAll.size());
+    FOREACHC(itjoint, body._vTopologicallySortedJointsAll) {
+        const Joint& joint = **itjoint;
+        if( !_bSupported ) {
+            break;
+        }
+        if( joint.GetDOF() != 1 || joint.IsMimic() || joint.GetDOFIndex() < 0 || (joint.GetType() != JointRevolute && joint.GetType() != JointPrismatic) ) {
+            _bSupported = false;
+            break;
+        }
+
+        JointData data;
+        data.pjoint = &joint;
+        data.dofindex = joint.GetDOFIndex();
+        data.childindex = joint.GetHierarchyChildLink()->GetIndex();
+        data.parentindex = !!joint.GetHierarchyParentLink() ? joint.GetHierarchyParentLink()->GetIndex() : -1;
+        data.velocityparentindex = !!joint._attachedbodies[0] ? joint._attachedbodies[0]->GetIndex() : 0;
+        data.velocitychildindex = joint._attachedbodies[1]->GetIndex();
+        data.parentjointindex = data.parentindex >= 0 ? vlinkjointindices[data.parentindex] : -1;
+        data.bRevolute = joint.GetType() == JointRevolute;
+        if( data.childindex == 0 || vlinkjointindices[data.childindex] >= 0 ) {
+            // closed chains move the same link through several joints
+            _bSupported = false;
+            break;
+        }
+        vlinkjointindices[data.childindex] = (int)_vjoints.size();
+        if( !data.bRevolute ) {
+            _vdofscales[data.dofindex] = 1/(2*PI);
+        }
+        _vjoints.push_back(data);
+    }
+    if( !_bSupported ) {
+        _vjoints.clear();
+        return;
+    }
+
+    _vLinkCOMs.resize(numlinks);
+    _vLinkInertias.resize(numlinks);
+    _vLinkLinearAccelerations.resize(numlinks);
+    _vLinkAngularAccelerations.resize(numlinks);
+    _vLinkCOMLinearAccelerations.resize(numlinks);
+    _vLinkCOMMoments.resize(numlinks);
+    _vLinkForces.resize(numlinks);
+    _vLinkTorques.resize(numlinks);
+    _vCompositeMasses.resize(numlinks);
+    _vCompositeFirstMoments.resize(numlinks);
+    _vCompositeInertias.resize(numlinks);
+    _vDOFVelocities.resize(body.GetDOF());
+}
+
+dReal KinBody::DynamicsWorkspace::_GetRotorInertia(const Joint& joint)
+{
+    const ElectricMotorActuatorInfoPtr& pActuatorInfo = joint._info._infoElectricMotor;
+    if( !!pActuatorInfo && pActuatorInfo->rotor_inertia > 0.0 ) {
+        // converting inertia on motor side to load side requires multiplying by gear ratio squared because inertia unit is mass * distance^2
+        return pActuatorInfo->rotor_inertia * pActuatorInfo->gear_ratio * pActuatorInfo->gear_ratio;
+    }
+    return 0;
+}
+
+void KinBody::DynamicsWorkspace::_UpdateState(const KinBody& body)
+{
+    body.GetEnv()->GetPhysicsEngine()->GetLinkVelocities(body.shared_kinbody_const(), _vLinkVelocities);
+
+    std::fill(_vDOFVelocities.begin(), _vDOFVelocities.end(), 0);
+    _bHasVelocity = false;
+    FOREACHC(itjoint, _vjoints) {
+        itjoint->pjoint->_GetVelocities(&_vDOFVelocities[itjoint->dofindex], _vLinkVelocities[itjoint->velocityparentindex], _vLinkVelocities[itjoint->velocitychildindex]);
+        if( RaveFabs(_vDOFVelocities[itjoint->dofindex]) > g_fEpsilonLinear ) {
+            _bHasVelocity = true;
+        }
+    }
+
+    for(size_t ilink = 0; ilink < _vLinkCOMs.size(); ++ilink) {
+        const Transform tmassframe = body._veclinks[ilink]->_info._t * _vlinkmassframes[ilink];
+        _vLinkCOMs[ilink] = tmassframe.trans;
+
+        // R * diag(moments) * R^T
+        const TransformMatrix mrot = geometry::matrixFromQuat(tmassframe.rot);
+        const Vector& vmoments = _vlinkinertiamoments[ilink];
+        boost::array<dReal, 9>& inertia = _vLinkInertias[ilink];
+        for(int i = 0; i < 3; ++i) {
+            for(int j = i; j < 3; ++j) {
+                inertia[3*i+j] = inertia[3*j+i] = mrot.m[4*i]*vmoments.x*mrot.m[4*j] + mrot.m[4*i+1]*vmoments.y*mrot.m[4*j+1] + mrot.m[4*i+2]*vmoments.z*mrot.m[4*j+2];
+            }
+        }
+    }
+}
+
+void KinBody::DynamicsWorkspace::_ComputeTorques(const KinBody& body, std::vector<dReal>& doftorques, const dReal* pdofaccelerations, const ForceTorqueMap& mapExternalForceTorque)
+{
+    const std::vector<LinkPtr>& vlinks = body._veclinks;
+    const Vector vgravity = body.GetEnv()->GetPhysicsEngine()->GetGravity();
+
+    // set accelerations of all links as if they were the base link, the base link is accelerated against gravity
+    for(size_t ilink = 0; ilink < vlinks.size(); ++ilink) {
+        _vLinkLinearAccelerations[ilink] = _vLinkVelocities[ilink].second.cross(_vLinkVelocities[ilink].first);
+        _vLinkAngularAccelerations[ilink] = Vector();
+    }
+    _vLinkLinearAccelerations[0] -= vgravity;
+
+    // forward recursion for the link accelerations, see KinBody::_ComputeLinkAccelerations for the derivation
+    FOREACHC(itjoint, _vjoints) {
+        const int childindex = itjoint->childindex;
+        const int parentindex = itjoint->parentindex >= 0 ? itjoint->parentindex : 0;
+        const Transform& tparent = vlinks[parentindex]->_info._t;
+        const Transform& tchild = vlinks[childindex]->_info._t;
+        const Vector& vParentLinearVelocity = _vLinkVelocities[parentindex].first;
+        const Vector& vParentAngularVelocity = _vLinkVelocities[parentindex].second;
+        const Vector& vParentLinearAcceleration = _vLinkLinearAccelerations[parentindex];
+        const Vector& vParentAngularAcceleration = _vLinkAngularAccelerations[parentindex];
+        const Vector xyzdelta = tchild.trans - tparent.trans;
+        const Transform tdelta = tparent * itjoint->pjoint->GetInternalHierarchyLeftTransform();
+        const Vector vaxis = tdelta.rotate(itjoint->pjoint->GetInternalHierarchyAxis(0));
+
+        Vector& vChildLinearAcceleration = _vLinkLinearAccelerations[childindex];
+        Vector& vChildAngularAcceleration = _vLinkAngularAccelerations[childindex];
+        if( itjoint->bRevolute ) {
+            vChildLinearAcceleration = vParentLinearAcceleration + vParentAngularAcceleration.cross(xyzdelta) + vParentAngularVelocity.cross((_vLinkVelocities[childindex].first-vParentLinearVelocity)*2-vParentAngularVelocity.cross(xyzdelta));
+            vChildAngularAcceleration = vParentAngularAcceleration;
+            if( _bHasVelocity ) {
+                Vector gw = vaxis*_vDOFVelocities[itjoint->dofindex];
+                vChildLinearAcceleration += gw.cross(gw.cross(tchild.trans-tdelta.trans));
+                vChildAngularAcceleration += vParentAngularVelocity.cross(gw);
+            }
+            if( !!pdofaccelerations ) {
+                Vector gdw = vaxis*pdofaccelerations[itjoint->dofindex];
+                vChildLinearAcceleration += gdw.cross(tchild.trans-tdelta.trans);
+                vChildAngularAcceleration += gdw;
+            }
+        }
+        else {
+            vChildLinearAcceleration = vParentLinearAcceleration + vParentAngularAcceleration.cross(xyzdelta);
+            Vector angularveloctiycontrib = _vLinkVelocities[childindex].first-vParentLinearVelocity;
+            if( _bHasVelocity ) {
+                angularveloctiycontrib += vaxis*_vDOFVelocities[itjoint->dofindex];
+            }
+            vChildLinearAcceleration += vParentAngularVelocity.cross(angularveloctiycontrib);
+            if( !!pdofaccelerations ) {
+                vChildLinearAcceleration += vaxis*pdofaccelerations[itjoint->dofindex];
+            }
+            vChildAngularAcceleration = vParentAngularAcceleration;
+        }
+    }
+
+    for(size_t ilink = 0; ilink < vlinks.size(); ++ilink) {
+        const Vector vglobalcomfromlink = _vLinkCOMs[ilink] - vlinks[ilink]->_info._t.trans;
+        const Vector& vangularaccel = _vLinkAngularAccelerations[ilink];
+        const Vector& vangularvelocity = _vLinkVelocities[ilink].second;
+        _vLinkCOMLinearAccelerations[ilink] = _vLinkLinearAccelerations[ilink] + vangularaccel.cross(vglobalcomfromlink) + vangularvelocity.cross(vangularvelocity.cross(vglobalcomfromlink));
+        _vLinkCOMMoments[ilink] = MultiplyMatrix3(_vLinkInertias[ilink], vangularaccel) + vangularvelocity.cross(MultiplyMatrix3(_vLinkInertias[ilink], vangularvelocity));
+        _vLinkForces[ilink] = Vector();
+        _vLinkTorques[ilink] = Vector();
+    }
+    FOREACHC(it, mapExternalForceTorque) {
+        _vLinkForces.at(it->first) = it->second.first;
+        _vLinkTorques.at(it->first) = it->second.second;
+    }
+
+    // backward recursion
+    doftorques.resize(_vdofscales.size());
+    std::fill(doftorques.begin(), doftorques.end(), 0);
+    for(std::vector<JointData>::const_reverse_iterator itjoint = _vjoints.rbegin(); itjoint != _vjoints.rend(); ++itjoint) {
+        const Joint& joint = *itjoint->pjoint;
+        const int childindex = itjoint->childindex;
+        const Vector vcomforce = _vLinkCOMLinearAccelerations[childindex]*_vlinkmasses[childindex] + _vLinkForces[childindex];
+        const Vector vjointtorque = _vLinkTorques[childindex] + _vLinkCOMMoments[childindex];
+        if( itjoint->parentindex >= 0 ) {
+            const int parentindex = itjoint->parentindex;
+            _vLinkForces[parentindex] += vcomforce;
+            _vLinkTorques[parentindex] += vjointtorque + (_vLinkCOMs[childindex] - _vLinkCOMs[parentindex]).cross(vcomforce);
+        }
+
+        dReal& fdoftorque = doftorques[itjoint->dofindex];
+        if( itjoint->bRevolute ) {
+            const Vector vcomtoanchor = _vLinkCOMs[childindex] - joint.GetAnchor();
+            fdoftorque += joint.GetAxis(0).dot3(vjointtorque + vcomtoanchor.cross(vcomforce));
+        }
+        else {
+            fdoftorque += joint.GetAxis(0).dot3(vcomforce)*_vdofscales[itjoint->dofindex];
+        }
+
+        // friction is only added if the velocity is non-zero since with zero velocity do not know the exact torque on the joint
+        const ElectricMotorActuatorInfoPtr& pActuatorInfo = joint._info._infoElectricMotor;
+        if( !!pActuatorInfo ) {
+            if( _bHasVelocity ) {
+                const dReal fvelocity = _vDOFVelocities[itjoint->dofindex];
+                if( fvelocity > g_fEpsilonLinear ) {
+                    fdoftorque += pActuatorInfo->coloumb_friction;
+                }
+                else if( fvelocity < -g_fEpsilonLinear ) {
+                    fdoftorque -= pActuatorInfo->coloumb_friction;
+                }
+                fdoftorque += fvelocity*pActuatorInfo->viscous_friction;
+            }
+            if( !!pdofaccelerations ) {
+                fdoftorque += pdofaccelerations[itjoint->dofindex]*_GetRotorInertia(joint);
+            }
+        }
+    }
+}
+
+void KinBody::DynamicsWorkspace::_ComputeSymmetricMassMatrix()
+{
+    // composite inertia of the subtree of every link about the global origin
+    for(size_t ilink = 0; ilink < _vCompositeMasses.size(); ++ilink) {
+        const dReal fmass = _vlinkmasses[ilink];
+        const Vector& vcom = _vLinkCOMs[ilink];
+        const dReal fcom2 = vcom.lengthsqr3();
+        _vCompositeMasses[ilink] = fmass;
+        _vCompositeFirstMoments[ilink] = vcom*fmass;
+        boost::array<dReal, 9>& inertia = _vCompositeInertias[ilink];
+        inertia = _vLinkInertias[ilink];
+        for(int i = 0; i < 3; ++i) {
+            inertia[4*i] += fmass*fcom2;
+            for(int j = 0; j < 3; ++j) {
+                inertia[3*i+j] -= fmass*vcom[i]*vcom[j];
+            }
+        }
+    }
+    for(std::vector<JointData>::const_reverse_iterator itjoint = _vjoints.rbegin(); itjoint != _vjoints.rend(); ++itjoint) {
+        if( itjoint->parentindex >= 0 ) {
+            _vCompositeMasses[itjoint->parentindex] += _vCompositeMasses[itjoint->childindex];
+            _vCompositeFirstMoments[itjoint->parentindex] += _vCompositeFirstMoments[itjoint->childindex];
+            boost::array<dReal, 9>& parentinertia = _vCompositeInertias[itjoint->parentindex];
+            const boost::array<dReal, 9>& childinertia = _vCompositeInertias[itjoint->childindex];
+            for(int i = 0; i < 9; ++i) {
+                parentinertia[i] += childinertia[i];
+            }
+        }
+    }
+
+    // a unit acceleration of a joint moves its subtree rigidly, the wrench needed for it is projected on the joint and all its ancestors
+    const size_t dof = _vdofscales.size();
+    _vMassMatrix.resize(dof*dof);
+    std::fill(_vMassMatrix.begin(), _vMassMatrix.end(), 0);
+    for(size_t ijoint = 0; ijoint < _vjoints.size(); ++ijoint) {
+        const JointData& data = _vjoints[ijoint];
+        const dReal fmass = _vCompositeMasses[data.childindex];
+        const Vector& vfirstmoment = _vCompositeFirstMoments[data.childindex];
+        const Vector vaxis = data.pjoint->GetAxis(0);
+        Vector vforce, vmoment; // moment about the global origin
+        if( data.bRevolute ) {
+            const Vector vanchor = data.pjoint->GetAnchor();
+            vforce = vaxis.cross(vfirstmoment - vanchor*fmass);
+            vmoment = MultiplyMatrix3(_vCompositeInertias[data.childindex], vaxis) - vfirstmoment.cross(vaxis.cross(vanchor));
+        }
+        else {
+            vforce = vaxis*fmass;
+            vmoment = vfirstmoment.cross(vaxis);
+        }
+
+        for(int iancestor = (int)ijoint; iancestor >= 0; iancestor = _vjoints[iancestor].parentjointindex) {
+            const JointData& ancestor = _vjoints[iancestor];
+            const Vector vancestoraxis = ancestor.pjoint->GetAxis(0);
+            dReal fvalue;
+            if( ancestor.bRevolute ) {
+                fvalue = vancestoraxis.dot3(vmoment - ancestor.pjoint->GetAnchor().cross(vforce));
+            }
+            else {
+                fvalue = vancestoraxis.dot3(vforce);
+            }
+            _vMassMatrix[ancestor.dofindex*dof+data.dofindex] = fvalue;
+            _vMassMatrix[data.dofindex*dof+ancestor.dofindex] = fvalue;
+        }
+    }
+}
+
+void KinBody::DynamicsWorkspace::ComputeInverseDynamics(const KinBody& body, std::vector<dReal>& doftorques, const std::vector<dReal>& vDOFAccelerations, const ForceTorqueMap& mapExternalForceTorque)
+{
+    if( vDOFAccelerations.size() > 0 ) {
+        OPENRAVE_ASSERT_OP(vDOFAccelerations.size(), ==, _vdofscales.size());
+    }
+    _UpdateState(body);
+    _ComputeTorques(body, doftorques, vDOFAccelerations.size() > 0 ? &vDOFAccelerations[0] : NULL, mapExternalForceTorque);
+}
+
+void KinBody::DynamicsWorkspace::ComputeMassMatrix(const KinBody& body, std::vector<dReal>& massmatrix)
+{
+    _UpdateState(body);
+    _ComputeSymmetricMassMatrix();
+    const size_t dof = _vdofscales.size();
+    massmatrix.resize(dof*dof);
+    for(size_t i = 0; i < dof; ++i) {
+        for(size_t j = 0; j < dof; ++j) {
+            massmatrix[i*dof+j] = _vMassMatrix[i*dof+j]*_vdofscales[i];
+        }
+    }
+    FOREACHC(itjoint, _vjoints) {
+        massmatrix[itjoint->dofindex*dof+itjoint->dofindex] += _GetRotorInertia(*itjoint->pjoint);
+    }
+}
+
+void KinBody::DynamicsWorkspace::ComputeForwardDynamics(const KinBody& body, std::vector<dReal>& dofaccelerations, const std::vector<dReal>& doftorques, const ForceTorqueMap& mapExternalForceTorque)
+{
+    const size_t dof = _vdofscales.size();
+    OPENRAVE_ASSERT_OP(doftorques.size(), ==, dof);
+    _UpdateState(body);
+    _ComputeTorques(body, _vBiasTorques, NULL, mapExternalForceTorque);
+    _ComputeSymmetricMassMatrix();
+
+    // massmatrix = diag(_vdofscales) * symmetric + diag(rotor), so divide every row by its scale to get a symmetric positive definite system
+    FOREACHC(itjoint, _vjoints) {
+        _vMassMatrix[itjoint->dofindex*dof+itjoint->dofindex] += _GetRotorInertia(*itjoint->pjoint)/_vdofscales[itjoint->dofindex];
+    }
+    dofaccelerations.resize(dof);
+    for(size_t i = 0; i < dof; ++i) {
+        dofaccelerations[i] = (doftorques[i] - _vBiasTorques[i])/_vdofscales[i];
+    }
+
+    // in-place cholesky decomposition into the lower triangle, then forward and backward substitution
+    dReal* pmatrix = _vMassMatrix.data();
+    for(size_t j = 0; j < dof; ++j) {
+        dReal fdiag = pmatrix[j*dof+j];
+        for(size_t k = 0; k < j; ++k) {
+            fdiag -= pmatrix[j*dof+k]*pmatrix[j*dof+k];
+        }
+        if( fdiag <= g_fEpsilon ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s mass matrix is singular at dof %d, check that all moving links have mass and inertia"), body.GetEnv()->GetNameId()%body.GetName()%j, ORE_Failed);
+        }
+        fdiag = RaveSqrt(fdiag);
+        pmatrix[j*dof+j] = fdiag;
+        for(size_t i = j+1; i < dof; ++i) {
+            dReal fvalue = pmatrix[i*dof+j];
+            for(size_t k = 0; k < j; ++k) {
+                fvalue -= pmatrix[i*dof+k]*pmatrix[j*dof+k];
+            }
+            pmatrix[i*dof+j] = fvalue/fdiag;
+        }
+    }
+    for(size_t i = 0; i < dof; ++i) {
+        dReal fvalue = dofaccelerations[i];
+        for(size_t k = 0; k < i; ++k) {
+            fvalue -= pmatrix[i*dof+k]*dofaccelerations[k];
+        }
+        dofaccelerations[i] = fvalue/pmatrix[i*dof+i];
+    }
+    for(size_t i = dof; i-- > 0; ) {
+        dReal fvalue = dofaccelerations[i];
+        for(size_t k = i+1; k < dof; ++k) {
+            fvalue -= pmatrix[k*dof+i]*dofaccelerations[k];
+        }
+        dofaccelerations[i] = fvalue/pmatrix[i*dof+i];
+    }
+}
+
+KinBody::DynamicsWorkspace& KinBody::_GetDynamicsWorkspace() const
+{
+    if( !_pDynamicsWorkspace ) {
+        _pDynamicsWorkspace.reset(new DynamicsWorkspace(*this));
+    }
+    return *_pDynamicsWorkspace;
+}
+
+void KinBody::ComputeMassMatrix(std::vector<dReal>& massmatrix) const
+{
+    OPENRAVE_ASSERT_FORMAT(_nHierarchyComputed == 2, "env=%s, body %s internal structures need to be computed, current value is %d. Are you sure Environment::AddRobot/AddKinBody was called?", GetEnv()->GetNameId()%GetName()%_nHierarchyComputed, ORE_NotInitialized);
+    DynamicsWorkspace& workspace = _GetDynamicsWorkspace();
+    if( !workspace.IsSupported() ) {
+        throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s has joints that are not single dof revolute or prismatic joints without mimic equations, cannot compute the mass matrix"), GetEnv()->GetNameId()%GetName(), ORE_NotImplemented);
+    }
+    workspace.ComputeMassMatrix(*this, massmatrix);
+}
+
+void KinBody::ComputeForwardDynamics(std::vector<dReal>& dofaccelerations, const std::vector<dReal>& doftorques, const ForceTorqueMap& mapExternalForceTorque) const
+{
+    OPENRAVE_ASSERT_FORMAT(_nHierarchyComputed == 2, "env=%s, body %s internal structures need to be computed, current value is %d. Are you sure Environment::AddRobot/AddKinBody was called?", GetEnv()->GetNameId()%GetName()%_nHierarchyComputed, ORE_NotInitialized);
+    DynamicsWorkspace& workspace = _GetDynamicsWorkspace();
+    if( !workspace.IsSupported() ) {
+        throw OPENRAVE_EXCEPTION_FORMAT(_("env=%s, body %s has joints that are not single dof revolute or prismatic joints without mimic equations, cannot compute the forward dynamics"), GetEnv()->GetNameId()%GetName(), ORE_NotImplemented);
+    }
+    workspace.ComputeForwardDynamics(*this, dofaccelerations, doftorques, mapExternalForceTorque);
+}
+
+} // end namespace OpenRAVE
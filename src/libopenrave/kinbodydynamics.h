@@ -0,0 +1,101 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2006-2022 Rosen Diankov (rosen.diankov@gmail.com)
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#ifndef OPENRAVE_KINBODY_DYNAMICS_H
+#define OPENRAVE_KINBODY_DYNAMICS_H
+
+#include "libopenrave.h"
+
+namespace OpenRAVE {
+
+/// \brief topology, local inertias and preallocated buffers for the rigid body dynamics of one body.
+///
+/// Created on demand by KinBody::_GetDynamicsWorkspace and reset whenever the joints or the link dynamics change.
+/// Every per-link and per-dof quantity is kept in its own array, so after the first call the recursions do not allocate.
+/// All quantities are in the global coordinate system and follow the same equations as KinBody::_ComputeLinkAccelerations.
+class KinBody::DynamicsWorkspace
+{
+public:
+    DynamicsWorkspace(const KinBody& body);
+
+    /// \brief true if all joints are single dof revolute or prismatic joints without mimic equations and every link has at most one parent joint
+    inline bool IsSupported() const {
+        return _bSupported;
+    }
+
+    /// \brief recursive Newton-Euler inverse dynamics of the current state, see KinBody::ComputeInverseDynamics
+    void ComputeInverseDynamics(const KinBody& body, std::vector<dReal>& doftorques, const std::vector<dReal>& vDOFAccelerations, const ForceTorqueMap& mapExternalForceTorque);
+
+    /// \brief composite rigid body mass matrix of the current position, see KinBody::ComputeMassMatrix
+    void ComputeMassMatrix(const KinBody& body, std::vector<dReal>& massmatrix);
+
+    /// \brief solves the mass matrix for the torques left after removing the zero acceleration torques, see KinBody::ComputeForwardDynamics
+    void ComputeForwardDynamics(const KinBody& body, std::vector<dReal>& dofaccelerations, const std::vector<dReal>& doftorques, const ForceTorqueMap& mapExternalForceTorque);
+
+private:
+    struct JointData
+    {
+        const Joint* pjoint;
+        int dofindex;
+        int childindex;
+        int parentindex; ///< hierarchy parent link, -1 if the joint is attached to the environment
+        int velocityparentindex; ///< first attached link used for computing the joint velocity, 0 if attached to the environment
+        int velocitychildindex; ///< second attached link used for computing the joint velocity
+        int parentjointindex; ///< index into _vjoints of the joint moving parentindex, -1 if none
+        bool bRevolute;
+    };
+
+    /// \brief reads the link velocities from the physics engine and computes dof velocities, global centers of mass and inertias
+    void _UpdateState(const KinBody& body);
+
+    /// \brief runs the forward and backward recursions on the state read by _UpdateState
+    ///
+    /// \param pdofaccelerations dof accelerations, if NULL assumes all accelerations are 0
+    void _ComputeTorques(const KinBody& body, std::vector<dReal>& doftorques, const dReal* pdofaccelerations, const ForceTorqueMap& mapExternalForceTorque);
+
+    /// \brief fills _vMassMatrix with the symmetric mass matrix of the state read by _UpdateState, without the force scaling of prismatic dofs and rotor inertias
+    void _ComputeSymmetricMassMatrix();
+
+    /// \brief rotor inertia on the load side of the electric motor driving the joint
+    static dReal _GetRotorInertia(const Joint& joint);
+
+    std::vector<JointData> _vjoints; ///< joints in topological order
+    std::vector<dReal> _vdofscales; ///< 1 for revolute dofs, 1/(2*pi) for prismatic dofs
+    std::vector<dReal> _vlinkmasses;
+    std::vector<Transform> _vlinkmassframes;
+    std::vector<Vector> _vlinkinertiamoments;
+    bool _bSupported;
+
+    // state of the body
+    std::vector< std::pair<Vector, Vector> > _vLinkVelocities; ///< linear and angular velocity of every link from the physics engine
+    std::vector<dReal> _vDOFVelocities;
+    bool _bHasVelocity;
+    std::vector<Vector> _vLinkCOMs; ///< global center of mass of every link
+    std::vector< boost::array<dReal, 9> > _vLinkInertias; ///< global inertia about the center of mass of every link, row-major
+
+    // recursion buffers
+    std::vector<Vector> _vLinkLinearAccelerations, _vLinkAngularAccelerations;
+    std::vector<Vector> _vLinkCOMLinearAccelerations, _vLinkCOMMoments;
+    std::vector<Vector> _vLinkForces, _vLinkTorques;
+    std::vector<dReal> _vCompositeMasses; ///< mass of the subtree rooted at every link
+    std::vector<Vector> _vCompositeFirstMoments; ///< sum of mass times global center of mass of the subtree rooted at every link
+    std::vector< boost::array<dReal, 9> > _vCompositeInertias; ///< inertia about the global origin of the subtree rooted at every link
+    std::vector<dReal> _vMassMatrix, _vBiasTorques;
+};
+
+} // end namespace OpenRAVE
+
+#endif
@@ -17,6 +17,10 @@
 
 #include "libopenrave.h"
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace OpenRAVE {
 
@@ -129,6 +133,120 @@ void GenerateSphereTriangulation(TriMesh& tri, int levels)
     tri = *pcur;
 }
 
+namespace {
+
+/// \brief process-wide memo of tessellated primitive geometries.
+///
+/// The key holds the geometry type, the tessellation and every shape parameter, so equal keys always produce equal meshes.
+/// Geometries assigned from the cache share its buffers.
+class TessellationCache
+{
+public:
+    typedef std::vector<dReal> Key;
+
+    boost::shared_ptr<CompactTriMesh const> Find(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::map<Key, boost::shared_ptr<CompactTriMesh const> >::const_iterator it = _mapMeshes.find(key);
+        if( it != _mapMeshes.end() ) {
+            return it->second;
+        }
+        return boost::shared_ptr<CompactTriMesh const>();
+    }
+
+    void Insert(const Key& key, boost::shared_ptr<CompactTriMesh const> pmesh)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if( _mapMeshes.size() >= s_nMaxMeshes ) {
+            // scenes rarely have this many distinct primitives, so start over instead of tracking usage
+            _mapMeshes.clear();
+        }
+        _mapMeshes[key] = pmesh;
+    }
+
+private:
+    static const size_t s_nMaxMeshes = 4096;
+
+    std::mutex _mutex;
+    std::map<Key, boost::shared_ptr<CompactTriMesh const> > _mapMeshes;
+};
+
+TessellationCache& GetTessellationCache()
+{
+    static TessellationCache cache;
+    return cache;
+}
+
+/// \brief returns the triangulation of the unit sphere at levels, computed once per process
+boost::shared_ptr<CompactTriMesh const> GetUnitSphereTriangulation(int levels)
+{
+    TessellationCache::Key key(2);
+    key[0] = -1; // not a geometry type
+    key[1] = levels;
+    boost::shared_ptr<CompactTriMesh const> pmesh = GetTessellationCache().Find(key);
+    if( !pmesh ) {
+        TriMesh sphere;
+        GenerateSphereTriangulation(sphere, levels);
+        pmesh = boost::make_shared<CompactTriMesh>(sphere);
+        GetTessellationCache().Insert(key, pmesh);
+    }
+    return pmesh;
+}
+
+inline void AppendTessellationKey(TessellationCache::Key& key, const Vector& v)
+{
+    key.push_back(v.x);
+    key.push_back(v.y);
+    key.push_back(v.z);
+}
+
+/// \brief fills the cache key of the collision mesh of info
+///
+/// \return false if the geometry is cheaper to tessellate than to look up
+bool GetTessellationKey(const KinBody::GeometryInfo& info, float fTessellation, TessellationCache::Key& key)
+{
+    key.resize(0);
+    key.push_back(info._type);
+    key.push_back(fTessellation);
+    switch(info._type) {
+    case GT_Sphere:
+    case GT_Cylinder:
+    case GT_Capsule:
+    case GT_ConicalFrustum:
+        AppendTessellationKey(key, info._vGeomData);
+        return true;
+    case GT_Axial:
+        FOREACHC(itslice, info._vAxialSlices) {
+            key.push_back(itslice->zOffset);
+            key.push_back(itslice->radius);
+        }
+        return true;
+    case GT_Cage:
+        AppendTessellationKey(key, info._vGeomData);
+        FOREACHC(itwall, info._vSideWalls) {
+            key.push_back(itwall->type);
+            AppendTessellationKey(key, itwall->vExtents);
+            AppendTessellationKey(key, itwall->transf.trans);
+            key.push_back(itwall->transf.rot.x);
+            key.push_back(itwall->transf.rot.y);
+            key.push_back(itwall->transf.rot.z);
+            key.push_back(itwall->transf.rot.w);
+        }
+        return true;
+    case GT_Container:
+        AppendTessellationKey(key, info._vGeomData);
+        AppendTessellationKey(key, info._vGeomData2);
+        AppendTessellationKey(key, info._vGeomData3);
+        AppendTessellationKey(key, info._vGeomData4);
+        return true;
+    default:
+        // boxes and calibration boards are a single box
+        return false;
+    }
+}
+
+} // end namespace
+
 /// \param ex half extents
 void AppendBoxTriangulation(const Vector& pos, const Vector& ex, TriMesh& tri)
 {
@@ -477,15 +595,15 @@ int KinBody::GeometryInfo::Compare(const GeometryInfo& rhs, dReal fUnitScale, dR
     // use collision mesh to make the rest of the comparison
     case GT_Prism:
     case GT_TriMesh:
-        if( _meshcollision.vertices.size() != rhs._meshcollision.vertices.size() ) {
+        if( _meshcollision.GetNumVertices() != rhs._meshcollision.GetNumVertices() ) {
             return 17;
         }
-        for(int ivertex = 0; ivertex < (int)_meshcollision.vertices.size(); ++ivertex) {
-            if( !IsZeroWithEpsilon3(_meshcollision.vertices[ivertex]-rhs._meshcollision.vertices[ivertex]*fUnitScale, fEpsilon) ) {
+        for(int ivertex = 0; ivertex < (int)_meshcollision.GetNumVertices(); ++ivertex) {
+            if( !IsZeroWithEpsilon3(_meshcollision.GetVertex(ivertex)-rhs._meshcollision.GetVertex(ivertex)*fUnitScale, fEpsilon) ) {
                 return 18;
             }
         }
-        if( _meshcollision.indices != rhs._meshcollision.indices ) {
+        if( _meshcollision.GetIndices() != rhs._meshcollision.GetIndices() ) {
             return 19;
         }
 
@@ -516,21 +634,36 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
         return true;
     }
 
-    // is clear() better since it releases the memory?
     _modifiedFields |= GIF_Mesh;
-    _meshcollision.indices.resize(0);
-    _meshcollision.vertices.resize(0);
+    _meshcollision.Clear();
 
     if( fTessellation < 0.01f ) {
         fTessellation = 0.01f;
     }
+    if( _type == GT_Axial ) {
+        // sort the axial slices by the Z value
+        std::sort(_vAxialSlices.begin(), _vAxialSlices.end());
+    }
+
+    // identical primitives are common (cages, calibration rigs, sphere models), so reuse their tessellation
+    TessellationCache::Key vkey;
+    const bool bCacheable = GetTessellationKey(*this, fTessellation, vkey);
+    if( bCacheable ) {
+        boost::shared_ptr<CompactTriMesh const> pmesh = GetTessellationCache().Find(vkey);
+        if( !!pmesh ) {
+            _meshcollision = *pmesh;
+            return true;
+        }
+    }
+
     // start tesselating
+    TriMesh meshcollision;
     switch(_type) {
     case GT_Sphere: {
         // log_2 (1+ tess)
-        GenerateSphereTriangulation(_meshcollision, 3 + (int)(logf(fTessellation) / logf(2.0f)) );
+        GetUnitSphereTriangulation(3 + (int)(logf(fTessellation) / logf(2.0f)))->GetTriMesh(meshcollision);
         dReal fRadius = GetSphereRadius();
-        FOREACH(it, _meshcollision.vertices) {
+        FOREACH(it, meshcollision.vertices) {
             *it *= fRadius;
         }
         break;
@@ -561,30 +694,26 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
             1, 3, 5,
             3, 7, 5
         };
-        _meshcollision.vertices.resize(8);
-        std::copy(&v[0],&v[8],_meshcollision.vertices.begin());
-        _meshcollision.indices.resize(nindices);
-        std::copy(&indices[0],&indices[nindices],_meshcollision.indices.begin());
+        meshcollision.vertices.resize(8);
+        std::copy(&v[0],&v[8],meshcollision.vertices.begin());
+        meshcollision.indices.resize(nindices);
+        std::copy(&indices[0],&indices[nindices],meshcollision.indices.begin());
         break;
     }
     case GT_Cylinder: {
         // cylinder is on z axis
         int numverts = (int)(fTessellation*48.0f) + 3;
-        AppendCylinderTriangulation(Vector(0, 0, 0), GetCylinderRadius(), GetCylinderHeight()*0.5, numverts, _meshcollision);
+        AppendCylinderTriangulation(Vector(0, 0, 0), GetCylinderRadius(), GetCylinderHeight()*0.5, numverts, meshcollision);
         break;
     }
     case GT_Capsule: {
         // capsule is on z axis
         int numverts = (int)(fTessellation*48.0f) + 3;
-        AppendCylinderTriangulation(Vector(0, 0, 0), GetCapsuleRadius(), GetCapsuleHeight()*0.5, numverts, _meshcollision);
-        TriMesh tri;
-        GenerateSphereTriangulation(tri, 3 + (int)(logf(fTessellation) / logf(2.0f)));
-        dReal fRadius = GetCapsuleRadius();
-        FOREACH(it, tri.vertices) {
-            *it *= fRadius;
-        }
-        _meshcollision.Append(tri, Transform(Vector(), Vector(0, 0, GetCapsuleHeight() * 0.5)));
-        _meshcollision.Append(tri, Transform(Vector(), Vector(0, 0, -GetCapsuleHeight() * 0.5)));
+        AppendCylinderTriangulation(Vector(0, 0, 0), GetCapsuleRadius(), GetCapsuleHeight()*0.5, numverts, meshcollision);
+        CompactTriMesh tri = *GetUnitSphereTriangulation(3 + (int)(logf(fTessellation) / logf(2.0f)));
+        tri.Scale(GetCapsuleRadius());
+        meshcollision.Append(tri, Transform(Vector(1, 0, 0, 0), Vector(0, 0, GetCapsuleHeight() * 0.5)));
+        meshcollision.Append(tri, Transform(Vector(1, 0, 0, 0), Vector(0, 0, -GetCapsuleHeight() * 0.5)));
         break;
     }
     case GT_ConicalFrustum:
@@ -594,25 +723,22 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
             GetConicalFrustumBottomRadius(),
             GetConicalFrustumHeight() / 2,
             (int)(fTessellation*48.0f) + 3,
-            _meshcollision
+            meshcollision
             );
         break;
     case GT_Axial: {
         if (_vAxialSlices.size() > 1) {
             // there has to be at least two slices: top and bottom
-            // sort the axial slices by the Z value
-            std::sort(_vAxialSlices.begin(), _vAxialSlices.end());
-
             int numberOfSections = (int)(fTessellation*48.0f) + 3;
             int numberOfAxialSlices = _vAxialSlices.size();
-            _meshcollision.vertices.reserve(2+numberOfAxialSlices*(numberOfSections+1));
-            _meshcollision.indices.reserve((numberOfAxialSlices*2)*(numberOfSections+1));
+            meshcollision.vertices.reserve(2+numberOfAxialSlices*(numberOfSections+1));
+            meshcollision.indices.reserve((numberOfAxialSlices*2)*(numberOfSections+1));
 
             // add top center point
-            _meshcollision.vertices.push_back(Vector(0, 0, _vAxialSlices.front().zOffset));
+            meshcollision.vertices.push_back(Vector(0, 0, _vAxialSlices.front().zOffset));
 
             // add bottom center point
-            _meshcollision.vertices.push_back(Vector(0, 0, _vAxialSlices.back().zOffset));
+            meshcollision.vertices.push_back(Vector(0, 0, _vAxialSlices.back().zOffset));
 
             // tessellate the surfaces
             dReal dAngle = 2 * PI / (dReal)numberOfSections;
@@ -623,7 +749,7 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
 
                 // add every slice's outer edge vertices
                 FOREACH(axialSlice, _vAxialSlices) {
-                    _meshcollision.vertices.push_back(Vector(axialSlice->radius*cosTheta, axialSlice->radius*sinTheta, axialSlice->zOffset));
+                    meshcollision.vertices.push_back(Vector(axialSlice->radius*cosTheta, axialSlice->radius*sinTheta, axialSlice->zOffset));
                 }
 
                 // we can start adding vertices after the first section only
@@ -631,30 +757,30 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
                     continue;
                 }
 
-                int numberOfVertices = (int)(_meshcollision.vertices.size());
+                int numberOfVertices = (int)(meshcollision.vertices.size());
 
                 // add top circle surface
-                _meshcollision.indices.push_back(0);
-                _meshcollision.indices.push_back(numberOfVertices-numberOfAxialSlices);
-                _meshcollision.indices.push_back(numberOfVertices-2*numberOfAxialSlices);
+                meshcollision.indices.push_back(0);
+                meshcollision.indices.push_back(numberOfVertices-numberOfAxialSlices);
+                meshcollision.indices.push_back(numberOfVertices-2*numberOfAxialSlices);
 
                 // add bottom circle surface
-                _meshcollision.indices.push_back(1);
-                _meshcollision.indices.push_back(numberOfVertices-numberOfAxialSlices-1);
-                _meshcollision.indices.push_back(numberOfVertices-1);
+                meshcollision.indices.push_back(1);
+                meshcollision.indices.push_back(numberOfVertices-numberOfAxialSlices-1);
+                meshcollision.indices.push_back(numberOfVertices-1);
 
                 // add the upper side triangles
                 for (int index = 0; index < numberOfAxialSlices-1; index++) {
-                    _meshcollision.indices.push_back(index+numberOfVertices-numberOfAxialSlices);
-                    _meshcollision.indices.push_back(index+numberOfVertices-numberOfAxialSlices+1);
-                    _meshcollision.indices.push_back(index+numberOfVertices-2*numberOfAxialSlices);
+                    meshcollision.indices.push_back(index+numberOfVertices-numberOfAxialSlices);
+                    meshcollision.indices.push_back(index+numberOfVertices-numberOfAxialSlices+1);
+                    meshcollision.indices.push_back(index+numberOfVertices-2*numberOfAxialSlices);
                 }
 
                 // add the lower side triangles
                 for (int index = 1; index < numberOfAxialSlices; index++) {
-                    _meshcollision.indices.push_back(index+(numberOfVertices-numberOfAxialSlices));
-                    _meshcollision.indices.push_back(index+(numberOfVertices-2*numberOfAxialSlices));
-                    _meshcollision.indices.push_back(index+(numberOfVertices-2*numberOfAxialSlices)-1);
+                    meshcollision.indices.push_back(index+(numberOfVertices-numberOfAxialSlices));
+                    meshcollision.indices.push_back(index+(numberOfVertices-2*numberOfAxialSlices));
+                    meshcollision.indices.push_back(index+(numberOfVertices-2*numberOfAxialSlices)-1);
                 }
             }
         }
@@ -664,15 +790,15 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
         const Vector& vCageBaseExtents = _vGeomData;
         for (size_t i = 0; i < _vSideWalls.size(); ++i) {
             const SideWall &s = _vSideWalls[i];
-            const size_t vBase = _meshcollision.vertices.size();
-            AppendBoxTriangulation(Vector(0, 0, s.vExtents[2]), s.vExtents, _meshcollision);
+            const size_t vBase = meshcollision.vertices.size();
+            AppendBoxTriangulation(Vector(0, 0, s.vExtents[2]), s.vExtents, meshcollision);
 
             for (size_t j = 0; j < 8; ++j) {
-                _meshcollision.vertices[vBase + j] = s.transf * _meshcollision.vertices[vBase + j];
+                meshcollision.vertices[vBase + j] = s.transf * meshcollision.vertices[vBase + j];
             }
         }
         // finally add the base
-        AppendBoxTriangulation(Vector(0, 0, vCageBaseExtents.z),vCageBaseExtents, _meshcollision);
+        AppendBoxTriangulation(Vector(0, 0, vCageBaseExtents.z),vCageBaseExtents, meshcollision);
         break;
     }
     case GT_Container: {
@@ -687,30 +813,30 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
             }
         }
         // +x wall
-        AppendBoxTriangulation(Vector((outerextents[0]+innerextents[0])/4.,0,outerextents[2]/2.+zoffset), Vector((outerextents[0]-innerextents[0])/4., outerextents[1]/2., outerextents[2]/2.), _meshcollision);
+        AppendBoxTriangulation(Vector((outerextents[0]+innerextents[0])/4.,0,outerextents[2]/2.+zoffset), Vector((outerextents[0]-innerextents[0])/4., outerextents[1]/2., outerextents[2]/2.), meshcollision);
         // -x wall
-        AppendBoxTriangulation(Vector(-(outerextents[0]+innerextents[0])/4.,0,outerextents[2]/2.+zoffset), Vector((outerextents[0]-innerextents[0])/4., outerextents[1]/2., outerextents[2]/2.), _meshcollision);
+        AppendBoxTriangulation(Vector(-(outerextents[0]+innerextents[0])/4.,0,outerextents[2]/2.+zoffset), Vector((outerextents[0]-innerextents[0])/4., outerextents[1]/2., outerextents[2]/2.), meshcollision);
         // +y wall
-        AppendBoxTriangulation(Vector(0,(outerextents[1]+innerextents[1])/4.,outerextents[2]/2.+zoffset), Vector(outerextents[0]/2., (outerextents[1]-innerextents[1])/4., outerextents[2]/2.), _meshcollision);
+        AppendBoxTriangulation(Vector(0,(outerextents[1]+innerextents[1])/4.,outerextents[2]/2.+zoffset), Vector(outerextents[0]/2., (outerextents[1]-innerextents[1])/4., outerextents[2]/2.), meshcollision);
         // -y wall
-        AppendBoxTriangulation(Vector(0,-(outerextents[1]+innerextents[1])/4.,outerextents[2]/2.+zoffset), Vector(outerextents[0]/2., (outerextents[1]-innerextents[1])/4., outerextents[2]/2.), _meshcollision);
+        AppendBoxTriangulation(Vector(0,-(outerextents[1]+innerextents[1])/4.,outerextents[2]/2.+zoffset), Vector(outerextents[0]/2., (outerextents[1]-innerextents[1])/4., outerextents[2]/2.), meshcollision);
         // bottom
         if( outerextents[2] - innerextents[2] >= 1e-6 ) { // small epsilon error can make thin triangles appear, so test with a reasonable threshold
-            AppendBoxTriangulation(Vector(0,0,(outerextents[2]-innerextents[2])/2.+zoffset), Vector(outerextents[0]/2., outerextents[1]/2., (outerextents[2]-innerextents[2])/2), _meshcollision);
+            AppendBoxTriangulation(Vector(0,0,(outerextents[2]-innerextents[2])/2.+zoffset), Vector(outerextents[0]/2., outerextents[1]/2., (outerextents[2]-innerextents[2])/2), meshcollision);
         }
         // cross
         if( bottomcross[2] > 0 ) {
             if( bottomcross[0] > 0 ) {
-                AppendBoxTriangulation(Vector(0, 0, bottomcross[2]/2+outerextents[2]-innerextents[2]+zoffset), Vector(bottomcross[0]/2, innerextents[1]/2, bottomcross[2]/2), _meshcollision);
+                AppendBoxTriangulation(Vector(0, 0, bottomcross[2]/2+outerextents[2]-innerextents[2]+zoffset), Vector(bottomcross[0]/2, innerextents[1]/2, bottomcross[2]/2), meshcollision);
             }
             if( bottomcross[1] > 0 ) {
-                AppendBoxTriangulation(Vector(0, 0, bottomcross[2]/2+outerextents[2]-innerextents[2]+zoffset), Vector(innerextents[0]/2, bottomcross[1]/2, bottomcross[2]/2), _meshcollision);
+                AppendBoxTriangulation(Vector(0, 0, bottomcross[2]/2+outerextents[2]-innerextents[2]+zoffset), Vector(innerextents[0]/2, bottomcross[1]/2, bottomcross[2]/2), meshcollision);
             }
         }
         // bottom
         if( bottom[2] > 0 ) {
             if( bottom[0] > 0 && bottom[1] > 0 ) {
-                AppendBoxTriangulation(Vector(0, 0, bottom[2]/2), Vector(bottom[0]/2., bottom[1]/2., bottom[2]/2.), _meshcollision);
+                AppendBoxTriangulation(Vector(0, 0, bottom[2]/2), Vector(bottom[0]/2., bottom[1]/2., bottom[2]/2.), meshcollision);
             }
         }
         break;
@@ -718,16 +844,74 @@ bool KinBody::GeometryInfo::InitCollisionMesh(float fTessellation)
     case GT_CalibrationBoard: {
         // create board mesh
         Vector boardEx = GetBoxExtents();
-        AppendBoxTriangulation(Vector(0, 0, -boardEx[2]), boardEx, _meshcollision);
+        AppendBoxTriangulation(Vector(0, 0, -boardEx[2]), boardEx, meshcollision);
         break;
     }
     default:
         throw OPENRAVE_EXCEPTION_FORMAT(_("unrecognized geom type %d!"), _type, ORE_InvalidArguments);
     }
 
+    _meshcollision.SetTriMesh(meshcollision);
+    if( bCacheable ) {
+        GetTessellationCache().Insert(vkey, boost::make_shared<CompactTriMesh>(_meshcollision));
+    }
     return true;
 }
 
+void InitCollisionMeshes(const std::vector<KinBody::GeometryPtr>& vgeometries, float fTessellation)
+{
+    // spawning threads only pays off when there are many geometries, otherwise tessellate in place
+    const size_t nMinGeometriesPerThread = 16;
+    const size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), vgeometries.size()/nMinGeometriesPerThread);
+    if( numThreads <= 1 ) {
+        FOREACHC(itgeometry, vgeometries) {
+            (*itgeometry)->InitCollisionMesh(fTessellation);
+        }
+        return;
+    }
+
+    // every geometry owns its info, so the only shared state is the tessellation cache
+    std::vector<std::exception_ptr> vExceptions(vgeometries.size());
+    std::atomic<size_t> nextIndex(0);
+    const auto runJobs = [&]() {
+        for (size_t index = nextIndex++; index < vgeometries.size(); index = nextIndex++) {
+            try {
+                vgeometries[index]->InitCollisionMesh(fTessellation);
+            }
+            catch (...) {
+                vExceptions[index] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<boost::shared_ptr<std::thread> > vThreads;
+    for (size_t iThread = 1; iThread < numThreads; ++iThread) {
+        vThreads.push_back(boost::make_shared<std::thread>(runJobs));
+    }
+    runJobs();
+    FOREACH(itThread, vThreads) {
+        (*itThread)->join();
+    }
+    FOREACHC(itException, vExceptions) {
+        if( !!*itException ) {
+            std::rethrow_exception(*itException);
+        }
+    }
+}
+
+void InitMissingCollisionMeshes(const std::vector<KinBody::LinkPtr>& vlinks, size_t ilinkstart)
+{
+    std::vector<KinBody::GeometryPtr> vgeometries;
+    for(size_t ilink = ilinkstart; ilink < vlinks.size(); ++ilink) {
+        FOREACHC(itgeometry, vlinks[ilink]->GetGeometries()) {
+            if( (*itgeometry)->GetCollisionMesh().GetNumVertices() == 0 ) { // try to avoid recomputing
+                vgeometries.push_back(*itgeometry);
+            }
+        }
+    }
+    InitCollisionMeshes(vgeometries);
+}
+
 bool KinBody::GeometryInfo::ComputeInnerEmptyVolume(Transform& tInnerEmptyVolume, Vector& abInnerEmptyExtents) const
 {
     switch(_type) {
@@ -990,9 +1174,7 @@ void KinBody::GeometryInfo::ConvertUnitScale(dReal fUnitScale)
 
     case GT_Prism:
     case GT_TriMesh:
-        FOREACH(itvertex, _meshcollision.vertices) {
-            *itvertex *= fUnitScale;
-        }
+        _meshcollision.Scale(fUnitScale);
         _modifiedFields |= GIF_Mesh;
         break;
 
@@ -1020,8 +1202,7 @@ void KinBody::GeometryInfo::Reset()
     _vAxialSlices.clear();
     _vDiffuseColor = Vector(1,1,1);
     _vAmbientColor = Vector(0,0,0);
-    _meshcollision.vertices.clear();
-    _meshcollision.indices.clear();
+    _meshcollision.Clear();
     _type = GT_None;
     _id.clear();
     _name.clear();
@@ -1187,10 +1368,11 @@ void KinBody::GeometryInfo::SerializeJSON(rapidjson::Value& rGeometryInfo, rapid
     case GT_Prism: {
         rapidjson::Value rPoints;
         rPoints.SetArray();
-        rPoints.Reserve(_meshcollision.vertices.size(), allocator);
-        for( size_t ipoint = 0; ipoint < _meshcollision.vertices.size(); ipoint += 2 ) {
-            rPoints.PushBack(_meshcollision.vertices[ipoint].x * fUnitScale, allocator);
-            rPoints.PushBack(_meshcollision.vertices[ipoint].y * fUnitScale, allocator);
+        rPoints.Reserve(_meshcollision.GetNumVertices(), allocator);
+        for( size_t ipoint = 0; ipoint < _meshcollision.GetNumVertices(); ipoint += 2 ) {
+            const Vector vertex = _meshcollision.GetVertex(ipoint);
+            rPoints.PushBack(vertex.x * fUnitScale, allocator);
+            rPoints.PushBack(vertex.y * fUnitScale, allocator);
         }
         rGeometryInfo.AddMember("crossSection", rPoints, allocator);
         rGeometryInfo.AddMember("height", _vGeomData.y, allocator);
@@ -1207,14 +1389,15 @@ void KinBody::GeometryInfo::SerializeJSON(rapidjson::Value& rGeometryInfo, rapid
         rTriMesh.SetObject();
         rapidjson::Value rVertices;
         rVertices.SetArray();
-        rVertices.Reserve(_meshcollision.vertices.size()*3, allocator);
-        for(size_t ivertex = 0; ivertex < _meshcollision.vertices.size(); ++ivertex) {
-            rVertices.PushBack(_meshcollision.vertices[ivertex][0]*fUnitScale, allocator);
-            rVertices.PushBack(_meshcollision.vertices[ivertex][1]*fUnitScale, allocator);
-            rVertices.PushBack(_meshcollision.vertices[ivertex][2]*fUnitScale, allocator);
+        rVertices.Reserve(_meshcollision.GetNumVertices()*3, allocator);
+        for(size_t ivertex = 0; ivertex < _meshcollision.GetNumVertices(); ++ivertex) {
+            const Vector vertex = _meshcollision.GetVertex(ivertex);
+            rVertices.PushBack(vertex[0]*fUnitScale, allocator);
+            rVertices.PushBack(vertex[1]*fUnitScale, allocator);
+            rVertices.PushBack(vertex[2]*fUnitScale, allocator);
         }
         rTriMesh.AddMember("vertices", rVertices, allocator);
-        orjson::SetJsonValueByKey(rTriMesh, "indices", _meshcollision.indices, allocator);
+        orjson::SetJsonValueByKey(rTriMesh, "indices", _meshcollision.GetIndices(), allocator);
         rGeometryInfo.AddMember(rapidjson::Document::StringRefType("mesh"), rTriMesh, allocator);
         break;
     }
@@ -1555,33 +1738,34 @@ void KinBody::GeometryInfo::DeserializeJSON(const rapidjson::Value &value, const
         if( value.HasMember("crossSection") && value["crossSection"].IsArray() && value["crossSection"].Size() >= 2 && value["crossSection"].Size() % 2 == 0 ) {
             orjson::LoadJsonValue(value["crossSection"], vCrossSection);
         }
-        else if ( vGeomDataTemp != _vGeomData && !_meshcollision.vertices.empty() ) {
-            for( size_t ipoint = 0; ipoint < _meshcollision.vertices.size(); ipoint += 2 ) {
-                vCrossSection.emplace_back(_meshcollision.vertices[ipoint].x);
-                vCrossSection.emplace_back(_meshcollision.vertices[ipoint].y);
+        else if ( vGeomDataTemp != _vGeomData && _meshcollision.GetNumVertices() > 0 ) {
+            for( size_t ipoint = 0; ipoint < _meshcollision.GetNumVertices(); ipoint += 2 ) {
+                const Vector vertex = _meshcollision.GetVertex(ipoint);
+                vCrossSection.emplace_back(vertex.x);
+                vCrossSection.emplace_back(vertex.y);
             }
         }
         if( !vCrossSection.empty() ) {
             const size_t nPoints = vCrossSection.size();
-            _meshcollision.vertices.clear();
-            _meshcollision.indices.clear();
-            _meshcollision.vertices.reserve(nPoints);
-            _meshcollision.indices.reserve(nPoints * 3);
+            TriMesh meshcollision;
+            meshcollision.vertices.reserve(nPoints);
+            meshcollision.indices.reserve(nPoints * 3);
             OpenRAVE::Vector vertex;
             for( size_t ipoint = 0; ipoint < nPoints; ipoint += 2 ) {
                 vertex.x = vCrossSection[ipoint] * fUnitScale;
                 vertex.y = vCrossSection[ipoint + 1] * fUnitScale;
                 for( dReal z : { -vGeomDataTemp.y * 0.5, vGeomDataTemp.y * 0.5 } ) { // in meter
                     vertex.z = z * fUnitScale;
-                    _meshcollision.vertices.push_back(vertex);
+                    meshcollision.vertices.push_back(vertex);
                 }
-                _meshcollision.indices.push_back(ipoint + 0);
-                _meshcollision.indices.push_back(ipoint + 1);
-                _meshcollision.indices.push_back((ipoint + 2) % nPoints);
-                _meshcollision.indices.push_back(ipoint + 1);
-                _meshcollision.indices.push_back((ipoint + 3) % nPoints);
-                _meshcollision.indices.push_back((ipoint + 2) % nPoints);
-            }
+                meshcollision.indices.push_back(ipoint + 0);
+                meshcollision.indices.push_back(ipoint + 1);
+                meshcollision.indices.push_back((ipoint + 2) % nPoints);
+                meshcollision.indices.push_back(ipoint + 1);
+                meshcollision.indices.push_back((ipoint + 3) % nPoints);
+                meshcollision.indices.push_back((ipoint + 2) % nPoints);
+            }
+            _meshcollision.SetTriMesh(meshcollision);
             _vGeomData = vGeomDataTemp;
             _modifiedFields |= KinBody::GeometryInfo::GIF_Mesh; // hard to check if mesh changed, need to do manual rapidjson operations for that
         }
@@ -1605,10 +1789,10 @@ void KinBody::GeometryInfo::DeserializeJSON(const rapidjson::Value &value, const
 
     case GT_TriMesh:
         if (value.HasMember("mesh")) {
-            orjson::LoadJsonValueByKey(value, "mesh", _meshcollision);
-            FOREACH(itvertex, _meshcollision.vertices) {
-                *itvertex *= fUnitScale;
-            }
+            TriMesh meshcollision;
+            orjson::LoadJsonValueByKey(value, "mesh", meshcollision);
+            _meshcollision.SetTriMesh(meshcollision);
+            _meshcollision.Scale(fUnitScale);
             _modifiedFields |= KinBody::GeometryInfo::GIF_Mesh; // hard to check if mesh changed, need to do manual rapidjson operations for that
         }
         break;
@@ -1827,22 +2011,23 @@ AABB KinBody::GeometryInfo::ComputeAABB(const Transform& tGeometryWorld) const
     case GT_TriMesh: {
         // Cage: init collision mesh?
         // just use _meshcollision
-        if( _meshcollision.vertices.size() > 0) {
+        const size_t numvertices = _meshcollision.GetNumVertices();
+        if( numvertices > 0) {
             // no need to check rot(2,2), guaranteed to be 1 if rot(0,0) and rot(1,1) are both 1
             const bool bRotationIsIdentity = RaveFabs(tglobal.rot(0,0) - 1.0) <= g_fEpsilon && RaveFabs(tglobal.rot(1,1) - 1.0) <= g_fEpsilon;
             Vector vmin, vmax;
             // if no rotation (identity), skip rotation of vertices
             if (bRotationIsIdentity) {
-                vmin = vmax = _meshcollision.vertices.at(0);
-                for (const Vector& vertex : _meshcollision.vertices) {
-                    _UpdateExtrema(vertex, vmin, vmax);
+                vmin = vmax = _meshcollision.GetVertex(0);
+                for (size_t ivertex = 1; ivertex < numvertices; ++ivertex) {
+                    _UpdateExtrema(_meshcollision.GetVertex(ivertex), vmin, vmax);
                 }
                 ab.pos = (dReal)0.5*(vmax+vmin) + tglobal.trans;
             }
             else {
-                vmin = vmax = tglobal*_meshcollision.vertices.at(0);
-                for (const Vector& vertex : _meshcollision.vertices) {
-                    _UpdateExtrema(tglobal * vertex, vmin, vmax);
+                vmin = vmax = tglobal*_meshcollision.GetVertex(0);
+                for (size_t ivertex = 1; ivertex < numvertices; ++ivertex) {
+                    _UpdateExtrema(tglobal * _meshcollision.GetVertex(ivertex), vmin, vmax);
                 }
                 ab.pos = (dReal)0.5*(vmax+vmin);
             }
@@ -1919,11 +2104,19 @@ void KinBody::Geometry::SetCollisionMesh(const TriMesh& mesh)
 {
     OPENRAVE_ASSERT_FORMAT0(_info._bModifiable, "geometry cannot be modified", ORE_Failed);
     LinkPtr parent(_parent);
-    _info._meshcollision = mesh;
+    _info._meshcollision.SetTriMesh(mesh);
     // _info._modifiedFields; change??
     parent->_Update();
 }
 
+void KinBody::Geometry::SetCollisionMesh(const CompactTriMesh& mesh)
+{
+    OPENRAVE_ASSERT_FORMAT0(_info._bModifiable, "geometry cannot be modified", ORE_Failed);
+    LinkPtr parent(_parent);
+    _info._meshcollision = mesh;
+    parent->_Update();
+}
+
 bool KinBody::Geometry::SetVisible(bool visible)
 {
     if( _info._bVisible != visible ) {
@@ -2116,6 +2309,16 @@ void KinBody::Geometry::ExtractInfo(KinBody::GeometryInfo& info) const
 }
 
 UpdateFromInfoResult KinBody::Geometry::UpdateFromInfo(const KinBody::GeometryInfo& info)
+{
+    bool bLinkUpdateRequired = false;
+    const UpdateFromInfoResult updateFromInfoResult = _UpdateFromInfo(info, bLinkUpdateRequired);
+    if( bLinkUpdateRequired ) {
+        LinkPtr(_parent)->_Update();
+    }
+    return updateFromInfoResult;
+}
+
+UpdateFromInfoResult KinBody::Geometry::_UpdateFromInfo(const KinBody::GeometryInfo& info, bool& bLinkUpdateRequired)
 {
     if(!info._id.empty() && _info._id != info._id) {
         throw OPENRAVE_EXCEPTION_FORMAT("Do not allow updating link '%s' geometry '%s' (id='%s') with a different info id='%s'", _parent.lock()->GetName()%GetName()%_info._id%info._id, ORE_Assert);
@@ -2133,39 +2336,41 @@ UpdateFromInfoResult KinBody::Geometry::UpdateFromInfo(const KinBody::GeometryIn
         return UFIR_RequireReinitialize;
     }
 
+    // the type is the same, so changes of the shape and transform are applied in place and only the parent link has to be updated instead of re-initializing the whole body
+    bool bTransformChanged = false, bShapeChanged = false;
     if( info.IsModifiedField(KinBody::GeometryInfo::GIF_Transform) && GetTransform().CompareTransform(info._t, g_fEpsilon) ) {
         RAVELOG_VERBOSE_FORMAT("geometry %s transform changed", _info._id);
-        return UFIR_RequireReinitialize;
+        bTransformChanged = true;
     }
 
     if (GetType() == GT_Box) {
         if (GetBoxExtents() != info._vGeomData) {
             RAVELOG_VERBOSE_FORMAT("geometry %s box extents changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Container) {
         if (GetContainerOuterExtents() != info._vGeomData || GetContainerInnerExtents() != info._vGeomData2 || GetContainerBottomCross() != info._vGeomData3 || GetContainerBottom() != info._vGeomData4) {
             RAVELOG_VERBOSE_FORMAT("geometry %s container extents changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Cage) {
         if (GetCageBaseExtents() != info._vGeomData || _info._vGeomData2 != info._vGeomData2 || _info._vSideWalls != info._vSideWalls) {
             RAVELOG_VERBOSE_FORMAT("geometry %s cage changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Sphere) {
         if (GetSphereRadius() != info._vGeomData.x) {
             RAVELOG_VERBOSE_FORMAT("geometry %s sphere changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Cylinder) {
         if (GetCylinderRadius() != info._vGeomData.x || GetCylinderHeight() != info._vGeomData.y) {
             RAVELOG_VERBOSE_FORMAT("geometry %s cylinder changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_ConicalFrustum) {
@@ -2173,37 +2378,63 @@ UpdateFromInfoResult KinBody::Geometry::UpdateFromInfo(const KinBody::GeometryIn
             GetConicalFrustumBottomRadius() != info.GetConicalFrustumBottomRadius() ||
             GetConicalFrustumHeight() != info.GetConicalFrustumHeight()) {
             RAVELOG_VERBOSE_FORMAT("geometry %s conical frustum changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Axial) {
         if (_info._vAxialSlices != info._vAxialSlices) {
             RAVELOG_VERBOSE_FORMAT("geometry %s axial changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Prism) {
         if( info.IsModifiedField(KinBody::GeometryInfo::GIF_Mesh) && info._meshcollision != _info._meshcollision ) {
             RAVELOG_VERBOSE_FORMAT("geometry %s prism changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_Capsule) {
         if( GetCapsuleRadius() != info._vGeomData.x || GetCapsuleHeight() != info._vGeomData.y ) {
             RAVELOG_VERBOSE_FORMAT("geometry %s capsule changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     }
     else if (GetType() == GT_TriMesh) {
         if( info.IsModifiedField(KinBody::GeometryInfo::GIF_Mesh) && info._meshcollision != _info._meshcollision ) {
             RAVELOG_VERBOSE_FORMAT("geometry %s trimesh changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
         }
     } else if (GetType() == GT_CalibrationBoard) {
         if (GetBoxExtents() != info._vGeomData || info._calibrationBoardParameters != _info._calibrationBoardParameters) {
             RAVELOG_VERBOSE_FORMAT("geometry %s calibrationboard changed", _info._id);
-            return UFIR_RequireReinitialize;
+            bShapeChanged = true;
+        }
+    }
+
+    if( (bTransformChanged || bShapeChanged) && !_info._bModifiable ) {
+        // same as SetCollisionMesh, geometries that cannot be modified are only changed by re-initializing the body
+        RAVELOG_VERBOSE_FORMAT("geometry %s is not modifiable", _info._id);
+        return UFIR_RequireReinitialize;
+    }
+    if( bTransformChanged ) {
+        _info._t = info._t;
+    }
+    if( bShapeChanged ) {
+        _info._vGeomData = info._vGeomData;
+        _info._vGeomData2 = info._vGeomData2;
+        _info._vGeomData3 = info._vGeomData3;
+        _info._vGeomData4 = info._vGeomData4;
+        _info._vSideWalls = info._vSideWalls;
+        _info._vAxialSlices = info._vAxialSlices;
+        _info._calibrationBoardParameters = info._calibrationBoardParameters;
+        if( info.IsModifiedField(KinBody::GeometryInfo::GIF_Mesh) ) {
+            _info._meshcollision = info._meshcollision;
         }
+        _info.InitCollisionMesh();
+    }
+    if( bTransformChanged || bShapeChanged ) {
+        bLinkUpdateRequired = true;
+        updateFromInfoResult = UFIR_Success;
     }
 
     // transparency
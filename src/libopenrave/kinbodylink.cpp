@@ -746,14 +746,16 @@ KinBody::GeometryPtr KinBody::Link::GetGeometry(const string_view geomname) cons
 }
 
 void KinBody::Link::_InitGeometriesInternal(bool bForceRecomputeMeshCollision) {
+    std::vector<GeometryPtr> vgeometriestoinit;
     for(GeometryPtr& pgeom : _vGeometries) {
-        if( bForceRecomputeMeshCollision || pgeom->GetCollisionMesh().vertices.size() == 0 ) {
+        if( bForceRecomputeMeshCollision || pgeom->GetCollisionMesh().GetNumVertices() == 0 ) {
             if( !bForceRecomputeMeshCollision ) {
                 RAVELOG_VERBOSE("geometry has empty collision mesh\n");
             }
-            pgeom->InitCollisionMesh(); // have to initialize the mesh since some plugins might not understand all geometry types
+            vgeometriestoinit.push_back(pgeom);
         }
     }
+    InitCollisionMeshes(vgeometriestoinit); // have to initialize the mesh since some plugins might not understand all geometry types
     _info._mapExtraGeometries.clear();
     // have to reset the self group! cannot use geometries directly since we require exclusive access to the GeometryInfo objects
     std::vector<KinBody::GeometryInfoPtr> vgeometryinfos;
@@ -803,13 +805,15 @@ void KinBody::Link::SetGeometriesFromGroup(const std::string& groupname)
         pvinfos = &it->second;
     }
     _vGeometries.resize(pvinfos->size());
+    std::vector<GeometryPtr> vgeometriestoinit;
     for(size_t i = 0; i < pvinfos->size(); ++i) {
         _vGeometries[i].reset(new Geometry(shared_from_this(),*pvinfos->at(i)));
-        if( _vGeometries[i]->GetCollisionMesh().vertices.size() == 0 ) {
+        if( _vGeometries[i]->GetCollisionMesh().GetNumVertices() == 0 ) {
             RAVELOG_VERBOSE("geometry has empty collision mesh\n");
-            _vGeometries[i]->InitCollisionMesh();
+            vgeometriestoinit.push_back(_vGeometries[i]);
         }
     }
+    InitCollisionMeshes(vgeometriestoinit);
     _Update();
 }
 
@@ -1084,7 +1088,15 @@ UpdateFromInfoResult KinBody::Link::UpdateFromInfo(const KinBody::LinkInfo& info
     UpdateFromInfoResult updateFromInfoResult = UFIR_NoChange;
 
     std::vector<KinBody::Link::GeometryPtr> vGeometries = _vGeometries;
-    if (!UpdateChildrenFromInfo(info._vgeometryinfos, vGeometries, updateFromInfoResult)) {
+    // geometries changed in place share one link update, which bumps the geometry update stamp once and posts Prop_LinkGeometry once
+    bool bLinkUpdateRequired = false;
+    const bool bUpdatedGeometries = UpdateChildrenFromInfo(info._vgeometryinfos, vGeometries, updateFromInfoResult, [&bLinkUpdateRequired](const KinBody::Link::GeometryPtr& pGeometry, const KinBody::GeometryInfo& geometryInfo) {
+        return pGeometry->_UpdateFromInfo(geometryInfo, bLinkUpdateRequired);
+    });
+    if( bLinkUpdateRequired ) {
+        _Update();
+    }
+    if (!bUpdatedGeometries) {
         return updateFromInfoResult;
     }
 
@@ -1199,33 +1211,64 @@ UpdateFromInfoResult KinBody::Link::UpdateFromInfo(const KinBody::LinkInfo& info
     return updateFromInfoResult;
 }
 
-void KinBody::Link::_Update(bool parameterschanged, uint32_t extraParametersChanged)
+const CompactTriMesh& KinBody::Link::GetCompactCollisionData() const
 {
-    // if there's only one trimesh geometry and it has identity offset, then copy it directly
+    if( _collisiondata.valid.load(std::memory_order_acquire) & 1 ) {
+        return _collisiondata.collision;
+    }
+
+    boost::mutex::scoped_lock lock(_collisiondata.mutex);
+    CompactTriMesh& collision = _collisiondata.collision;
+    if( _collisiondata.valid.load(std::memory_order_relaxed) & 1 ) {
+        return collision; // computed by another reader while waiting
+    }
+    // if there's only one trimesh geometry and it has identity offset, then share its buffers
     if( _vGeometries.size() == 1 && _vGeometries.at(0)->GetType() == GT_TriMesh && TransformDistanceFast(Transform(), _vGeometries.at(0)->GetTransform()) <= g_fEpsilonLinear ) {
-        _collision = _vGeometries.at(0)->GetCollisionMesh();
+        collision = _vGeometries.at(0)->GetCollisionMesh();
     }
     else {
-        // Clear the existing collision volume data
-        _collision.vertices.resize(0);
-        _collision.indices.resize(0);
-
         // Do a quick precalculation of the new collision volume total size so we can reduce allocs in Append
-        unsigned totalVertices = 0, totalIndices = 0;
-        FOREACH(itgeom,_vGeometries) {
-            totalVertices += (*itgeom)->GetCollisionMesh().vertices.size();
-            totalIndices += (*itgeom)->GetCollisionMesh().indices.size();
+        size_t totalVertices = 0, totalIndices = 0;
+        for(const GeometryPtr& pgeom : _vGeometries) {
+            totalVertices += pgeom->GetCollisionMesh().GetNumVertices();
+            totalIndices += pgeom->GetCollisionMesh().GetIndices().size();
         }
-
-        // Pre-size the vertex/index vectors for the final volume size
-        _collision.vertices.reserve(totalVertices);
-        _collision.indices.reserve(totalIndices);
-
-        // Actually go through and transform/insert our collision geometries
-        FOREACH(itgeom,_vGeometries) {
-            _collision.Append((*itgeom)->GetCollisionMesh(),(*itgeom)->GetTransform());
+        collision = CompactTriMesh();
+        collision.Reserve(totalVertices, totalIndices);
+        for(const GeometryPtr& pgeom : _vGeometries) {
+            collision.Append(pgeom->GetCollisionMesh(), pgeom->GetTransform());
         }
     }
+    _collisiondata.valid.fetch_or(1, std::memory_order_release);
+    return collision;
+}
+
+const TriMesh& KinBody::Link::GetCollisionData() const
+{
+    if( _collisiondata.valid.load(std::memory_order_acquire) & 2 ) {
+        return _collisiondata.collisiontrimesh;
+    }
+    const CompactTriMesh& collision = GetCompactCollisionData();
+    boost::mutex::scoped_lock lock(_collisiondata.mutex);
+    if( !(_collisiondata.valid.load(std::memory_order_relaxed) & 2) ) {
+        collision.GetTriMesh(_collisiondata.collisiontrimesh);
+        _collisiondata.valid.fetch_or(2, std::memory_order_release);
+    }
+    return _collisiondata.collisiontrimesh;
+}
+
+void KinBody::Link::_ResetCollisionData()
+{
+    boost::mutex::scoped_lock lock(_collisiondata.mutex);
+    _collisiondata.valid.store(0, std::memory_order_release);
+    _collisiondata.collision = CompactTriMesh();
+    _collisiondata.collisiontrimesh = TriMesh(); // release the memory
+}
+
+void KinBody::Link::_Update(bool parameterschanged, uint32_t extraParametersChanged)
+{
+    ++_nGeometryUpdateStamp;
+    _ResetCollisionData();
     if( parameterschanged || extraParametersChanged ) {
         GetParent()->_PostprocessChangedParameters(Prop_LinkGeometry|extraParametersChanged);
     }
@@ -450,7 +450,6 @@ public:
 #else
         boost::shared_ptr<RaveDatabase> pdatabase = boost::make_shared<DynamicRaveDatabase>();
 #endif // OPENRAVE_STATIC_PLUGINS
-        pdatabase->Init();
 
         char* phomedir = getenv("OPENRAVE_HOME"); // getenv not thread-safe?
         if( phomedir == NULL ) {
@@ -468,6 +467,7 @@ public:
 #else
         CreateDirectory(_homedirectory.c_str(),NULL);
 #endif
+        pdatabase->Init(); // after the home directory is created since it stores the plugin manifest there
 
 #ifdef _WIN32
         const char* delim = ";";
@@ -666,12 +666,16 @@ protected:
 
     const BaseXMLReaderPtr CallXMLReader(InterfaceType type, const std::string& xmltag, InterfaceBasePtr pinterface, const AttributesList& atts)
     {
-        XMLREADERSMAP::iterator it = _mapxmlreaders[type].find(xmltag);
-        if( it == _mapxmlreaders[type].end() ) {
+        CreateXMLReaderFn fn = _FindReader(_mapxmlreaders, type, xmltag);
+        if( !fn && !!_pdatabase && _pdatabase->LoadPendingPlugins() ) {
+            // readers are registered when plugins are loaded, so try again after loading the plugins from the manifest
+            fn = _FindReader(_mapxmlreaders, type, xmltag);
+        }
+        if( !fn ) {
             //throw openrave_exception(str(boost::format(_("No function registered for interface %s xml tag %s"))%GetInterfaceName(type)%xmltag),ORE_InvalidArguments);
             return BaseXMLReaderPtr();
         }
-        return it->second(pinterface,atts);
+        return fn(pinterface,atts);
     }
 
     class JSONReaderFunctionData : public UserData
@@ -705,12 +709,31 @@ protected:
 
     const BaseJSONReaderPtr CallJSONReader(InterfaceType type, const std::string& id, ReadablePtr pReadable, const AttributesList& atts)
     {
-        JSONREADERSMAP::iterator it = _mapjsonreaders[type].find(id);
-        if( it == _mapjsonreaders[type].end() ) {
+        CreateJSONReaderFn fn = _FindReader(_mapjsonreaders, type, id);
+        if( !fn && !!_pdatabase && _pdatabase->LoadPendingPlugins() ) {
+            fn = _FindReader(_mapjsonreaders, type, id);
+        }
+        if( !fn ) {
             //throw openrave_exception(str(boost::format(_("No function registered for interface %s xml tag %s"))%GetInterfaceName(type)%id),ORE_InvalidArguments);
             return BaseJSONReaderPtr();
         }
-        return it->second(pReadable, atts);
+        return fn(pReadable, atts);
+    }
+
+    /// \brief returns a copy of the registered reader function, or an empty function. Readers are called from several threads when deserializing bodies.
+    template <typename ReadersMap>
+    typename ReadersMap::mapped_type _FindReader(const std::map<InterfaceType, ReadersMap>& mapreaders, InterfaceType type, const std::string& id)
+    {
+        std::lock_guard<std::mutex> lock(_mutexinternal);
+        typename std::map<InterfaceType, ReadersMap>::const_iterator ittype = mapreaders.find(type);
+        if( ittype == mapreaders.end() ) {
+            return typename ReadersMap::mapped_type();
+        }
+        typename ReadersMap::const_iterator it = ittype->second.find(id);
+        if( it == ittype->second.end() ) {
+            return typename ReadersMap::mapped_type();
+        }
+        return it->second;
     }
 
     boost::shared_ptr<RaveDatabase> GetDatabase() const {
@@ -2054,6 +2077,23 @@ void TriMesh::Append(const TriMesh& mesh, const Transform& trans)
     }
 }
 
+void TriMesh::Append(const CompactTriMesh& mesh, const Transform& trans)
+{
+    int offset = (int)vertices.size();
+    const size_t numvertices = mesh.GetNumVertices();
+    vertices.resize(vertices.size() + numvertices);
+    for(size_t i = 0; i < numvertices; ++i) {
+        vertices[i+offset] = trans * mesh.GetVertex(i);
+    }
+
+    const std::vector<int32_t>& meshindices = mesh.GetIndices();
+    const size_t baseIndicesSize = indices.size();
+    indices.resize(baseIndicesSize + meshindices.size());
+    for (size_t i = 0; i < meshindices.size(); i++) {
+        indices[baseIndicesSize + i] = meshindices[i] + offset;
+    }
+}
+
 void TriMesh::Clear()
 {
     vertices.clear();
@@ -2122,6 +2162,239 @@ void TriMesh::SerializeJSON(rapidjson::Value& rTriMesh, rapidjson::Document::All
     orjson::SetJsonValueByKey(rTriMesh, "indices", indices, allocator);
 }
 
+namespace {
+
+template <typename T>
+void _AppendCompactVertices(std::vector<T>& vertices, const TriMesh& mesh, const Transform& trans)
+{
+    size_t offset = vertices.size();
+    vertices.resize(offset + 3*mesh.vertices.size());
+    T* p = &vertices[offset];
+    for(const Vector& vertex : mesh.vertices) {
+        const Vector v = trans * vertex;
+        *p++ = v.x;
+        *p++ = v.y;
+        *p++ = v.z;
+    }
+}
+
+template <typename T>
+void _AppendCompactVertices(std::vector<T>& vertices, const CompactTriMesh& mesh, const Transform& trans)
+{
+    size_t offset = vertices.size();
+    const size_t numvertices = mesh.GetNumVertices();
+    vertices.resize(offset + 3*numvertices);
+    T* p = &vertices[offset];
+    for(size_t ivertex = 0; ivertex < numvertices; ++ivertex) {
+        const Vector v = trans * mesh.GetVertex(ivertex);
+        *p++ = v.x;
+        *p++ = v.y;
+        *p++ = v.z;
+    }
+}
+
+template <typename T>
+void _TransformCompactVertices(std::vector<T>& vertices, const TransformMatrix& tm)
+{
+    for(size_t i = 0; i < vertices.size(); i += 3) {
+        const dReal x = vertices[i], y = vertices[i+1], z = vertices[i+2];
+        vertices[i] = tm.m[0]*x + tm.m[1]*y + tm.m[2]*z + tm.trans.x;
+        vertices[i+1] = tm.m[4]*x + tm.m[5]*y + tm.m[6]*z + tm.trans.y;
+        vertices[i+2] = tm.m[8]*x + tm.m[9]*y + tm.m[10]*z + tm.trans.z;
+    }
+}
+
+void _AppendCompactIndices(std::vector<int32_t>& indices, const std::vector<int32_t>& meshindices, int32_t offset)
+{
+    const size_t baseIndicesSize = indices.size();
+    indices.resize(baseIndicesSize + meshindices.size());
+    for (size_t i = 0; i < meshindices.size(); i++) {
+        indices[baseIndicesSize + i] = meshindices[i] + offset;
+    }
+}
+
+} // end namespace
+
+CompactTriMesh::CompactTriMesh(bool bSinglePrecision) : _pvertices(new std::vector<dReal>()), _pverticesf(new std::vector<float>()), _pindices(new std::vector<int32_t>()), _bSinglePrecision(bSinglePrecision)
+{
+}
+
+CompactTriMesh::CompactTriMesh(const TriMesh& mesh, bool bSinglePrecision) : _pvertices(new std::vector<dReal>()), _pverticesf(new std::vector<float>()), _pindices(new std::vector<int32_t>()), _bSinglePrecision(bSinglePrecision)
+{
+    Append(mesh, Transform());
+}
+
+void CompactTriMesh::SetTriMesh(const TriMesh& mesh)
+{
+    Clear();
+    Append(mesh, Transform());
+}
+
+void CompactTriMesh::GetTriMesh(TriMesh& mesh) const
+{
+    const size_t numvertices = GetNumVertices();
+    mesh.vertices.resize(numvertices);
+    for(size_t ivertex = 0; ivertex < numvertices; ++ivertex) {
+        mesh.vertices[ivertex] = GetVertex(ivertex);
+    }
+    mesh.indices = *_pindices;
+}
+
+void CompactTriMesh::Append(const TriMesh& mesh, const Transform& trans)
+{
+    _MakeUnique();
+    const int32_t offset = GetNumVertices();
+    if( _bSinglePrecision ) {
+        _AppendCompactVertices(*_pverticesf, mesh, trans);
+    }
+    else {
+        _AppendCompactVertices(*_pvertices, mesh, trans);
+    }
+    _AppendCompactIndices(*_pindices, mesh.indices, offset);
+}
+
+void CompactTriMesh::Append(const CompactTriMesh& mesh, const Transform& trans)
+{
+    _MakeUnique();
+    const int32_t offset = GetNumVertices();
+    if( _bSinglePrecision ) {
+        _AppendCompactVertices(*_pverticesf, mesh, trans);
+    }
+    else {
+        _AppendCompactVertices(*_pvertices, mesh, trans);
+    }
+    _AppendCompactIndices(*_pindices, *mesh._pindices, offset);
+}
+
+void CompactTriMesh::ApplyTransform(const Transform& t)
+{
+    ApplyTransform(TransformMatrix(t));
+}
+
+void CompactTriMesh::ApplyTransform(const TransformMatrix& t)
+{
+    _MakeUnique();
+    if( _bSinglePrecision ) {
+        _TransformCompactVertices(*_pverticesf, t);
+    }
+    else {
+        _TransformCompactVertices(*_pvertices, t);
+    }
+}
+
+void CompactTriMesh::Scale(dReal fScale)
+{
+    _MakeUnique();
+    FOREACH(it, *_pverticesf) {
+        *it *= fScale;
+    }
+    FOREACH(it, *_pvertices) {
+        *it *= fScale;
+    }
+}
+
+void CompactTriMesh::Reserve(size_t numvertices, size_t numindices)
+{
+    _MakeUnique();
+    if( _bSinglePrecision ) {
+        _pverticesf->reserve(3*numvertices);
+    }
+    else {
+        _pvertices->reserve(3*numvertices);
+    }
+    _pindices->reserve(numindices);
+}
+
+void CompactTriMesh::Clear()
+{
+    // other copies keep the old buffers
+    _pvertices.reset(new std::vector<dReal>());
+    _pverticesf.reset(new std::vector<float>());
+    _pindices.reset(new std::vector<int32_t>());
+}
+
+void CompactTriMesh::serialize(std::ostream& o, int options) const
+{
+    const size_t numvertices = GetNumVertices();
+    o << numvertices << " ";
+    for(size_t ivertex = 0; ivertex < numvertices; ++ivertex) {
+        SerializeRound3(o, GetVertex(ivertex));
+    }
+    o << _pindices->size() << " ";
+    FOREACHC(it, *_pindices) {
+        o << *it << " ";
+    }
+}
+
+bool CompactTriMesh::operator==(const CompactTriMesh& other) const
+{
+    if( _bSinglePrecision == other._bSinglePrecision && _pindices == other._pindices && _pvertices == other._pvertices && _pverticesf == other._pverticesf ) {
+        return true; // shares the buffers
+    }
+    if( *_pindices != *other._pindices ) {
+        return false;
+    }
+    if( _bSinglePrecision == other._bSinglePrecision ) {
+        return _bSinglePrecision ? *_pverticesf == *other._pverticesf : *_pvertices == *other._pvertices;
+    }
+    const size_t numvertices = GetNumVertices();
+    if( numvertices != other.GetNumVertices() ) {
+        return false;
+    }
+    for(size_t ivertex = 0; ivertex < numvertices; ++ivertex) {
+        if( GetVertex(ivertex) != other.GetVertex(ivertex) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AABB CompactTriMesh::ComputeAABB() const
+{
+    AABB ab;
+    const size_t numvertices = GetNumVertices();
+    if( numvertices == 0 ) {
+        return ab;
+    }
+    Vector vmin, vmax;
+    vmin = vmax = GetVertex(0);
+    for(size_t ivertex = 1; ivertex < numvertices; ++ivertex) {
+        const Vector v = GetVertex(ivertex);
+        vmin.x = std::min(vmin.x, v.x);
+        vmin.y = std::min(vmin.y, v.y);
+        vmin.z = std::min(vmin.z, v.z);
+        vmax.x = std::max(vmax.x, v.x);
+        vmax.y = std::max(vmax.y, v.y);
+        vmax.z = std::max(vmax.z, v.z);
+    }
+    ab.extents = (dReal)0.5*(vmax-vmin);
+    ab.pos = (dReal)0.5*(vmax+vmin);
+    return ab;
+}
+
+size_t CompactTriMesh::GetMemoryUsage() const
+{
+    return _pvertices->capacity()*sizeof(dReal) + _pverticesf->capacity()*sizeof(float) + _pindices->capacity()*sizeof(int32_t);
+}
+
+bool CompactTriMesh::IsShared() const
+{
+    return _pvertices.use_count() > 1 || _pverticesf.use_count() > 1 || _pindices.use_count() > 1;
+}
+
+void CompactTriMesh::_MakeUnique()
+{
+    if( _pvertices.use_count() > 1 ) {
+        _pvertices.reset(new std::vector<dReal>(*_pvertices));
+    }
+    if( _pverticesf.use_count() > 1 ) {
+        _pverticesf.reset(new std::vector<float>(*_pverticesf));
+    }
+    if( _pindices.use_count() > 1 ) {
+        _pindices.reset(new std::vector<int32_t>(*_pindices));
+    }
+}
+
 std::ostream& operator<<(std::ostream& O, const TriMesh& trimesh)
 {
     trimesh.serialize(O,0);
@@ -2223,6 +2496,7 @@ void EnvironmentBase::_InitializeInternal()
         RAVELOG_WARN_FORMAT("[th:%s] OpenRAVE global state finished initializing in %u[us].", std::this_thread::get_id()%(utils::GetMicroTime()-starttime));
     }
     __nUniqueId = RaveGlobal::instance()->RegisterEnvironment(this);
+    __pStatisticsRegistry.reset(new StatisticsRegistry());
 }
 
 EnvironmentBase::EnvironmentBase()
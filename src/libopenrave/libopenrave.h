@@ -308,6 +308,14 @@ int CallSetStateValuesFns(const std::vector< std::pair<PlannerBase::PlannerParam
 void CallGetStateFns(const std::vector< std::pair<PlannerBase::PlannerParameters::GetStateFn, int> >& vfunctions, int nDOF, int nMaxDOFForGroup, std::vector<dReal>& v);
 
 void subtractstates(std::vector<dReal>& q1, const std::vector<dReal>& q2);
+
+/// \brief calls InitCollisionMesh on every geometry, spreading them over several threads when there are many
+///
+/// If any geometry throws, the exception of the first failing geometry is rethrown after all geometries finished.
+void InitCollisionMeshes(const std::vector<KinBody::GeometryPtr>& vgeometries, float fTessellation=1);
+
+/// \brief calls InitCollisionMeshes on the geometries that have an empty collision mesh in the links starting at ilinkstart
+void InitMissingCollisionMeshes(const std::vector<KinBody::LinkPtr>& vlinks, size_t ilinkstart=0);
 /// -1 v1 is smaller than v2
 // 0 two vectors are equivalent
 /// +1 v1 is greater than v2
@@ -532,9 +540,9 @@ void UpdateOrCreateInfoWithNameCheck(const rapidjson::Value& value, std::vector<
     vInfos.push_back(pNewInfo);
 }
 
-/// \brief Recursively call UpdateFromInfo on children. If children need to be added or removed, require re-init. Returns false if update fails and caller should not continue with other parts of the update.
-template<typename InfoPtrType, typename PtrType>
-bool UpdateChildrenFromInfo(const std::vector<InfoPtrType>& vInfos, std::vector<PtrType>& vPointers, UpdateFromInfoResult& result)
+/// \brief Recursively update children with updateFn(pointer, info). If children need to be added or removed, require re-init. Returns false if update fails and caller should not continue with other parts of the update.
+template<typename InfoPtrType, typename PtrType, typename UpdateFn>
+bool UpdateChildrenFromInfo(const std::vector<InfoPtrType>& vInfos, std::vector<PtrType>& vPointers, UpdateFromInfoResult& result, UpdateFn updateFn)
 {
     int index = 0;
     for (typename std::vector<InfoPtrType>::const_iterator itInfo = vInfos.begin(); itInfo != vInfos.end(); ++itInfo, ++index) {
@@ -609,7 +617,7 @@ bool UpdateChildrenFromInfo(const std::vector<InfoPtrType>& vInfos, std::vector<
             return false;
         }
 
-        UpdateFromInfoResult updateFromInfoResult = pMatchExistingPointer->UpdateFromInfo(*pInfo);
+        UpdateFromInfoResult updateFromInfoResult = updateFn(pMatchExistingPointer, *pInfo);
         if (updateFromInfoResult == UFIR_NoChange) {
             // no change
             continue;
@@ -636,6 +644,15 @@ bool UpdateChildrenFromInfo(const std::vector<InfoPtrType>& vInfos, std::vector<
     return true;
 }
 
+/// \brief Recursively call UpdateFromInfo on children. If children need to be added or removed, require re-init. Returns false if update fails and caller should not continue with other parts of the update.
+template<typename InfoPtrType, typename PtrType>
+bool UpdateChildrenFromInfo(const std::vector<InfoPtrType>& vInfos, std::vector<PtrType>& vPointers, UpdateFromInfoResult& result)
+{
+    return UpdateChildrenFromInfo(vInfos, vPointers, result, [](const PtrType& pPointer, const typename InfoPtrType::element_type& info) {
+        return pPointer->UpdateFromInfo(info);
+    });
+}
+
 template<typename T>
 bool AreSharedPtrsDeepEqual(const boost::shared_ptr<T>& pFirst, const boost::shared_ptr<T>& pSecond) {
     return (pFirst == pSecond) || (!!pFirst && !!pSecond && *pFirst == *pSecond);
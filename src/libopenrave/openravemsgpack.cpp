@@ -28,6 +28,49 @@ MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
 
 namespace adaptor {
 
+/// \brief converts the msgpack extensions used in our documents to strings, returns false for unknown extensions
+///
+/// The timestamp extension (-1) is converted to RFC 3339 format.
+static bool _ConvertMsgPackExtToString(msgpack::object const& o, std::string& out)
+{
+    if (o.via.ext.type() != -1) {
+        RAVELOG_WARN("Unrecognized msgpack extension type.");
+        return false;
+    }
+    const std::chrono::system_clock::time_point tp = o.as<std::chrono::system_clock::time_point>();
+    const std::time_t parsedTime = std::chrono::system_clock::to_time_t(tp);
+
+    // RFC 3339 Nano format
+    char formatted[sizeof("2006-01-02T15:04:05.999999999Z07:00")];
+
+    // The extension does not include timezone information. By convention, we format to local time.
+    struct tm datetime = {0};
+    std::size_t size = std::strftime(formatted, sizeof(formatted), "%FT%T", localtime_r(&parsedTime, &datetime));
+
+    // Add nanoseconds portion if present
+    const long nanoseconds = (std::chrono::duration_cast<chrono::nanoseconds>(tp.time_since_epoch()).count() % 1000000000 + 1000000000) % 1000000000;
+    if (nanoseconds != 0) {
+        size += sprintf(formatted + size, ".%09lu", nanoseconds);
+        // remove trailing zeros
+        while (formatted[size - 1] == '0') {
+            --size;
+        }
+    }
+    if (datetime.tm_gmtoff == 0) {
+        formatted[size] = 'Z';
+    } else {
+        size += std::strftime(formatted + size, sizeof(formatted) - size, "%z", &datetime);
+        // fix timezone format (0000 -> 00:00)
+        formatted[size] = formatted[size - 1];
+        formatted[size - 1] = formatted[size - 2];
+        formatted[size - 2] = ':';
+    }
+    formatted[++size] = '\0';
+
+    out.assign(formatted, size);
+    return true;
+}
+
 template <typename Encoding, typename Allocator, typename StackAllocator>
 struct convert< rapidjson::GenericDocument<Encoding, Allocator, StackAllocator> > {
     msgpack::object const& operator()(msgpack::object const& o, rapidjson::GenericDocument<Encoding, Allocator, StackAllocator>& v) const {
@@ -67,40 +110,9 @@ struct convert< rapidjson::GenericDocument<Encoding, Allocator, StackAllocator>
             }
                 break;
             case msgpack::type::EXT: {
-                if (o.via.ext.type() == -1) {
-                    const std::chrono::system_clock::time_point tp = o.as<std::chrono::system_clock::time_point>();
-                    const std::time_t parsedTime = std::chrono::system_clock::to_time_t(tp);
-
-                    // RFC 3339 Nano format
-                    char formatted[sizeof("2006-01-02T15:04:05.999999999Z07:00")];
-
-                    // The extension does not include timezone information. By convention, we format to local time.
-                    struct tm datetime = {0};
-                    std::size_t size = std::strftime(formatted, sizeof(formatted), "%FT%T", localtime_r(&parsedTime, &datetime));
-
-                    // Add nanoseconds portion if present
-                    const long nanoseconds = (std::chrono::duration_cast<chrono::nanoseconds>(tp.time_since_epoch()).count() % 1000000000 + 1000000000) % 1000000000;
-                    if (nanoseconds != 0) {
-                        size += sprintf(formatted + size, ".%09lu", nanoseconds);
-                        // remove trailing zeros
-                        while (formatted[size - 1] == '0') {
-                            --size;
-                        }
-                    }
-                    if (datetime.tm_gmtoff == 0) {
-                        formatted[size] = 'Z';
-                    } else {
-                        size += std::strftime(formatted + size, sizeof(formatted) - size, "%z", &datetime);
-                        // fix timezone format (0000 -> 00:00)
-                        formatted[size] = formatted[size - 1];
-                        formatted[size - 1] = formatted[size - 2];
-                        formatted[size - 2] = ':';
-                    }
-                    formatted[++size] = '\0';
-
-                    v.SetString(formatted, size, v.GetAllocator());
-                } else {
-                    RAVELOG_WARN("Unrecognized msgpack extension type.");
+                std::string formatted;
+                if (_ConvertMsgPackExtToString(o, formatted)) {
+                    v.SetString(formatted.c_str(), formatted.size(), v.GetAllocator());
                 }
                 break;
             }
@@ -319,6 +331,133 @@ private:
 
 } // namespace msgpack
 
+namespace {
+
+/// \brief forwards the events of the msgpack parser to a rapidjson SAX handler.
+///
+/// Unlike unpacking into msgpack::object and converting, this does not hold the unpacked zone and temporary documents in memory
+/// while the rapidjson document is built. The events only build the rapidjson document, the infos are still deserialized from it.
+template <typename Handler>
+class MsgPackToSAXVisitor : public msgpack::null_visitor
+{
+public:
+    MsgPackToSAXVisitor(Handler& handler) : _handler(handler) {
+    }
+
+    bool visit_nil() {
+        return _CheckValue() && _handler.Null();
+    }
+    bool visit_boolean(bool v) {
+        return _CheckValue() && _handler.Bool(v);
+    }
+    bool visit_positive_integer(uint64_t v) {
+        return _CheckValue() && _handler.Uint64(v);
+    }
+    bool visit_negative_integer(int64_t v) {
+        return _CheckValue() && _handler.Int64(v);
+    }
+    bool visit_float32(float v) {
+        return _CheckValue() && _handler.Double(v);
+    }
+    bool visit_float64(double v) {
+        return _CheckValue() && _handler.Double(v);
+    }
+    bool visit_str(const char* v, uint32_t size) {
+        if( _bExpectKey ) {
+            _bExpectKey = false;
+            return _handler.Key(v, size, true);
+        }
+        return _handler.String(v, size, true);
+    }
+    bool visit_bin(const char* v, uint32_t size) {
+        return visit_str(v, size);
+    }
+    bool visit_ext(const char* v, uint32_t size) {
+        if( !_CheckValue() ) {
+            return false;
+        }
+        // v starts with the extension type
+        msgpack::object o;
+        o.type = msgpack::type::EXT;
+        o.via.ext.ptr = v;
+        o.via.ext.size = size - 1;
+        std::string formatted;
+        if( msgpack::adaptor::_ConvertMsgPackExtToString(o, formatted) ) {
+            return _handler.String(formatted.c_str(), formatted.size(), true);
+        }
+        return _handler.Null();
+    }
+    bool start_array(uint32_t num_elements) {
+        if( !_CheckValue() ) {
+            return false;
+        }
+        _vcounts.push_back(num_elements);
+        return _handler.StartArray();
+    }
+    bool end_array() {
+        const uint32_t num_elements = _vcounts.back();
+        _vcounts.pop_back();
+        return _handler.EndArray(num_elements);
+    }
+    bool start_map(uint32_t num_kv_pairs) {
+        if( !_CheckValue() ) {
+            return false;
+        }
+        _vcounts.push_back(num_kv_pairs);
+        return _handler.StartObject();
+    }
+    bool start_map_key() {
+        _bExpectKey = true;
+        return true;
+    }
+    bool end_map() {
+        const uint32_t num_kv_pairs = _vcounts.back();
+        _vcounts.pop_back();
+        return _handler.EndObject(num_kv_pairs);
+    }
+    void parse_error(size_t parsed_offset, size_t error_offset) {
+        throw OPENRAVE_EXCEPTION_FORMAT("msgpack parse error at offset %d", error_offset, OpenRAVE::ORE_InvalidArguments);
+    }
+    void insufficient_bytes(size_t parsed_offset, size_t error_offset) {
+        throw OPENRAVE_EXCEPTION_FORMAT("msgpack data ends unexpectedly at offset %d", error_offset, OpenRAVE::ORE_InvalidArguments);
+    }
+
+private:
+    /// \brief map keys have to be strings since they become the member names of json objects
+    bool _CheckValue() {
+        if( _bExpectKey ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("msgpack map key is not a string", OpenRAVE::ORE_InvalidArguments);
+        }
+        return true;
+    }
+
+    Handler& _handler;
+    std::vector<uint32_t> _vcounts; ///< number of elements of the arrays and maps being parsed
+    bool _bExpectKey = false; ///< true if the next value is a map key
+};
+
+/// \brief generator for rapidjson::Document::Populate that parses msgpack data into the document
+struct MsgPackDocumentGenerator
+{
+    MsgPackDocumentGenerator(const char* data, size_t size) : _data(data), _size(size) {
+    }
+
+    template <typename Handler>
+    bool operator()(Handler& handler) {
+        MsgPackToSAXVisitor<Handler> visitor(handler);
+        size_t offset = 0;
+        if( !msgpack::parse(_data, _size, offset, visitor) ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to parse msgpack data at offset %d", offset, OpenRAVE::ORE_InvalidArguments);
+        }
+        return true;
+    }
+
+    const char* _data;
+    size_t _size;
+};
+
+} // end namespace
+
 void OpenRAVE::MsgPack::DumpMsgPack(const rapidjson::Value& value, std::ostream& os)
 {
     msgpack::osbuffer buf(os);
@@ -333,22 +472,33 @@ void OpenRAVE::MsgPack::DumpMsgPack(const rapidjson::Value& value, std::vector<c
 
 void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const std::string& str)
 {
-    msgpack::unpacked unpacked;
-    msgpack::unpack(unpacked, str.data(), str.size());
-    unpacked.get().convert(d);
+    OpenRAVE::MsgPack::ParseMsgPack(d, str.data(), str.size());
 }
 
 void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const void* data, size_t size)
 {
-    msgpack::unpacked unpacked;
-    msgpack::unpack(unpacked, (const char*) data, size);
-    unpacked.get().convert(d);
+    MsgPackDocumentGenerator generator((const char*) data, size);
+    d.Populate(generator);
 }
 
 void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, std::istream& is)
 {
     std::string str;
-    str.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    // read seekable streams like files in one go instead of growing the buffer character by character
+    const std::istream::pos_type startpos = is.tellg();
+    if( startpos != std::istream::pos_type(-1) && is.seekg(0, std::ios::end) ) {
+        const std::istream::pos_type endpos = is.tellg();
+        is.seekg(startpos);
+        if( endpos != std::istream::pos_type(-1) && endpos >= startpos ) {
+            str.resize(endpos - startpos);
+            is.read(&str[0], str.size());
+            str.resize(is.gcount());
+        }
+    }
+    else {
+        is.clear();
+        str.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
     OpenRAVE::MsgPack::ParseMsgPack(d, str);
 }
 
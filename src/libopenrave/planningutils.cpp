@@ -25,6 +25,10 @@
 
 #include <boost/bind/bind.hpp>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using namespace boost::placeholders;
 
 namespace OpenRAVE {
@@ -411,6 +415,30 @@ public:
     }
 
     void VerifyTrajectory(TrajectoryBaseConstPtr trajectory, dReal samplingstep)
+    {
+        VerifyWaypoints(trajectory);
+
+        if( !!_parameters->_checkpathvelocityconstraintsfn && trajectory->GetNumWaypoints() >= 2 ) {
+            if( trajectory->GetDuration() > 0 && samplingstep > 0 ) {
+                // use sampling and check segment constraints
+                std::vector<dReal> vsampletimes;
+                ComputeSampleTimes(trajectory, samplingstep, vsampletimes);
+                VerifySegments(trajectory, vsampletimes, 0, vsampletimes.size());
+            }
+            else {
+                std::vector<dReal> vdata;
+                for(size_t i = 0; i < trajectory->GetNumWaypoints(); ++i) {
+                    trajectory->GetWaypoint(i,vdata,_parameters->_configurationspecification);
+                    if( _parameters->CheckPathAllConstraints(vdata,vdata,std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart) != 0 ) {
+                        throw OPENRAVE_EXCEPTION_FORMAT(_("CheckPathAllConstraints, failed at %d, wrote trajectory to %s"),i%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+                    }
+                }
+            }
+        }
+    }
+
+    /// \brief checks the limits and the state functions at every waypoint
+    void VerifyWaypoints(TrajectoryBaseConstPtr trajectory)
     {
         OPENRAVE_ASSERT_FORMAT0(!!trajectory,"need valid trajectory",ORE_InvalidArguments);
 
@@ -422,8 +450,7 @@ public:
         }
         fresolutionmean /= _parameters->_vConfigResolution.size();
 
-        dReal fthresh = 5e-5f;
-        vector<dReal> deltaq(_parameters->GetDOF(),0);
+        const dReal fthresh = 5e-5f;
         std::vector<dReal> vdata, vdatavel, vdiff;
         for(size_t ipoint = 0; ipoint < trajectory->GetNumWaypoints(); ++ipoint) {
             trajectory->GetWaypoint(ipoint,vdata,_parameters->_configurationspecification);
@@ -462,104 +489,116 @@ public:
                 OPENRAVE_ASSERT_OP_FORMAT(fdist,<=,0.01 * fresolutionmean, "neighstatefn is rejecting configuration %d, wrote trajectory %s",ipoint%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
             }
         }
+    }
 
-        if( !!_parameters->_checkpathvelocityconstraintsfn && trajectory->GetNumWaypoints() >= 2 ) {
+    /// \brief computes the times to sample the trajectory at for \ref VerifySegments
+    ///
+    /// have to make sure that sampling interval doesn't include a waypoint. otherwise interpolation could become inconsistent! so the waypoint times are merged in. times closer than 1e-5s to the previous time are removed.
+    void ComputeSampleTimes(TrajectoryBaseConstPtr trajectory, dReal samplingstep, std::vector<dReal>& vsampletimes)
+    {
+        std::vector<dReal> vabstimes;
+        vabstimes.reserve(trajectory->GetNumWaypoints() + (trajectory->GetDuration()/samplingstep) + 1);
+        ConfigurationSpecification deltatimespec;
+        deltatimespec.AddDeltaTimeGroup();
+        trajectory->GetWaypoints(0, trajectory->GetNumWaypoints(), vabstimes, deltatimespec);
+        dReal totaltime = 0;
+        FOREACH(ittime, vabstimes) {
+            totaltime += *ittime;
+            *ittime = totaltime;
+        }
+        for(dReal ftime = 0; ftime < trajectory->GetDuration(); ftime += samplingstep ) {
+            vabstimes.push_back(ftime);
+        }
+        vsampletimes.resize(vabstimes.size());
+        std::merge(vabstimes.begin(), vabstimes.begin()+trajectory->GetNumWaypoints(), vabstimes.begin()+trajectory->GetNumWaypoints(), vabstimes.end(), vsampletimes.begin());
+        size_t numkept = 1;
+        for(size_t itime = 1; itime < vsampletimes.size(); ++itime) {
+            if( vsampletimes[itime] >= vsampletimes[numkept-1] + 1e-5 ) {
+                vsampletimes[numkept++] = vsampletimes[itime];
+            }
+        }
+        vsampletimes.resize(numkept);
+    }
 
-            if( trajectory->GetDuration() > 0 && samplingstep > 0 ) {
-                // use sampling and check segment constraints
-                // have to make sure that sampling interval doesn't include a waypoint. otherwise interpolation could become inconsistent!
-                std::vector<dReal> vabstimes, vsampletimes;
-                vabstimes.reserve(trajectory->GetNumWaypoints() + (trajectory->GetDuration()/samplingstep) + 1);
-                ConfigurationSpecification deltatimespec;
-                deltatimespec.AddDeltaTimeGroup();
-                trajectory->GetWaypoints(0, trajectory->GetNumWaypoints(), vabstimes, deltatimespec);
-                dReal totaltime = 0;
-                FOREACH(ittime, vabstimes) {
-                    totaltime += *ittime;
-                    *ittime = totaltime;
-                }
-                for(dReal ftime = 0; ftime < trajectory->GetDuration(); ftime += samplingstep ) {
-                    vabstimes.push_back(ftime);
-                }
-                vsampletimes.resize(vabstimes.size());
-                std::merge(vabstimes.begin(), vabstimes.begin()+trajectory->GetNumWaypoints(), vabstimes.begin()+trajectory->GetNumWaypoints(), vabstimes.end(), vsampletimes.begin());
-
-                // Check if the trajectory has all-linear interpolation
-                ConfigurationSpecification trajspec = trajectory->GetConfigurationSpecification();
-                vector<ConfigurationSpecification::Group>::const_iterator itvaluesgroup = trajspec.FindCompatibleGroup("joint_values", false);
-                vector<ConfigurationSpecification::Group>::const_iterator itvelocitiesgroup = trajspec.FindCompatibleGroup("joint_velocities", false);
-                vector<ConfigurationSpecification::Group>::const_iterator itaccelerationsgroup = trajspec.FindCompatibleGroup("joint_accelerations", false);
-                bool bHasAllLinearInterpolation = false;
-                if( (itvaluesgroup == trajspec._vgroups.end() || itvaluesgroup->interpolation == "linear") &&
-                    (itvelocitiesgroup == trajspec._vgroups.end() || itvelocitiesgroup->interpolation == "linear") &&
-                    (itaccelerationsgroup == trajspec._vgroups.end() || itaccelerationsgroup->interpolation == "linear") ) {
-                    bHasAllLinearInterpolation = true;
-                }
-                IntervalType interval = bHasAllLinearInterpolation ? (IntervalType)(IT_Closed | IT_AllLinear) : IT_Closed;
-
-                std::vector<dReal> vprevdata, vprevdatavel;
-                ConstraintFilterReturnPtr filterreturn(new ConstraintFilterReturn());
-                trajectory->Sample(vprevdata,0,_parameters->_configurationspecification);
-                trajectory->Sample(vprevdatavel,0,velspec);
-                std::vector<dReal>::iterator itprevtime = vsampletimes.begin();
-                for(std::vector<dReal>::iterator itsampletime = vsampletimes.begin()+1; itsampletime != vsampletimes.end(); ++itsampletime) {
-                    if (*itsampletime < *itprevtime + 1e-5 ) {
-                        continue;
-                    }
-                    filterreturn->Clear();
-                    trajectory->Sample(vdata,*itsampletime,_parameters->_configurationspecification);
-                    trajectory->Sample(vdatavel,*itsampletime,velspec);
-                    dReal deltatime = *itsampletime - *itprevtime;
-                    vdiff = vdata;
-                    _parameters->_diffstatefn(vdiff,vprevdata);
-                    for(size_t i = 0; i < _parameters->_vConfigVelocityLimit.size(); ++i) {
-                        dReal velthresh = _parameters->_vConfigVelocityLimit.at(i)*deltatime+fthresh;
-                        OPENRAVE_ASSERT_OP_FORMAT(RaveFabs(vdiff.at(i)), <=, velthresh, "time %fs-%fs, dof %d traveled %f, but maxvelocity only allows %f, wrote trajectory to %s",*itprevtime%*itsampletime%i%RaveFabs(vdiff.at(i))%velthresh%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
-                    }
-                    if( _parameters->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn) != 0 ) {
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            _parameters->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn);
-                        }
-                        throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, CheckPathAllConstraints failed, wrote trajectory to %s"),*itprevtime%*itsampletime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
-                    }
-                    OPENRAVE_ASSERT_OP(filterreturn->_configurations.size()%_parameters->GetDOF(),==,0);
-                    std::vector<dReal>::iterator itprevconfig = filterreturn->_configurations.begin();
-                    std::vector<dReal>::iterator itcurconfig = itprevconfig + _parameters->GetDOF();
-                    for(; itcurconfig != filterreturn->_configurations.end(); itcurconfig += _parameters->GetDOF()) {
-                        std::vector<dReal> vprevconfig(itprevconfig,itprevconfig+_parameters->GetDOF());
-                        std::vector<dReal> vcurconfig(itcurconfig,itcurconfig+_parameters->GetDOF());
-                        for(int i = 0; i < _parameters->GetDOF(); ++i) {
-                            deltaq.at(i) = vcurconfig.at(i) - vprevconfig.at(i);
-                        }
-                        if( _parameters->SetStateValues(vprevconfig, 0) != 0 ) {
-                            throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, failed to set state values"), *itprevtime%*itsampletime, ORE_InconsistentConstraints);
-                        }
-                        vector<dReal> vtemp = vprevconfig;
-                        if( _parameters->_neighstatefn(vtemp,deltaq,NSO_OnlyHardConstraints) == NSS_Failed ) {
-                            throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, neighstatefn is rejecting configurations from CheckPathAllConstraints, wrote trajectory to %s"),*itprevtime%*itsampletime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
-                        }
-                        else {
-                            dReal fprevdist = _parameters->_distmetricfn(vprevconfig,vtemp);
-                            dReal fcurdist = _parameters->_distmetricfn(vcurconfig,vtemp);
-                            if( fprevdist > g_fEpsilonLinear ) {
-                                OPENRAVE_ASSERT_OP_FORMAT(fprevdist, >, fcurdist, "time %fs-%fs, neighstatefn returned a configuration closer to the previous configuration %f than the expected current %f, wrote trajectory to %s",*itprevtime%*itsampletime%fprevdist%fcurdist%DumpTrajectory(trajectory), ORE_InconsistentConstraints);
-                            }
-                        }
-                        itprevconfig=itcurconfig;
-                    }
-                    vprevdata.swap(vdata);
-                    vprevdatavel.swap(vdatavel);
-                    itprevtime = itsampletime;
+    /// \brief checks the segments [vsampletimes[i-1], vsampletimes[i]] for istart < i < iend with the segment constraints
+    ///
+    /// \param stopfn if set, called before every segment. if it returns true, the rest of the segments are not checked.
+    void VerifySegments(TrajectoryBaseConstPtr trajectory, const std::vector<dReal>& vsampletimes, size_t istart, size_t iend, const boost::function<bool()>& stopfn=boost::function<bool()>())
+    {
+        if( istart+1 >= iend ) {
+            return;
+        }
+        ConfigurationSpecification velspec =  _parameters->_configurationspecification.ConvertToVelocitySpecification();
+        const dReal fthresh = 5e-5f;
+        std::vector<dReal> deltaq(_parameters->GetDOF(),0);
+        std::vector<dReal> vdata, vdatavel, vdiff;
+
+        // Check if the trajectory has all-linear interpolation
+        ConfigurationSpecification trajspec = trajectory->GetConfigurationSpecification();
+        vector<ConfigurationSpecification::Group>::const_iterator itvaluesgroup = trajspec.FindCompatibleGroup("joint_values", false);
+        vector<ConfigurationSpecification::Group>::const_iterator itvelocitiesgroup = trajspec.FindCompatibleGroup("joint_velocities", false);
+        vector<ConfigurationSpecification::Group>::const_iterator itaccelerationsgroup = trajspec.FindCompatibleGroup("joint_accelerations", false);
+        bool bHasAllLinearInterpolation = false;
+        if( (itvaluesgroup == trajspec._vgroups.end() || itvaluesgroup->interpolation == "linear") &&
+            (itvelocitiesgroup == trajspec._vgroups.end() || itvelocitiesgroup->interpolation == "linear") &&
+            (itaccelerationsgroup == trajspec._vgroups.end() || itaccelerationsgroup->interpolation == "linear") ) {
+            bHasAllLinearInterpolation = true;
+        }
+        IntervalType interval = bHasAllLinearInterpolation ? (IntervalType)(IT_Closed | IT_AllLinear) : IT_Closed;
+
+        std::vector<dReal> vprevdata, vprevdatavel;
+        ConstraintFilterReturnPtr filterreturn(new ConstraintFilterReturn());
+        std::vector<dReal>::const_iterator itprevtime = vsampletimes.begin()+istart;
+        trajectory->Sample(vprevdata,*itprevtime,_parameters->_configurationspecification);
+        trajectory->Sample(vprevdatavel,*itprevtime,velspec);
+        for(std::vector<dReal>::const_iterator itsampletime = itprevtime+1; itsampletime != vsampletimes.begin()+iend; ++itsampletime) {
+            if( !!stopfn && stopfn() ) {
+                return;
+            }
+            filterreturn->Clear();
+            trajectory->Sample(vdata,*itsampletime,_parameters->_configurationspecification);
+            trajectory->Sample(vdatavel,*itsampletime,velspec);
+            dReal deltatime = *itsampletime - *itprevtime;
+            vdiff = vdata;
+            _parameters->_diffstatefn(vdiff,vprevdata);
+            for(size_t i = 0; i < _parameters->_vConfigVelocityLimit.size(); ++i) {
+                dReal velthresh = _parameters->_vConfigVelocityLimit.at(i)*deltatime+fthresh;
+                OPENRAVE_ASSERT_OP_FORMAT(RaveFabs(vdiff.at(i)), <=, velthresh, "time %fs-%fs, dof %d traveled %f, but maxvelocity only allows %f, wrote trajectory to %s",*itprevtime%*itsampletime%i%RaveFabs(vdiff.at(i))%velthresh%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+            }
+            if( _parameters->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn) != 0 ) {
+                if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                    _parameters->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn);
                 }
+                throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, CheckPathAllConstraints failed, wrote trajectory to %s"),*itprevtime%*itsampletime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
             }
-            else {
-                for(size_t i = 0; i < trajectory->GetNumWaypoints(); ++i) {
-                    trajectory->GetWaypoint(i,vdata,_parameters->_configurationspecification);
-                    if( _parameters->CheckPathAllConstraints(vdata,vdata,std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart) != 0 ) {
-                        throw OPENRAVE_EXCEPTION_FORMAT(_("CheckPathAllConstraints, failed at %d, wrote trajectory to %s"),i%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+            OPENRAVE_ASSERT_OP(filterreturn->_configurations.size()%_parameters->GetDOF(),==,0);
+            std::vector<dReal>::iterator itprevconfig = filterreturn->_configurations.begin();
+            std::vector<dReal>::iterator itcurconfig = itprevconfig + _parameters->GetDOF();
+            for(; itcurconfig != filterreturn->_configurations.end(); itcurconfig += _parameters->GetDOF()) {
+                std::vector<dReal> vprevconfig(itprevconfig,itprevconfig+_parameters->GetDOF());
+                std::vector<dReal> vcurconfig(itcurconfig,itcurconfig+_parameters->GetDOF());
+                for(int i = 0; i < _parameters->GetDOF(); ++i) {
+                    deltaq.at(i) = vcurconfig.at(i) - vprevconfig.at(i);
+                }
+                if( _parameters->SetStateValues(vprevconfig, 0) != 0 ) {
+                    throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, failed to set state values"), *itprevtime%*itsampletime, ORE_InconsistentConstraints);
+                }
+                vector<dReal> vtemp = vprevconfig;
+                if( _parameters->_neighstatefn(vtemp,deltaq,NSO_OnlyHardConstraints) == NSS_Failed ) {
+                    throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, neighstatefn is rejecting configurations from CheckPathAllConstraints, wrote trajectory to %s"),*itprevtime%*itsampletime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+                }
+                else {
+                    dReal fprevdist = _parameters->_distmetricfn(vprevconfig,vtemp);
+                    dReal fcurdist = _parameters->_distmetricfn(vcurconfig,vtemp);
+                    if( fprevdist > g_fEpsilonLinear ) {
+                        OPENRAVE_ASSERT_OP_FORMAT(fprevdist, >, fcurdist, "time %fs-%fs, neighstatefn returned a configuration closer to the previous configuration %f than the expected current %f, wrote trajectory to %s",*itprevtime%*itsampletime%fprevdist%fcurdist%DumpTrajectory(trajectory), ORE_InconsistentConstraints);
                     }
                 }
+                itprevconfig=itcurconfig;
             }
+            vprevdata.swap(vdata);
+            vprevdatavel.swap(vdatavel);
+            itprevtime = itsampletime;
         }
     }
 
@@ -587,6 +626,111 @@ void VerifyTrajectory(PlannerBase::PlannerParametersConstPtr parameters, Traject
     v.VerifyTrajectory(trajectory,samplingstep);
 }
 
+/// \brief state of one worker of VerifyTrajectoryParallel
+struct TrajectoryVerifierWorker
+{
+    EnvironmentBasePtr penv; ///< cloned environment only used by this worker
+    TrajectoryBasePtr ptraj;
+    PlannerBase::PlannerParametersPtr parameters;
+    size_t istart, iend; ///< range of vsampletimes to check
+    std::exception_ptr pexception; ///< set if the segments are invalid or checking them failed
+};
+
+static void _VerifyTrajectoryWorkerThread(TrajectoryVerifierWorker& worker, const std::vector<dReal>& vsampletimes, int iworker, std::atomic<int>& nFirstInvalidWorker)
+{
+    try {
+        EnvironmentLock lockenv(worker.penv->GetMutex());
+        TrajectoryVerifier v(worker.parameters);
+        // stop early if an earlier part of the trajectory is already known to be invalid, later failures would not be reported anyway
+        v.VerifySegments(worker.ptraj, vsampletimes, worker.istart, worker.iend, [iworker, &nFirstInvalidWorker]() {
+            return nFirstInvalidWorker.load() < iworker;
+        });
+    }
+    catch(...) {
+        worker.pexception = std::current_exception();
+        int nprev = nFirstInvalidWorker.load();
+        while( iworker < nprev && !nFirstInvalidWorker.compare_exchange_weak(nprev, iworker) ) {
+        }
+    }
+}
+
+void VerifyTrajectoryParallel(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, dReal samplingstep, int numthreads)
+{
+    OPENRAVE_ASSERT_FORMAT0(!!trajectory,"need valid trajectory",ORE_InvalidArguments);
+    const bool bCallerParameters = !!parameters;
+    if( !bCallerParameters ) {
+        PlannerBase::PlannerParametersPtr newparams(new PlannerBase::PlannerParameters());
+        newparams->SetConfigurationSpecification(trajectory->GetEnv(), trajectory->GetConfigurationSpecification().GetTimeDerivativeSpecification(0));
+        parameters = newparams;
+    }
+    if( numthreads <= 0 ) {
+        numthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if( numthreads == 1 || !parameters->_checkpathvelocityconstraintsfn || trajectory->GetNumWaypoints() < 2 || trajectory->GetDuration() <= 0 || samplingstep <= 0 ) {
+        VerifyTrajectory(parameters, trajectory, samplingstep);
+        return;
+    }
+
+    TrajectoryVerifier v(parameters);
+    v.VerifyWaypoints(trajectory);
+
+    std::vector<dReal> vsampletimes;
+    v.ComputeSampleTimes(trajectory, samplingstep, vsampletimes);
+    const size_t numsegments = vsampletimes.size()-1;
+    // cloning the environment is expensive, so give every worker enough segments
+    static const size_t s_nMinSegmentsPerWorker = 64;
+    numthreads = std::min((size_t)numthreads, std::max((size_t)1, numsegments/s_nMinSegmentsPerWorker));
+    if( numthreads <= 1 ) {
+        v.VerifySegments(trajectory, vsampletimes, 0, vsampletimes.size());
+        return;
+    }
+
+    EnvironmentBasePtr penv = trajectory->GetEnv();
+    const ConfigurationSpecification& spec = parameters->_configurationspecification;
+    std::vector<TrajectoryVerifierWorker> vworkers(numthreads);
+    for(int iworker = 0; iworker < numthreads; ++iworker) {
+        TrajectoryVerifierWorker& worker = vworkers[iworker];
+        worker.penv = penv->CloneSelf(Clone_Bodies);
+        worker.ptraj = RaveCreateTrajectory(worker.penv, trajectory->GetXMLId());
+        worker.ptraj->Clone(trajectory, 0);
+        worker.parameters.reset(new PlannerBase::PlannerParameters());
+        {
+            EnvironmentLock lockenv(worker.penv->GetMutex());
+            // the functions of parameters are bound to the caller's environment, so bind the default ones to the clone and only transfer the serialized data (limits, resolutions, _sExtraParameters, etc)
+            worker.parameters->SetConfigurationSpecification(worker.penv, spec);
+            if( bCallerParameters ) {
+                std::stringstream ss;
+                ss << std::setprecision(std::numeric_limits<dReal>::digits10+1);
+                ss << *parameters;
+                ss >> *worker.parameters;
+            }
+        }
+        // segments (istart, iend) share their boundary sample with the neighboring workers
+        worker.istart = (iworker*numsegments)/numthreads;
+        worker.iend = ((iworker+1)*numsegments)/numthreads+1;
+    }
+
+    std::atomic<int> nFirstInvalidWorker(numthreads);
+    std::vector< boost::shared_ptr<std::thread> > vthreads;
+    vthreads.reserve(numthreads);
+    for(int iworker = 0; iworker < numthreads; ++iworker) {
+        vthreads.push_back(boost::make_shared<std::thread>(std::bind(_VerifyTrajectoryWorkerThread, std::ref(vworkers[iworker]), std::cref(vsampletimes), iworker, std::ref(nFirstInvalidWorker))));
+    }
+    FOREACH(itthread, vthreads) {
+        (*itthread)->join();
+    }
+    FOREACH(itworker, vworkers) {
+        itworker->ptraj.reset();
+        itworker->parameters.reset();
+        itworker->penv->Destroy();
+    }
+
+    int ifirstinvalid = nFirstInvalidWorker.load();
+    if( ifirstinvalid < numthreads ) {
+        std::rethrow_exception(vworkers[ifirstinvalid].pexception);
+    }
+}
+
 PlannerStatus _PlanActiveDOFTrajectory(TrajectoryBasePtr traj, RobotBasePtr probot, bool hastimestamps, dReal fmaxvelmult, dReal fmaxaccelmult, const std::string& plannername, bool bsmooth, const std::string& plannerparameters)
 {
     if( traj->GetNumWaypoints() == 1 ) {
@@ -2274,7 +2418,7 @@ void GetDHParameters(std::vector<DHParameter>& vparameters, KinBodyConstPtr pbod
     }
 }
 
-DynamicsCollisionConstraint::DynamicsCollisionConstraint(PlannerBase::PlannerParametersConstPtr parameters, const std::list<KinBodyPtr>& listCheckBodies, int filtermask) : _listCheckBodies(listCheckBodies), _filtermask(filtermask), _torquelimitmode(DC_NominalTorque), _perturbation(0.1)
+DynamicsCollisionConstraint::DynamicsCollisionConstraint(PlannerBase::PlannerParametersConstPtr parameters, const std::list<KinBodyPtr>& listCheckBodies, int filtermask) : _listCheckBodies(listCheckBodies), _filtermask(filtermask), _torquelimitmode(DC_NominalTorque), _perturbation(0.1), _checkorder(DCCO_Sequential)
 {
     BOOST_ASSERT(listCheckBodies.size()>0);
     _report.reset(new CollisionReport());
@@ -2314,6 +2458,11 @@ void DynamicsCollisionConstraint::SetPerturbation(dReal perturbation)
     _perturbation = perturbation;
 }
 
+void DynamicsCollisionConstraint::SetCheckOrder(DynamicsCollisionCheckOrder checkorder)
+{
+    _checkorder = checkorder;
+}
+
 int DynamicsCollisionConstraint::_SetAndCheckState(PlannerBase::PlannerParametersConstPtr params, const std::vector<dReal>& vdofvalues, const std::vector<dReal>& vdofvelocities, const std::vector<dReal>& vdofaccels, int options, ConstraintFilterReturnPtr filterreturn)
 {
 //    if( IS_DEBUGLEVEL(Level_Verbose) ) {
@@ -3402,7 +3551,17 @@ int DynamicsCollisionConstraint::Check(const std::vector<dReal>& q0, const std::
         }
 
         _vprevtempconfig.resize(dQ.size());
-        for (int f = start; f < numSteps; f++) {
+        int istartstep = start;
+        if( _checkorder != DCCO_Sequential ) {
+            int nsamplesret = _CheckLinearSamplesOutOfOrder(params, q0, dq0, start, numSteps, fisteps, validVelocities, neighstateoptions, maskoptions, options, filterreturn);
+            if( nsamplesret == 0 ) {
+                istartstep = numSteps; // all steps are checked, _vtempconfig is at the last step
+            }
+            else if( nsamplesret > 0 ) {
+                return nsamplesret;
+            }
+        }
+        for (int f = istartstep; f < numSteps; f++) {
             int nstateret = _SetAndCheckState(params, _vtempconfig, _vtempvelconfig, _vtempaccelconfig, maskoptions, filterreturn);
             if( !!params->_getstatefn ) {
                 params->_getstatefn(_vtempconfig);     // query again in order to get normalizations/joint limits
@@ -3628,6 +3787,115 @@ int DynamicsCollisionConstraint::Check(const std::vector<dReal>& q0, const std::
     return 0;
 }
 
+int DynamicsCollisionConstraint::_CheckLinearSamplesOutOfOrder(PlannerBase::PlannerParametersConstPtr params, const std::vector<dReal>& q0, const std::vector<dReal>& dq0, int start, int numSteps, dReal fisteps, bool validVelocities, int neighstateoptions, int maskoptions, int options, ConstraintFilterReturnPtr filterreturn)
+{
+    const int numSamples = numSteps - start;
+    if( numSamples <= 2 ) {
+        return -1; // nothing to gain from reordering
+    }
+    const size_t dof = _vtempconfig.size(), veldof = _vtempvelconfig.size();
+    const std::vector<dReal>& vConfigResolution = params->_vConfigResolution;
+    const std::vector<dReal> vstartconfig = _vtempconfig, vstartvelconfig = _vtempvelconfig;
+    _vsampleconfigs.resize(numSamples*dof);
+    _vsamplevelconfigs.resize(numSamples*veldof);
+
+    // generate the configurations with the same steps as the sequential check. if the neighbor function deviates, then the segment (q, qnew) has to be checked before continuing, so give up.
+    bool bGenerated = true;
+    for(int isample = 0; isample < numSamples; ++isample) {
+        const int f = start + isample;
+        if( params->SetStateValues(_vtempconfig, 0) != 0 ) {
+            bGenerated = false;
+            break;
+        }
+        if( !!params->_getstatefn ) {
+            params->_getstatefn(_vtempconfig);     // query again in order to get normalizations/joint limits
+        }
+        std::copy(_vtempconfig.begin(), _vtempconfig.end(), _vsampleconfigs.begin() + isample*dof);
+        std::copy(_vtempvelconfig.begin(), _vtempvelconfig.end(), _vsamplevelconfigs.begin() + isample*veldof);
+
+        dReal fnewscale = 1;
+        for(size_t idof = 0; idof < dof; ++idof) {
+            _vprevtempconfig[idof] = q0[idof] + (f+1)*dQ[idof] - _vtempconfig[idof];
+            if( RaveFabs(_vprevtempconfig[idof]) > vConfigResolution[idof] ) {
+                dReal fscale = vConfigResolution[idof]/RaveFabs(_vprevtempconfig[idof]);
+                if( fscale < fnewscale ) {
+                    fnewscale = fscale;
+                }
+            }
+        }
+        for(size_t idof = 0; idof < dof; ++idof) {
+            _vprevtempconfig[idof] *= fnewscale;
+        }
+        if( params->_neighstatefn(_vtempconfig, _vprevtempconfig, neighstateoptions) != NSS_Reached ) {
+            bGenerated = false;
+            break;
+        }
+        if( validVelocities ) {
+            for( size_t idof = 0; idof < veldof; ++idof ) {
+                _vtempvelconfig.at(idof) = dq0.at(idof) + dReal(f + 1)*_vtempveldelta.at(idof);
+            }
+        }
+    }
+    if( !bGenerated ) {
+        _vtempconfig = vstartconfig;
+        _vtempvelconfig = vstartvelconfig;
+        return -1;
+    }
+
+    // bisection order, the samples right before and after the range are already checked
+    _vsampleorder.resize(0);
+    std::vector< std::pair<int, int> > vintervals;
+    vintervals.reserve(numSamples);
+    vintervals.emplace_back(-1, numSamples);
+    for(size_t iinterval = 0; iinterval < vintervals.size(); ++iinterval) {
+        const int low = vintervals[iinterval].first, high = vintervals[iinterval].second;
+        const int mid = (low + high)/2;
+        _vsampleorder.push_back(mid);
+        if( mid - low > 1 ) {
+            vintervals.emplace_back(low, mid);
+        }
+        if( high - mid > 1 ) {
+            vintervals.emplace_back(mid, high);
+        }
+    }
+
+    _vsamplechecked.resize(0);
+    _vsamplechecked.resize(numSamples, 0);
+    _vprevtempvelconfig.resize(veldof);
+    int nstateret = 0, nInvalidSample = -1;
+    FOREACHC(itsample, _vsampleorder) {
+        std::copy(_vsampleconfigs.begin() + (*itsample)*dof, _vsampleconfigs.begin() + (*itsample+1)*dof, _vprevtempconfig.begin());
+        std::copy(_vsamplevelconfigs.begin() + (*itsample)*veldof, _vsamplevelconfigs.begin() + (*itsample+1)*veldof, _vprevtempvelconfig.begin());
+        nstateret = _SetAndCheckState(params, _vprevtempconfig, _vprevtempvelconfig, _vtempaccelconfig, maskoptions, filterreturn);
+        if( nstateret != 0 ) {
+            nInvalidSample = *itsample;
+            break;
+        }
+        _vsamplechecked[*itsample] = 1;
+    }
+
+    if( !!filterreturn && (options & CFO_FillCheckedConfiguration) ) {
+        // fill in time order. on failure, stop at the invalid configuration like the sequential check
+        const int numFill = nInvalidSample >= 0 ? nInvalidSample+1 : numSamples;
+        for(int isample = 0; isample < numFill; ++isample) {
+            if( _vsamplechecked[isample] || isample == nInvalidSample ) {
+                filterreturn->_configurations.insert(filterreturn->_configurations.end(), _vsampleconfigs.begin() + isample*dof, _vsampleconfigs.begin() + (isample+1)*dof);
+                filterreturn->_configurationtimes.push_back((start + isample)*fisteps);
+            }
+        }
+    }
+    if( nstateret != 0 ) {
+        if( !!filterreturn ) {
+            filterreturn->_returncode = nstateret;
+            filterreturn->_invalidvalues = _vprevtempconfig;
+            filterreturn->_invalidvelocities = _vprevtempvelconfig;
+            filterreturn->_fTimeWhenInvalid = (start + nInvalidSample)*fisteps;
+        }
+        return nstateret;
+    }
+    return 0;
+}
+
 int DynamicsCollisionConstraint::Check(const std::vector<dReal>& q0, const std::vector<dReal>& q1,
                                        const std::vector<dReal>& dq0, const std::vector<dReal>& dq1,
                                        const std::vector<dReal>& ddq0, const std::vector<dReal>& ddq1,
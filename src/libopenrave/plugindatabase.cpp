@@ -16,10 +16,13 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #if !OPENRAVE_STATIC_PLUGINS
 
+#include <atomic>
 #include <cstdarg>
 #include <cstring>
 #include <functional>
+#include <iterator>
 #include <mutex>
+#include <thread>
 
 #include <openrave/openraveexception.h>
 #include <openrave/logging.h>
@@ -38,6 +41,7 @@ namespace fs = boost::filesystem;
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <unistd.h>
 
 #endif
 
@@ -121,6 +125,140 @@ void* DynamicRaveDatabase::DynamicLibrary::LoadSymbol(const std::string& name, s
 #endif
 }
 
+/// \brief Plugin whose interfaces were read from the plugin manifest. The shared object is opened when the first interface is created.
+class DynamicRaveDatabase::LazyPlugin final : public RavePlugin
+{
+public:
+    LazyPlugin(DynamicRaveDatabase& database, const std::string& strpath, const PluginManifestEntry& entry)
+        : _database(database)
+        , _pluginname(entry.pluginname)
+        , _interfaces(entry.interfaces)
+    {
+        SetPluginPath(strpath);
+    }
+
+    void OnRaveInitialized() override
+    {
+        std::lock_guard<std::mutex> lock(_mutexload);
+        _bRaveInitialized = true;
+        if( !!_plugin ) {
+            _plugin->OnRaveInitialized();
+        }
+    }
+
+    void OnRavePreDestroy() override
+    {
+        std::lock_guard<std::mutex> lock(_mutexload);
+        _bRaveInitialized = false;
+        if( !!_plugin ) {
+            _plugin->OnRavePreDestroy();
+        }
+    }
+
+    void Destroy() override
+    {
+        std::lock_guard<std::mutex> lock(_mutexload);
+        if( !!_plugin ) {
+            _plugin->Destroy();
+            _plugin.reset();
+        }
+        _bLoadFailed = true; // do not open the shared object again while the database is being destroyed
+    }
+
+    const InterfaceMap& GetInterfaces() const override
+    {
+        return _interfaces;
+    }
+
+    const std::string& GetPluginName() const override
+    {
+        return _pluginname;
+    }
+
+    /// \brief returns true if the shared object has not been opened yet
+    bool IsPending() const
+    {
+        std::lock_guard<std::mutex> lock(_mutexload);
+        return !_plugin && !_bLoadFailed;
+    }
+
+    /// \brief opens the shared object if it is not loaded yet and returns the plugin it exports
+    PluginPtr Load()
+    {
+        std::lock_guard<std::mutex> lock(_mutexload);
+        if( !_plugin && !_bLoadFailed ) {
+            _plugin = _database._LoadLazyPlugin(GetPluginPath());
+            if( !_plugin ) {
+                _bLoadFailed = true;
+            }
+            else if( _bRaveInitialized ) {
+                _plugin->OnRaveInitialized();
+            }
+        }
+        return _plugin;
+    }
+
+protected:
+    InterfaceBasePtr CreateInterface(InterfaceType type, const std::string& interfacename, std::istream& sinput, EnvironmentBasePtr penv) override
+    {
+        PluginPtr plugin = Load();
+        if( !plugin ) {
+            return InterfaceBasePtr();
+        }
+        // the loaded plugin parses the name again, so pass the interface name together with the remaining arguments
+        std::string name = interfacename;
+        name.append(std::istreambuf_iterator<char>(sinput), std::istreambuf_iterator<char>());
+        return plugin->OpenRAVECreateInterface(type, name, RaveGetInterfaceHash(type), OPENRAVE_ENVIRONMENT_HASH, penv);
+    }
+
+private:
+    DynamicRaveDatabase& _database; ///< owns this plugin
+    std::string _pluginname;
+    InterfaceMap _interfaces;
+    mutable std::mutex _mutexload; ///< protects the members below
+    PluginPtr _plugin; ///< the plugin exported by the shared object, empty until first used
+    bool _bRaveInitialized = false; ///< true if OnRaveInitialized was called, so it can be forwarded when the plugin is loaded later
+    bool _bLoadFailed = false;
+};
+
+/// \brief returns the first line of the plugin manifest, the manifest is discarded when it was written by a different openrave version
+static std::string _GetPluginManifestHeader()
+{
+    return str(boost::format("openrave_plugin_manifest 1 %s %s %s")%OPENRAVE_VERSION_STRING%OPENRAVE_PLUGININFO_HASH%OPENRAVE_ENVIRONMENT_HASH);
+}
+
+/// \brief gets the modification time in nanoseconds and the size of a file, returns false if the file cannot be accessed.
+static bool _GetFileStamp(const std::string& strpath, int64_t& mtime, uint64_t& filesize)
+{
+#ifndef _WIN32
+    struct stat sb;
+    if( ::stat(strpath.c_str(), &sb) != 0 ) {
+        return false;
+    }
+#if defined(__APPLE__)
+    mtime = (int64_t)sb.st_mtimespec.tv_sec*1000000000 + sb.st_mtimespec.tv_nsec;
+#else
+    mtime = (int64_t)sb.st_mtim.tv_sec*1000000000 + sb.st_mtim.tv_nsec;
+#endif
+    filesize = sb.st_size;
+    return true;
+#elif defined(HAVE_BOOST_FILESYSTEM)
+    boost::system::error_code ec;
+    const std::time_t writetime = fs::last_write_time(strpath, ec);
+    if( !!ec ) {
+        return false;
+    }
+    filesize = fs::file_size(strpath, ec);
+    if( !!ec ) {
+        return false;
+    }
+    mtime = (int64_t)writetime*1000000000;
+    return true;
+#else
+    return false;
+#endif
+}
+
 DynamicRaveDatabase::DynamicRaveDatabase()
 {
 }
@@ -198,9 +336,132 @@ void DynamicRaveDatabase::Init()
         }
         _vPluginDirs.emplace_back(std::move(entry));
     }
+    std::vector<std::string> vpluginpaths;
     for (const std::string& entry : _vPluginDirs) {
         RAVELOG_DEBUG_FORMAT("Looking for plugins in %s", entry);
-        _LoadPluginsFromPath(entry);
+        _FindPluginsFromPath(entry, vpluginpaths);
+    }
+
+    const char* pOPENRAVE_PLUGINS_CACHE = getenv("OPENRAVE_PLUGINS_CACHE"); // getenv not thread-safe?
+    const bool bUseManifest = !pOPENRAVE_PLUGINS_CACHE || strcmp(pOPENRAVE_PLUGINS_CACHE, "0") != 0;
+    std::string manifestfilename;
+    std::unordered_map<std::string, PluginManifestEntry> mapentries;
+    if( bUseManifest ) {
+        manifestfilename = RaveGetHomeDirectory() + s_filesep + "plugins.manifest";
+        _ReadPluginManifest(manifestfilename, mapentries);
+    }
+
+    // plugins are kept in the order of vpluginpaths so that Create prefers the same plugin regardless of which ones were loaded lazily
+    std::vector<PluginPtr> vplugins(vpluginpaths.size());
+    std::vector<PluginManifestEntry> vstamps(vpluginpaths.size());
+    std::vector<uint8_t> vrecordstamps(vpluginpaths.size(), 0); ///< 1 if the rescan result should be stored in the manifest. Not vector<bool> since it is written from several threads.
+    std::vector<size_t> vstaleindices;
+    for (size_t ipath = 0; ipath < vpluginpaths.size(); ++ipath) {
+        const std::string& strpath = vpluginpaths[ipath];
+        PluginManifestEntry& stamp = vstamps[ipath];
+        if( !_GetFileStamp(strpath, stamp.mtime, stamp.filesize) ) {
+            vstaleindices.push_back(ipath);
+            continue;
+        }
+        std::unordered_map<std::string, PluginManifestEntry>::const_iterator itentry = mapentries.find(strpath);
+        if( itentry == mapentries.end() || itentry->second.mtime != stamp.mtime || itentry->second.filesize != stamp.filesize ) {
+            vstaleindices.push_back(ipath);
+            continue;
+        }
+        if( !itentry->second.pluginname.empty() ) {
+            LazyPluginPtr plugin = boost::make_shared<LazyPlugin>(*this, strpath, itentry->second);
+            _vLazyPlugins.push_back(plugin);
+            vplugins[ipath] = plugin;
+        }
+    }
+
+    // open the shared objects that are not in the manifest or have changed since it was written
+    std::vector<boost::shared_ptr<DynamicLibrary> > vlibraries(vpluginpaths.size());
+    std::atomic<size_t> nextstaleindex(0);
+    auto rescanfn = [&]() {
+        for (size_t istale = nextstaleindex++; istale < vstaleindices.size(); istale = nextstaleindex++) {
+            const size_t ipath = vstaleindices[istale];
+            const std::string& strpath = vpluginpaths[ipath];
+            try {
+                boost::shared_ptr<DynamicLibrary> dylib = boost::make_shared<DynamicLibrary>(strpath);
+                if (!*dylib) {
+                    RAVELOG_DEBUG_FORMAT("Failed to load shared object %s", strpath);
+                    continue; // might depend on libraries that are missing now, so do not store in the manifest
+                }
+                RavePlugin* plugin = _CreatePlugin(strpath, *dylib);
+                if (!!plugin) {
+                    vplugins[ipath].reset(plugin); // Ownership passed to the shared_ptr
+                    vplugins[ipath]->SetPluginPath(strpath);
+                    vlibraries[ipath] = dylib;
+                }
+                vrecordstamps[ipath] = 1;
+            }
+            catch (const std::exception& e) {
+                RAVELOG_WARN_FORMAT("Failed to load plugin %s: %s", strpath % e.what());
+            }
+        }
+    };
+    const size_t numthreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), vstaleindices.size());
+    std::vector<boost::shared_ptr<std::thread> > vthreads;
+    for (size_t ithread = 1; ithread < numthreads; ++ithread) {
+        vthreads.push_back(boost::make_shared<std::thread>(rescanfn));
+    }
+    rescanfn();
+    FOREACH(itthread, vthreads) {
+        (*itthread)->join();
+    }
+    if( vstaleindices.size() > 0 ) {
+        RAVELOG_DEBUG_FORMAT("Scanned %d/%d shared objects with %d threads", vstaleindices.size()%vpluginpaths.size()%numthreads);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t ipath = 0; ipath < vpluginpaths.size(); ++ipath) {
+            if( !!vlibraries[ipath] ) {
+                _mapLibraryHandles.emplace(vpluginpaths[ipath], std::move(*vlibraries[ipath])); // Keep the library handle around in case we need it
+            }
+            if( !!vplugins[ipath] ) {
+                _vPlugins.push_back(vplugins[ipath]);
+                if( !vlibraries[ipath] ) {
+                    RAVELOG_DEBUG_FORMAT("Found %s at %s in the plugin manifest.", vplugins[ipath]->GetPluginName() % vpluginpaths[ipath]);
+                }
+                else {
+                    RAVELOG_DEBUG_FORMAT("Found %s at %s.", vplugins[ipath]->GetPluginName() % vpluginpaths[ipath]);
+                }
+            }
+        }
+    }
+
+    if( bUseManifest ) {
+        bool bManifestChanged = false;
+        FOREACHC(itstaleindex, vstaleindices) {
+            const size_t ipath = *itstaleindex;
+            if( !vrecordstamps[ipath] ) {
+                continue;
+            }
+            PluginManifestEntry& entry = mapentries[vpluginpaths[ipath]];
+            entry = vstamps[ipath];
+            if( !!vplugins[ipath] ) {
+                entry.pluginname = vplugins[ipath]->GetPluginName();
+                entry.interfaces = vplugins[ipath]->GetInterfaces();
+            }
+            bManifestChanged = true;
+        }
+        // remove shared objects that do not exist anymore. The manifest is shared by all plugin directories, so entries of other directories are kept.
+        int64_t mtime = 0;
+        uint64_t filesize = 0;
+        for (std::unordered_map<std::string, PluginManifestEntry>::iterator itentry = mapentries.begin(); itentry != mapentries.end(); ) {
+            if( !_GetFileStamp(itentry->first, mtime, filesize) ) {
+                itentry = mapentries.erase(itentry);
+                bManifestChanged = true;
+            }
+            else {
+                ++itentry;
+            }
+        }
+        if( bManifestChanged ) {
+            _WritePluginManifest(manifestfilename, mapentries);
+        }
     }
 }
 
@@ -237,7 +498,23 @@ bool DynamicRaveDatabase::LoadPlugin(const std::string& libraryname)
     return _LoadPlugin(canonicalizedLibraryname);
 }
 
-void DynamicRaveDatabase::_LoadPluginsFromPath(const std::string& strpath, bool recurse) try
+bool DynamicRaveDatabase::LoadPendingPlugins()
+{
+    std::vector<LazyPluginPtr> vLazyPlugins;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        vLazyPlugins = _vLazyPlugins; // Copy, loading locks _mutex
+    }
+    bool bLoaded = false;
+    for (const LazyPluginPtr& plugin : vLazyPlugins) {
+        if( plugin->IsPending() && !!plugin->Load() ) {
+            bLoaded = true;
+        }
+    }
+    return bLoaded;
+}
+
+void DynamicRaveDatabase::_FindPluginsFromPath(const std::string& strpath, std::vector<std::string>& vpaths, bool recurse) try
 {
 #ifdef HAVE_BOOST_FILESYSTEM
     const fs::path path(strpath);
@@ -250,15 +527,15 @@ void DynamicRaveDatabase::_LoadPluginsFromPath(const std::string& strpath, bool
         for (const fs::directory_entry& entry : fs::directory_iterator(path)) {
 #endif
             if (fs::is_directory(entry) && recurse) {
-                _LoadPluginsFromPath(entry.path().string(), true);
+                _FindPluginsFromPath(entry.path().string(), vpaths, true);
             } else {
-                _LoadPluginsFromPath(entry.path().string(), false);
+                _FindPluginsFromPath(entry.path().string(), vpaths, false);
             }
         }
     } else if (fs::is_regular_file(path)) {
         // Check that the file has a platform-appropriate extension
         if (0 == strpath.compare(strpath.size() - PLUGIN_EXT.size(), PLUGIN_EXT.size(), PLUGIN_EXT)) {
-            _LoadPlugin(path.string());
+            vpaths.push_back(path.string());
         }
     } else {
         RAVELOG_WARN_FORMAT("Path is not a valid directory or file: %s", strpath);
@@ -287,8 +564,11 @@ void DynamicRaveDatabase::_LoadPluginsFromPath(const std::string& strpath, bool
                 }
             }
             case DT_REG: {
-                pathstr.assign(entry->d_name, sizeof(entry->d_name));
-                _LoadPluginsFromPath(pathstr, recurse);
+                if (entry->d_name[0] == '.') {
+                    break;
+                }
+                pathstr = strpath + s_filesep + entry->d_name;
+                _FindPluginsFromPath(pathstr, vpaths, recurse);
                 break;
             }
             default: continue;
@@ -296,7 +576,9 @@ void DynamicRaveDatabase::_LoadPluginsFromPath(const std::string& strpath, bool
         }
         ::closedir(dirptr);
     } else if (S_ISREG(sb.st_mode)) {
-        _LoadPlugin(strpath);
+        if (strpath.size() >= PLUGIN_EXT.size() && 0 == strpath.compare(strpath.size() - PLUGIN_EXT.size(), PLUGIN_EXT.size(), PLUGIN_EXT)) {
+            vpaths.push_back(strpath);
+        }
     } else {
         // Not a directory or file, ignore it
     }
@@ -307,18 +589,13 @@ void DynamicRaveDatabase::_LoadPluginsFromPath(const std::string& strpath, bool
     RAVELOG_VERBOSE_FORMAT("%s", e.what());
 }
 
-bool DynamicRaveDatabase::_LoadPlugin(const std::string& strpath)
+RavePlugin* DynamicRaveDatabase::_CreatePlugin(const std::string& strpath, const DynamicLibrary& dylib)
 {
-    DynamicLibrary dylib(strpath);
-    if (!dylib) {
-        RAVELOG_DEBUG_FORMAT("Failed to load shared object %s", strpath);
-        return false;
-    }
     std::string errstr;
     void* psym = dylib.LoadSymbol("CreatePlugin", errstr);
     if (!psym) {
         RAVELOG_DEBUG_FORMAT("%s, might not be an OpenRAVE plugin.", errstr);
-        return false;
+        return nullptr;
     }
     RavePlugin* plugin = nullptr;
     try {
@@ -326,6 +603,17 @@ bool DynamicRaveDatabase::_LoadPlugin(const std::string& strpath)
     } catch (const std::exception& e) {
         RAVELOG_WARN_FORMAT("Failed to construct a RavePlugin from %s: %s", strpath % e.what());
     }
+    return plugin;
+}
+
+bool DynamicRaveDatabase::_LoadPlugin(const std::string& strpath)
+{
+    DynamicLibrary dylib(strpath);
+    if (!dylib) {
+        RAVELOG_DEBUG_FORMAT("Failed to load shared object %s", strpath);
+        return false;
+    }
+    RavePlugin* plugin = _CreatePlugin(strpath, dylib);
     if (!plugin) {
         return false;
     }
@@ -337,6 +625,117 @@ bool DynamicRaveDatabase::_LoadPlugin(const std::string& strpath)
     return true;
 }
 
+PluginPtr DynamicRaveDatabase::_LoadLazyPlugin(const std::string& strpath)
+{
+    DynamicLibrary dylib(strpath);
+    if (!dylib) {
+        RAVELOG_WARN_FORMAT("Failed to load shared object %s listed in the plugin manifest", strpath);
+        return PluginPtr();
+    }
+    PluginPtr plugin(_CreatePlugin(strpath, dylib));
+    if (!plugin) {
+        return PluginPtr();
+    }
+    plugin->SetPluginPath(strpath);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _mapLibraryHandles.emplace(strpath, std::move(dylib)); // Keep the library handle around in case we need it
+    RAVELOG_DEBUG_FORMAT("Loaded %s from %s on first use.", plugin->GetPluginName() % strpath);
+    return plugin;
+}
+
+void DynamicRaveDatabase::_ReadPluginManifest(const std::string& filename, std::unordered_map<std::string, PluginManifestEntry>& mapentries)
+{
+    std::ifstream f(filename.c_str());
+    if( !f ) {
+        return;
+    }
+    std::string line;
+    if( !std::getline(f, line) || line != _GetPluginManifestHeader() ) {
+        RAVELOG_DEBUG_FORMAT("Ignoring plugin manifest %s written by a different version", filename);
+        return;
+    }
+    // every line is: path mtime filesize pluginname numinterfaces [type hash name]*, separated by tabs
+    std::vector<std::string> vfields;
+    std::string field;
+    while( std::getline(f, line) ) {
+        vfields.clear();
+        std::stringstream ss(line);
+        while( std::getline(ss, field, '\t') ) {
+            vfields.push_back(field);
+        }
+        if( vfields.size() < 5 ) {
+            continue;
+        }
+        try {
+            PluginManifestEntry entry;
+            entry.mtime = boost::lexical_cast<int64_t>(vfields[1]);
+            entry.filesize = boost::lexical_cast<uint64_t>(vfields[2]);
+            entry.pluginname = vfields[3];
+            const size_t numinterfaces = boost::lexical_cast<size_t>(vfields[4]);
+            if( vfields.size() != 5 + 3*numinterfaces ) {
+                continue;
+            }
+            bool bValid = true;
+            for (size_t iinterface = 0; iinterface < numinterfaces; ++iinterface) {
+                const InterfaceType type = static_cast<InterfaceType>(boost::lexical_cast<int>(vfields[5+3*iinterface]));
+                if( vfields[6+3*iinterface] != RaveGetInterfaceHash(type) ) {
+                    bValid = false; // interface changed, so have to rescan the plugin
+                    break;
+                }
+                entry.interfaces[type].push_back(vfields[7+3*iinterface]);
+            }
+            if( bValid ) {
+                mapentries[vfields[0]] = std::move(entry);
+            }
+        }
+        catch (const std::exception& e) {
+            RAVELOG_VERBOSE_FORMAT("Skipping invalid plugin manifest entry for %s: %s", vfields[0] % e.what());
+        }
+    }
+}
+
+void DynamicRaveDatabase::_WritePluginManifest(const std::string& filename, const std::unordered_map<std::string, PluginManifestEntry>& mapentries)
+{
+    // write to a temporary file and rename so that other processes starting at the same time never read a partial manifest
+#ifdef _WIN32
+    const std::string tempfilename = str(boost::format("%s.%d.tmp")%filename%GetCurrentProcessId());
+#else
+    const std::string tempfilename = str(boost::format("%s.%d.tmp")%filename%getpid());
+#endif
+    {
+        std::ofstream f(tempfilename.c_str(), std::ios::out | std::ios::trunc);
+        if( !f ) {
+            RAVELOG_DEBUG_FORMAT("Failed to write plugin manifest %s", tempfilename);
+            return;
+        }
+        f << _GetPluginManifestHeader() << "\n";
+        FOREACHC(itentry, mapentries) {
+            const PluginManifestEntry& entry = itentry->second;
+            size_t numinterfaces = 0;
+            FOREACHC(itinterfaces, entry.interfaces) {
+                numinterfaces += itinterfaces->second.size();
+            }
+            f << itentry->first << '\t' << entry.mtime << '\t' << entry.filesize << '\t' << entry.pluginname << '\t' << numinterfaces;
+            FOREACHC(itinterfaces, entry.interfaces) {
+                FOREACHC(itname, itinterfaces->second) {
+                    f << '\t' << static_cast<int>(itinterfaces->first) << '\t' << RaveGetInterfaceHash(itinterfaces->first) << '\t' << *itname;
+                }
+            }
+            f << "\n";
+        }
+        if( !f ) {
+            RAVELOG_DEBUG_FORMAT("Failed to write plugin manifest %s", tempfilename);
+            f.close();
+            std::remove(tempfilename.c_str());
+            return;
+        }
+    }
+    if( std::rename(tempfilename.c_str(), filename.c_str()) != 0 ) {
+        RAVELOG_DEBUG_FORMAT("Failed to rename plugin manifest to %s", filename);
+        std::remove(tempfilename.c_str());
+    }
+}
+
 } // namespace OpenRAVE
 
 #endif // !OPENRAVE_STATIC_PLUGINS
@@ -37,10 +37,16 @@ public:
     DynamicRaveDatabase(DynamicRaveDatabase&&) = default;
     ~DynamicRaveDatabase() override;
 
-    void Init() override; ///< Initializes by identifying environment variables and loading paths from $OPENRAVE_PLUGINS, then loads plugins
+    /// \brief Initializes by identifying environment variables and loading paths from $OPENRAVE_PLUGINS, then loads plugins
+    ///
+    /// Shared objects whose path, modification time and size match an entry of the plugin manifest in $OPENRAVE_HOME are not
+    /// opened, their interfaces are read from the manifest and the shared object is only loaded when one of them is first created.
+    /// All other shared objects are loaded in parallel and the manifest is updated. Set $OPENRAVE_PLUGINS_CACHE to 0 to disable the manifest.
+    void Init() override;
 
     void ReloadPlugins() override;
     bool LoadPlugin(const std::string& libraryname) override;
+    bool LoadPendingPlugins() override;
 
 private:
     struct DynamicLibrary final
@@ -58,11 +64,29 @@ private:
         void* _handle;
     };
 
-    void _LoadPluginsFromPath(const std::string&, bool recurse = false);
+    /// \brief Description of a shared object in one of the plugin directories as stored in the plugin manifest.
+    struct PluginManifestEntry
+    {
+        int64_t mtime = 0; ///< modification time of the shared object in nanoseconds
+        uint64_t filesize = 0;
+        std::string pluginname; ///< empty if the shared object is not an OpenRAVE plugin
+        RavePlugin::InterfaceMap interfaces;
+    };
+
+    class LazyPlugin;
+    typedef boost::shared_ptr<LazyPlugin> LazyPluginPtr;
+
+    void _FindPluginsFromPath(const std::string& strpath, std::vector<std::string>& vpaths, bool recurse = false); ///< Appends the paths of all files with the plugin extension under strpath
+    static RavePlugin* _CreatePlugin(const std::string& strpath, const DynamicLibrary& dylib); ///< Calls the CreatePlugin export of an opened shared object, returns NULL if it is not an OpenRAVE plugin.
     bool _LoadPlugin(const std::string&); ///< Attempts to load a RavePlugin from a shared object, fails liberally if the right symbols cannot be found. Locks _mutex.
+    PluginPtr _LoadLazyPlugin(const std::string& strpath); ///< Opens the shared object of a plugin created from the manifest. Locks _mutex.
+
+    static void _ReadPluginManifest(const std::string& filename, std::unordered_map<std::string, PluginManifestEntry>& mapentries);
+    static void _WritePluginManifest(const std::string& filename, const std::unordered_map<std::string, PluginManifestEntry>& mapentries);
 
     std::vector<std::string> _vPluginDirs; ///< List of plugin directories
     std::unordered_map<std::string, DynamicLibrary> _mapLibraryHandles; ///< A map of paths to *open* shared object handles.
+    std::vector<LazyPluginPtr> _vLazyPlugins; ///< plugins created from the manifest, their shared objects are opened on first use. Protected by _mutex.
 };
 
 } // end namespace OpenRAVE
@@ -40,6 +40,13 @@ public:
     virtual void ReloadPlugins() = 0;
     virtual bool LoadPlugin(const std::string& libraryname) = 0;
 
+    /// \brief Loads all plugins that were registered but whose code has not been loaded yet.
+    ///
+    /// \return true if at least one plugin was loaded
+    virtual bool LoadPendingPlugins() {
+        return false;
+    }
+
     virtual UserDataPtr AddVirtualPlugin(InterfaceType type, std::string name, std::function<InterfaceBasePtr(EnvironmentBasePtr, std::istream&)> createfn);
 
     // Old interface
@@ -732,6 +732,7 @@ void RobotBase::_ComputeConnectedBodiesInformation()
 
         // Links
         connectedBody._vResolvedLinkNames.resize(connectedBodyInfo._vLinkInfos.size());
+        const size_t ifirstnewlink = _veclinks.size();
         for(int ilink = 0; ilink < (int)connectedBodyInfo._vLinkInfos.size(); ++ilink) {
             KinBody::LinkPtr& plink = connectedBody._vResolvedLinkNames[ilink].second;
             if( !plink ) {
@@ -765,6 +766,7 @@ void RobotBase::_ComputeConnectedBodiesInformation()
                 }
             }
         }
+        InitMissingCollisionMeshes(_veclinks, ifirstnewlink);
 
         // Joints
         std::vector<KinBody::JointPtr> vNewJointsToAdd;
@@ -0,0 +1,124 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2006-2024 Rosen Diankov (rosen.diankov@gmail.com)
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "libopenrave.h"
+
+namespace OpenRAVE {
+
+StatisticsCounter::StatisticsCounter()
+{
+    Reset();
+}
+
+uint64_t StatisticsCounter::ComputeDurationPercentile(dReal fraction) const
+{
+    uint64_t numTimedCalls = 0;
+    for( const std::atomic<uint64_t>& bucket : _vHistogram ) {
+        numTimedCalls += bucket.load(std::memory_order_relaxed);
+    }
+    if( numTimedCalls == 0 ) {
+        return 0;
+    }
+    const uint64_t rank = std::max(uint64_t(1), (uint64_t)std::ceil(fraction*numTimedCalls));
+    uint64_t numCallsSoFar = 0;
+    for( int ibucket = 0; ibucket < NUM_BUCKETS; ++ibucket ) {
+        numCallsSoFar += _vHistogram[ibucket].load(std::memory_order_relaxed);
+        if( numCallsSoFar >= rank ) {
+            // the upper boundary of the bucket can never exceed the longest recorded duration
+            return std::min(GetMaxDuration(), (uint64_t(2) << ibucket) - 1);
+        }
+    }
+    return GetMaxDuration();
+}
+
+void StatisticsCounter::Reset()
+{
+    _numCalls.store(0, std::memory_order_relaxed);
+    _totalDurationNs.store(0, std::memory_order_relaxed);
+    _maxDurationNs.store(0, std::memory_order_relaxed);
+    for( std::atomic<uint64_t>& bucket : _vHistogram ) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void StatisticsCounter::SerializeJSON(rapidjson::Value& rCounter, rapidjson::Document::AllocatorType& allocator) const
+{
+    rCounter.SetObject();
+    rCounter.AddMember("numCalls", rapidjson::Value().SetUint64(GetNumCalls()), allocator);
+    rCounter.AddMember("totalDurationNs", rapidjson::Value().SetUint64(GetTotalDuration()), allocator);
+    rCounter.AddMember("maxDurationNs", rapidjson::Value().SetUint64(GetMaxDuration()), allocator);
+    rCounter.AddMember("p50DurationNs", rapidjson::Value().SetUint64(ComputeDurationPercentile(0.5)), allocator);
+    rCounter.AddMember("p90DurationNs", rapidjson::Value().SetUint64(ComputeDurationPercentile(0.9)), allocator);
+    rCounter.AddMember("p99DurationNs", rapidjson::Value().SetUint64(ComputeDurationPercentile(0.99)), allocator);
+    int numBuckets = NUM_BUCKETS;
+    while( numBuckets > 0 && _vHistogram[numBuckets-1].load(std::memory_order_relaxed) == 0 ) {
+        --numBuckets;
+    }
+    rapidjson::Value rHistogram(rapidjson::kArrayType);
+    rHistogram.Reserve(numBuckets, allocator);
+    for( int ibucket = 0; ibucket < numBuckets; ++ibucket ) {
+        rHistogram.PushBack(rapidjson::Value().SetUint64(_vHistogram[ibucket].load(std::memory_order_relaxed)), allocator);
+    }
+    rCounter.AddMember("histogram", rHistogram, allocator);
+}
+
+StatisticsRegistry::StatisticsRegistry()
+{
+}
+
+StatisticsCounter* StatisticsRegistry::GetCounter(const std::string& interfaceName, const std::string& name)
+{
+    // xml ids can carry the creation parameters of the interface after its name
+    const std::string::size_type namelength = interfaceName.find(' ');
+    std::lock_guard<std::mutex> lock(_mutex);
+    boost::shared_ptr<StatisticsCounter>& pcounter = _mapCounters[namelength == std::string::npos ? interfaceName : interfaceName.substr(0, namelength)][name];
+    if( !pcounter ) {
+        pcounter.reset(new StatisticsCounter());
+    }
+    return pcounter.get();
+}
+
+void StatisticsRegistry::Reset(const std::string& interfaceName)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for( const std::pair<const std::string, std::map<std::string, boost::shared_ptr<StatisticsCounter> > >& interfacecounters : _mapCounters ) {
+        if( interfaceName.empty() || interfacecounters.first == interfaceName ) {
+            for( const std::pair<const std::string, boost::shared_ptr<StatisticsCounter> >& counter : interfacecounters.second ) {
+                counter.second->Reset();
+            }
+        }
+    }
+}
+
+void StatisticsRegistry::SerializeJSON(rapidjson::Value& rStatistics, rapidjson::Document::AllocatorType& allocator, const std::string& interfaceName) const
+{
+    rStatistics.SetObject();
+    std::lock_guard<std::mutex> lock(_mutex);
+    for( const std::pair<const std::string, std::map<std::string, boost::shared_ptr<StatisticsCounter> > >& interfacecounters : _mapCounters ) {
+        if( !interfaceName.empty() && interfacecounters.first != interfaceName ) {
+            continue;
+        }
+        rapidjson::Value rInterface(rapidjson::kObjectType);
+        for( const std::pair<const std::string, boost::shared_ptr<StatisticsCounter> >& counter : interfacecounters.second ) {
+            rapidjson::Value rCounter;
+            counter.second->SerializeJSON(rCounter, allocator);
+            rInterface.AddMember(rapidjson::Value().SetString(counter.first.c_str(), allocator), rCounter, allocator);
+        }
+        rStatistics.AddMember(rapidjson::Value().SetString(interfacecounters.first.c_str(), allocator), rInterface, allocator);
+    }
+}
+
+} // end namespace OpenRAVE
@@ -441,36 +441,39 @@ bool GeometryInfoReader::endElement(const std::string& xmlname)
             break;
         case GT_Prism:
             if( xmlname == "crosssection" ) {
-                _pgeom->_meshcollision.vertices.clear();
-                _pgeom->_meshcollision.indices.clear();
+                TriMesh meshcollision;
                 vector<dReal> values((istream_iterator<dReal>(_ss)), istream_iterator<dReal>());
                 if( values.size() >= 2 && values.size() % 2 == 0 ) {
                     const size_t nPoints = values.size();
-                    _pgeom->_meshcollision.vertices.reserve(nPoints);
-                    _pgeom->_meshcollision.indices.reserve(nPoints * 3);
+                    meshcollision.vertices.reserve(nPoints);
+                    meshcollision.indices.reserve(nPoints * 3);
                     OpenRAVE::Vector vertex;
                     for( size_t ipoint = 0; ipoint < nPoints; ipoint += 2 ) {
                         vertex.x = values[ipoint];
                         vertex.y = values[ipoint + 1];
                         for( dReal z : { -_pgeom->_vGeomData.y * 0.5, _pgeom->_vGeomData.y * 0.5 } ) { // in meter
                             vertex.z = z;
-                            _pgeom->_meshcollision.vertices.push_back(vertex);
+                            meshcollision.vertices.push_back(vertex);
                         }
-                        _pgeom->_meshcollision.indices.push_back(ipoint + 0);
-                        _pgeom->_meshcollision.indices.push_back(ipoint + 1);
-                        _pgeom->_meshcollision.indices.push_back((ipoint + 2) % nPoints);
-                        _pgeom->_meshcollision.indices.push_back(ipoint + 1);
-                        _pgeom->_meshcollision.indices.push_back((ipoint + 3) % nPoints);
-                        _pgeom->_meshcollision.indices.push_back((ipoint + 2) % nPoints);
+                        meshcollision.indices.push_back(ipoint + 0);
+                        meshcollision.indices.push_back(ipoint + 1);
+                        meshcollision.indices.push_back((ipoint + 2) % nPoints);
+                        meshcollision.indices.push_back(ipoint + 1);
+                        meshcollision.indices.push_back((ipoint + 3) % nPoints);
+                        meshcollision.indices.push_back((ipoint + 2) % nPoints);
                     }
                 }
+                _pgeom->_meshcollision.SetTriMesh(meshcollision);
             }
             else if( xmlname == "height" ) {
                 _ss >> _pgeom->_vGeomData.y;
-                for( size_t ipoint = 0; ipoint < _pgeom->_meshcollision.vertices.size(); ipoint += 2 ) {
-                    _pgeom->_meshcollision.vertices[ipoint].z = -_pgeom->_vGeomData.y * 0.5;
-                    _pgeom->_meshcollision.vertices[ipoint + 1].z = _pgeom->_vGeomData.y * 0.5;
+                TriMesh meshcollision;
+                _pgeom->_meshcollision.GetTriMesh(meshcollision);
+                for( size_t ipoint = 0; ipoint < meshcollision.vertices.size(); ipoint += 2 ) {
+                    meshcollision.vertices[ipoint].z = -_pgeom->_vGeomData.y * 0.5;
+                    meshcollision.vertices[ipoint + 1].z = _pgeom->_vGeomData.y * 0.5;
                 }
+                _pgeom->_meshcollision.SetTriMesh(meshcollision);
             }
             break;
         case GT_Capsule:
@@ -497,17 +500,19 @@ bool GeometryInfoReader::endElement(const std::string& xmlname)
                     RAVELOG_WARN(str(boost::format("number of points specified in the vertices field needs to be a multiple of 3 (it is %d), ignoring...\n")%values.size()));
                 }
                 else {
-                    _pgeom->_meshcollision.vertices.resize(values.size()/3);
-                    _pgeom->_meshcollision.indices.resize(values.size()/3);
+                    TriMesh meshcollision;
+                    meshcollision.vertices.resize(values.size()/3);
+                    meshcollision.indices.resize(values.size()/3);
                     vector<dReal>::iterator itvalue = values.begin();
                     size_t i = 0;
-                    FOREACH(itv,_pgeom->_meshcollision.vertices) {
+                    FOREACH(itv,meshcollision.vertices) {
                         itv->x = *itvalue++;
                         itv->y = *itvalue++;
                         itv->z = *itvalue++;
-                        _pgeom->_meshcollision.indices[i] = i;
+                        meshcollision.indices[i] = i;
                         ++i;
                     }
+                    _pgeom->_meshcollision.SetTriMesh(meshcollision);
                 }
             }
             break;
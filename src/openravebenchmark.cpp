@@ -0,0 +1,505 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2006-2024 Rosen Diankov (rosen.diankov@gmail.com)
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+/// \brief Benchmarks of the hot paths of the core: kinematics, collision checking, trajectory sampling and conversion, loading and smoothing.
+///
+/// Every benchmark reports the throughput and the latency percentiles of its calls. The results can be saved as json and
+/// later used as a baseline, in which case the program fails when the median latency of a benchmark regressed. The program
+/// also fails when a benchmark throws.
+#include "libopenrave-core/openrave-core.h"
+#include <openrave/openravejson.h>
+#include <openrave/planningutils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <boost/algorithm/string.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+using namespace OpenRAVE;
+
+namespace {
+
+/// \brief latencies of one benchmark
+struct BenchmarkResult
+{
+    std::string name;
+    int numIterations = 0;
+    uint64_t totalDurationNs = 0;
+    uint64_t p50DurationNs = 0, p90DurationNs = 0, p99DurationNs = 0, maxDurationNs = 0;
+
+    /// \brief calls per second
+    inline double GetThroughput() const {
+        return totalDurationNs > 0 ? 1e9*numIterations/totalDurationNs : 0;
+    }
+
+    void SaveToJson(rapidjson::Value& rResult, rapidjson::Document::AllocatorType& alloc) const
+    {
+        rResult.SetObject();
+        orjson::SetJsonValueByKey(rResult, "numIterations", numIterations, alloc);
+        orjson::SetJsonValueByKey(rResult, "totalDurationNs", totalDurationNs, alloc);
+        orjson::SetJsonValueByKey(rResult, "callsPerSecond", GetThroughput(), alloc);
+        orjson::SetJsonValueByKey(rResult, "p50DurationNs", p50DurationNs, alloc);
+        orjson::SetJsonValueByKey(rResult, "p90DurationNs", p90DurationNs, alloc);
+        orjson::SetJsonValueByKey(rResult, "p99DurationNs", p99DurationNs, alloc);
+        orjson::SetJsonValueByKey(rResult, "maxDurationNs", maxDurationNs, alloc);
+    }
+};
+
+class Benchmarker
+{
+public:
+    Benchmarker(int numIterations, dReal fMinDuration, const std::string& filter) : _numIterations(numIterations), _fMinDuration(fMinDuration), _filter(filter) {
+    }
+
+    /// \brief times fn until it ran numIterations times and for at least fMinDuration seconds. fn receives the iteration index.
+    ///
+    /// \param numIterationsScale scales the number of iterations for benchmarks that are much slower than the others
+    void Run(const std::string& name, const std::function<void(int)>& fn, dReal numIterationsScale=1)
+    {
+        if( !IsEnabled(name) ) {
+            return;
+        }
+        const int numIterations = std::max(1, (int)(_numIterations*numIterationsScale));
+        const uint64_t minDurationNs = _fMinDuration*numIterationsScale*1e9;
+        std::vector<uint64_t> vdurations;
+        vdurations.reserve(numIterations);
+        uint64_t totalDurationNs = 0;
+        try {
+            fn(0); // warm up caches and lazily created structures
+            for(int iteration = 0; iteration < numIterations || totalDurationNs < minDurationNs; ++iteration) {
+                const std::chrono::steady_clock::time_point starttime = std::chrono::steady_clock::now();
+                fn(iteration);
+                const uint64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - starttime).count();
+                vdurations.push_back(durationNs);
+                totalDurationNs += durationNs;
+            }
+        }
+        catch(const std::exception& ex) {
+            RAVELOG_ERROR_FORMAT("benchmark %s failed: %s", name%ex.what());
+            ++_numFailures;
+            return;
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.numIterations = vdurations.size();
+        result.totalDurationNs = totalDurationNs;
+        std::sort(vdurations.begin(), vdurations.end());
+        result.p50DurationNs = _GetPercentile(vdurations, 0.5);
+        result.p90DurationNs = _GetPercentile(vdurations, 0.9);
+        result.p99DurationNs = _GetPercentile(vdurations, 0.99);
+        result.maxDurationNs = vdurations.back();
+        RAVELOG_INFO_FORMAT("%-50s %9d calls %12.1f calls/s  p50=%10.3fus p90=%10.3fus p99=%10.3fus max=%10.3fus", name%result.numIterations%result.GetThroughput()%(1e-3*result.p50DurationNs)%(1e-3*result.p90DurationNs)%(1e-3*result.p99DurationNs)%(1e-3*result.maxDurationNs));
+        _vresults.push_back(result);
+    }
+
+    /// \brief true if the benchmark name passes the filter
+    inline bool IsEnabled(const std::string& name) const {
+        return _filter.empty() || name.find(_filter) != std::string::npos;
+    }
+
+    const std::vector<BenchmarkResult>& GetResults() const {
+        return _vresults;
+    }
+
+    /// \brief number of benchmarks that threw an exception
+    inline int GetNumFailures() const {
+        return _numFailures;
+    }
+
+private:
+    static uint64_t _GetPercentile(const std::vector<uint64_t>& vsorteddurations, dReal fraction)
+    {
+        size_t index = std::ceil(fraction*vsorteddurations.size());
+        return vsorteddurations.at(index > 0 ? index-1 : 0);
+    }
+
+    int _numIterations;
+    dReal _fMinDuration;
+    std::string _filter;
+    std::vector<BenchmarkResult> _vresults;
+    int _numFailures = 0;
+};
+
+/// \brief samples random dof values inside the limits of the active dofs
+class ActiveDOFSampler
+{
+public:
+    ActiveDOFSampler(RobotBasePtr probot) : _rng(0) {
+        probot->GetActiveDOFLimits(_vlower, _vupper);
+    }
+
+    void Sample(std::vector<dReal>& values) {
+        values.resize(_vlower.size());
+        for(size_t idof = 0; idof < values.size(); ++idof) {
+            boost::random::uniform_real_distribution<dReal> dist(_vlower[idof], _vupper[idof]);
+            values[idof] = dist(_rng);
+        }
+    }
+
+    /// \brief samples values at most fdelta away from values0 relative to the range of the dof
+    void SampleNeighbor(const std::vector<dReal>& values0, dReal fdelta, std::vector<dReal>& values) {
+        values.resize(_vlower.size());
+        boost::random::uniform_real_distribution<dReal> dist(-fdelta, fdelta);
+        for(size_t idof = 0; idof < values.size(); ++idof) {
+            values[idof] = std::min(_vupper[idof], std::max(_vlower[idof], values0[idof] + dist(_rng)*(_vupper[idof] - _vlower[idof])));
+        }
+    }
+
+private:
+    boost::random::mt19937 _rng;
+    std::vector<dReal> _vlower, _vupper;
+};
+
+void BenchmarkKinematics(Benchmarker& benchmarker, RobotBasePtr probot)
+{
+    ActiveDOFSampler sampler(probot);
+    std::vector<std::vector<dReal> > vsamples(1000);
+    for(std::vector<dReal>& values : vsamples) {
+        sampler.Sample(values);
+    }
+    benchmarker.Run("SetDOFValues", [&](int iteration) {
+        probot->SetActiveDOFValues(vsamples[iteration%vsamples.size()], KinBody::CLA_Nothing);
+    });
+    std::vector<Transform> vtransforms;
+    benchmarker.Run("SetDOFValues+GetLinkTransformations", [&](int iteration) {
+        probot->SetActiveDOFValues(vsamples[iteration%vsamples.size()], KinBody::CLA_Nothing);
+        probot->GetLinkTransformations(vtransforms);
+    });
+    std::vector<dReal> vjacobian;
+    RobotBase::ManipulatorPtr pmanip = probot->GetActiveManipulator();
+    if( !!pmanip ) {
+        benchmarker.Run("CalculateJacobian", [&](int iteration) {
+            probot->SetActiveDOFValues(vsamples[iteration%vsamples.size()], KinBody::CLA_Nothing);
+            pmanip->CalculateJacobian(vjacobian);
+        });
+    }
+}
+
+void BenchmarkCollision(Benchmarker& benchmarker, EnvironmentBasePtr penv, RobotBasePtr probot, const std::vector<std::string>& vcheckernames)
+{
+    ActiveDOFSampler sampler(probot);
+    std::vector<std::vector<dReal> > vsamples(1000);
+    for(std::vector<dReal>& values : vsamples) {
+        sampler.Sample(values);
+    }
+    CollisionCheckerBasePtr poldchecker = penv->GetCollisionChecker();
+    CollisionReportPtr preport(new CollisionReport());
+    for(const std::string& checkername : vcheckernames) {
+        CollisionCheckerBasePtr pchecker = RaveCreateCollisionChecker(penv, checkername);
+        if( !pchecker ) {
+            RAVELOG_WARN_FORMAT("collision checker %s is not available, skipping its benchmarks", checkername);
+            continue;
+        }
+        penv->SetCollisionChecker(pchecker);
+        benchmarker.Run(str(boost::format("CheckCollision/%s/env")%checkername), [&](int iteration) {
+            probot->SetActiveDOFValues(vsamples[iteration%vsamples.size()], KinBody::CLA_Nothing);
+            penv->CheckCollision(probot);
+        });
+        benchmarker.Run(str(boost::format("CheckCollision/%s/env+report")%checkername), [&](int iteration) {
+            probot->SetActiveDOFValues(vsamples[iteration%vsamples.size()], KinBody::CLA_Nothing);
+            penv->CheckCollision(probot, preport);
+        });
+        benchmarker.Run(str(boost::format("CheckCollision/%s/self")%checkername), [&](int iteration) {
+            probot->SetActiveDOFValues(vsamples[iteration%vsamples.size()], KinBody::CLA_Nothing);
+            probot->CheckSelfCollision();
+        });
+    }
+    penv->SetCollisionChecker(poldchecker);
+}
+
+/// \brief creates a trajectory with numwaypoints random linear waypoints of the active dofs, timed with deltatime
+TrajectoryBasePtr CreateRandomTrajectory(EnvironmentBasePtr penv, RobotBasePtr probot, int numwaypoints, dReal fdelta)
+{
+    ActiveDOFSampler sampler(probot);
+    ConfigurationSpecification spec = probot->GetActiveConfigurationSpecification("linear");
+    spec.AddDerivativeGroups(1, true);
+    TrajectoryBasePtr ptraj = RaveCreateTrajectory(penv, "");
+    ptraj->Init(spec);
+    const int dof = probot->GetActiveDOF();
+    std::vector<dReal> vvalues, vprevvalues, vwaypoint(spec.GetDOF(), 0);
+    probot->GetActiveDOFValues(vprevvalues);
+    for(int iwaypoint = 0; iwaypoint < numwaypoints; ++iwaypoint) {
+        sampler.SampleNeighbor(vprevvalues, fdelta, vvalues);
+        std::copy(vvalues.begin(), vvalues.end(), vwaypoint.begin());
+        vwaypoint.back() = iwaypoint > 0 ? 0.1 : 0;
+        ptraj->Insert(ptraj->GetNumWaypoints(), vwaypoint);
+        vprevvalues.swap(vvalues);
+    }
+    OPENRAVE_ASSERT_OP((int)vwaypoint.size(), ==, 2*dof+1);
+    return ptraj;
+}
+
+void BenchmarkTrajectory(Benchmarker& benchmarker, EnvironmentBasePtr penv, RobotBasePtr probot)
+{
+    TrajectoryBasePtr ptraj = CreateRandomTrajectory(penv, probot, 100, 0.05);
+    const dReal fduration = ptraj->GetDuration();
+    std::vector<dReal> vdata;
+    benchmarker.Run("GenericTrajectory::Sample", [&](int iteration) {
+        ptraj->Sample(vdata, fduration*((iteration*7919)%1000)/1000);
+    });
+    ConfigurationSpecification valuesspec = probot->GetActiveConfigurationSpecification("linear");
+    benchmarker.Run("GenericTrajectory::Sample/spec", [&](int iteration) {
+        ptraj->Sample(vdata, fduration*((iteration*7919)%1000)/1000, valuesspec);
+    });
+
+    // convert all the waypoints to a specification with the groups in a different order
+    const ConfigurationSpecification& sourcespec = ptraj->GetConfigurationSpecification();
+    ConfigurationSpecification targetspec;
+    targetspec.AddDeltaTimeGroup();
+    targetspec += sourcespec.GetTimeDerivativeSpecification(1);
+    targetspec += sourcespec.GetTimeDerivativeSpecification(0);
+    std::vector<dReal> vsourcedata, vtargetdata(ptraj->GetNumWaypoints()*targetspec.GetDOF());
+    ptraj->GetWaypoints(0, ptraj->GetNumWaypoints(), vsourcedata);
+    benchmarker.Run("ConfigurationSpecification::ConvertData", [&](int iteration) {
+        ConfigurationSpecification::ConvertData(vtargetdata.begin(), targetspec, vsourcedata.begin(), sourcespec, ptraj->GetNumWaypoints(), penv);
+    });
+}
+
+void BenchmarkSmoothers(Benchmarker& benchmarker, EnvironmentBasePtr penv, RobotBasePtr probot, const std::vector<std::string>& vsmoothernames)
+{
+    TrajectoryBasePtr ptrajsource = CreateRandomTrajectory(penv, probot, 10, 0.1);
+    TrajectoryBasePtr ptraj = RaveCreateTrajectory(penv, "");
+    for(const std::string& smoothername : vsmoothernames) {
+        if( !RaveHasInterface(PT_Planner, smoothername) ) {
+            RAVELOG_WARN_FORMAT("smoother %s is not available, skipping its benchmark", smoothername);
+            continue;
+        }
+        benchmarker.Run(str(boost::format("Smoother/%s")%smoothername), [&](int iteration) {
+            ptraj->Clone(ptrajsource, 0);
+            planningutils::SmoothActiveDOFTrajectory(ptraj, probot, 1, 1, smoothername, "<_nmaxiterations>20</_nmaxiterations>");
+        }, 0.01);
+    }
+}
+
+void BenchmarkLoading(Benchmarker& benchmarker, EnvironmentBasePtr penv, const std::vector<std::string>& vfilenames)
+{
+    EnvironmentBasePtr ploadenv = penv->CloneSelf(0);
+    for(const std::string& filename : vfilenames) {
+        const std::string loadname = str(boost::format("Load/%s")%filename), loadjsonname = str(boost::format("LoadJSON/%s")%filename);
+        if( filename.empty() || (!benchmarker.IsEnabled(loadname) && !benchmarker.IsEnabled(loadjsonname)) ) {
+            continue;
+        }
+        ploadenv->Reset();
+        if( !ploadenv->Load(filename) ) {
+            RAVELOG_WARN_FORMAT("failed to load %s, skipping its benchmarks", filename);
+            continue;
+        }
+        benchmarker.Run(loadname, [&](int iteration) {
+            ploadenv->Reset();
+            ploadenv->Load(filename);
+        }, 0.05);
+
+        // load the same scene from its json representation
+        EnvironmentBase::EnvironmentBaseInfo info;
+        ploadenv->ExtractInfo(info);
+        rapidjson::Document rEnvInfo;
+        info.SerializeJSON(rEnvInfo, rEnvInfo.GetAllocator(), 1.0);
+        std::vector<KinBodyPtr> vCreatedBodies, vModifiedBodies, vRemovedBodies;
+        benchmarker.Run(loadjsonname, [&](int iteration) {
+            ploadenv->Reset();
+            ploadenv->LoadJSON(rEnvInfo, UFIM_Exact, vCreatedBodies, vModifiedBodies, vRemovedBodies);
+        }, 0.05);
+    }
+    ploadenv->Destroy();
+}
+
+void SaveResults(const std::vector<BenchmarkResult>& vresults, const std::string& filename)
+{
+    rapidjson::Document rResults;
+    rResults.SetObject();
+    for(const BenchmarkResult& result : vresults) {
+        rapidjson::Value rResult;
+        result.SaveToJson(rResult, rResults.GetAllocator());
+        rResults.AddMember(rapidjson::Value().SetString(result.name.c_str(), rResults.GetAllocator()), rResult, rResults.GetAllocator());
+    }
+    std::ofstream f(filename.c_str());
+    f << orjson::DumpJson(rResults, 4) << std::endl;
+}
+
+/// \brief compares the median latencies of the results of benchmarker to the ones of the baseline file
+/// \return the number of benchmarks that became slower than the baseline by more than the tolerance, plus the number of enabled benchmarks of the baseline that did not produce a result
+int CompareToBaseline(const Benchmarker& benchmarker, const std::string& filename, dReal ftolerance)
+{
+    const std::vector<BenchmarkResult>& vresults = benchmarker.GetResults();
+    std::ifstream f(filename.c_str());
+    if( !f ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to open baseline %s", filename, ORE_InvalidArguments);
+    }
+    std::stringstream ss;
+    ss << f.rdbuf();
+    rapidjson::Document rBaseline;
+    orjson::ParseJson(rBaseline, ss.str());
+    int numregressions = 0;
+    for(const BenchmarkResult& result : vresults) {
+        rapidjson::Value::ConstMemberIterator itbaseline = rBaseline.FindMember(result.name.c_str());
+        if( itbaseline == rBaseline.MemberEnd() ) {
+            RAVELOG_INFO_FORMAT("%s is not in the baseline", result.name);
+            continue;
+        }
+        uint64_t baselineDurationNs = 0;
+        orjson::LoadJsonValueByKey(itbaseline->value, "p50DurationNs", baselineDurationNs);
+        const dReal fratio = baselineDurationNs > 0 ? dReal(result.p50DurationNs)/baselineDurationNs : 1;
+        if( fratio > 1 + ftolerance ) {
+            RAVELOG_ERROR_FORMAT("%s regressed: p50 %.3fus, baseline %.3fus (%.2fx)", result.name%(1e-3*result.p50DurationNs)%(1e-3*baselineDurationNs)%fratio);
+            ++numregressions;
+        }
+        else {
+            RAVELOG_INFO_FORMAT("%s: p50 %.3fus, baseline %.3fus (%.2fx)", result.name%(1e-3*result.p50DurationNs)%(1e-3*baselineDurationNs)%fratio);
+        }
+    }
+    // a benchmark that disappeared, for example because it failed or its checker is not found anymore, should not pass silently
+    for(rapidjson::Value::ConstMemberIterator itbaseline = rBaseline.MemberBegin(); itbaseline != rBaseline.MemberEnd(); ++itbaseline) {
+        const std::string name = itbaseline->name.GetString();
+        if( !benchmarker.IsEnabled(name) ) {
+            continue;
+        }
+        bool bFound = false;
+        for(const BenchmarkResult& result : vresults) {
+            if( result.name == name ) {
+                bFound = true;
+                break;
+            }
+        }
+        if( !bFound ) {
+            RAVELOG_ERROR_FORMAT("%s is in the baseline but did not run", name);
+            ++numregressions;
+        }
+    }
+    return numregressions;
+}
+
+} // end namespace
+
+int main(int argc, char** argv)
+{
+    std::string robotname = "robots/barrettwam.robot.xml", filter, outputfilename, baselinefilename;
+    std::vector<std::string> vcheckernames = {"fcl_", "pqp", "ode"}, vsmoothernames = {"ParabolicSmoother", "ParabolicSmoother2"};
+    std::vector<std::string> vloadfilenames = {"robots/barrettwam.robot.xml", "robots/pr2-beta-static.zae", "data/lab1.env.xml"};
+    int numIterations = 1000;
+    dReal fMinDuration = 0.5, ftolerance = 0.2;
+    DebugLevel debuglevel = Level_Info;
+    for(int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if( arg == "-h" || arg == "--help" ) {
+            printf("OpenRAVE benchmarks of the kinematics, collision, trajectory, loading and smoothing hot paths\n"
+                   "--robot [uri]            robot to benchmark with (default %s)\n"
+                   "--collision [names]      comma separated collision checkers to benchmark (default fcl_,pqp,ode)\n"
+                   "--smoothers [names]      comma separated smoothers to benchmark (default ParabolicSmoother,ParabolicSmoother2)\n"
+                   "--load [uris]            comma separated files whose loading is benchmarked\n"
+                   "--iterations [n]         minimum number of calls of each benchmark (default %d)\n"
+                   "--mintime [seconds]      minimum time spent in each benchmark (default %f)\n"
+                   "--filter [substring]     only run the benchmarks whose name contains the substring\n"
+                   "--output [file]          save the results as json, this file can be used as a baseline later\n"
+                   "--baseline [file]        compare to the results of a previous run and fail if any median latency got slower or any benchmark is missing\n"
+                   "--tolerance [fraction]   allowed relative slow down compared to the baseline (default %f)\n"
+                   "-d [debug-level]         debug level\n", robotname.c_str(), numIterations, fMinDuration, ftolerance);
+            return 0;
+        }
+        if( i+1 >= argc ) {
+            RAVELOG_ERROR_FORMAT("%s needs a value", arg);
+            return 2;
+        }
+        const std::string value = argv[++i];
+        if( arg == "--robot" ) {
+            robotname = value;
+        }
+        else if( arg == "--collision" ) {
+            boost::split(vcheckernames, value, boost::is_any_of(","), boost::token_compress_on);
+        }
+        else if( arg == "--smoothers" ) {
+            boost::split(vsmoothernames, value, boost::is_any_of(","), boost::token_compress_on);
+        }
+        else if( arg == "--load" ) {
+            boost::split(vloadfilenames, value, boost::is_any_of(","), boost::token_compress_on);
+        }
+        else if( arg == "--iterations" ) {
+            numIterations = atoi(value.c_str());
+        }
+        else if( arg == "--mintime" ) {
+            fMinDuration = atof(value.c_str());
+        }
+        else if( arg == "--filter" ) {
+            filter = value;
+        }
+        else if( arg == "--output" ) {
+            outputfilename = value;
+        }
+        else if( arg == "--baseline" ) {
+            baselinefilename = value;
+        }
+        else if( arg == "--tolerance" ) {
+            ftolerance = atof(value.c_str());
+        }
+        else if( arg == "-d" ) {
+            debuglevel = (DebugLevel)atoi(value.c_str());
+        }
+        else {
+            RAVELOG_ERROR_FORMAT("unknown argument %s, see --help", arg);
+            return 2;
+        }
+    }
+
+    RaveInitialize(true, debuglevel);
+    int numfailures = 0;
+    {
+        EnvironmentBasePtr penv = RaveCreateEnvironment();
+        RobotBasePtr probot = penv->ReadRobotURI(RobotBasePtr(), robotname);
+        if( !probot ) {
+            RAVELOG_ERROR_FORMAT("failed to load robot %s", robotname);
+            RaveDestroy();
+            return 2;
+        }
+        penv->Add(probot, IAM_StrictNameChecking);
+        if( probot->GetManipulators().size() > 0 ) {
+            probot->SetActiveDOFs(probot->GetActiveManipulator()->GetArmIndices());
+        }
+        else {
+            std::vector<int> vdofindices(probot->GetDOF());
+            for(int idof = 0; idof < probot->GetDOF(); ++idof) {
+                vdofindices[idof] = idof;
+            }
+            probot->SetActiveDOFs(vdofindices);
+        }
+
+        Benchmarker benchmarker(numIterations, fMinDuration, filter);
+        {
+            EnvironmentLock lock(penv->GetMutex());
+            BenchmarkKinematics(benchmarker, probot);
+            BenchmarkCollision(benchmarker, penv, probot, vcheckernames);
+            BenchmarkTrajectory(benchmarker, penv, probot);
+            BenchmarkSmoothers(benchmarker, penv, probot, vsmoothernames);
+        }
+        BenchmarkLoading(benchmarker, penv, vloadfilenames);
+
+        if( !outputfilename.empty() ) {
+            SaveResults(benchmarker.GetResults(), outputfilename);
+        }
+        numfailures = benchmarker.GetNumFailures();
+        if( !baselinefilename.empty() ) {
+            numfailures += CompareToBaseline(benchmarker, baselinefilename, ftolerance);
+        }
+        penv->Destroy();
+    }
+    RaveDestroy();
+    return numfailures > 0 ? 1 : 0;
+}
@@ -310,3 +310,59 @@ class TestConfigurationCache(EnvironmentSetup):
                 cachedcollisions, cachedcollisionhits, cachedfreehits, cachesize = cachechecker.SendCommand('GetSelfCacheStatistics').split()
                 assert(int(cachesize)==0)
                 self.log.info('self cache reset test passed')
+
+    def test_jitterer(self):
+        self.log.info('jitter out of collision with several streams and a time limit')
+        self.LoadEnv('data/lab1.env.xml')
+        env=self.env
+        robot=env.GetRobots()[0]
+        with env:
+            robot.SetActiveDOFs(range(7))
+            # box that slightly overlaps the hand
+            ab = robot.GetActiveManipulator().GetEndEffector().ComputeAABB()
+            box = RaveCreateKinBody(env,'')
+            box.InitFromBoxes(array([r_[ab.pos()+array([ab.extents()[0]+0.015,0,0]),0.02,0.02,0.02]]),True)
+            box.SetName('obstacle')
+            env.Add(box,True)
+            assert(env.CheckCollision(robot))
+            initialvalues = robot.GetActiveDOFValues()
+
+            jitterer = RaveCreateSpaceSampler(env,'ConfigurationJitterer %s'%robot.GetName())
+            assert(jitterer.SendCommand('SetMaxJitter 0.3') is not None)
+            assert(jitterer.SendCommand('SetMaxIterations 1000') is not None)
+            assert(jitterer.SendCommand('SetNumThreads 4') is not None)
+            assert(jitterer.SendCommand('SetMaxJitterTime 5') is not None)
+            parameters = jitterer.SendJSONCommand('GetCurrentParameters', {})
+            assert(parameters['numJitterThreads'] == 4 and parameters['maxJitterTime'] == 5)
+            samples = jitterer.SampleSequence(SampleDataType.Real,1)
+            assert(len(samples) == 7)
+            assert(transdist(robot.GetActiveDOFValues(), samples) <= g_epsilon)
+            assert(not env.CheckCollision(robot) and not robot.CheckSelfCollision())
+            robot.SetActiveDOFValues(initialvalues)
+
+            # move the box into the hand so that no configuration within the jitter is free
+            box.SetTransform(matrixFromPose([1,0,0,0,-ab.extents()[0]-0.015,0,0]))
+            assert(jitterer.SendCommand('SetMaxJitterTime 0') is not None)
+            assert(jitterer.SendCommand('SetMaxIterations 200') is not None)
+            samples = jitterer.SampleSequence(SampleDataType.Real,1)
+            assert(len(samples) == 0)
+            assert(transdist(robot.GetActiveDOFValues(), initialvalues) <= g_epsilon)
+            # every sample fails for exactly one reason in exactly one stream
+            numfailures = numpy.sum(list(jitterer.SendJSONCommand('GetFailuresCount', {}).values()))
+            assert(numfailures > 200)
+
+            maxjittertime = 1.0
+            assert(jitterer.SendCommand('SetMaxJitterTime %f'%maxjittertime) is not None)
+            starttime = time.time()
+            samples = jitterer.SampleSequence(SampleDataType.Real,1)
+            jittertime = time.time()-starttime
+            self.log.info('jittering with 4 streams stopped after %fs', jittertime)
+            assert(len(samples) == 0)
+            assert(jittertime < maxjittertime+0.5)
+
+            # the counts of all the streams add up to the count of the serial loop
+            assert(jitterer.SendCommand('SetNumThreads 1') is not None)
+            assert(jitterer.SendCommand('SetMaxJitterTime 0') is not None)
+            samples = jitterer.SampleSequence(SampleDataType.Real,1)
+            assert(len(samples) == 0)
+            assert(numpy.sum(list(jitterer.SendJSONCommand('GetFailuresCount', {}).values())) == numfailures)
@@ -65,6 +65,38 @@ class test_ideal(RunController):
     def __init__(self):
         RunController.__init__(self, 'IdealController')
 
+    def test_realtimeplayback(self):
+        self.log.debug('plays back a trajectory converted for real-time playback')
+        robot=self.LoadRobot('robots/schunk-lwa3.zae')
+        env=self.env
+        with env:
+            initvalues = robot.GetActiveDOFValues()
+            waypoint=zeros(robot.GetActiveDOF())
+            waypoint[0] = 0.5
+            waypoint[1] = 0.5
+            traj=RaveCreateTrajectory(env, '')
+            traj.Init(robot.GetActiveConfigurationSpecification('quadratic'))
+            traj.Insert(0,r_[initvalues,waypoint])
+            ret=planningutils.RetimeActiveDOFTrajectory(traj,robot,False, 1, 1, 'ParabolicTrajectoryRetimer2')
+            assert(ret.statusCode==PlannerStatusCode.HasSolution)
+            controller = robot.GetController()
+            controller.SendCommand('SetRealtimePlayback 1')
+            controller.SendCommand('ResetTickStatistics')
+            # sample in the middle of the trajectory and compare with the original
+            robot.SetConfigurationValues(traj.GetWaypoint(0,robot.GetConfigurationSpecification()))
+            controller.SetPath(traj)
+            elapsedtime = 0
+            while elapsedtime+0.01 <= 0.5*traj.GetDuration():
+                env.StepSimulation(0.01)
+                elapsedtime += 0.01
+            expectedvalues = traj.Sample(controller.GetTime()-0.01,robot.GetActiveConfigurationSpecification())
+            assert(transdist(robot.GetActiveDOFValues(),expectedvalues) <= g_epsilon)
+            while not controller.IsDone():
+                env.StepSimulation(0.01)
+            assert(transdist(robot.GetActiveDOFValues(),waypoint) <= g_epsilon)
+            stats = [float(f) for f in controller.SendCommand('GetTickStatistics').split()]
+            assert(len(stats) == 6 and stats[0] > 0)
+
 # class test_bullet(RunController):
 #     def __init__(self):
 #         RunController.__init__(self, 'bullet')
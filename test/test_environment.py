@@ -209,6 +209,211 @@ class TestEnvironment(EnvironmentSetup):
         for t in threads:
             t.join()
 
+    def test_deserializebodyinfos(self):
+        self.log.info('bodies are deserialized in parallel, check that the result keeps the input order and updates')
+        numbodies = 40
+        bodies = []
+        for ibody in range(numbodies):
+            bodies.append({'id':'b%d'%ibody, 'name':'body%d'%ibody, 'links':[{'id':'l0', 'name':'base', 'geometries':[{'id':'g0', 'type':'box', 'halfExtents':[0.1,0.1,0.1*(ibody+1)]}]}]})
+        bodies.append({'id':'b3', 'name':'renamed3'})
+        bodies.append({'id':'b5', '__deleted__':True})
+        bodies.append({'id':'b7', 'isRobot':True})
+        bodies.append({'id':'noname'})
+        bodies.append({'name':'renamed3', 'links':[{'id':'l1', 'name':'tip'}]})
+        envInfo = EnvironmentBaseInfo()
+        envInfo.DeserializeJSON({'bodies':bodies})
+        names = [bodyInfo._name for bodyInfo in envInfo._vBodyInfos]
+        expectednames = ['body%d'%ibody for ibody in range(numbodies) if ibody != 5]
+        expectednames[3] = 'renamed3'
+        assert(names == expectednames)
+        for bodyInfo in envInfo._vBodyInfos:
+            assert(bodyInfo._isRobot == (bodyInfo._id == 'b7'))
+        renamedInfo = envInfo._vBodyInfos[3]
+        assert(renamedInfo._id == '')
+        assert(sorted(linkInfo._name for linkInfo in renamedInfo._vLinkInfos) == ['base', 'tip'])
+
+    def test_updategeometryfrominfo(self):
+        self.log.info('changing the shape of a geometry updates the body in place and only changes the geometry stamp of its link')
+        env=self.env
+        def getEnvInfo(extents):
+            return {'bodies':[
+                {'id':'b1', 'name':'b1', 'transform':[1,0,0,0,0,0,0], 'links':[{'id':'l0', 'name':'base', 'geometries':[{'id':'g0', 'type':'box', 'halfExtents':extents}]}]},
+                {'id':'b2', 'name':'b2', 'transform':[1,0,0,0,0.5,0,0], 'links':[{'id':'l0', 'name':'base', 'geometries':[{'id':'g0', 'type':'box', 'halfExtents':[0.1,0.1,0.1]}]}]},
+            ]}
+        createdBodies, modifiedBodies, removedBodies = env.LoadJSON(getEnvInfo([0.1,0.1,0.1]), UpdateFromInfoMode.Exact)
+        assert(len(createdBodies) == 2)
+        body1 = env.GetKinBody('b1')
+        body2 = env.GetKinBody('b2')
+        bodyIndex1 = body1.GetEnvironmentBodyIndex()
+        stamp1 = body1.GetLinks()[0].GetGeometryUpdateStamp()
+        stamp2 = body2.GetLinks()[0].GetGeometryUpdateStamp()
+        assert(not env.CheckCollision(body1, body2))
+
+        createdBodies, modifiedBodies, removedBodies = env.LoadJSON(getEnvInfo([0.45,0.1,0.1]), UpdateFromInfoMode.Exact)
+        assert(len(createdBodies) == 0 and len(removedBodies) == 0)
+        assert([body.GetName() for body in modifiedBodies] == ['b1'])
+        assert(body1.GetEnvironmentBodyIndex() == bodyIndex1)
+        assert(body1.GetLinks()[0].GetGeometryUpdateStamp() != stamp1)
+        assert(body2.GetLinks()[0].GetGeometryUpdateStamp() == stamp2)
+        assert(transdist(body1.GetLinks()[0].GetGeometries()[0].GetBoxExtents(), [0.45,0.1,0.1]) <= g_epsilon)
+        assert(env.CheckCollision(body1, body2))
+
+    def test_downloadcache(self):
+        self.log.info('remote json documents are kept in a disk cache, revalidated with the server, and can be loaded offline')
+        import json, tempfile
+        try:
+            from http.server import HTTPServer, SimpleHTTPRequestHandler
+        except ImportError:
+            from BaseHTTPServer import HTTPServer
+            from SimpleHTTPServer import SimpleHTTPRequestHandler
+        servedir = tempfile.mkdtemp()
+        cachedir = tempfile.mkdtemp()
+        try:
+            with open(os.path.join(servedir, 'box.json'), 'w') as f:
+                json.dump({'bodies':[{'id':'box', 'name':'box', 'links':[{'id':'l0', 'name':'base', 'geometries':[{'id':'g0', 'type':'box', 'halfExtents':[0.1,0.2,0.3]}]}]}]}, f)
+            responsecodes = []
+            class FileHandler(SimpleHTTPRequestHandler):
+                def translate_path(self, path):
+                    return os.path.join(servedir, path.lstrip('/'))
+                def send_response(self, code, message=None):
+                    responsecodes.append(code)
+                    SimpleHTTPRequestHandler.send_response(self, code, message)
+                def log_message(self, format, *args):
+                    pass
+            # temporary file left by a writer that died, removed when the cache is written
+            stalefilename = os.path.join(cachedir, 'stale.data.1.0.tmp')
+            open(stalefilename, 'w').close()
+            os.utime(stalefilename, (time.time()-7200, time.time()-7200))
+            server = HTTPServer(('127.0.0.1', 0), FileHandler)
+            serverthread = threading.Thread(target=server.serve_forever)
+            serverthread.start()
+            atts = {'remoteurl':'http://127.0.0.1:%d'%server.server_address[1], 'downloadcachedir':cachedir}
+            try:
+                for iload in range(2):
+                    env = Environment()
+                    try:
+                        assert(env.LoadURI('openrave:/box.json', atts))
+                        assert(env.GetKinBody('box') is not None)
+                    finally:
+                        env.Destroy()
+            finally:
+                server.shutdown()
+                server.server_close()
+                serverthread.join()
+            assert(responsecodes == [200, 304])
+            assert(not os.path.exists(stalefilename))
+            assert(not any(filename.endswith('.tmp') for filename in os.listdir(cachedir)))
+
+            atts['downloadoffline'] = '1'
+            env = Environment()
+            try:
+                assert(env.LoadURI('openrave:/box.json', atts))
+                assert(transdist(env.GetKinBody('box').ComputeAABB().extents(), [0.1,0.2,0.3]) <= g_epsilon)
+                try:
+                    env.LoadURI('openrave:/missing.json', atts)
+                    raise ValueError('loading an uncached document offline should fail')
+                except openrave_exception:
+                    pass
+            finally:
+                env.Destroy()
+        finally:
+            shutil.rmtree(servedir)
+            shutil.rmtree(cachedir)
+
+    def test_msgpackroundtrip(self):
+        self.log.info('msgpack documents with binary strings, timestamp extensions, nested maps and large meshes load and save without loss')
+        import msgpack, datetime, tempfile
+        env=self.env
+        numvertices = 60000
+        vertices = [0.001*ivalue for ivalue in range(3*numvertices)]
+        indices = list(range(numvertices))
+        timestamp = msgpack.Timestamp(1600000000, 123000000)
+        # the unknown nested map comes first so the keys after it are only read correctly if the parser tracks the map nesting
+        body = {'unknownMap':{'nested':{'key':[1,{'inner':'value'}], 'empty':{}}},
+                'id':b'meshbody',
+                'name':'meshbody',
+                'links':[{'id':'l0', 'name':'base', 'geometries':[{'id':'g0', 'type':'trimesh', 'mesh':{'vertices':vertices, 'indices':indices}}]}]}
+        data = msgpack.packb({'description':timestamp, 'keywords':[b'binarykeyword', 'stringkeyword'], 'bodies':[body]}, use_bin_type=True)
+        assert(env.LoadData(data))
+
+        localtime = datetime.datetime.fromtimestamp(1600000000).astimezone()
+        offset = localtime.strftime('%z')
+        expecteddescription = localtime.strftime('%Y-%m-%dT%H:%M:%S') + '.123' + ('Z' if offset == '+0000' else offset[:3] + ':' + offset[3:])
+        assert(env.GetDescription() == expecteddescription)
+        assert(env.GetKeywords() == ['binarykeyword', 'stringkeyword'])
+
+        def checkmesh(env):
+            meshbody = env.GetKinBody('meshbody')
+            assert(meshbody is not None)
+            mesh = meshbody.GetLinks()[0].GetGeometries()[0].GetCollisionMesh()
+            assert(len(mesh.indices) == numvertices//3)
+            assert(transdist(mesh.vertices.flatten(), vertices) <= g_epsilon*numvertices)
+            assert(list(mesh.indices.flatten()) == indices)
+
+        checkmesh(env)
+        tempdir = tempfile.mkdtemp()
+        try:
+            filename = os.path.join(tempdir, 'roundtrip.msgpack')
+            env.Save(filename)
+            env2 = Environment()
+            try:
+                assert(env2.Load(filename))
+                assert(env2.GetDescription() == expecteddescription)
+                assert(env2.GetKeywords() == ['binarykeyword', 'stringkeyword'])
+                checkmesh(env2)
+            finally:
+                env2.Destroy()
+        finally:
+            shutil.rmtree(tempdir)
+
+    def test_staterecorder(self):
+        self.log.info('record body states into a binary log and restore them at any time')
+        import tempfile
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        logdir = tempfile.mkdtemp()
+        try:
+            filename = os.path.join(logdir, 'states.bin')
+            recorder = RaveCreateModule(env,'StateRecorder')
+            # only the first frame is a keyframe, so the other frames are restored from the changed values
+            assert(recorder.SendCommand('Start timing manual keyframeinterval 1000 filename %s\n'%filename) is not None)
+            vstates = []
+            for i in range(5):
+                with env:
+                    robot.SetDOFValues(robot.GetDOFValues()*0.5 + 0.1*i)
+                    recorder.SendCommand('Sample')
+                    # manual sampling stamps frames with the wall time in microseconds
+                    vstates.append((int(time.time()*1000000), robot.GetLinkTransformations(), robot.GetDOFValues()))
+                time.sleep(0.01)
+            with env:
+                env.Remove(env.GetKinBody('mug1'))
+                recorder.SendCommand('Sample')
+            recorder.SendCommand('Stop')
+
+            replayer = RaveCreateModule(env,'StateReplayer')
+            assert(replayer.SendCommand('Open %s'%filename) is not None)
+            starttime, endtime = [int(x) for x in replayer.SendCommand('GetTimeRange').split()]
+            assert(starttime < endtime)
+            assert(len(replayer.SendCommand('GetKeyframeTimes').split()) == 1)
+            replayer.SendCommand('Seek %d'%starttime)
+            with env:
+                assert(transdist(robot.GetDOFValues(), vstates[0][2]) <= g_epsilon)
+                assert(transdist(robot.GetLinkTransformations(), vstates[0][1]) <= g_epsilon)
+            # seek backwards and forwards through the delta frames
+            for i in [3, 1, 4, 2]:
+                replayer.SendCommand('Seek %d'%vstates[i][0])
+                with env:
+                    assert(transdist(robot.GetDOFValues(), vstates[i][2]) <= g_epsilon)
+                    assert(transdist(robot.GetLinkTransformations(), vstates[i][1]) <= g_epsilon)
+                    assert(env.GetKinBody('mug1') is not None)
+            replayer.SendCommand('Seek %d'%endtime)
+            with env:
+                assert(transdist(robot.GetDOFValues(), vstates[-1][2]) <= g_epsilon)
+                assert(env.GetKinBody('mug1') is None)
+        finally:
+            shutil.rmtree(logdir)
+
     def test_dataccess(self):
         RaveDestroy()
         OPENRAVE_DATA = os.environ.get('OPENRAVE_DATA','')
@@ -262,3 +467,26 @@ class TestEnvironment(EnvironmentSetup):
         # thread is done, so should be able to lock
         assert(env.Lock(1.0))
         env.Unlock()
+
+    def test_statistics(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        with env:
+            env.ResetStatistics()
+            values = robot.GetDOFValues()
+            for i in range(10):
+                robot.SetDOFValues(values)
+            env.CheckCollision(robot)
+            statistics = env.GetStatistics()
+            assert(statistics['robot']['SetDOFValues']['numCalls'] >= 10)
+            checkername = env.GetCollisionChecker().GetXMLId()
+            assert(statistics[checkername]['CheckCollision']['numCalls'] == 1)
+            counter = statistics['robot']['SetDOFValues']
+            assert(counter['p50DurationNs'] <= counter['p99DurationNs'] <= counter['maxDurationNs'])
+            assert(sum(counter['histogram']) == counter['numCalls'])
+            # the json commands of any interface return the same counters
+            assert(robot.SendJSONCommand('GetStatistics', {'interfaceName':'robot'})['robot']['SetDOFValues']['numCalls'] == counter['numCalls'])
+            robot.SendJSONCommand('ResetStatistics', {'interfaceName':'robot'})
+            assert(env.GetStatistics('robot')['robot']['SetDOFValues']['numCalls'] == 0)
+            assert(env.GetStatistics()[checkername]['CheckCollision']['numCalls'] == 1)
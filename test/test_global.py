@@ -24,6 +24,21 @@ def test_pluginloading():
     env=Environment()
     assert(RaveCreateProblem(env,'ikfast') is not None)
 
+@with_destroy
+def test_pluginmanifest():
+    RaveDestroy()
+    RaveInitialize(load_all_plugins=True)
+    manifestfilename = os.path.join(RaveGetHomeDirectory(),'plugins.manifest')
+    assert(os.path.exists(manifestfilename))
+    plugininfo = RaveGetPluginInfo()
+    RaveDestroy()
+    # second initialization reads the interfaces from the manifest and loads the shared objects on first use
+    RaveInitialize(load_all_plugins=True)
+    assert(sorted(name for name,info in RaveGetPluginInfo()) == sorted(name for name,info in plugininfo))
+    env=Environment()
+    assert(RaveCreateProblem(env,'ikfast') is not None)
+    assert(RaveCreateController(env,'IdealController') is not None)
+
 class RunTutorialExample(object):
     __name__= 'test_global.tutorialexample'
     def __call__(self,modulepath):
@@ -122,6 +122,66 @@ class TestIkSolver(EnvironmentSetup):
         joint.SetLimits([-pi],[pi])
         sols=ikmodel.manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions|IkFilterOptions.IgnoreJointLimits)
 
+    def test_solveallbatch(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            lower,upper = robot.GetDOFLimits(ikmodel.manip.GetArmIndices())
+            ikparams = []
+            for i in range(20):
+                robot.SetDOFValues(lower+numpy.random.rand(len(lower))*(upper-lower),ikmodel.manip.GetArmIndices())
+                ikparams.append(ikmodel.manip.GetIkParameterization(IkParameterizationType.Transform6D,False))
+            cmd = 'SolveAllBatch %d 4 %d '%(IkFilterOptions.CheckEnvCollisions,len(ikparams)) + ' '.join([str(ikparam) for ikparam in ikparams])
+            output = [float(f) for f in ikmodel.manip.GetIkSolver().SendCommand(cmd).split()]
+            numsolutions = int(output[0])
+            armdof = int(output[1])
+            assert(armdof == len(ikmodel.manip.GetArmIndices()))
+            batchsols = [[] for ikparam in ikparams]
+            for isolution in range(numsolutions):
+                offset = 2+isolution*(armdof+1)
+                batchsols[int(output[offset])].append(output[offset+1:offset+1+armdof])
+            for ikparam, sols in zip(ikparams, batchsols):
+                expectedsols = ikmodel.manip.GetIkSolver().SolveAll(ikparam, IkFilterOptions.CheckEnvCollisions)
+                assert(len(sols) == len(expectedsols))
+                for sol, expectedikreturn in zip(sols, expectedsols):
+                    assert(transdist(sol, expectedikreturn.GetSolution()) <= g_epsilon)
+
+    def test_solutioncache(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        solver=ikmodel.manip.GetIkSolver()
+        with env:
+            lower,upper = robot.GetDOFLimits(ikmodel.manip.GetArmIndices())
+            ikparams = []
+            for i in range(10):
+                robot.SetDOFValues(lower+numpy.random.rand(len(lower))*(upper-lower),ikmodel.manip.GetArmIndices())
+                ikparams.append(ikmodel.manip.GetIkParameterization(IkParameterizationType.Transform6D,False))
+            expectedsols = [solver.SolveAll(ikparam, IkFilterOptions.CheckEnvCollisions) for ikparam in ikparams]
+            solver.SendCommand('SetSolutionCache 0.05 100')
+            try:
+                for iter in range(2):
+                    for ikparam, expectedikreturns in zip(ikparams, expectedsols):
+                        ikreturns = solver.SolveAll(ikparam, IkFilterOptions.CheckEnvCollisions)
+                        assert(len(ikreturns) == len(expectedikreturns))
+                        for ikreturn, expectedikreturn in zip(ikreturns, expectedikreturns):
+                            assert(transdist(ikreturn.GetSolution(), expectedikreturn.GetSolution()) <= g_epsilon)
+                numqueries, numhits, numnearbyhits, nummisses, numentries = [int(f) for f in solver.SendCommand('GetSolutionCacheStatistics').split()[:5]]
+                assert(numqueries == 2*len(ikparams))
+                assert(numhits == len(ikparams) and nummisses == len(ikparams))
+                assert(numentries == len(ikparams))
+            finally:
+                solver.SendCommand('SetSolutionCache 0')
+
     def test_returnactions(self):
         env=self.env
         self.LoadEnv('data/lab1.env.xml')
@@ -395,6 +395,32 @@ class TestKinematics(EnvironmentSetup):
         assert(transdist(torques1c,M_ref[0]) <= g_epsilon)
         assert(transdist(torques2c,M_ref[1]) <= g_epsilon)
 
+    def test_forwarddynamics(self):
+        self.log.info('verify mass matrix and forward dynamics against inverse dynamics')
+        env=self.env
+        with env:
+            env.GetPhysicsEngine().SetGravity([0,0,-10])
+            for envfile in ['robots/wam7.kinbody.xml', 'robots/barrettwam.robot.xml']:
+                env.Reset()
+                self.LoadEnv(envfile)
+                body = [body for body in env.GetBodies() if body.GetDOF() > 0][0]
+                lower,upper = body.GetDOFLimits()
+                vellimits = body.GetDOFVelocityLimits()
+                for iter in range(10):
+                    body.SetDOFValues(randlimits(lower,upper))
+                    body.SetDOFVelocities(randlimits(-vellimits,vellimits))
+                    dofaccel = 10*random.rand(body.GetDOF())-5
+                    externalforcetorque = {body.GetLinks()[-1].GetIndex():random.rand(6)-0.5}
+
+                    torquebase = body.ComputeInverseDynamics(None,externalforcetorque)
+                    torques = body.ComputeInverseDynamics(dofaccel,externalforcetorque)
+                    M = body.ComputeMassMatrix()
+                    assert(M.shape == (body.GetDOF(),body.GetDOF()))
+                    assert(transdist(dot(M,dofaccel)+torquebase,torques) <= 1e-10*len(torques))
+
+                    dofaccel2 = body.ComputeForwardDynamics(torques,externalforcetorque)
+                    assert(transdist(dofaccel2,dofaccel) <= 1e-8*len(dofaccel))
+
     @expected_failure  # not running in testopenrave-legacy either
     def test_inversedynamics(self):
         self.log.info('verify inverse dynamics computations')
@@ -1120,3 +1146,223 @@ class TestKinematics(EnvironmentSetup):
         assert(robot.CheckSelfCollision())
         robot.SetNonCollidingConfiguration()
         assert(not robot.CheckSelfCollision())
+
+    def test_bulkarrays(self):
+        self.log.info('bulk numpy accessors that share memory with the C++ buffers')
+        env=self.env
+        robot=self.LoadRobot('robots/barrettwam.robot.xml')
+        with env:
+            Tlinks,doflastvalues = robot.GetLinkTransformations(True)
+            poses,doflastvalues2 = robot.GetLinkTransformPoses(True)
+            assert(poses.shape == (len(robot.GetLinks()),7))
+            assert(transdist(matrixFromPoses(poses),Tlinks) <= g_epsilon)
+            assert(transdist(doflastvalues,doflastvalues2) == 0)
+            for ilink,link in enumerate(robot.GetLinks()):
+                assert(transdist(matrixFromPose(poses[ilink]),link.GetTransform()) <= g_epsilon)
+            # the returned array keeps its values after the body changes
+            posesold = array(poses)
+            robot.SetDOFValues(robot.GetDOFValues()+0.01)
+            assert(transdist(poses,posesold) == 0)
+            robot.SetLinkTransformations(Tlinks,doflastvalues)
+            # the array views a C++ buffer that belongs to it only, numpy views of it share that buffer
+            assert(not poses.flags.owndata and poses.flags.writeable)
+            assert(not numpy.shares_memory(poses,robot.GetLinkTransformPoses()))
+            translations = poses[:,4:]
+            assert(numpy.shares_memory(poses,translations))
+            translations += 1
+            assert(transdist(poses[:,4:],posesold[:,4:]+1) <= g_epsilon)
+            assert(transdist(robot.GetLinkTransformations(),Tlinks) <= g_epsilon)
+            del translations
+            poses[:] = posesold
+
+            robot.SetLinkTransformations(poses,doflastvalues)
+            assert(transdist(robot.GetLinkTransformations(),Tlinks) <= g_epsilon)
+            robot.SetDOFValues(robot.GetDOFValues()+0.01)
+            robot.SetLinkTransformations(array(Tlinks),doflastvalues)
+            assert(transdist(robot.GetLinkTransformations(),Tlinks) <= g_epsilon)
+
+            traj = RaveCreateTrajectory(env,'')
+            traj.Init(robot.GetActiveConfigurationSpecification())
+            waypoints = random.rand(10000,robot.GetActiveDOF())
+            traj.Insert(0,waypoints.flatten())
+            assert(transdist(traj.GetWaypoints2D(0,traj.GetNumWaypoints()),waypoints) <= g_epsilon)
+            assert(transdist(traj.GetWaypoints(0,traj.GetNumWaypoints()),waypoints.flatten()) <= g_epsilon)
+            # every call returns its own array, so changing one does not change the trajectory or other returned arrays
+            waypoints0 = traj.GetWaypoints2D(0,traj.GetNumWaypoints())
+            waypoints1 = traj.GetWaypoints2D(0,traj.GetNumWaypoints())
+            assert(not waypoints0.flags.owndata and not numpy.shares_memory(waypoints0,waypoints1))
+            waypoints0[0,0] += 1
+            assert(transdist(waypoints1,waypoints) <= g_epsilon)
+            assert(transdist(traj.GetWaypoint(0),waypoints[0]) <= g_epsilon)
+
+            # integer index arrays of any width are converted to int with one same-kind cast
+            dofvalues = robot.GetDOFValues()
+            for dtype in [int8,int32,int64,uint16]:
+                robot.SetDOFValues(dofvalues[:3]+0.01,array([2,1,0],dtype))
+                assert(transdist(robot.GetDOFValues([2,1,0]),dofvalues[:3]+0.01) <= g_epsilon)
+                robot.SetDOFValues(dofvalues)
+            assert(transdist(robot.GetDOFValues(array([2,1,0],int64)),dofvalues[[2,1,0]]) <= g_epsilon)
+
+            trimesh = env.Triangulate(robot)
+            assert(trimesh.vertices.shape[1] == 3 and trimesh.indices.shape[1] == 3)
+            assert(not trimesh.vertices.flags.owndata and not trimesh.indices.flags.owndata)
+            assert(len(trimesh.indices) > 0 and trimesh.indices.max() < len(trimesh.vertices))
+            vertices = array(trimesh.vertices)
+            robot.SetDOFValues(dofvalues+0.01)
+            assert(transdist(trimesh.vertices,vertices) == 0)
+            robot.SetDOFValues(dofvalues)
+
+            num = 1000
+            starttime=time.time()
+            for i in range(num):
+                [poseFromMatrix(T) for T in robot.GetLinkTransformations()]
+            listtime=time.time()-starttime
+            starttime=time.time()
+            for i in range(num):
+                robot.GetLinkTransformPoses()
+            arraytime=time.time()-starttime
+            self.log.info('GetLinkTransformations: %fs, GetLinkTransformPoses: %fs', listtime, arraytime)
+            starttime=time.time()
+            for i in range(num):
+                robot.SetLinkTransformations(poses,doflastvalues)
+            self.log.info('SetLinkTransformations with a (N,7) array: %fs', time.time()-starttime)
+            starttime=time.time()
+            for i in range(100):
+                traj.GetWaypoints2D(0,traj.GetNumWaypoints())
+            self.log.info('GetWaypoints2D of %d waypoints: %fs', traj.GetNumWaypoints(), (time.time()-starttime)/100)
+
+    def test_linkcollisiondata(self):
+        self.log.info('link collision data is the union of the geometries and follows their changes')
+        env=self.env
+        robot=self.LoadRobot('robots/barrettwam.robot.xml')
+        with env:
+            for link in robot.GetLinks():
+                vertices = []
+                numindices = 0
+                for geom in link.GetGeometries():
+                    mesh = geom.GetCollisionMesh()
+                    if len(mesh.vertices) > 0:
+                        vertices += list(transformPoints(geom.GetTransform(),mesh.vertices))
+                    numindices += len(mesh.indices)
+                linkmesh = link.GetCollisionData()
+                assert(len(linkmesh.vertices) == len(vertices) and len(linkmesh.indices) == numindices)
+                if len(vertices) > 0:
+                    assert(transdist(linkmesh.vertices,array(vertices)) <= g_epsilon*len(vertices))
+
+            body = RaveCreateKinBody(env,'')
+            body.InitFromBoxes(array([[0,0,0,0.1,0.2,0.3]]),True)
+            body.SetName('box')
+            env.Add(body)
+            link = body.GetLinks()[0]
+            assert(len(link.GetCollisionData().vertices) == len(link.GetGeometries()[0].GetCollisionMesh().vertices))
+            newmesh = TriMesh(array([[0,0,0],[1,0,0],[0,1,0]]),array([[0,1,2]]))
+            link.GetGeometries()[0].SetCollisionMesh(newmesh)
+            assert(transdist(link.GetCollisionData().vertices,newmesh.vertices) <= g_epsilon)
+            assert(transdist(link.GetCollisionData().indices,newmesh.indices) == 0)
+
+            # clones keep their own copy of the collision data
+            clonedenv = env.CloneSelf(CloningOptions.Bodies)
+            try:
+                clonedlink = clonedenv.GetKinBody('box').GetLinks()[0]
+                assert(transdist(clonedlink.GetCollisionData().vertices,newmesh.vertices) <= g_epsilon)
+                link.GetGeometries()[0].SetCollisionMesh(TriMesh(array([[0,0,0],[2,0,0],[0,2,0]]),array([[0,1,2]])))
+                assert(transdist(clonedlink.GetCollisionData().vertices,newmesh.vertices) <= g_epsilon)
+            finally:
+                clonedenv.Destroy()
+
+    def test_compacttrimesh(self):
+        self.log.info('compact meshes share their buffers between copies until one is modified and round-trip through single precision')
+        env=self.env
+        vertices = array([[0,0,0],[0.1,0,0],[0,1.0/3,0],[0.7,0.2,1e-3]])
+        indices = array([[0,1,2],[1,2,3]],int32)
+        trimesh = TriMesh(vertices,indices)
+
+        mesh0 = CompactTriMesh(trimesh)
+        assert(not mesh0.IsSinglePrecision() and mesh0.GetNumVertices() == 4 and mesh0.GetNumTriangles() == 2)
+        assert(mesh0.GetVertices().dtype == float64 and transdist(mesh0.GetVertices(),vertices) == 0)
+        assert(transdist(mesh0.GetIndices(),indices) == 0)
+        assert(not mesh0.IsShared())
+        mesh1 = mesh0.__copy__()
+        assert(mesh0.IsShared() and mesh1.IsShared())
+        assert(numpy.shares_memory(mesh0.GetVertices(),mesh1.GetVertices()))
+        assert(not mesh0.GetVertices().flags.writeable)
+        # modifying one copy duplicates the shared buffers, the other copy keeps its values
+        T = matrixFromAxisAngle([0,0,0.5])
+        T[0:3,3] = [1,2,3]
+        mesh1.ApplyTransform(T)
+        assert(not mesh0.IsShared() and not mesh1.IsShared())
+        assert(transdist(mesh0.GetVertices(),vertices) == 0)
+        assert(transdist(mesh1.GetVertices(),transformPoints(T,vertices)) <= g_epsilon)
+        assert(transdist(mesh1.GetIndices(),indices) == 0)
+        mesh2 = mesh0.__copy__()
+        mesh2.Append(trimesh,T)
+        assert(transdist(mesh0.GetVertices(),vertices) == 0 and mesh0.GetNumTriangles() == 2)
+        assert(transdist(mesh2.GetVertices(),r_[vertices,transformPoints(T,vertices)]) <= g_epsilon)
+        assert(transdist(mesh2.GetIndices(),r_[indices,indices+4]) == 0)
+
+        # single precision keeps the float32 rounding of the vertices and the exact indices
+        meshf = CompactTriMesh(trimesh,True)
+        assert(meshf.IsSinglePrecision() and meshf.GetVertices().dtype == float32)
+        assert(all(meshf.GetVertices() == vertices.astype(float32)))
+        trimeshf = meshf.GetTriMesh()
+        assert(all(trimeshf.vertices == vertices.astype(float32).astype(float64)))
+        assert(transdist(trimeshf.vertices,vertices) <= 1e-6)
+        assert(transdist(trimeshf.indices,indices) == 0)
+        assert(all(CompactTriMesh(trimeshf,True).GetVertices() == meshf.GetVertices()))
+        assert(all(CompactTriMesh(trimeshf).GetTriMesh().vertices == trimeshf.vertices))
+        assert(meshf.GetMemoryUsage() < mesh0.GetMemoryUsage())
+
+        # the link collision data is shared with the link until the geometries change
+        with env:
+            body = RaveCreateKinBody(env,'')
+            body.InitFromBoxes(array([[0,0,0,0.1,0.2,0.3]]),True)
+            body.SetName('box')
+            env.Add(body)
+            link = body.GetLinks()[0]
+            linkmesh = link.GetCompactCollisionData()
+            assert(linkmesh.IsShared())
+            assert(numpy.shares_memory(linkmesh.GetVertices(),link.GetCompactCollisionData().GetVertices()))
+            assert(transdist(linkmesh.GetTriMesh().vertices,link.GetCollisionData().vertices) == 0)
+            boxvertices = array(linkmesh.GetVertices())
+            link.GetGeometries()[0].SetCollisionMesh(trimesh)
+            assert(not linkmesh.IsShared())
+            assert(transdist(linkmesh.GetVertices(),boxvertices) == 0)
+            assert(transdist(link.GetCompactCollisionData().GetVertices(),vertices) <= g_epsilon)
+
+    def test_tessellation(self):
+        self.log.info('primitive geometries tessellated in bulk match their shape parameters')
+        env=self.env
+        with env:
+            infos = []
+            for i in range(200):
+                info = KinBody.Link.GeometryInfo()
+                info._t[0,3] = 0.1*i
+                if i % 2 == 0:
+                    info._type = KinBody.Link.GeomType.Sphere
+                    info._vGeomData = [0.05 + 0.01*(i%5),0,0]
+                else:
+                    info._type = KinBody.Link.GeomType.Cylinder
+                    info._vGeomData = [0.02 + 0.01*(i%3),0.1 + 0.1*(i%7),0]
+                infos.append(info)
+            body = RaveCreateKinBody(env,'')
+            body.InitFromGeometries(infos)
+            body.SetName('primitives')
+            env.Add(body)
+            geoms = body.GetLinks()[0].GetGeometries()
+            assert(len(geoms) == len(infos))
+            for info, geom in zip(infos, geoms):
+                mesh = geom.GetCollisionMesh()
+                assert(len(mesh.vertices) > 0 and len(mesh.indices) > 0)
+                if info._type == KinBody.Link.GeomType.Sphere:
+                    radii = sqrt(sum(mesh.vertices**2,1))
+                    assert(all(abs(radii-info._vGeomData[0]) <= g_epsilon))
+                else:
+                    assert(max(sqrt(sum(mesh.vertices[:,0:2]**2,1))) <= info._vGeomData[0]+g_epsilon)
+                    assert(abs(max(abs(mesh.vertices[:,2]))-0.5*info._vGeomData[1]) <= g_epsilon)
+
+                # the meshes above can come from the tessellation cache, so compare against a mesh that is tessellated
+                # again. the cache key holds the tessellation, and 1.001 gives the same sphere levels and cylinder
+                # sections as 1, so it misses the meshes cached at 1 the first time each shape is seen
+                geom.InitCollisionMesh(1.001)
+                mesh2 = geom.GetCollisionMesh()
+                assert(transdist(mesh.vertices,mesh2.vertices) <= g_epsilon and transdist(mesh.indices,mesh2.indices) == 0)
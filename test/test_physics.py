@@ -268,6 +268,42 @@ class RunPhysics(EnvironmentSetup):
             for i in range(10):
                 env.StepSimulation(0.01)
 
+    def test_odenumthreads(self):
+        if self.physicsenginename != 'ode':
+            return
+        log.info('test that stepping independent islands in several threads gives the same result as one thread')
+        env=self.env
+        with env:
+            env.GetPhysicsEngine().SetGravity([0,0,-9.8])
+            floor = RaveCreateKinBody(env,'')
+            floor.InitFromBoxes(numpy.array([[0,0,-0.05,10,10,0.05]]),True)
+            floor.SetName('floor')
+            floor.GetLinks()[0].SetStatic(True)
+            env.Add(floor)
+            bodies = []
+            for i in range(16):
+                body = env.ReadKinBodyURI('data/mug1.kinbody.xml')
+                body.SetName('mug%d'%i)
+                env.Add(body)
+                T = eye(4)
+                T[0:3,3] = [-3+2*(i%4), -3+2*(i//4), 0.3]
+                body.SetTransform(T)
+                bodies.append(body)
+            Tinit = [body.GetTransform() for body in bodies]
+
+            vTfinal = []
+            for numthreads in [1,4]:
+                env.GetPhysicsEngine().SendCommand('SetNumThreads %d'%numthreads)
+                for body, T in zip(bodies, Tinit):
+                    body.SetTransform(T)
+                    body.SetVelocity([0,0,0],[0,0,0])
+                for i in range(100):
+                    env.StepSimulation(0.01)
+                vTfinal.append([body.GetTransform() for body in bodies])
+            for T1, T4, T0 in zip(vTfinal[0], vTfinal[1], Tinit):
+                assert(abs(T1[2,3]-T0[2,3]) > 0.1)
+                assert(transdist(T1,T4) <= 1e-3)
+
 #generate_classes(RunPhysics, globals(), [('ode','ode'),('bullet','bullet')])
 
 class test_ode(RunPhysics):
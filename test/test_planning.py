@@ -12,6 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 from common_test_openrave import *
+import re
 
 class RunPlanning(EnvironmentSetup):
     def __init__(self,collisioncheckername):
@@ -42,6 +43,8 @@ class RunPlanning(EnvironmentSetup):
                 parameters = Planner.PlannerParameters()
                 parameters.SetRobotActiveJoints(robot)
                 planningutils.VerifyTrajectory(parameters,traj,samplingstep=0.002)
+                planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,numthreads=4)
+                planningutils.VerifyTrajectoryParallel(None,traj,samplingstep=0.002,numthreads=4)
             self.RunTrajectory(robot,traj)
 
             spec = manip.GetArmConfigurationSpecification()
@@ -627,6 +630,136 @@ class RunPlanning(EnvironmentSetup):
             assert(success)
             assert(not env.CheckCollision(collisionbody))
 
+    def test_dynamicscollisionconstraint_checkorder(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        with env:
+            robot.SetActiveDOFs(robot.GetActiveManipulator().GetArmIndices())
+            parameters = Planner.PlannerParameters()
+            parameters.SetRobotActiveJoints(robot)
+            sequentialconstraint = planningutils.DynamicsCollisionConstraint(parameters,[robot])
+            bisectionconstraint = planningutils.DynamicsCollisionConstraint(parameters,[robot])
+            bisectionconstraint.SetCheckOrder(planningutils.DynamicsCollisionCheckOrder.Bisection)
+            q0 = robot.GetActiveDOFValues()
+            options = ConstraintFilterOptions.CheckEnvCollisions|ConstraintFilterOptions.CheckSelfCollisions|ConstraintFilterOptions.FillCheckedConfiguration
+            lower,upper = robot.GetActiveDOFLimits()
+            for itry in range(20):
+                q1 = lower+numpy.random.rand(len(lower))*(upper-lower)
+                ret0 = sequentialconstraint.Check(q0,q1,[],[],0,Interval.Closed,options,True)
+                ret1 = bisectionconstraint.Check(q0,q1,[],[],0,Interval.Closed,options,True)
+                assert((ret0['returncode'] == 0) == (ret1['returncode'] == 0))
+                if ret0['returncode'] == 0:
+                    assert(len(ret0['configurationtimes']) == len(ret1['configurationtimes']))
+                    assert(transdist(ret0['configurationtimes'], ret1['configurationtimes']) <= g_epsilon)
+                    assert(transdist(ret0['configurations'], ret1['configurations']) <= g_epsilon)
+                else:
+                    assert(all(numpy.diff(ret1['configurationtimes']) > 0))
+
+    def _SweepThroughWall(self):
+        """loads a wam whose arm sweeps through a thin wall twice and returns the robot and the retimed trajectory
+        """
+        env = self.env
+        self.LoadEnv('robots/barrettwam.robot.xml')
+        robot = env.GetRobots()[0]
+        robot.SetActiveDOFs(robot.GetActiveManipulator().GetArmIndices())
+        values = zeros(robot.GetActiveDOF())
+        values[1] = 1.0
+        values[3] = 1.0
+        robot.SetActiveDOFValues(values)
+        wall = RaveCreateKinBody(env,'')
+        wall.InitFromBoxes(array([r_[robot.GetLink('wam4').GetTransform()[0:3,3],0.3,0.01,0.3]]),True)
+        wall.SetName('wall')
+        env.Add(wall,True)
+        traj = RaveCreateTrajectory(env,'')
+        traj.Init(robot.GetActiveConfigurationSpecification())
+        for angle in [-1,1,-1]:
+            values[0] = angle
+            traj.Insert(traj.GetNumWaypoints(),values)
+        planningutils.RetimeActiveDOFTrajectory(traj,robot,False,plannername='LinearTrajectoryRetimer')
+        return robot, wall, traj
+
+    def _GetVerifyFailureTime(self,parameters,traj,numthreads):
+        """returns the 'time Xs-Ys' of the segment reported by VerifyTrajectoryParallel, or VerifyTrajectory if numthreads is 0
+        """
+        try:
+            if numthreads == 0:
+                planningutils.VerifyTrajectory(parameters,traj,samplingstep=0.002)
+            else:
+                planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,numthreads=numthreads)
+        except openrave_exception as ex:
+            assert(ex.GetCode()=='InconsistentConstraints')
+            return re.search('time [0-9.]+s-[0-9.]+s',str(ex)).group(0)
+        return None
+
+    def test_verifytrajectoryparallel_invalidsegment(self):
+        self.log.info('segments violating the constraints are reported with and without caller parameters')
+        env = self.env
+        with env:
+            robot, wall, traj = self._SweepThroughWall()
+            parameters = Planner.PlannerParameters()
+            parameters.SetRobotActiveJoints(robot)
+            for numthreads in [2,4]:
+                assert(self._GetVerifyFailureTime(parameters,traj,numthreads) is not None)
+                assert(self._GetVerifyFailureTime(None,traj,numthreads) is not None)
+            env.Remove(wall)
+            planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,numthreads=4)
+            planningutils.VerifyTrajectoryParallel(None,traj,samplingstep=0.002,numthreads=4)
+
+    def test_verifytrajectoryparallel_earliestfailure(self):
+        self.log.info('the earliest invalid segment is reported regardless of the number of threads')
+        env = self.env
+        with env:
+            robot, wall, traj = self._SweepThroughWall()
+            parameters = Planner.PlannerParameters()
+            parameters.SetRobotActiveJoints(robot)
+            serialtime = self._GetVerifyFailureTime(parameters,traj,0)
+            assert(serialtime is not None)
+            for numthreads in [1,2,3,4]:
+                assert(self._GetVerifyFailureTime(parameters,traj,numthreads) == serialtime)
+                assert(self._GetVerifyFailureTime(None,traj,numthreads) == serialtime)
+
+    def test_visibleconfigurations(self):
+        self.log.info('camera poses evaluated in several threads give the same results as in one thread')
+        env = self.env
+        self.LoadEnv('data/testwamcamera.env.xml')
+        robot = env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot, iktype=IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            Tcamera = robot.GetAttachedSensor('camera').GetTransform()
+            target = RaveCreateKinBody(env,'')
+            target.InitFromBoxes(array([[0,0,0,0.05,0.05,0.01]]),True)
+            target.SetName('target')
+            env.Add(target,True)
+            Ttarget = array(Tcamera)
+            Ttarget[0:3,3] = dot(Tcamera[0:3,0:3],[0,0,0.4])+Tcamera[0:3,3]
+            target.SetTransform(Ttarget)
+
+            vf = interfaces.VisualFeedback(robot)
+            vf.SetCameraAndTarget(sensorname='camera',targetlink=target.GetLinks()[0])
+            poses = []
+            for i in range(12):
+                Tpose = dot(Tcamera,matrixFromAxisAngle([0,0,0.1*(i%3)]))
+                Tpose[0:3,3] += dot(Tcamera[0:3,0:3],[0.02*(i%4)-0.03,0.02*(i//4)-0.02,0])
+                poses.append(poseFromMatrix(Tpose))
+            initialvalues = robot.GetDOFValues()
+            vresults = []
+            for numthreads in [1,3]:
+                assert(vf.SetParameter(numthreads=numthreads) is not None)
+                vresults.append(vf.ComputeVisibleConfiguration(poses=poses))
+                assert(transdist(robot.GetDOFValues(),initialvalues) <= g_epsilon)
+            assert(len(vresults[0]) == len(poses))
+            assert(vresults[0] == vresults[1])
+            assert(any('solution' in result for result in vresults[0]))
+
+            # a bad number of threads keeps the previous one
+            assert(vf.SetParameter(numthreads=-1) is None)
+            assert(vf.ComputeVisibleConfiguration(poses=poses) == vresults[0])
+            assert_raises(openrave_exception, vf.ComputeVisibleConfiguration)
+
 #generate_classes(RunPlanning, globals(), [('ode','ode'),('bullet','bullet')])
 
 class test_ode(RunPlanning):
@@ -31,12 +31,14 @@ class TestSampling(EnvironmentSetup):
                     for N in [1,1000]:
                         lowerN = tile(lower,(N,1))
                         upperN = tile(upper,(N,1))
-                        closedvalues = sp.SampleSequence(type,N,Interval.Closed)
+                        # SampleSequence returns a flat array, SampleSequence2D returns one row per sample
+                        assert(len(sp.SampleSequence(type,N,Interval.Closed)) == N*dim)
+                        closedvalues = sp.SampleSequence2D(type,N,Interval.Closed)
                         assert(len(closedvalues) == N and all(closedvalues>=lowerN) and all(closedvalues<=upperN))
                         if type == SampleDataType.Real:
-                            openvalues = sp.SampleSequence(type,N,Interval.Open)
-                            openendvalues = sp.SampleSequence(type,N,Interval.OpenEnd)
-                            openstartvalues = sp.SampleSequence(type,N,Interval.OpenStart)
+                            openvalues = sp.SampleSequence2D(type,N,Interval.Open)
+                            openendvalues = sp.SampleSequence2D(type,N,Interval.OpenEnd)
+                            openstartvalues = sp.SampleSequence2D(type,N,Interval.OpenStart)
                             assert(len(openvalues) == N and all(openvalues>lowerN) and all(openvalues<upperN))
                             assert(len(openendvalues) == N and all(openendvalues>=lowerN) and all(openendvalues<upperN))
                             assert(len(openstartvalues) == N and all(openstartvalues>lowerN) and all(openstartvalues<=upperN))
@@ -60,3 +62,44 @@ class TestSampling(EnvironmentSetup):
         robot.SetActiveDOFs(range(robot.GetDOF()-3),Robot.DOFAffine.X|Robot.DOFAffine.Y|Robot.DOFAffine.RotationAxis,[0,0,1])
         values = sp.SampleSequence(SampleDataType.Real,1)
         assert(len(values) == robot.GetActiveDOF())
+
+    def test_streams(self):
+        self.log.info('low-discrepancy samplers with independent streams for parallel planners')
+        for samplername in ['ScrambledSobol','LeapedHalton']:
+            self._runsampler(samplername)
+            sp0=RaveCreateSpaceSampler(self.env,samplername)
+            sp1=RaveCreateSpaceSampler(self.env,samplername)
+            for sp in [sp0,sp1]:
+                sp.SetSpaceDOF(7)
+            sp1.SendCommand('SetStream 1')
+            values0 = sp0.SampleSequence2D(SampleDataType.Real,1000,Interval.Closed)
+            values1 = sp1.SampleSequence2D(SampleDataType.Real,1000,Interval.Closed)
+            assert(values0.shape == (1000,7) and values1.shape == (1000,7))
+            # samplers of the same stream return the same points, different streams return disjoint points
+            sp0.SendCommand('SetStream 1')
+            sp1.SendCommand('SetStream 1')
+            assert(all(sp0.SampleSequence2D(SampleDataType.Real,100,Interval.Closed) == sp1.SampleSequence2D(SampleDataType.Real,100,Interval.Closed)))
+            assert(len(set(map(tuple,values0)) & set(map(tuple,values1))) == 0)
+            # every dimension of the first points is stratified
+            assert(all(abs(mean(values0,0)-0.5) < 0.05))
+
+    def test_samplingthroughput(self):
+        self.log.info('SampleSequence2D samples into the returned array with the buffer api, check it returns the same samples as the vector api of SampleSequence and compare their throughput')
+        num=100000
+        dof=7
+        for samplername in ['MT19937','Halton','ScrambledSobol','LeapedHalton']:
+            spvector=RaveCreateSpaceSampler(self.env,samplername)
+            spbuffer=RaveCreateSpaceSampler(self.env,samplername)
+            for sp in [spvector,spbuffer]:
+                sp.SetSpaceDOF(dof)
+                sp.SetSeed(42)
+            starttime=time.time()
+            vectorvalues=spvector.SampleSequence(SampleDataType.Real,num,Interval.Closed)
+            vectortime=time.time()-starttime
+            starttime=time.time()
+            buffervalues=spbuffer.SampleSequence2D(SampleDataType.Real,num,Interval.Closed)
+            buffertime=time.time()-starttime
+            assert(vectorvalues.shape == (num*dof,))
+            assert(buffervalues.shape == (num,dof))
+            assert(all(reshape(vectorvalues,(num,dof)) == buffervalues))
+            self.log.info('%s: vector %d samples/s, buffer %d samples/s', samplername, num/max(vectortime,1e-6), num/max(buffertime,1e-6))
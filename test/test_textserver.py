@@ -0,0 +1,67 @@
+# -*- coding: utf-8 -*-
+from common_test_openrave import *
+import socket, struct
+
+class TestTextServer(EnvironmentSetup):
+    def _ReceiveBytes(self, sock, size):
+        data = b''
+        while len(data) < size:
+            chunk = sock.recv(size-len(data))
+            assert(len(chunk) > 0)
+            data += chunk
+        return data
+
+    def _ReceiveResult(self, sock):
+        # every result is sent as a native int32 size followed by the data
+        size = struct.unpack('=i', self._ReceiveBytes(sock, 4))[0]
+        return self._ReceiveBytes(sock, size).decode('utf-8')
+
+    def test_pipelining(self):
+        self.log.info('requests sent together on one connection are answered in order, and their latencies are reported by server_getlatencies')
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        with env:
+            lower,upper = robot.GetDOFLimits()
+            robot.SetDOFValues(lower + 0.25*(upper-lower))
+            values = robot.GetDOFValues()
+            bodyindex = robot.GetEnvironmentBodyIndex()
+
+        probe = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        probe.bind(('127.0.0.1', 0))
+        port = probe.getsockname()[1]
+        probe.close()
+        server = RaveCreateModule(env,'textserver')
+        assert(server is not None)
+        env.AddModule(server, '%d 4'%port)
+        try:
+            sock = socket.create_connection(('127.0.0.1', port), timeout=10)
+            try:
+                numrequests = 50
+                requests = []
+                for irequest in range(numrequests):
+                    dofindex = irequest % robot.GetDOF()
+                    requests.append(('body_getjoints %d %d\n'%(bodyindex, dofindex), [values[dofindex]]))
+                requests.append(('body_getjoints %d\n'%bodyindex, values))
+                data = ''.join(request for request, expectedvalues in requests).encode('utf-8')
+                # split one request over two sends so the server has to keep incomplete lines
+                splitindex = len(data) - 5
+                sock.sendall(data[:splitindex])
+                time.sleep(0.1)
+                sock.sendall(data[splitindex:])
+                for request, expectedvalues in requests:
+                    result = [float(value) for value in self._ReceiveResult(sock).split()]
+                    assert(transdist(result, expectedvalues) <= g_epsilon)
+
+                sock.sendall(b'server_getlatencies\n')
+                latencies = {}
+                for line in self._ReceiveResult(sock).splitlines():
+                    tokens = line.split()
+                    latencies[tokens[0]] = [int(token) for token in tokens[1:]]
+                assert(latencies['body_getjoints'][0] == numrequests+1)
+                p50, p90, p99, pmax = latencies['body_getjoints'][1:]
+                assert(p50 <= p90 <= p99 <= pmax)
+            finally:
+                sock.close()
+        finally:
+            env.Remove(server)
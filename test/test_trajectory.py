@@ -776,6 +776,31 @@ class TestTrajectory(EnvironmentSetup):
         sampledata=traj.Sample(1.5,velspec)
         assert(transdist(sampledata, array([-1. ,  0. ,  0. ,  0. ,  0. , -0.5,  0. ])) <= g_epsilon)
 
+    def test_cachedconversions(self):
+        self.log.debug('sampling with alternating specifications has to match converting the native samples')
+        env=self.env
+        self.LoadEnv('robots/schunk-lwa3.zae')
+        robot=env.GetRobots()[0]
+        with env:
+            spec = robot.GetActiveConfigurationSpecification('linear')
+            traj = RaveCreateTrajectory(env,'')
+            traj.Init(spec)
+            traj.Insert(0,r_[zeros(robot.GetDOF()),0.5*ones(robot.GetDOF())])
+            planningutils.RetimeActiveDOFTrajectory(traj,robot,False,1,1,'LinearTrajectoryRetimer')
+            robotname = robot.GetName()
+            subsetspec = ConfigurationSpecification()
+            subsetspec.AddGroup('joint_values %s 3 1 0'%robotname,3,'linear')
+            # the transform is not in the trajectory, so has to be filled from the robot
+            affinespec = spec.GetTimeDerivativeSpecification(0)+RaveGetAffineConfigurationSpecification(DOFAffine.Transform,robot)
+            specs = [subsetspec, affinespec, spec.ConvertToVelocitySpecification()]
+            for itime, t in enumerate(arange(0,traj.GetDuration(),0.05)):
+                targetspec = specs[itime%len(specs)]
+                expected = traj.GetConfigurationSpecification().ConvertData(targetspec,traj.Sample(t),1,env,True)
+                assert(transdist(traj.Sample(t,targetspec),expected) <= g_epsilon)
+            # inserting with a different specification
+            traj.Insert(traj.GetNumWaypoints(),traj.GetWaypoint(0,subsetspec),subsetspec)
+            assert(transdist(traj.GetWaypoint(-1,subsetspec),traj.GetWaypoint(0,subsetspec)) <= g_epsilon)
+
     @expected_failure  # cannot generate iksolver with newer sympy
     def test_insertionsmoothing(self):
         env=self.env
@@ -892,3 +917,70 @@ class TestTrajectory(EnvironmentSetup):
         planningutils.SegmentTrajectory(traj, startoffset, duration)
         assert( abs(traj.GetDuration() - (duration-startoffset)) <= g_epsilon )
 
+
+    def _ComputeMaxManipSpeedAccel(self, robot, traj):
+        # speed and acceleration of the corners of the box enclosing the end-effector at the waypoints, the same checkpoints as the manip constraint checker of parabolicsmoother2
+        manip = robot.GetActiveManipulator()
+        eelink = manip.GetEndEffector()
+        Teeinv = linalg.inv(eelink.GetTransform())
+        corners = []
+        for link in manip.GetChildLinks():
+            ab = link.ComputeLocalAABB()
+            Tdelta = dot(Teeinv, link.GetTransform())
+            for signs in [[x,y,z] for x in [-1,1] for y in [-1,1] for z in [-1,1]]:
+                corners.append(dot(Tdelta[0:3,0:3], ab.pos()+array(signs)*ab.extents())+Tdelta[0:3,3])
+        cornermin = array(corners).min(0)
+        cornermax = array(corners).max(0)
+        checkpoints = array([[x,y,z] for x in [cornermin[0],cornermax[0]] for y in [cornermin[1],cornermax[1]] for z in [cornermin[2],cornermax[2]]])
+        spec = traj.GetConfigurationSpecification()
+        indices = robot.GetActiveDOFIndices()
+        speeds = [0]
+        accels = [0]
+        for iwaypoint in range(1,traj.GetNumWaypoints()):
+            waypoints = [traj.GetWaypoint(iwaypoint-1), traj.GetWaypoint(iwaypoint)]
+            deltatime = spec.ExtractDeltaTime(waypoints[1])
+            if deltatime <= g_epsilon:
+                continue
+            velocities = [spec.ExtractJointValues(waypoint,robot,indices,1) for waypoint in waypoints]
+            # joint values are quadratic, so the acceleration is constant between waypoints
+            dofaccelerations = zeros(robot.GetDOF())
+            dofaccelerations[indices] = (velocities[1]-velocities[0])/deltatime
+            for waypoint, dofvelocities in zip(waypoints, velocities):
+                robot.SetDOFValues(spec.ExtractJointValues(waypoint,robot,indices,0),indices)
+                robot.SetDOFVelocities(dofvelocities,indices)
+                linkvelocity = robot.GetLinkVelocities()[eelink.GetIndex()]
+                linkaccel = robot.GetLinkAccelerations(dofaccelerations)[eelink.GetIndex()]
+                R = eelink.GetTransform()[0:3,0:3]
+                for checkpoint in checkpoints:
+                    r = dot(R,checkpoint)
+                    vpoint = linkvelocity[0:3] + cross(linkvelocity[3:6],r)
+                    apoint = linkaccel[0:3] + cross(linkaccel[3:6],r) + cross(linkvelocity[3:6],cross(linkvelocity[3:6],r))
+                    speeds.append(linalg.norm(vpoint))
+                    accels.append(linalg.norm(apoint))
+        return numpy.max(speeds), numpy.max(accels)
+
+    def test_smoothingmanipconstraints(self):
+        self.log.info('parabolicsmoother2 keeps the speed and acceleration of the end-effector within the manip limits at the ends of every ramp')
+        env=self.env
+        robot=self.LoadRobot('robots/barrettwam.robot.xml')
+        with env:
+            manip = robot.SetActiveManipulator('arm')
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            q0 = zeros(robot.GetActiveDOF())
+            q0[[0,1,3]] = [-1.0,0.5,1.0]
+            q1 = zeros(robot.GetActiveDOF())
+            q1[[0,1,3]] = [1.0,1.0,1.5]
+            maxmanipspeed = 0.5
+            maxmanipaccel = 2.0
+            results = []
+            for plannerparameters in ['', '<manipname>arm</manipname><maxmanipspeed>%f</maxmanipspeed>'%maxmanipspeed, '<manipname>arm</manipname><maxmanipaccel>%f</maxmanipaccel>'%maxmanipaccel]:
+                traj = RaveCreateTrajectory(env,'')
+                traj.Init(robot.GetActiveConfigurationSpecification('linear'))
+                traj.Insert(0,r_[q0,q1])
+                ret=planningutils.SmoothActiveDOFTrajectory(traj,robot,maxvelmult=1,maxaccelmult=1,plannername='parabolicsmoother2',plannerparameters=plannerparameters)
+                assert(ret.statusCode==PlannerStatusCode.HasSolution)
+                results.append(self._ComputeMaxManipSpeedAccel(robot,traj))
+            # without manip limits the motion is fast enough to trip both limits, so the checks below exercise the checker
+            assert(results[0][0] > maxmanipspeed and results[0][1] > maxmanipaccel)
+            assert(results[1][0] <= maxmanipspeed*(1+1e-3))
+            assert(results[2][1] <= maxmanipaccel*(1+1e-3))